@@ -0,0 +1,450 @@
+/**
+ * @file Batch / replay mode for the dispatcher: many events through ONE warm
+ *   process. `node index.cjs __fleet-batch [file…]` or the snapshot boot
+ *   `node --snapshot-blob <blob> __fleet-batch [file…]` reads NDJSON from
+ *   each file in turn (stdin when none is given), runs every record through
+ *   the same `dispatchRaw` a live event takes, and writes one NDJSON result
+ *   per record to stdout.
+ *
+ *   An input line is either
+ *
+ *     { "event": "<Event>", "payload": { …hook stdin payload… } }
+ *
+ *   or a row of a Claude transcript, replayed into the events the harness
+ *   would have fired for it: a `tool_use` block is a PreToolUse, its
+ *   `tool_result` a PostToolUse (with the row's `toolUseResult` as
+ *   `tool_response`, else the block's content), and a main-thread assistant
+ *   turn followed by the next genuine user prompt (or the end of the file) is
+ *   a Stop. The rows are appended to a scratch transcript as they are read,
+ *   so each replayed event's `transcript_path` holds the session exactly as
+ *   far as it had got: a PreToolUse sees its own tool_use row, a PostToolUse
+ *   not yet its result, a Stop not yet the next prompt. `cwd` and
+ *   `session_id` come from the rows; a recorded cwd that doesn't exist here
+ *   just makes the hooks that read it fail open.
+ *
+ *   STATEFUL HOOKS ARE SKIPPED. A recorded cwd is usually the live project,
+ *   and its runtime state isn't confined to one redirectable root (the
+ *   ledgers sit under `node_modules/.cache`, throttle stamps and logs under
+ *   the home dir, and some hooks kill processes or land commits). So every
+ *   record runs with `skipStateful`: a hook the table marks `stateful`
+ *   (`@dispatch-must-run`, `@dispatch-stateful`, or a write the maker spots
+ *   in its source; see dispatch-scan.mts) doesn't run. Thousands of replayed
+ *   events then can't plant ledger entries for dead sessions, trip
+ *   live-edit-collision-guard on real edits, or skew recurrence counts. The
+ *   price is that those hooks' verdicts are absent from a replay diff, and
+ *   their `hooks` timings too.
+ *
+ *   One result line per record:
+ *
+ *     { "i": <n>, "source": "<file>:<line>", "event", "tool", "exitCode",
+ *       "stdout", "stderr", "us": <dispatch µs>, "hooks": [[<hook>, <µs>]…] }
+ *
+ *   `scripts/fleet/dispatch-replay.mts` drives this: it diffs the verdict
+ *   fields of two builds over the same input and summarizes per-hook cost,
+ *   cold (each hook's first run) apart from JIT-warm steady state.
+ *
+ *   The heap is SHARED across records, unlike one-shot dispatches: module
+ *   memos (git facts, parsed configs) carry over, which is the point when
+ *   measuring steady state, and means a verdict that reads such a memo
+ *   reflects the repo as the first record found it. The verdict cache and
+ *   the latency profile default to off here (FLEET_VERDICT_CACHE=0,
+ *   FLEET_DISPATCH_PROFILE=0, unless already set), so every record runs its
+ *   hooks and a replay of old sessions stays out of the repo's live
+ *   histograms.
+ *
+ *   This module only imports types from `dispatch-cli.mts`: the CLI and the
+ *   snapshot entry hand it their `dispatchRaw`. Nothing runs at module eval
+ *   (snapshot-clean).
+ */
+
+import { appendFileSync, mkdtempSync, readFileSync, rmSync } from 'node:fs'
+import os from 'node:os'
+import path from 'node:path'
+import process from 'node:process'
+
+import {
+  extractTurnPieces,
+  resolveRoleAndContent,
+} from '../_shared/transcript.mts'
+
+import { PROFILE_ENV } from './dispatch-profile.mts'
+import { traceNow } from './dispatch-trace.mts'
+import { VERDICT_CACHE_ENV } from './verdict-cache.mts'
+
+import type {
+  DispatchOutput,
+  DispatchRawOptions,
+} from './dispatch-cli.mts'
+import type { DispatchPayload } from './dispatch-types.mts'
+
+/**
+ * The argv sentinel (in the event slot) that selects batch mode.
+ */
+export const BATCH_ARG = '__fleet-batch'
+
+/**
+ * Runs one event the way a live dispatch does; `onHookTimed` gets each hook's
+ * wall time. `dispatchRaw` is one.
+ */
+export type BatchDispatch = (
+  event: string,
+  raw: string,
+  options: DispatchRawOptions,
+) => Promise<DispatchOutput>
+
+export interface BatchRecord {
+  readonly event: string
+  readonly payload: DispatchPayload
+}
+
+export interface BatchResult {
+  readonly event: string
+  readonly exitCode: number
+  readonly hooks: ReadonlyArray<readonly [name: string, micros: number]>
+  readonly i: number
+  readonly source: string
+  readonly stderr: string
+  readonly stdout: string
+  readonly tool: string | undefined
+  readonly us: number
+}
+
+interface PendingToolUse {
+  readonly input: Record<string, unknown>
+  readonly name: string
+}
+
+/**
+ * Replay state for one transcript.
+ */
+export interface TranscriptReplay {
+  cwd: string
+  readonly pending: Map<string, PendingToolUse>
+  sessionId: string | undefined
+  readonly transcriptPath: string
+  // A main-thread assistant turn has run since the last Stop.
+  turnOpen: boolean
+}
+
+/**
+ * What one transcript row replays into: the events that fire before the row
+ * is in the transcript and the ones that fire after.
+ */
+export interface ReplayStep {
+  readonly after: readonly BatchRecord[]
+  readonly before: readonly BatchRecord[]
+}
+
+const NO_STEP: ReplayStep = {
+  __proto__: null,
+  after: [],
+  before: [],
+} as ReplayStep
+
+/**
+ * A fresh replay writing its scratch transcript to `transcriptPath`.
+ */
+export function createTranscriptReplay(
+  transcriptPath: string,
+  cwd: string = process.cwd(),
+): TranscriptReplay {
+  return {
+    __proto__: null,
+    cwd,
+    pending: new Map(),
+    sessionId: undefined,
+    transcriptPath,
+    turnOpen: false,
+  } as TranscriptReplay
+}
+
+function basePayload(
+  replay: TranscriptReplay,
+  event: string,
+): Record<string, unknown> {
+  return {
+    __proto__: null,
+    cwd: replay.cwd,
+    hook_event_name: event,
+    session_id: replay.sessionId,
+    transcript_path: replay.transcriptPath,
+  } as Record<string, unknown>
+}
+
+function record(event: string, payload: Record<string, unknown>): BatchRecord {
+  return {
+    __proto__: null,
+    event,
+    payload: payload as DispatchPayload,
+  } as BatchRecord
+}
+
+function blocksOf(content: unknown): Array<Record<string, unknown>> {
+  if (!Array.isArray(content)) {
+    return []
+  }
+  const out: Array<Record<string, unknown>> = []
+  for (let i = 0, { length } = content; i < length; i += 1) {
+    const block = content[i]
+    if (block && typeof block === 'object') {
+      out.push(block as Record<string, unknown>)
+    }
+  }
+  return out
+}
+
+function stopRecord(replay: TranscriptReplay): BatchRecord {
+  replay.turnOpen = false
+  const payload = basePayload(replay, 'Stop')
+  payload['stop_hook_active'] = false
+  return record('Stop', payload)
+}
+
+/**
+ * The events one transcript row replays into (mutates `replay`). A malformed
+ * row or one without tool traffic or a prompt replays into nothing.
+ */
+export function replayTranscriptLine(
+  replay: TranscriptReplay,
+  line: string,
+): ReplayStep {
+  let evt: unknown
+  try {
+    evt = JSON.parse(line)
+  } catch {
+    return NO_STEP
+  }
+  const r = resolveRoleAndContent(evt)
+  if (!r) {
+    return NO_STEP
+  }
+  const row = evt as Record<string, unknown>
+  if (typeof row['cwd'] === 'string' && row['cwd']) {
+    replay.cwd = row['cwd']
+  }
+  if (typeof row['sessionId'] === 'string') {
+    replay.sessionId = row['sessionId']
+  }
+  const before: BatchRecord[] = []
+  const after: BatchRecord[] = []
+  const blocks = blocksOf(r.content)
+  if (r.role === 'assistant') {
+    for (let i = 0, { length } = blocks; i < length; i += 1) {
+      const b = blocks[i]!
+      const name = b['name']
+      const input = b['input']
+      if (
+        b['type'] !== 'tool_use' ||
+        typeof name !== 'string' ||
+        !input ||
+        typeof input !== 'object'
+      ) {
+        continue
+      }
+      const tool = {
+        __proto__: null,
+        input: input as Record<string, unknown>,
+        name,
+      } as PendingToolUse
+      if (typeof b['id'] === 'string') {
+        replay.pending.set(b['id'], tool)
+      }
+      const payload = basePayload(replay, 'PreToolUse')
+      payload['tool_name'] = name
+      payload['tool_input'] = tool.input
+      payload['tool_use_id'] = b['id']
+      after.push(record('PreToolUse', payload))
+    }
+    if (!r.isSidechain) {
+      replay.turnOpen = true
+    }
+  } else if (r.role === 'user') {
+    for (let i = 0, { length } = blocks; i < length; i += 1) {
+      const b = blocks[i]!
+      const id = b['tool_use_id']
+      const tool =
+        b['type'] === 'tool_result' && typeof id === 'string'
+          ? replay.pending.get(id)
+          : undefined
+      if (!tool) {
+        continue
+      }
+      replay.pending.delete(id as string)
+      const payload = basePayload(replay, 'PostToolUse')
+      payload['tool_name'] = tool.name
+      payload['tool_input'] = tool.input
+      payload['tool_response'] = row['toolUseResult'] ?? b['content']
+      payload['tool_use_id'] = id
+      before.push(record('PostToolUse', payload))
+    }
+    if (
+      !r.isSidechain &&
+      replay.turnOpen &&
+      extractTurnPieces(r.content).length
+    ) {
+      // The harness fired Stop when the answer ended, before this prompt.
+      before.push(stopRecord(replay))
+    }
+  }
+  return before.length || after.length
+    ? ({ __proto__: null, after, before } as ReplayStep)
+    : NO_STEP
+}
+
+/**
+ * The events the end of a transcript replays into: the last turn's Stop.
+ */
+export function replayTranscriptEnd(replay: TranscriptReplay): BatchRecord[] {
+  return replay.turnOpen ? [stopRecord(replay)] : []
+}
+
+/**
+ * An explicit `{ event, payload }` batch record, or undefined when the line
+ * is something else (a transcript row).
+ */
+export function parseBatchRecord(line: string): BatchRecord | undefined {
+  let value: unknown
+  try {
+    value = JSON.parse(line)
+  } catch {
+    return undefined
+  }
+  if (!value || typeof value !== 'object') {
+    return undefined
+  }
+  const { event, payload } = value as Record<string, unknown>
+  if (typeof event !== 'string' || !event) {
+    return undefined
+  }
+  if (!payload || typeof payload !== 'object' || Array.isArray(payload)) {
+    return undefined
+  }
+  return record(event, payload as Record<string, unknown>)
+}
+
+function readSource(file: string | undefined): string {
+  try {
+    // fd 0 is stdin on every platform.
+    return readFileSync(file ?? 0, 'utf8')
+  } catch {
+    return ''
+  }
+}
+
+function micros(startNs: bigint, endNs: bigint): number {
+  return endNs > startNs ? Math.round(Number(endNs - startNs) / 100) / 10 : 0
+}
+
+/**
+ * Run every record of `files` (stdin when empty) through `run` and write one
+ * result line each to stdout. Fail-open per record: a throw renders as the
+ * record's silent allow, like a live dispatch.
+ */
+export async function runDispatchBatch(
+  files: readonly string[],
+  run: BatchDispatch,
+): Promise<void> {
+  process.env[VERDICT_CACHE_ENV] ??= '0'
+  process.env[PROFILE_ENV] ??= '0'
+  const sources: Array<string | undefined> = files.length
+    ? [...files]
+    : [undefined]
+  let scratch: string | undefined
+  let count = 0
+  let out = ''
+  const flush = async (): Promise<void> => {
+    if (out && !process.stdout.write(out)) {
+      await new Promise(resolve => process.stdout.once('drain', resolve))
+    }
+    out = ''
+  }
+  const dispatchOne = async (rec: BatchRecord, source: string) => {
+    const hooks: Array<readonly [string, number]> = []
+    const start = traceNow()
+    let output: DispatchOutput
+    try {
+      output = await run(rec.event, JSON.stringify(rec.payload), {
+        __proto__: null,
+        onHookTimed: (name: string, startNs: bigint, endNs: bigint) => {
+          hooks.push([name, micros(startNs, endNs)])
+        },
+        skipStateful: true,
+      } as DispatchRawOptions)
+    } catch {
+      output = {
+        __proto__: null,
+        exitCode: 0,
+        stderr: '',
+        stdout: '',
+      } as DispatchOutput
+    }
+    const result: BatchResult = {
+      __proto__: null,
+      i: count,
+      source,
+      event: rec.event,
+      tool: rec.payload.tool_name,
+      exitCode: output.exitCode,
+      stdout: output.stdout,
+      stderr: output.stderr,
+      us: micros(start, traceNow()),
+      hooks,
+    } as BatchResult
+    count += 1
+    out += `${JSON.stringify(result)}\n`
+    if (out.length >= 64 * 1024) {
+      await flush()
+    }
+  }
+  try {
+    for (let s = 0, { length } = sources; s < length; s += 1) {
+      const file = sources[s]
+      const label = file ?? '-'
+      const lines = readSource(file).split('\n')
+      let replay: TranscriptReplay | undefined
+      for (let n = 0, { length: nlen } = lines; n < nlen; n += 1) {
+        const line = lines[n]!.trim()
+        if (!line) {
+          continue
+        }
+        const where = `${label}:${n + 1}`
+        const explicit = parseBatchRecord(line)
+        if (explicit) {
+          // eslint-disable-next-line no-await-in-loop
+          await dispatchOne(explicit, where)
+          continue
+        }
+        if (!replay) {
+          scratch ??= mkdtempSync(path.join(os.tmpdir(), 'fleet-replay-'))
+          replay = createTranscriptReplay(
+            path.join(scratch, `transcript-${s}.jsonl`),
+          )
+        }
+        const step = replayTranscriptLine(replay, line)
+        for (let i = 0, { length: blen } = step.before; i < blen; i += 1) {
+          // eslint-disable-next-line no-await-in-loop
+          await dispatchOne(step.before[i]!, where)
+        }
+        appendFileSync(replay.transcriptPath, `${line}\n`)
+        for (let i = 0, { length: alen } = step.after; i < alen; i += 1) {
+          // eslint-disable-next-line no-await-in-loop
+          await dispatchOne(step.after[i]!, where)
+        }
+      }
+      if (replay) {
+        const tail = replayTranscriptEnd(replay)
+        for (let i = 0, { length: tlen } = tail; i < tlen; i += 1) {
+          // eslint-disable-next-line no-await-in-loop
+          await dispatchOne(tail[i]!, `${label}:end`)
+        }
+      }
+    }
+    await flush()
+  } finally {
+    if (scratch) {
+      try {
+        rmSync(scratch, { force: true, recursive: true })
+      } catch {}
+    }
+  }
+}
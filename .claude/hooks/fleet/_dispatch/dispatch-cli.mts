@@ -0,0 +1,182 @@
+/**
+ * @file The per-invocation shell around `dispatch()`: read the event arg and
+ *   stdin once, parse the payload lazily (`_shared/lazy-json.mts`), run the
+ *   event's hooks, and render the result into the hook protocol. Every runner
+ *   goes through `dispatchRaw` — the `index.cjs` bundle, the snapshot
+ *   deserialize-main, the warm daemon worker and batch mode — so all of them
+ *   fail open the same way and surface byte-identical output.
+ */
+
+import process from 'node:process'
+
+import { parseJsonLazy } from '../_shared/lazy-json.mts'
+import { readStdin } from '../_shared/transcript.mts'
+
+import { BATCH_ARG, runDispatchBatch } from './dispatch-batch.mts'
+import { hooksFor } from './dispatch-index.mts'
+import { dispatchBudgetMs, dispatchConcurrency } from './dispatch-pool.mts'
+import { profileFlush, profileStart } from './dispatch-profile.mts'
+import {
+  traceFlush,
+  traceNow,
+  tracePhase,
+  traceStart,
+} from './dispatch-trace.mts'
+import { dispatch } from './dispatch.mts'
+import type { DispatchOptions } from './dispatch.mts'
+import { ensureLazyHooks } from './lazy-hooks.mts'
+import { openVerdictMemo } from './verdict-cache.mts'
+
+import type { DispatchPayload, DispatchResult } from './dispatch-types.mts'
+
+/**
+ * The exact bytes + exit code a dispatch surfaces, independent of where they
+ * are written. Every runner — the CLI below, the snapshot deserialize-main,
+ * and the warm daemon worker — renders through `dispatchOutput`, so the three
+ * paths stay byte-equivalent by construction rather than by copy.
+ */
+export interface DispatchOutput {
+  readonly exitCode: number
+  readonly stderr: string
+  readonly stdout: string
+}
+
+/**
+ * Render a dispatch result into the hook protocol: reminders on stderr; a Stop
+ * block as the stdout-JSON decision (exit 0); a PreToolUse / PostToolUse block
+ * as exit code 2 (the reason already rides stderr as a reminder line).
+ */
+export function dispatchOutput(
+  result: DispatchResult,
+  payload: DispatchPayload,
+): DispatchOutput {
+  const stderr = result.reminders.length
+    ? result.reminders.join('\n') + '\n'
+    : ''
+  let stdout = ''
+  let exitCode = 0
+  if (result.decision === 'block' && result.blockReason !== undefined) {
+    if (payload.tool_name === undefined) {
+      stdout = JSON.stringify({ decision: 'block', reason: result.blockReason })
+    } else {
+      exitCode = 2
+    }
+  }
+  return { __proto__: null, exitCode, stderr, stdout } as DispatchOutput
+}
+
+export interface DispatchRawOptions {
+  /**
+   * Passed through to `dispatch()` (DispatchOptions.onHookTimed).
+   */
+  readonly onHookTimed?:
+    | ((name: string, startNs: bigint, endNs: bigint) => void)
+    | undefined
+  /**
+   * Passed through to `dispatch()` (DispatchOptions.skipStateful).
+   */
+  readonly skipStateful?: boolean | undefined
+}
+
+/**
+ * Run one event against a raw stdin payload and render the result. The single
+ * per-invocation body shared by every runner: a blank or unparseable payload,
+ * or a throw escaping `dispatch()`, renders as the silent allow (fail-open).
+ */
+export async function dispatchRaw(
+  event: string,
+  raw: string,
+  options?: DispatchRawOptions | undefined,
+): Promise<DispatchOutput> {
+  const allow = {
+    __proto__: null,
+    exitCode: 0,
+    stderr: '',
+    stdout: '',
+  } as DispatchOutput
+  try {
+    if (!raw.trim()) {
+      return allow
+    }
+    let payload: DispatchPayload
+    const parseStart = traceNow()
+    try {
+      // Big string fields (Write content, a Read's tool_response) stay
+      // undecoded until a hook reads them.
+      payload = parseJsonLazy(raw) as DispatchPayload
+    } catch {
+      return allow
+    }
+    tracePhase('parse', parseStart)
+    profileStart(event, payload.tool_name)
+    ensureLazyHooks(event, payload.tool_name)
+    const dispatchStart = traceNow()
+    const verdicts = hooksFor(event, payload.tool_name).some(e => e.pure)
+      ? openVerdictMemo(event, payload)
+      : undefined
+    try {
+      const result = await dispatch(event, payload, {
+        __proto__: null,
+        budgetMs: dispatchBudgetMs(),
+        concurrency: dispatchConcurrency(),
+        onHookTimed: options?.onHookTimed,
+        skipStateful: options?.skipStateful,
+        verdicts,
+      } as DispatchOptions)
+      tracePhase('dispatch', dispatchStart)
+      return dispatchOutput(result, payload)
+    } catch {
+      return allow
+    } finally {
+      verdicts?.close()
+    }
+  } finally {
+    // Every runner passes through here once per event: one ring write, one
+    // histogram merge.
+    traceFlush()
+    profileFlush()
+  }
+}
+
+/**
+ * Write a rendered dispatch to the real process streams and exit with its code.
+ */
+export function emitDispatchOutput(output: DispatchOutput): never {
+  if (output.stderr) {
+    process.stderr.write(output.stderr)
+  }
+  if (output.stdout) {
+    process.stdout.write(output.stdout)
+  }
+  process.exit(output.exitCode)
+}
+
+/**
+ * The dispatcher CLI: read the event arg (`process.argv[2]`) + stdin once, run
+ * the bundled hooks, surface reminders on stderr, exit 0. BATCH_ARG in the
+ * event slot runs batch mode over the remaining args instead. Exported (not
+ * auto-run) so the rolldown bundle entry (`dispatch-entry.mts`) can call it
+ * unconditionally while unit tests / the source module stay import-safe — a
+ * CJS bundle has no `import.meta`, so an entrypoint-guard can't gate it there.
+ */
+export async function runDispatcherCli(): Promise<void> {
+  const event = process.argv[2]
+  if (!event) {
+    process.exit(0)
+  }
+  if (event === BATCH_ARG) {
+    await runDispatchBatch(process.argv.slice(3), dispatchRaw)
+    process.exit(0)
+  }
+  // Launcher handoff → here: node boot + compile-cache bundle load.
+  traceStart(event, 'boot')
+  let raw: string
+  const stdinStart = traceNow()
+  try {
+    raw = await readStdin()
+  } catch {
+    process.exit(0)
+  }
+  tracePhase('stdin', stdinStart)
+  emitDispatchOutput(await dispatchRaw(event, raw))
+}
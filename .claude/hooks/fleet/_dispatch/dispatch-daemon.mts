@@ -0,0 +1,466 @@
+/**
+ * @file The opt-in warm-dispatcher daemon behind the native launchers.
+ *
+ *   A snapshot boot still costs a full node start + deserialize per hook
+ *   event (~47-53 ms warm, snapshot-notes.md). The daemon moves that cost OFF
+ *   the hook's critical path: a long-lived supervisor, booted from the same
+ *   blob, keeps a small pool of ALREADY-BOOTED one-shot workers, each parked
+ *   listening on its own slot socket (`<base>.<n>.sock`: a Unix socket in a
+ *   per-uid 0700 dir on POSIX, a per-user named pipe on Windows — node's `net`
+ *   listens on either through the same call). The launcher
+ *   (`dispatch-launcher.c` / `dispatch-launcher-win.c`) connects straight to
+ *   the first slot that answers, the worker runs the frozen `dispatch()` for
+ *   that ONE request and exits, and the supervisor boots a fresh worker into
+ *   the freed slot.
+ *
+ *   Direct slot sockets, not one socket + handle passing: handing an accepted
+ *   connection to a parked child over IPC measured ~4-6 ms of the round trip
+ *   (handle serialization + the child's cold receive path) — most of the
+ *   single-digit budget. With slots the supervisor is never on the hot path.
+ *
+ *   ONE-SHOT workers are what keep the byte-equivalence guarantee: every
+ *   request runs in a fresh heap with the caller's env + cwd applied before
+ *   any hook code runs, exactly like the `execv node --snapshot-blob` path. A
+ *   single long-lived heap serving many requests would leak module-level
+ *   caches (`cachedStdin`, memoized git facts, …) across sessions. The one
+ *   thing a parked worker does ahead is compile the acorn-WASM parser
+ *   (`primeAcornWasm`): parser code, no session state.
+ *
+ *   Wire protocol (every length a little-endian u32):
+ *     request  "FDD1" | len hash | len event | len cwd | len env | len stdin
+ *              (env = NUL-separated KEY=VALUE entries — the launcher's environ)
+ *     reply    'A' (accepted; the hooks are now running) then
+ *                i32 exitCode | len stdout | len stderr
+ *              'S' (stale: the request's bundle hash ≠ the blob this daemon
+ *                booted from — the supervisor then shuts itself down)
+ *   The launcher tries the next slot on a refused / missing socket and falls
+ *   back to its `execv` path on anything but a complete 'A' reply inside its
+ *   deadline, so a missing, stale, saturated, or slow daemon costs a failed
+ *   connect or two and nothing else.
+ *
+ *   Snapshot-clean: nothing here runs at module eval. `node:net` +
+ *   `node:child_process` are `require()`d lazily inside the two entry fns,
+ *   which `dispatch-snapshot-entry.mts` calls only from its deserialize-main
+ *   (argv sentinels `__fleet-daemon` / `__fleet-daemon-worker`).
+ *
+ *   Start / stop / status: `node scripts/fleet/hook-daemon.mts`.
+ */
+
+import { createRequire } from 'node:module'
+import process from 'node:process'
+
+import { primeAcornWasm } from '../_shared/ast/core.mts'
+import { dispatchRaw } from './dispatch-cli.mts'
+import type { DispatchOutput } from './dispatch-cli.mts'
+import { traceStart } from './dispatch-trace.mts'
+
+import type { ChildProcess } from 'node:child_process'
+import type { Socket } from 'node:net'
+
+const require = createRequire(import.meta.url)
+
+/**
+ * argv[1] sentinel the snapshot entry routes to `runDaemonSupervisor`.
+ */
+export const DAEMON_SUPERVISOR_ARG = '__fleet-daemon'
+
+/**
+ * argv[1] sentinel the snapshot entry routes to `runDaemonWorker`.
+ */
+export const DAEMON_WORKER_ARG = '__fleet-daemon-worker'
+
+const REQUEST_MAGIC = 'FDD1'
+
+// A worker that dies before it reports ready this many times in a row means
+// the blob can't boot here (deleted, wrong node) — stop, don't spin.
+const MAX_BOOT_FAILURES = 5
+
+// The supervisor exits after this long with no request served, so a forgotten
+// daemon doesn't pin a stale blob's node processes forever.
+const IDLE_EXIT_MS = 30 * 60 * 1000
+
+// A worker that never sees its request frame (launcher died mid-send) exits
+// rather than idling with a half-read socket.
+const REQUEST_READ_MS = 5000
+
+interface DaemonRequest {
+  readonly cwd: string
+  readonly env: Record<string, string>
+  readonly event: string
+  readonly hash: string
+  readonly stdin: string
+}
+
+/**
+ * Parse a complete request frame, or `undefined` when the buffer is still
+ * short. A malformed frame (wrong magic) throws.
+ */
+export function parseDaemonRequest(buf: Buffer): DaemonRequest | undefined {
+  if (buf.length < 4) {
+    return undefined
+  }
+  if (buf.toString('latin1', 0, 4) !== REQUEST_MAGIC) {
+    throw new Error('bad daemon request magic')
+  }
+  const fields: string[] = []
+  let off = 4
+  for (let i = 0; i < 5; i += 1) {
+    if (buf.length < off + 4) {
+      return undefined
+    }
+    const len = buf.readUInt32LE(off)
+    off += 4
+    if (buf.length < off + len) {
+      return undefined
+    }
+    fields.push(buf.toString('utf8', off, off + len))
+    off += len
+  }
+  const env: Record<string, string> = { __proto__: null } as unknown as Record<
+    string,
+    string
+  >
+  const entries = fields[3]!.split('\0')
+  for (let i = 0, { length } = entries; i < length; i += 1) {
+    const entry = entries[i]!
+    const eq = entry.indexOf('=')
+    if (eq > 0) {
+      env[entry.slice(0, eq)] = entry.slice(eq + 1)
+    }
+  }
+  return {
+    __proto__: null,
+    cwd: fields[2]!,
+    env,
+    event: fields[1]!,
+    hash: fields[0]!,
+    stdin: fields[4]!,
+  } as DaemonRequest
+}
+
+/**
+ * Encode the 'A' reply body that follows the ack byte.
+ */
+export function encodeDaemonReply(output: DispatchOutput): Buffer {
+  const stdout = Buffer.from(output.stdout, 'utf8')
+  const stderr = Buffer.from(output.stderr, 'utf8')
+  const head = Buffer.alloc(12)
+  head.writeInt32LE(output.exitCode, 0)
+  head.writeUInt32LE(stdout.length, 4)
+  head.writeUInt32LE(stderr.length, 8)
+  return Buffer.concat([head.subarray(0, 8), stdout, head.subarray(8), stderr])
+}
+
+/**
+ * Make the worker's process look like the one the launcher would have
+ * exec'd: the caller's exact environment and working directory.
+ */
+function adoptCaller(req: DaemonRequest): void {
+  const { env } = process
+  const names = Object.keys(env)
+  for (let i = 0, { length } = names; i < length; i += 1) {
+    delete env[names[i]!]
+  }
+  Object.assign(env, req.env)
+  try {
+    process.chdir(req.cwd)
+  } catch {
+    // A cwd that vanished between the launcher's getcwd and now: the exec
+    // path would have failed the same way; run from where we are.
+  }
+}
+
+/**
+ * Slot `n`'s socket path under a daemon base (`daemonSocketBase()` in
+ * snapshot-cache-path.cjs). The launcher derives the same names in C.
+ */
+export function daemonSlotPath(base: string, slot: number): string {
+  return `${base}.${slot}.sock`
+}
+
+/**
+ * One-shot worker: listen on one slot socket, serve exactly the first request
+ * that connects, exit. A bundle-hash mismatch replies 'S' and tells the
+ * supervisor to shut down. Exits with the supervisor (IPC disconnect) while
+ * still parked.
+ */
+export function runDaemonWorker(socketPath: string, bundleHash: string): void {
+  if (typeof process.send !== 'function') {
+    process.exit(0)
+  }
+  const fs = require('node:fs') as typeof import('node:fs')
+  const net = require('node:net') as typeof import('node:net')
+  const unlink = (): void => {
+    try {
+      fs.unlinkSync(socketPath)
+    } catch {}
+  }
+  let serving = false
+  process.on('disconnect', () => {
+    if (!serving) {
+      unlink()
+      process.exit(0)
+    }
+  })
+  const server = net.createServer(socket => {
+    if (serving) {
+      socket.destroy()
+      return
+    }
+    serving = true
+    // Off the filesystem first: a concurrent launcher must see this slot as
+    // taken (ENOENT / ECONNREFUSED) and move on, not queue behind us.
+    server.close()
+    unlink()
+    const timer = setTimeout(() => process.exit(0), REQUEST_READ_MS)
+    let buf = Buffer.alloc(0)
+    const onData = (chunk: Buffer): void => {
+      buf = Buffer.concat([buf, chunk])
+      let req: DaemonRequest | undefined
+      try {
+        req = parseDaemonRequest(buf)
+      } catch {
+        socket.destroy()
+        process.exit(0)
+      }
+      if (!req) {
+        return
+      }
+      socket.off('data', onData)
+      clearTimeout(timer)
+      if (req.hash !== bundleHash) {
+        process.send?.('stale')
+        socket.end('S', () => process.exit(0))
+        return
+      }
+      socket.write('A')
+      void serve(socket, req)
+    }
+    socket.on('data', onData)
+    socket.on('error', () => process.exit(0))
+  })
+  server.on('error', () => process.exit(0))
+  // Parked, so compile the acorn-WASM parser now rather than inside the first
+  // AST guard's request (snapshot-notes.md, "acorn.wasm compile").
+  primeAcornWasm()
+  void warmUp(socketPath).then(() => {
+    unlink()
+    server.listen(socketPath, () => {
+      try {
+        fs.chmodSync(socketPath, 0o600)
+      } catch {}
+      process.send?.('ready')
+    })
+  })
+}
+
+/**
+ * Run one throwaway frame through the socket + parse + reply code before the
+ * slot is advertised. A snapshot-booted heap has those paths uncompiled; the
+ * first real request paying their lazy compile measured ~1.5-2 ms of the
+ * round trip. Best-effort: any failure just advertises the slot cold.
+ */
+function warmUp(socketPath: string): Promise<void> {
+  const fs = require('node:fs') as typeof import('node:fs')
+  const net = require('node:net') as typeof import('node:net')
+  const warmPath = `${socketPath}.warm`
+  return new Promise(resolve => {
+    const done = (): void => {
+      server.close()
+      try {
+        fs.unlinkSync(warmPath)
+      } catch {}
+      resolve()
+    }
+    const server = net.createServer(socket => {
+      let buf = Buffer.alloc(0)
+      socket.on('data', (chunk: Buffer) => {
+        buf = Buffer.concat([buf, chunk])
+        try {
+          if (parseDaemonRequest(buf)) {
+            socket.end(
+              encodeDaemonReply({
+                __proto__: null,
+                exitCode: 0,
+                stderr: '',
+                stdout: '',
+              } as DispatchOutput),
+            )
+          }
+        } catch {
+          socket.destroy()
+        }
+      })
+      socket.on('error', done)
+    })
+    server.on('error', done)
+    try {
+      fs.unlinkSync(warmPath)
+    } catch {}
+    server.listen(warmPath, () => {
+      const frame = Buffer.alloc(24)
+      frame.write('FDD1', 'latin1')
+      const client = net.connect(warmPath, () => client.end(frame))
+      client.on('data', () => {})
+      client.on('close', done)
+      client.on('error', done)
+    })
+  })
+}
+
+async function serve(socket: Socket, req: DaemonRequest): Promise<void> {
+  adoptCaller(req)
+  // Launcher connect → here: the frame transfer + env adoption.
+  traceStart(req.event, 'handoff')
+  // Hooks write to the process streams directly in a few places (debug
+  // logging); route those bytes into the reply too so the caller sees exactly
+  // what an exec'd dispatcher would have printed.
+  let extraOut = ''
+  let extraErr = ''
+  process.stdout.write = ((chunk: string | Uint8Array): boolean => {
+    extraOut += Buffer.from(chunk).toString('utf8')
+    return true
+  }) as typeof process.stdout.write
+  process.stderr.write = ((chunk: string | Uint8Array): boolean => {
+    extraErr += Buffer.from(chunk).toString('utf8')
+    return true
+  }) as typeof process.stderr.write
+  const output = await dispatchRaw(req.event, req.stdin)
+  const reply = encodeDaemonReply({
+    __proto__: null,
+    exitCode: output.exitCode,
+    stderr: extraErr + output.stderr,
+    stdout: extraOut + output.stdout,
+  } as DispatchOutput)
+  socket.end(reply, () => process.exit(0))
+}
+
+interface SlotWorker {
+  child: ChildProcess
+  ready: boolean
+}
+
+/**
+ * Supervisor: own the pid file, keep one booted worker parked per slot, boot a
+ * replacement when one exits. Never touches a request or runs a hook itself.
+ * `slotCount` is `DAEMON_SLOTS` from snapshot-cache-path.cjs, passed down by
+ * `hook-daemon.mts` — the same number the build froze into `daemon.path`;
+ * `pidPath` is `daemonPidPath()` (a real file even when the slots are Windows
+ * named pipes). Workers boot with the supervisor's own `execArgv` — the
+ * frozen node flags + `--snapshot-blob <blob>` it was itself booted with — so
+ * they can only ever run the blob, under the flags, the launcher would exec.
+ */
+export function runDaemonSupervisor(
+  base: string,
+  pidPath: string,
+  bundleHash: string,
+  slotCount: number,
+): void {
+  const childProcess = require('node:child_process') as typeof import('node:child_process')
+  const fs = require('node:fs') as typeof import('node:fs')
+  const path = require('node:path') as typeof import('node:path')
+
+  const slots: Array<SlotWorker | undefined> = []
+  let bootFailures = 0
+  let stopping = false
+  let idleTimer: NodeJS.Timeout | undefined
+
+  const shutdown = (): void => {
+    if (stopping) {
+      return
+    }
+    stopping = true
+    for (let i = 0; i < slotCount; i += 1) {
+      slots[i]?.child.kill()
+      try {
+        fs.unlinkSync(daemonSlotPath(base, i))
+      } catch {}
+    }
+    try {
+      if (fs.readFileSync(pidPath, 'utf8').trim() === String(process.pid)) {
+        fs.unlinkSync(pidPath)
+      }
+    } catch {}
+    process.exit(0)
+  }
+
+  const armIdle = (): void => {
+    if (idleTimer) {
+      clearTimeout(idleTimer)
+    }
+    idleTimer = setTimeout(shutdown, IDLE_EXIT_MS)
+  }
+
+  const boot = (slot: number): void => {
+    if (stopping) {
+      return
+    }
+    // Core spawn, not the lib's promise wrapper: the supervisor lives on the
+    // IPC 'message' / 'exit' events of a child that outlives any await.
+    const child = childProcess.spawn(
+      process.execPath,
+      [
+        ...process.execArgv,
+        DAEMON_WORKER_ARG,
+        daemonSlotPath(base, slot),
+        bundleHash,
+      ],
+      { stdio: ['ignore', 'ignore', 'ignore', 'ipc'] },
+    )
+    const worker: SlotWorker = { child, ready: false }
+    slots[slot] = worker
+    child.on('message', msg => {
+      if (msg === 'ready') {
+        worker.ready = true
+        bootFailures = 0
+      } else if (msg === 'stale') {
+        shutdown()
+      }
+    })
+    let retired = false
+    // Replace on EXIT, never earlier: booting the successor while this worker
+    // is still running hooks would steal the CPU (on a one-core runner, all
+    // of it) from the request the launcher is waiting on.
+    const retire = (): void => {
+      if (retired) {
+        return
+      }
+      retired = true
+      slots[slot] = undefined
+      if (worker.ready) {
+        armIdle()
+      } else {
+        bootFailures += 1
+        if (bootFailures >= MAX_BOOT_FAILURES) {
+          shutdown()
+          return
+        }
+      }
+      boot(slot)
+    }
+    child.on('exit', retire)
+    child.on('error', retire)
+  }
+
+  fs.mkdirSync(path.dirname(pidPath), { mode: 0o700, recursive: true })
+  // A LIVE prior supervisor already serves this dispatch dir — leave it be. A
+  // dead one's pid file (crash, SIGKILL) is simply overwritten.
+  try {
+    const prior = Number(fs.readFileSync(pidPath, 'utf8').trim())
+    if (prior && prior !== process.pid) {
+      process.kill(prior, 0)
+      process.exit(0)
+    }
+  } catch {}
+  try {
+    fs.writeFileSync(pidPath, `${process.pid}\n`)
+  } catch {
+    process.exit(0)
+  }
+  for (let i = 0; i < slotCount; i += 1) {
+    boot(i)
+  }
+  armIdle()
+  process.on('SIGTERM', shutdown)
+  process.on('SIGINT', shutdown)
+}
@@ -0,0 +1,51 @@
+/**
+ * @file Which hooks can fire for an event + tool. The generated dispatch
+ *   table carries a precomputed (event, tool) → hooks index
+ *   (`DISPATCH_INDEX`, rendered by `scripts/fleet/gen/hook-dispatch.mts`), so
+ *   `dispatch()` iterates only the hooks that can fire instead of testing
+ *   every entry of the event's row. The launcher's native pre-flight sidecar
+ *   is frozen from the same index, so the two filters can't drift apart.
+ */
+
+import { splicedHooksFor } from './lazy-hooks.mts'
+import { DISPATCH_INDEX } from './dispatch-table.mts'
+
+import type { DispatchHookEntry } from './dispatch-types.mts'
+
+/**
+ * The hooks that can fire for `event` + `toolName`, in table order — a
+ * lookup in the generated index, equal to filtering the event's table row
+ * with `hookHandlesTool`.
+ */
+export function hooksFor(
+  event: string,
+  toolName: string | undefined,
+): readonly DispatchHookEntry[] {
+  const index = DISPATCH_INDEX[event]
+  // A snapshot boot may have spliced in its left-out hooks (lazy-hooks.mts).
+  const spliced = splicedHooksFor(event, toolName, index)
+  if (spliced) {
+    return spliced
+  }
+  if (!index) {
+    return []
+  }
+  return (toolName && index.byTool[toolName]) || index.any
+}
+
+/**
+ * Returns true when the hook entry handles the payload's tool. An entry with
+ * no declared tools handles every event (Stop / SessionStart style).
+ */
+export function hookHandlesTool(
+  entry: DispatchHookEntry,
+  toolName: string | undefined,
+): boolean {
+  if (!entry.tools || entry.tools.length === 0) {
+    return true
+  }
+  if (!toolName) {
+    return false
+  }
+  return entry.tools.includes(toolName)
+}
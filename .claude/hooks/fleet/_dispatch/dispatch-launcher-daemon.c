@@ -0,0 +1,257 @@
+/*
+ * POSIX launcher: the warm-daemon client. Ships the event to a parked
+ * dispatch-daemon.mts worker over its Unix socket and relays the reply;
+ * the frame layout is documented there.
+ */
+
+#include "dispatch-launcher.h"
+
+/* Budget from connect to the daemon's ack byte. Past the ack the hooks are
+ * already running in the daemon, so the launcher waits for the reply rather
+ * than racing a second dispatch through execv. */
+#define DAEMON_ACK_MS 250
+
+#if !defined(MSG_NOSIGNAL)
+#define MSG_NOSIGNAL 0 /* macOS: SO_NOSIGPIPE is set on the socket instead. */
+#endif
+
+static int buf_put(struct buf *b, const void *src, size_t n) {
+  if (b->len + n > b->cap) {
+    size_t cap = b->cap ? b->cap : 4096;
+    while (cap < b->len + n) cap *= 2;
+    char *np = realloc(b->p, cap);
+    if (!np) return -1;
+    b->p = np;
+    b->cap = cap;
+  }
+  memcpy(b->p + b->len, src, n);
+  b->len += n;
+  return 0;
+}
+
+/* One length-prefixed (u32 little-endian) protocol field. */
+static int buf_field(struct buf *b, const void *src, size_t n) {
+  unsigned char le[4] = {(unsigned char)n, (unsigned char)(n >> 8),
+                         (unsigned char)(n >> 16), (unsigned char)(n >> 24)};
+  return (buf_put(b, le, 4) == 0 && buf_put(b, src, n) == 0) ? 0 : -1;
+}
+
+int read_all_fd(int fd, struct buf *b) {
+  char chunk[65536];
+  for (;;) {
+    ssize_t n = read(fd, chunk, sizeof(chunk));
+    if (n == 0) return 0;
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      return -1;
+    }
+    if (buf_put(b, chunk, (size_t)n) != 0) return -1;
+  }
+}
+
+static long now_ms(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/* Wait for fd readiness until deadline (ms, CLOCK_MONOTONIC; <0 = forever). */
+static int wait_fd(int fd, short events, long deadline) {
+  for (;;) {
+    int timeout = -1;
+    if (deadline >= 0) {
+      long left = deadline - now_ms();
+      if (left <= 0) return -1;
+      timeout = (int)left;
+    }
+    struct pollfd pfd = {fd, events, 0};
+    int r = poll(&pfd, 1, timeout);
+    if (r > 0) return 0;
+    if (r < 0 && errno == EINTR) continue;
+    return -1;
+  }
+}
+
+static int send_all(int fd, const char *p, size_t n, long deadline) {
+  while (n) {
+    ssize_t w = send(fd, p, n, MSG_NOSIGNAL);
+    if (w > 0) {
+      p += w;
+      n -= (size_t)w;
+      continue;
+    }
+    if (w < 0 && errno == EINTR) continue;
+    if (w < 0 && (errno == EAGAIN || errno == EWOULDBLOCK) &&
+        wait_fd(fd, POLLOUT, deadline) == 0)
+      continue;
+    return -1;
+  }
+  return 0;
+}
+
+static int recv_all(int fd, void *out, size_t n, long deadline) {
+  char *p = out;
+  while (n) {
+    ssize_t r = recv(fd, p, n, 0);
+    if (r > 0) {
+      p += r;
+      n -= (size_t)r;
+      continue;
+    }
+    if (r == 0) return -1;
+    if (errno == EINTR) continue;
+    if ((errno == EAGAIN || errno == EWOULDBLOCK) &&
+        wait_fd(fd, POLLIN, deadline) == 0)
+      continue;
+    return -1;
+  }
+  return 0;
+}
+
+static uint32_t le32(const unsigned char *b) {
+  return (uint32_t)b[0] | (uint32_t)b[1] << 8 | (uint32_t)b[2] << 16 |
+         (uint32_t)b[3] << 24;
+}
+
+static int write_all(int fd, const char *p, size_t n) {
+  while (n) {
+    ssize_t w = write(fd, p, n);
+    if (w < 0 && errno == EINTR) continue;
+    if (w <= 0) return -1;
+    p += w;
+    n -= (size_t)w;
+  }
+  return 0;
+}
+
+/* Read one length-prefixed reply field (no deadline: only used after the ack). */
+static int recv_field(int sock, struct buf *out) {
+  unsigned char le[4];
+  if (recv_all(sock, le, 4, -1) != 0) return -1;
+  size_t n = le32(le);
+  if (n == 0) return 0;
+  if (!(out->p = malloc(n))) return -1;
+  out->cap = n;
+  if (recv_all(sock, out->p, n, -1) != 0) return -1;
+  out->len = n;
+  return 0;
+}
+
+/* Connect to one slot socket (non-blocking). Returns the fd, or -1 when the
+ * slot is missing / not ours / refused (taken, booting, or a dead daemon). */
+static int connect_slot(const char *path, long deadline) {
+  /* Only a socket owned by us: the 0700 parent dir already fences other users
+   * out, this also refuses a planted regular file or symlink. */
+  struct stat st;
+  if (lstat(path, &st) != 0 || !S_ISSOCK(st.st_mode) || st.st_uid != getuid())
+    return -1;
+  struct sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if (strlen(path) >= sizeof(addr.sun_path)) return -1;
+  strcpy(addr.sun_path, path);
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) return -1;
+#if defined(SO_NOSIGPIPE)
+  int one = 1;
+  setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+  if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 &&
+      !(errno == EINPROGRESS && wait_fd(fd, POLLOUT, deadline) == 0)) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+/* Build the request frame (see dispatch-daemon.mts for the layout). */
+static int build_request(struct buf *req, const char *hash, const char *event,
+                         const struct buf *in) {
+  char cwd[PATH_MAX];
+  if (!getcwd(cwd, sizeof(cwd))) cwd[0] = '\0';
+  struct buf env = {0};
+  for (char **e = environ; *e; ++e) {
+    if (buf_put(&env, *e, strlen(*e) + 1) != 0) {
+      free(env.p);
+      return -1;
+    }
+  }
+  const char *ev = event ? event : "";
+  int ok = buf_put(req, "FDD1", 4) == 0 && buf_field(req, hash, strlen(hash)) == 0 &&
+           buf_field(req, ev, strlen(ev)) == 0 &&
+           buf_field(req, cwd, strlen(cwd)) == 0 &&
+           buf_field(req, env.p, env.len ? env.len - 1 : 0) == 0 &&
+           buf_field(req, in->p, in->len) == 0;
+  free(env.p);
+  return ok ? 0 : -1;
+}
+
+/* Try the warm daemon. Returns the hook exit code when the daemon served the
+ * event, -1 to fall back to execv, or DAEMON_TRUNCATED when it acked but its
+ * reply ended early (fall back the same way). Stdin lands in `in` (unless the
+ * pre-flight already `drained` it there) for the caller to replay. */
+int try_daemon(const char *dir, const char *event, struct buf *in,
+                      int drained) {
+  /* daemon.path: "<bundle-hash> <slot-count> <socket-base>" */
+  char line[PATH_MAX + 80];
+  if (read_sidecar(dir, "daemon.path", line, sizeof(line)) != 0) return -1;
+  char *sp1 = strchr(line, ' ');
+  if (!sp1) return -1;
+  *sp1++ = '\0';
+  char *base = strchr(sp1, ' ');
+  if (!base) return -1;
+  *base++ = '\0';
+  const char *hash = line;
+  int slots = atoi(sp1);
+  if (slots <= 0 || slots > 16) return -1;
+
+  long deadline = now_ms() + DAEMON_ACK_MS;
+  struct buf req = {0};
+  int fd = -1;
+  for (int slot = 0; slot < slots && fd < 0; ++slot) {
+    char path[PATH_MAX];
+    if ((size_t)snprintf(path, sizeof(path), "%s.%d.sock", base, slot) >= sizeof(path))
+      break;
+    if ((fd = connect_slot(path, deadline)) < 0) continue;
+    /* First live slot: only now is it worth draining stdin + framing. */
+    if (!req.len) {
+      int ok = drained || read_all_fd(0, in) == 0;
+      if (ok) trace_handoff(1); /* before framing: the frame carries environ */
+      if (!ok || build_request(&req, hash, event, in) != 0) {
+        close(fd);
+        free(req.p);
+        return -1;
+      }
+    }
+    char ack = 0;
+    if (send_all(fd, req.p, req.len, deadline) != 0 ||
+        recv_all(fd, &ack, 1, deadline) != 0 || ack != 'A') {
+      /* Lost a race for this slot, or a stale ('S') daemon: try the next. */
+      close(fd);
+      fd = -1;
+      if (ack == 'S') break;
+    }
+  }
+  free(req.p);
+  if (fd < 0) return -1;
+
+  /* Acked: the daemon owns this event now. A reply cut short (a worker that
+   * died mid-event) is not an answer: nothing of it is written, and the
+   * caller dispatches locally with the replayed stdin. A hook the worker
+   * already ran may run twice; a block is never turned into an allow. */
+  unsigned char code[4];
+  struct buf out = {0}, err = {0};
+  int exit_code = DAEMON_TRUNCATED;
+  if (recv_all(fd, code, 4, -1) == 0 && recv_field(fd, &out) == 0 &&
+      recv_field(fd, &err) == 0) {
+    /* stderr first, matching the exec'd dispatcher's write order. */
+    write_all(2, err.p, err.len);
+    write_all(1, out.p, out.len);
+    exit_code = (int)(int32_t)le32(code);
+  }
+  free(out.p);
+  free(err.p);
+  close(fd);
+  return exit_code;
+}
@@ -0,0 +1,95 @@
+/*
+ * POSIX launcher: launch.manifest (layout in
+ * scripts/fleet/_shared/launch-manifest.mts), its blob check, and the
+ * per-event split-blob choice. Also the one-line text sidecar reader.
+ */
+
+#include "dispatch-launcher.h"
+
+/* Read the first line of <dir>/<name> into out (trimmed of trailing \n).
+ * Returns 0 on a non-empty line, -1 otherwise. */
+int read_sidecar(const char *dir, const char *name, char *out, size_t cap) {
+  char path[PATH_MAX];
+  if ((size_t)snprintf(path, sizeof(path), "%s/%s", dir, name) >= sizeof(path)) return -1;
+  FILE *f = fopen(path, "r");
+  if (!f) return -1;
+  if (!fgets(out, (int)cap, f)) { fclose(f); return -1; }
+  fclose(f);
+  size_t len = strlen(out);
+  while (len && (out[len - 1] == '\n' || out[len - 1] == '\r' || out[len - 1] == ' '))
+    out[--len] = '\0';
+  return len ? 0 : -1;
+}
+
+/* Read <dir>/<name> as a launch manifest. Returns 0 when it is whole and
+ * ours. */
+int read_manifest(const char *dir, const char *name, struct launch_manifest *m) {
+  char path[PATH_MAX];
+  if ((size_t)snprintf(path, sizeof(path), "%s/%s", dir, name) >= sizeof(path))
+    return -1;
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return -1;
+  ssize_t n;
+  do {
+    n = pread(fd, m, sizeof(*m), 0);
+  } while (n < 0 && errno == EINTR);
+  close(fd);
+  if (n != (ssize_t)sizeof(*m) || memcmp(m->magic, LAUNCH_MANIFEST_MAGIC, 8) != 0 ||
+      m->size != LAUNCH_MANIFEST_SIZE || !m->node[0] ||
+      m->node[sizeof(m->node) - 1] || m->blob[sizeof(m->blob) - 1] ||
+      m->flags[sizeof(m->flags) - 1])
+    return -1;
+  return 0;
+}
+
+/* The frozen blob is still the one the manifest describes. A size-0 record
+ * means the blob didn't exist at freeze time. */
+int blob_matches(const struct launch_manifest *m) {
+  struct stat st;
+  if (!m->blob_size || stat(m->blob, &st) != 0) return 0;
+#if defined(__APPLE__)
+  int64_t mtime_ns = (int64_t)st.st_mtimespec.tv_sec * 1000000000 + st.st_mtimespec.tv_nsec;
+#else
+  int64_t mtime_ns = (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+  return (uint64_t)st.st_size == m->blob_size && mtime_ns == m->blob_mtime_ns &&
+         (uint64_t)st.st_ino == m->blob_ino;
+}
+
+/* Per-event split blob: <dir>/launch.<Event>.manifest, frozen only when the
+ * build ran with --split-events. The same layout and checks as
+ * launch.manifest, naming a blob that holds just this event's hooks. Only a
+ * plain identifier event is looked up (it becomes part of a filename; the
+ * builder applies the same rule). Returns 0 when one was read. */
+#define EVENT_NAME_MAX 64
+
+static int read_event_manifest(const char *dir, const char *event,
+                               struct launch_manifest *m) {
+  if (!event) return -1;
+  size_t n = strlen(event);
+  if (!n || n > EVENT_NAME_MAX ||
+      !((event[0] >= 'A' && event[0] <= 'Z') || (event[0] >= 'a' && event[0] <= 'z')))
+    return -1;
+  for (size_t i = 1; i < n; ++i) {
+    char c = event[i];
+    if (!((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9')))
+      return -1;
+  }
+  char name[EVENT_NAME_MAX + sizeof("launch..manifest")];
+  snprintf(name, sizeof(name), "launch.%s.manifest", event);
+  return read_manifest(dir, name, m);
+}
+
+/* The manifest to boot once the full blob `m` checked out: this event's
+ * split blob (read into *em) when there is one and it is intact, else `m`.
+ * A split manifest whose blob no longer matches sets *split_stale (the
+ * caller heals it like a missing blob) and leaves the full blob. */
+const struct launch_manifest *select_boot(const char *dir, const char *event,
+                                          const struct launch_manifest *m,
+                                          struct launch_manifest *em,
+                                          int *split_stale) {
+  if (read_event_manifest(dir, event, em) != 0) return m;
+  if (blob_matches(em)) return em;
+  *split_stale = 1;
+  return m;
+}
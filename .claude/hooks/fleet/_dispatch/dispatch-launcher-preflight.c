@@ -0,0 +1,204 @@
+/*
+ * Tool pre-flight for both native launchers (dispatch-launcher.c,
+ * dispatch-launcher-win.c): the hook-tools.map lookups and the payload scan
+ * that let a launcher exit 0 without booting node. Pure byte work over
+ * buffers the caller read; the file and stdin I/O stay in each launcher's
+ * preflight_skip. The map format is rendered by renderHookToolsMap in
+ * scripts/fleet/build-snapshot-launcher.mts.
+ */
+
+#include <string.h>
+
+#include "dispatch-launcher-preflight.h"
+
+#define TOOL_NAME_MAX 256
+
+static int is_ws(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
+/* Skip a JSON string starting at p[i] == '"'. Returns the index past the
+ * closing quote (n + 1 when unterminated), and flags a backslash escape in
+ * *escaped. */
+static size_t skip_string(const char *p, size_t n, size_t i, int *escaped) {
+  for (++i; i < n; ++i) {
+    if (p[i] == '\\') {
+      *escaped = 1;
+      ++i;
+    } else if (p[i] == '"') {
+      return i + 1;
+    }
+  }
+  return n + 1;
+}
+
+/* Skip one JSON value (scalar, string, or nested container) at p[i]. No
+ * validation: malformed JSON is an "allow" in the dispatcher anyway. */
+static size_t skip_value(const char *p, size_t n, size_t i) {
+  int esc = 0;
+  if (i < n && p[i] == '"') return skip_string(p, n, i, &esc);
+  if (i < n && (p[i] == '{' || p[i] == '[')) {
+    size_t depth = 0;
+    while (i < n) {
+      char c = p[i];
+      if (c == '"') {
+        i = skip_string(p, n, i, &esc);
+        continue;
+      }
+      if (c == '{' || c == '[') ++depth;
+      else if ((c == '}' || c == ']') && --depth == 0) return i + 1;
+      ++i;
+    }
+    return n;
+  }
+  while (i < n && p[i] != ',' && p[i] != '}' && p[i] != ']' && !is_ws(p[i])) ++i;
+  return i;
+}
+
+/* Find the payload's TOP-LEVEL "tool_name" (a nested tool_input key of the
+ * same name must not count). Returns 1 with the name in out, 0 when the
+ * object has none (or it is ""), -1 when the scan can't be sure what
+ * JSON.parse would see — the caller then lets node decide. Duplicate keys
+ * resolve last-wins, as JSON.parse does. */
+static int scan_tool_name(const char *p, size_t n, char *out, size_t cap) {
+  size_t i = 0;
+  int found = 0;
+  while (i < n && is_ws(p[i])) ++i;
+  if (i >= n || p[i] != '{') return -1;
+  for (++i;;) {
+    while (i < n && is_ws(p[i])) ++i;
+    if (i < n && p[i] == '}') break;
+    if (i >= n || p[i] != '"') return -1;
+    int esc = 0;
+    size_t key = i + 1;
+    i = skip_string(p, n, i, &esc);
+    if (esc || i >= n) return -1;
+    int is_tool = (i - 1 - key == 9 && memcmp(p + key, "tool_name", 9) == 0);
+    while (i < n && is_ws(p[i])) ++i;
+    if (i >= n || p[i] != ':') return -1;
+    ++i;
+    while (i < n && is_ws(p[i])) ++i;
+    if (is_tool) {
+      if (i >= n || p[i] != '"') return -1;
+      size_t val = i + 1;
+      i = skip_string(p, n, i, &esc);
+      size_t len = i - 1 - val;
+      if (esc || i > n || len >= cap) return -1;
+      memcpy(out, p + val, len);
+      out[len] = '\0';
+      found = len > 0;
+    } else {
+      i = skip_value(p, n, i);
+    }
+    while (i < n && is_ws(p[i])) ++i;
+    if (i < n && p[i] == ',') {
+      ++i;
+      continue;
+    }
+    if (i < n && p[i] == '}') break;
+    return -1;
+  }
+  return found;
+}
+
+/* The tool list the map records for `event`: sets *list / *len and returns
+ * 1, or returns 0 when no hook is registered for the event. */
+int map_lookup(const char *map, size_t n, const char *event, const char **list,
+               size_t *len) {
+  size_t elen = strlen(event);
+  for (size_t i = sizeof(HOOK_TOOLS_MAGIC) - 1; i < n;) {
+    const char *line = map + i;
+    const char *nl = memchr(line, '\n', n - i);
+    size_t llen = nl ? (size_t)(nl - line) : n - i;
+    if (llen > elen && line[elen] == ' ' && memcmp(line, event, elen) == 0) {
+      *list = line + elen + 1;
+      *len = llen - elen - 1;
+      return 1;
+    }
+    i += llen + 1;
+  }
+  return 0;
+}
+
+/* Whether the space-separated `list` names `tool` (or is the "*" wildcard). */
+static int list_has(const char *list, size_t len, const char *tool) {
+  if (len == 1 && list[0] == '*') return 1;
+  size_t tlen = strlen(tool);
+  for (size_t i = 0; i < len;) {
+    const char *sp = memchr(list + i, ' ', len - i);
+    size_t wlen = sp ? (size_t)(sp - (list + i)) : len - i;
+    if (wlen == tlen && memcmp(list + i, tool, tlen) == 0) return 1;
+    i += wlen + 1;
+  }
+  return 0;
+}
+
+/* The trigger rule for `event` + `tool` ("?<event> <tool>\t<trigger>\t…"):
+ * sets *rule / *len to the tab-separated triggers and returns 1, or returns
+ * 0 when some hook for the tool declared none. */
+static int rule_lookup(const char *map, size_t n, const char *event,
+                       const char *tool, const char **rule, size_t *len) {
+  size_t elen = strlen(event), tlen = strlen(tool);
+  size_t head = 1 + elen + 1 + tlen + 1;
+  for (size_t i = sizeof(HOOK_TOOLS_MAGIC) - 1; i < n;) {
+    const char *line = map + i;
+    const char *nl = memchr(line, '\n', n - i);
+    size_t llen = nl ? (size_t)(nl - line) : n - i;
+    if (llen > head && line[0] == '?' && memcmp(line + 1, event, elen) == 0 &&
+        line[1 + elen] == ' ' && memcmp(line + 2 + elen, tool, tlen) == 0 &&
+        line[head - 1] == '\t') {
+      *rule = line + head;
+      *len = llen - head;
+      return 1;
+    }
+    i += llen + 1;
+  }
+  return 0;
+}
+
+/* Whether `needle` (m > 0 bytes) occurs in `hay`. */
+static int has_bytes(const char *hay, size_t n, const char *needle, size_t m) {
+  if (m > n) return 0;
+  const char *end = hay + n - m + 1;
+  for (const char *p = hay; p < end; ++p) {
+    p = memchr(p, needle[0], (size_t)(end - p));
+    if (!p) return 0;
+    if (memcmp(p, needle, m) == 0) return 1;
+  }
+  return 0;
+}
+
+/* 1 when none of the rule's triggers occurs in the raw payload, so no hook
+ * for the tool can fire. A \u or \/ escape could spell a trigger the bytes
+ * don't show, and a payload holding one is never a skip. */
+static int rule_rejects(const char *rule, size_t len, const char *p, size_t n) {
+  if (has_bytes(p, n, "\\u", 2) || has_bytes(p, n, "\\/", 2)) return 0;
+  for (size_t i = 0; i < len;) {
+    const char *tab = memchr(rule + i, '\t', len - i);
+    size_t wlen = tab ? (size_t)(tab - (rule + i)) : len - i;
+    if (wlen && has_bytes(p, n, rule + i, wlen)) return 0;
+    i += wlen + 1;
+  }
+  return 1;
+}
+
+int tools_map_whole(const char *map, size_t n) {
+  return n < HOOK_TOOLS_MAX && n >= sizeof(HOOK_TOOLS_MAGIC) - 1 &&
+         memcmp(map, HOOK_TOOLS_MAGIC, sizeof(HOOK_TOOLS_MAGIC) - 1) == 0;
+}
+
+int preflight_verdict(const char *map, size_t n, const char *event,
+                      const char *list, size_t len, const char *p, size_t plen) {
+  size_t i = 0;
+  while (i < plen && is_ws(p[i])) ++i;
+  /* A blank payload is the dispatcher's silent allow too. */
+  if (i == plen) return 1;
+  char tool[TOOL_NAME_MAX];
+  int r = scan_tool_name(p, plen, tool, sizeof(tool));
+  if (r < 0) return 0;
+  /* No tool_name: only any-tool hooks fire, and this event has none. */
+  if (r == 0 || !list_has(list, len, tool)) return 1;
+  /* Every hook for the tool is prefiltered: no trigger, no hook fires. */
+  const char *rule;
+  size_t rlen;
+  if (!rule_lookup(map, n, event, tool, &rule, &rlen)) return 0;
+  return rule_rejects(rule, rlen, p, plen) ? 2 : 0;
+}
@@ -0,0 +1,32 @@
+/*
+ * Tool pre-flight shared by both native launchers; see
+ * dispatch-launcher-preflight.c.
+ */
+
+#ifndef DISPATCH_LAUNCHER_PREFLIGHT_H
+#define DISPATCH_LAUNCHER_PREFLIGHT_H
+
+#include <stddef.h>
+
+/* hook-tools.map is a few hundred bytes; anything near this is not ours. */
+#define HOOK_TOOLS_MAX 65536
+#define HOOK_TOOLS_MAGIC "# fleet hook-tools v1\n"
+
+/* Whether map[0, n) is a whole hook-tools.map read into a HOOK_TOOLS_MAX
+ * buffer: a missing header is a torn / foreign file, a full buffer a
+ * truncated one. */
+int tools_map_whole(const char *map, size_t n);
+
+/* The tool list the map records for `event`: sets *list / *len and returns
+ * 1, or returns 0 when no hook is registered for the event. */
+int map_lookup(const char *map, size_t n, const char *event, const char **list,
+               size_t *len);
+
+/* The payload half of the pre-flight, for an event whose tool `list` (from
+ * map_lookup) names tools. Returns 1 when no hook for the payload's tool can
+ * fire, 2 when its trigger rule rules out every hook for it (the launcher
+ * exits 0 on either), else 0. */
+int preflight_verdict(const char *map, size_t n, const char *event,
+                      const char *list, size_t len, const char *p, size_t plen);
+
+#endif
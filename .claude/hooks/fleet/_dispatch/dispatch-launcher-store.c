@@ -0,0 +1,177 @@
+/*
+ * POSIX launcher: the blob store side of a launch — self-heal of a missing
+ * blob, the read-ahead hint before a hit's execv, and the access log.
+ */
+
+#include "dispatch-launcher.h"
+
+/* Self-heal: the manifest names a blob that is gone or changed (a
+ * node_modules rebuild, an image without the bake step), so without help
+ * every event takes index.cjs until someone re-runs setup. Spawn ONE detached
+ * `node scripts/fleet/setup/hook-snapshot.mts --heal` (snapshot rebuild +
+ * sidecar refreeze, never a launcher recompile) and carry on down the
+ * fail-open path; a later event finds the new manifest.
+ *
+ * Guarded by heal.lock in the blob cache root
+ * (node_modules/.cache/fleet/node-snapshot-cache/, two levels above the blob,
+ * beside the per-runtime dirs). The healer holds a flock on it for the whole
+ * rebuild, so a second miss meanwhile spawns nothing; the file itself stays,
+ * and its mtime marks the last attempt, so a rebuild that can't succeed (no
+ * rolldown, a guard that fails to bundle) is retried once per HEAL_RETRY_S,
+ * not once per event. The healer's output lands in heal.log beside it. */
+#define HEAL_RETRY_S 600
+
+/* mkdir -p, creating at most `depth` missing parents above path itself. */
+static int mkdir_tail(char *path, int depth) {
+  if (mkdir(path, 0755) == 0 || errno == EEXIST) return 0;
+  if (errno != ENOENT || depth <= 0) return -1;
+  char *slash = strrchr(path, '/');
+  if (!slash || slash == path) return -1;
+  *slash = '\0';
+  int r = mkdir_tail(path, depth - 1);
+  *slash = '/';
+  return r == 0 && (mkdir(path, 0755) == 0 || errno == EEXIST) ? 0 : -1;
+}
+
+/* Take heal.lock for a new attempt: the locked fd, or -1 when a heal is
+ * running or the last one was too recent. */
+static int heal_lock(const char *cache) {
+  char lock[PATH_MAX];
+  if ((size_t)snprintf(lock, sizeof(lock), "%s/heal.lock", cache) >= sizeof(lock)) return -1;
+  int fd = open(lock, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+  if (fd < 0) return -1;
+  struct stat st;
+  /* Empty = never attempted (creation alone sets a fresh mtime). */
+  if (flock(fd, LOCK_EX | LOCK_NB) != 0 || fstat(fd, &st) != 0 ||
+      (st.st_size && time(NULL) - st.st_mtime < HEAL_RETRY_S)) {
+    close(fd);
+    return -1;
+  }
+  char stamp[32];
+  int n = snprintf(stamp, sizeof(stamp), "%ld\n", (long)time(NULL));
+  if (ftruncate(fd, 0) != 0 || pwrite(fd, stamp, (size_t)n, 0) != n) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+void heal_spawn(const char *dir, const struct launch_manifest *m) {
+  char cache[PATH_MAX], script[PATH_MAX], log[PATH_MAX];
+  /* <cache root>/<runtime tag>/<blob> */
+  if ((size_t)snprintf(cache, sizeof(cache), "%s", m->blob) >= sizeof(cache)) return;
+  for (int up = 0; up < 2; ++up) {
+    char *slash = strrchr(cache, '/');
+    if (!slash || slash == cache) return;
+    *slash = '\0';
+  }
+  /* A bundle-only tree ships no build scripts: nothing to heal with. */
+  if ((size_t)snprintf(script, sizeof(script),
+                       "%s/../../../../scripts/fleet/setup/hook-snapshot.mts",
+                       dir) >= sizeof(script) ||
+      access(script, R_OK) != 0)
+    return;
+  if ((size_t)snprintf(log, sizeof(log), "%s/heal.log", cache) >= sizeof(log)) return;
+  /* node_modules itself must exist (the rebuild needs it); .cache/fleet/
+   * may not after a fresh install. */
+  if (mkdir_tail(cache, 2) != 0) return;
+  int lock = heal_lock(cache);
+  if (lock < 0) return;
+  pid_t pid = fork();
+  if (pid == 0) {
+    /* Double fork: the healer is reparented to init, never a zombie under
+     * the node this process is about to become, and setsid keeps a hook
+     * timeout's process-group kill off it. */
+    if (setsid() < 0 || fork() != 0) _exit(0);
+    /* Off the hook's pipes: Claude Code waits for stdout / stderr to close. */
+    int nul = open("/dev/null", O_RDWR);
+    int out = open(log, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    if (nul < 0) _exit(0);
+    if (out < 0) out = nul;
+    dup2(nul, 0);
+    dup2(out, 1);
+    dup2(out, 2);
+    /* The flock lives as long as the healer holds this fd open. */
+    fcntl(lock, F_SETFD, 0);
+    char *args[] = {(char *)m->node, script, (char *)"--heal", NULL};
+    execv(m->node, args);
+    args[0] = (char *)"node";
+    execvp("node", args);
+    _exit(0);
+  }
+  close(lock);
+  if (pid > 0) {
+    while (waitpid(pid, NULL, 0) < 0 && errno == EINTR) {
+    }
+  }
+}
+
+/* Access record for the blob store's LRU sweep and hit/miss report
+ * (scripts/fleet/_shared/snapshot-store.mts, which owns the layout): one
+ * fixed 128-byte O_APPEND write to <store root>/access.log per launch that
+ * had a manifest, the store root being two levels above the blob. At
+ * ACCESS_LOG_MAX the log is renamed to access.log.1 (replacing the previous
+ * one), which bounds it at twice that. Fail-open: any error skips the record. */
+#define ACCESS_LOG_MAX (2 * 1024 * 1024)
+
+struct access_record {
+  int64_t at_ns;
+  char kind; /* H full blob, S split blob, P pre-flight, D daemon, M miss */
+  char reserved[7];
+  char blob[112]; /* "<tag>/<file>", NUL-padded */
+};
+
+_Static_assert(sizeof(struct access_record) == 128, "access record layout");
+
+void access_note(const char *blob, char kind) {
+  const char *file = strrchr(blob, '/');
+  if (!file || file == blob) return;
+  const char *tag = file - 1;
+  while (tag > blob && *tag != '/') --tag;
+  if (tag == blob) return;
+  struct access_record rec;
+  memset(&rec, 0, sizeof(rec));
+  size_t rel = strlen(tag + 1);
+  if (rel >= sizeof(rec.blob)) return;
+  memcpy(rec.blob, tag + 1, rel);
+  char log[PATH_MAX];
+  if ((size_t)snprintf(log, sizeof(log), "%.*s/access.log", (int)(tag - blob), blob) >=
+      sizeof(log))
+    return;
+  int fd = open(log, O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0600);
+  if (fd < 0) return;
+  struct stat st;
+  if (fstat(fd, &st) == 0 && st.st_size >= ACCESS_LOG_MAX) {
+    char old[PATH_MAX];
+    /* This record still lands in the renamed file, which is read too. */
+    if ((size_t)snprintf(old, sizeof(old), "%s.1", log) < sizeof(old)) rename(log, old);
+  }
+  struct timespec ts;
+  clock_gettime(CLOCK_REALTIME, &ts);
+  rec.at_ns = (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+  rec.kind = kind;
+  if (write(fd, &rec, sizeof(rec)) != (ssize_t)sizeof(rec)) {
+    /* A short append is a torn record; the reader skips it. */
+  }
+  close(fd);
+}
+
+/* Start the blob toward the page cache before node asks for it: after a
+ * reboot the first deserialize of a session is otherwise a synchronous
+ * 10-20 MB disk read on the hook's critical path. Issued just before the
+ * execv so the read-ahead overlaps node's own startup; with the blob already
+ * cached the kernel answers from memory and it costs one open. */
+void blob_prewarm(const struct launch_manifest *m) {
+  int fd = open(m->blob, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return;
+#if defined(__APPLE__)
+  struct radvisory ra = {
+      .ra_offset = 0,
+      .ra_count = m->blob_size > INT_MAX ? INT_MAX : (int)m->blob_size,
+  };
+  fcntl(fd, F_RDADVISE, &ra);
+#elif defined(POSIX_FADV_WILLNEED)
+  posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+#endif
+  close(fd);
+}
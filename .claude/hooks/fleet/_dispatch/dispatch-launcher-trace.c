@@ -0,0 +1,158 @@
+/*
+ * POSIX launcher: the opt-in phase-trace ring (FLEET_DISPATCH_TRACE), shared
+ * with the node side in dispatch-trace.mts.
+ */
+
+#include "dispatch-launcher.h"
+
+/* Opt-in phase tracing: FLEET_DISPATCH_TRACE=<absolute ring file>. Each phase
+ * becomes one fixed record in a shared mmap'd ring (layout, and the node side
+ * that appends to it, in dispatch-trace.mts). One atomic fetch-add on the
+ * ring's cursor claims a block of TRACE_BLOCK slots for this event; the
+ * launcher writes its records from the front of the block and hands the rest
+ * to node through FLEET_DISPATCH_TRACE_CTX, so no slot ever has two writers.
+ * Tracing off costs one getenv. */
+#define TRACE_MAGIC "FLTTR\0\0\1"
+#define TRACE_RECORD 128
+#define TRACE_SLOTS 65536
+#define TRACE_BLOCK 128
+/* Slots kept back at the block's tail for phases recorded after a handoff. */
+#define TRACE_TAIL 4
+
+struct trace_header {
+  char magic[8];
+  uint32_t record_size;
+  uint32_t slots;
+  uint64_t cursor;
+  char pad[TRACE_RECORD - 24];
+};
+
+struct trace_record {
+  uint32_t check; /* FNV-1a over the rest; stored last, 0 = empty */
+  uint32_t pid;
+  uint64_t id;
+  uint64_t start_ns;
+  uint64_t dur_ns;
+  char event[32];
+  char phase[64];
+};
+
+_Static_assert(sizeof(struct trace_header) == TRACE_RECORD, "trace header layout");
+_Static_assert(sizeof(struct trace_record) == TRACE_RECORD, "trace record layout");
+
+static struct {
+  struct trace_header *hdr; /* NULL = tracing off */
+  struct trace_record *slots;
+  uint64_t id, next, end; /* the launcher's own slots are [next, end) */
+  const char *event;
+} tr;
+
+/* The clock node's process.hrtime() reads, so both sides share one axis. */
+uint64_t trace_now(void) {
+#if defined(__APPLE__)
+  return clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+static uint32_t trace_check(const struct trace_record *r) {
+  const unsigned char *p = (const unsigned char *)r;
+  uint32_t h = 0x811c9dc5u;
+  for (size_t i = 4; i < sizeof(*r); ++i) h = (h ^ p[i]) * 0x01000193u;
+  return h ? h : 1;
+}
+
+/* Claim the next block; a block never straddles the ring's end. Returns the
+ * raw cursor, unique for the life of the ring file. */
+static uint64_t trace_claim(void) {
+  uint64_t base = __atomic_fetch_add(&tr.hdr->cursor, TRACE_BLOCK, __ATOMIC_RELAXED);
+  tr.next = base % TRACE_SLOTS;
+  tr.end = tr.next + TRACE_BLOCK;
+  return base;
+}
+
+/* Map the ring (creating it on first use). Never fails the launch. */
+void trace_open(const char *event) {
+  const char *path = getenv("FLEET_DISPATCH_TRACE");
+  if (!path || path[0] != '/') return;
+  int fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+  if (fd < 0) return;
+  size_t size = (size_t)(TRACE_SLOTS + 1) * TRACE_RECORD;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || ((size_t)st.st_size < size && ftruncate(fd, (off_t)size) != 0)) {
+    close(fd);
+    return;
+  }
+  void *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) return;
+  struct trace_header *hdr = map;
+  if (memcmp(hdr->magic, TRACE_MAGIC, 8) != 0) {
+    /* First use. Every initializer stores the same bytes and none touches
+     * the cursor, so a race here can't undo a concurrent claim. */
+    hdr->record_size = TRACE_RECORD;
+    hdr->slots = TRACE_SLOTS;
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(hdr->magic, TRACE_MAGIC, 8);
+  } else if (hdr->record_size != TRACE_RECORD || hdr->slots != TRACE_SLOTS) {
+    munmap(map, size);
+    return;
+  }
+  tr.hdr = hdr;
+  tr.slots = (struct trace_record *)((char *)map + TRACE_RECORD);
+  tr.event = event ? event : "";
+  tr.id = trace_claim() / TRACE_BLOCK + 1;
+}
+
+/* Record one phase ending now; returns now, the next phase's start. */
+uint64_t trace_phase(const char *phase, uint64_t start_ns) {
+  if (!tr.hdr) return 0;
+  uint64_t end_ns = trace_now();
+  if (tr.next >= tr.end) return end_ns;
+  struct trace_record *r = &tr.slots[tr.next++];
+  __atomic_store_n(&r->check, 0, __ATOMIC_RELAXED);
+  struct trace_record rec = {0};
+  rec.pid = (uint32_t)getpid();
+  rec.id = tr.id;
+  rec.start_ns = start_ns;
+  rec.dur_ns = end_ns > start_ns ? end_ns - start_ns : 0;
+  /* NUL-padded, not NUL-terminated: a full-width name fills its field. */
+  memcpy(rec.event, tr.event, strnlen(tr.event, sizeof(rec.event)));
+  memcpy(rec.phase, phase, strnlen(phase, sizeof(rec.phase)));
+  memcpy((char *)r + 4, (char *)&rec + 4, sizeof(rec) - 4);
+  __atomic_store_n(&r->check, trace_check(&rec), __ATOMIC_RELEASE);
+  return end_ns;
+}
+
+/* Hand node a slot range (the daemon worker or the exec'd dispatcher appends
+ * there) stamped with the handoff time, via FLEET_DISPATCH_TRACE_CTX. The
+ * first handoff gets the unused front of the block, the launcher keeping
+ * TRACE_TAIL slots for what it records after. An exec after a daemon attempt
+ * — whose worker may still be writing — gets a fresh block under the same
+ * trace id; a retry after a failed execv reuses the range. */
+void trace_handoff(int to_daemon) {
+  static uint64_t first, last;
+  static int daemon_may_write;
+  if (!tr.hdr) return;
+  if (!last) {
+    first = tr.next;
+    last = tr.end - TRACE_TAIL;
+    tr.next = last;
+  } else if (daemon_may_write) {
+    uint64_t next = tr.next, end = tr.end;
+    trace_claim();
+    first = tr.next;
+    last = tr.end;
+    tr.next = next;
+    tr.end = end;
+  }
+  daemon_may_write = to_daemon;
+  char ctx[96];
+  snprintf(ctx, sizeof(ctx), "%llu:%llu:%llu:%llu", (unsigned long long)tr.id,
+           (unsigned long long)first, (unsigned long long)last,
+           (unsigned long long)trace_now());
+  setenv("FLEET_DISPATCH_TRACE_CTX", ctx, 1);
+}
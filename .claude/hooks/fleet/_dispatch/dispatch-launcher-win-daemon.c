@@ -0,0 +1,262 @@
+/*
+ * Windows launcher: the warm-daemon client. Ships the event to a parked
+ * dispatch-daemon.mts worker over its per-user named pipe and relays the
+ * reply; the frame layout is documented there.
+ */
+
+#include "dispatch-launcher-win.h"
+
+/* Budget from opening the slot pipe to the daemon's ack byte. Past the ack the
+ * hooks are already running in the daemon, so the launcher waits for the reply
+ * rather than racing a second dispatch through CreateProcess. */
+#define DAEMON_ACK_MS 250
+
+static int buf_reserve(struct buf *b, size_t n) {
+  if (b->len + n > b->cap) {
+    size_t cap = b->cap ? b->cap : 4096;
+    while (cap < b->len + n) cap *= 2;
+    char *np = realloc(b->p, cap);
+    if (!np) return -1;
+    b->p = np;
+    b->cap = cap;
+  }
+  return 0;
+}
+
+static int buf_put(struct buf *b, const void *src, size_t n) {
+  if (buf_reserve(b, n) != 0) return -1;
+  if (n) memcpy(b->p + b->len, src, n);
+  b->len += n;
+  return 0;
+}
+
+/* One length-prefixed (u32 little-endian) protocol field. */
+static int buf_field(struct buf *b, const void *src, size_t n) {
+  unsigned char le[4] = {(unsigned char)n, (unsigned char)(n >> 8),
+                         (unsigned char)(n >> 16), (unsigned char)(n >> 24)};
+  return (buf_put(b, le, 4) == 0 && buf_put(b, src, n) == 0) ? 0 : -1;
+}
+
+/* Append a wide string as UTF-8 (the daemon decodes every field as UTF-8). */
+static int buf_put_utf8(struct buf *b, const wchar_t *w, int wlen) {
+  if (wlen == 0) return 0;
+  int n = WideCharToMultiByte(CP_UTF8, 0, w, wlen, NULL, 0, NULL, NULL);
+  if (n <= 0 || buf_reserve(b, (size_t)n) != 0) return -1;
+  if (WideCharToMultiByte(CP_UTF8, 0, w, wlen, b->p + b->len, n, NULL, NULL) != n) return -1;
+  b->len += (size_t)n;
+  return 0;
+}
+
+static int buf_field_utf8(struct buf *b, const wchar_t *w, int wlen) {
+  struct buf tmp = {0};
+  int ok = buf_put_utf8(&tmp, w, wlen) == 0 && buf_field(b, tmp.p, tmp.len) == 0;
+  free(tmp.p);
+  return ok ? 0 : -1;
+}
+
+static uint32_t le32(const unsigned char *b) {
+  return (uint32_t)b[0] | (uint32_t)b[1] << 8 | (uint32_t)b[2] << 16 |
+         (uint32_t)b[3] << 24;
+}
+
+/* Drain all of our stdin (a pipe from Claude; a console or NUL reads empty). */
+int read_all_stdin(struct buf *in) {
+  HANDLE h = GetStdHandle(STD_INPUT_HANDLE);
+  if (h == NULL || h == INVALID_HANDLE_VALUE) return 0;
+  if (GetFileType(h) == FILE_TYPE_CHAR) return 0;
+  char chunk[65536];
+  for (;;) {
+    DWORD got = 0;
+    if (!ReadFile(h, chunk, sizeof(chunk), &got, NULL)) {
+      return GetLastError() == ERROR_BROKEN_PIPE ? 0 : -1;
+    }
+    if (got == 0) return 0;
+    if (buf_put(in, chunk, got) != 0) return -1;
+  }
+}
+
+/* One overlapped read or write of exactly n bytes on the slot pipe, bounded by
+ * deadline (GetTickCount64 ms; 0 = no deadline). */
+static int pipe_io(HANDLE h, HANDLE ev, char *p, DWORD n, int writing, ULONGLONG deadline) {
+  while (n) {
+    OVERLAPPED ov;
+    ZeroMemory(&ov, sizeof(ov));
+    ov.hEvent = ev;
+    DWORD done = 0;
+    BOOL ok = writing ? WriteFile(h, p, n, NULL, &ov) : ReadFile(h, p, n, NULL, &ov);
+    if (!ok && GetLastError() != ERROR_IO_PENDING) return -1;
+    DWORD wait = INFINITE;
+    if (deadline) {
+      ULONGLONG now = GetTickCount64();
+      wait = now >= deadline ? 0 : (DWORD)(deadline - now);
+    }
+    if (WaitForSingleObject(ev, wait) != WAIT_OBJECT_0) {
+      CancelIoEx(h, &ov);
+      GetOverlappedResult(h, &ov, &done, TRUE);
+      return -1;
+    }
+    if (!GetOverlappedResult(h, &ov, &done, FALSE) || done == 0) return -1;
+    p += done;
+    n -= done;
+  }
+  return 0;
+}
+
+/* The pipe's server process must run as the same user as us: the pipe
+ * namespace is machine-global, so another account could have created a pipe
+ * of this name first and would otherwise receive our environment + stdin. */
+static int pipe_server_is_us(HANDLE pipe) {
+  ULONG pid = 0;
+  if (!GetNamedPipeServerProcessId(pipe, &pid)) return 0;
+  HANDLE proc = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid);
+  if (!proc) return 0;
+  int same = 0;
+  HANDLE theirs = NULL, ours = NULL;
+  if (OpenProcessToken(proc, TOKEN_QUERY, &theirs) &&
+      OpenProcessToken(GetCurrentProcess(), TOKEN_QUERY, &ours)) {
+    DWORD a[64], b[64]; /* TOKEN_USER + SID, DWORD-aligned */
+    DWORD an = 0, bn = 0;
+    if (GetTokenInformation(theirs, TokenUser, a, sizeof(a), &an) &&
+        GetTokenInformation(ours, TokenUser, b, sizeof(b), &bn)) {
+      same = EqualSid(((TOKEN_USER *)a)->User.Sid, ((TOKEN_USER *)b)->User.Sid) ? 1 : 0;
+    }
+  }
+  if (theirs) CloseHandle(theirs);
+  if (ours) CloseHandle(ours);
+  CloseHandle(proc);
+  return same;
+}
+
+/* Build the request frame (see dispatch-daemon.mts for the layout). */
+static int build_request(struct buf *req, const char *hash, const wchar_t *event,
+                         const struct buf *in) {
+  wchar_t cwd[MAX_PATH];
+  DWORD cwd_len = GetCurrentDirectoryW(MAX_PATH, cwd);
+  if (cwd_len == 0 || cwd_len >= MAX_PATH) cwd_len = 0;
+  /* Environment block: NUL-separated entries, double-NUL terminated. The
+   * drive-cwd pseudo-vars ("=C:=C:\...") ride along; the daemon skips any
+   * entry without a name before its '='. */
+  LPWCH env = GetEnvironmentStringsW();
+  int env_len = 0; /* up to (not including) the last entry's terminator */
+  if (env && env[0]) {
+    while (env[env_len] || env[env_len + 1]) env_len++;
+  }
+  int ok = buf_put(req, "FDD1", 4) == 0 &&
+           buf_field(req, hash, strlen(hash)) == 0 &&
+           buf_field_utf8(req, event ? event : L"", event ? (int)wcslen(event) : 0) == 0 &&
+           buf_field_utf8(req, cwd, (int)cwd_len) == 0 &&
+           buf_field_utf8(req, env ? env : L"", env_len) == 0 &&
+           buf_field(req, in->p, in->len) == 0;
+  if (env) FreeEnvironmentStringsW(env);
+  return ok ? 0 : -1;
+}
+
+static void write_std(DWORD which, const char *p, size_t n) {
+  HANDLE h = GetStdHandle(which);
+  while (n && h && h != INVALID_HANDLE_VALUE) {
+    DWORD w = 0;
+    if (!WriteFile(h, p, (DWORD)n, &w, NULL) || w == 0) return;
+    p += w;
+    n -= w;
+  }
+}
+
+/* Read one length-prefixed reply field (no deadline: only used after the ack). */
+static int recv_field(HANDLE h, HANDLE ev, struct buf *out) {
+  unsigned char le[4];
+  if (pipe_io(h, ev, (char *)le, 4, 0, 0) != 0) return -1;
+  uint32_t n = le32(le);
+  if (n == 0) return 0;
+  if (!(out->p = malloc(n))) return -1;
+  out->cap = n;
+  if (pipe_io(h, ev, out->p, n, 0, 0) != 0) return -1;
+  out->len = n;
+  return 0;
+}
+
+/* Try the warm daemon. Returns the hook exit code when the daemon served the
+ * event, -1 to fall back to CreateProcess, or DAEMON_TRUNCATED when it acked
+ * but its reply ended early (fall back the same way). Stdin lands in `in` (unless the
+ * pre-flight already `drained` it there) for the caller to replay. */
+int try_daemon(const wchar_t *dir, const wchar_t *event, struct buf *in,
+                      int drained) {
+  /* daemon.path: "<bundle-hash> <slot-count> <pipe-base>" (ASCII). */
+  wchar_t line[MAX_PATH];
+  if (read_sidecar(dir, L"daemon.path", line, MAX_PATH) != 0) return -1;
+  wchar_t *sp1 = wcschr(line, L' ');
+  if (!sp1) return -1;
+  *sp1++ = L'\0';
+  wchar_t *base = wcschr(sp1, L' ');
+  if (!base) return -1;
+  *base++ = L'\0';
+  char hash[64];
+  size_t hl = 0;
+  for (; line[hl] && hl + 1 < sizeof(hash); hl++) hash[hl] = (char)line[hl];
+  hash[hl] = '\0';
+  int slots = _wtoi(sp1);
+  if (slots <= 0 || slots > 16) return -1;
+
+  HANDLE ev = CreateEventW(NULL, TRUE, FALSE, NULL);
+  if (!ev) return -1;
+  ULONGLONG deadline = GetTickCount64() + DAEMON_ACK_MS;
+  struct buf req = {0};
+  HANDLE h = INVALID_HANDLE_VALUE;
+  for (int slot = 0; slot < slots && h == INVALID_HANDLE_VALUE; ++slot) {
+    wchar_t name[MAX_PATH];
+    if (_snwprintf_s(name, MAX_PATH, _TRUNCATE, L"%s.%d.sock", base, slot) < 0) break;
+    /* A taken slot answers ERROR_PIPE_BUSY / FILE_NOT_FOUND: move on, never
+     * WaitNamedPipe — queueing behind a running request is the execv path's
+     * job, not ours. */
+    h = CreateFileW(name, GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING,
+                    FILE_FLAG_OVERLAPPED, NULL);
+    if (h == INVALID_HANDLE_VALUE) continue;
+    if (!pipe_server_is_us(h)) {
+      CloseHandle(h);
+      h = INVALID_HANDLE_VALUE;
+      continue;
+    }
+    /* First live slot: only now is it worth draining stdin + framing. */
+    if (!req.len) {
+      int ok = drained || read_all_stdin(in) == 0;
+      if (ok) trace_handoff(1); /* before framing: the frame carries the env */
+      if (!ok || build_request(&req, hash, event, in) != 0) {
+        CloseHandle(h);
+        h = INVALID_HANDLE_VALUE;
+        break;
+      }
+    }
+    char ack = 0;
+    if (req.len > MAXDWORD || pipe_io(h, ev, req.p, (DWORD)req.len, 1, deadline) != 0 ||
+        pipe_io(h, ev, &ack, 1, 0, deadline) != 0 || ack != 'A') {
+      /* Lost a race for this slot, or a stale ('S') daemon: try the next. */
+      CloseHandle(h);
+      h = INVALID_HANDLE_VALUE;
+      if (ack == 'S') break;
+    }
+  }
+  free(req.p);
+  if (h == INVALID_HANDLE_VALUE) {
+    CloseHandle(ev);
+    return -1;
+  }
+
+  /* Acked: the daemon owns this event now. A reply cut short (a worker that
+   * died mid-event) is not an answer: nothing of it is written, and the
+   * caller dispatches locally with the replayed stdin. A hook the worker
+   * already ran may run twice; a block is never turned into an allow. */
+  unsigned char code[4];
+  struct buf out = {0}, err = {0};
+  int exit_code = DAEMON_TRUNCATED;
+  if (pipe_io(h, ev, (char *)code, 4, 0, 0) == 0 && recv_field(h, ev, &out) == 0 &&
+      recv_field(h, ev, &err) == 0) {
+    /* stderr first, matching the spawned dispatcher's write order. */
+    write_std(STD_ERROR_HANDLE, err.p, err.len);
+    write_std(STD_OUTPUT_HANDLE, out.p, out.len);
+    exit_code = (int)(int32_t)le32(code);
+  }
+  free(out.p);
+  free(err.p);
+  CloseHandle(h);
+  CloseHandle(ev);
+  return exit_code;
+}
@@ -0,0 +1,114 @@
+/*
+ * Windows launcher: launch.manifest (layout in
+ * scripts/fleet/_shared/launch-manifest.mts), its blob check, and the
+ * per-event split-blob choice. Also the one-line text sidecar reader.
+ */
+
+#include "dispatch-launcher-win.h"
+
+/* Read the first line of <dir>\<name> into out (trimmed of trailing CR/LF/space).
+ * Returns 0 on a non-empty line, -1 otherwise. The sidecars are ASCII paths
+ * written by Node; read as bytes and widen, which is correct for ASCII and the
+ * common case. (A non-ASCII frozen path is a rare build-host quirk; on a read
+ * miss the launcher simply falls open.) */
+int read_sidecar(const wchar_t *dir, const wchar_t *name, wchar_t *out, DWORD cap) {
+  wchar_t path[MAX_PATH];
+  if (_snwprintf_s(path, MAX_PATH, _TRUNCATE, L"%s\\%s", dir, name) < 0) return -1;
+  FILE *f = _wfopen(path, L"rb");
+  if (!f) return -1;
+  char raw[MAX_PATH * 2];
+  size_t got = fread(raw, 1, sizeof(raw) - 1, f);
+  fclose(f);
+  if (got == 0) return -1;
+  raw[got] = '\0';
+  /* Cut at the first newline. */
+  for (size_t i = 0; i < got; i++) {
+    if (raw[i] == '\n' || raw[i] == '\r') { raw[i] = '\0'; break; }
+  }
+  /* Trim trailing spaces. */
+  size_t len = strlen(raw);
+  while (len && raw[len - 1] == ' ') raw[--len] = '\0';
+  if (len == 0) return -1;
+  /* Widen ASCII bytes to wchar_t. */
+  DWORD i = 0;
+  for (; raw[i] && i + 1 < cap; i++) out[i] = (wchar_t)(unsigned char)raw[i];
+  out[i] = L'\0';
+  return i ? 0 : -1;
+}
+
+/* Read <dir>\<name> as a launch manifest. Returns 0 when it is whole and
+ * ours. */
+int read_manifest(const wchar_t *dir, const wchar_t *name, struct launch_manifest *m) {
+  wchar_t path[MAX_PATH];
+  if (_snwprintf_s(path, MAX_PATH, _TRUNCATE, L"%s\\%s", dir, name) < 0) return -1;
+  HANDLE f = CreateFileW(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                         FILE_ATTRIBUTE_NORMAL, NULL);
+  if (f == INVALID_HANDLE_VALUE) return -1;
+  DWORD n = 0;
+  BOOL ok = ReadFile(f, m, sizeof(*m), &n, NULL);
+  CloseHandle(f);
+  if (!ok || n != sizeof(*m) || memcmp(m->magic, LAUNCH_MANIFEST_MAGIC, 8) != 0 ||
+      m->size != LAUNCH_MANIFEST_SIZE || !m->node[0] ||
+      m->node[sizeof(m->node) - 1] || m->blob[sizeof(m->blob) - 1] ||
+      m->flags[sizeof(m->flags) - 1])
+    return -1;
+  return 0;
+}
+
+/* Per-event split blob: <dir>\launch.<Event>.manifest, as in the POSIX
+ * launcher — same layout, looked up only for a plain identifier event. */
+#define EVENT_NAME_MAX 64
+
+static int read_event_manifest(const wchar_t *dir, const wchar_t *event,
+                               struct launch_manifest *m) {
+  if (!event) return -1;
+  size_t n = wcslen(event);
+  if (!n || n > EVENT_NAME_MAX ||
+      !((event[0] >= L'A' && event[0] <= L'Z') || (event[0] >= L'a' && event[0] <= L'z')))
+    return -1;
+  for (size_t i = 1; i < n; ++i) {
+    wchar_t c = event[i];
+    if (!((c >= L'A' && c <= L'Z') || (c >= L'a' && c <= L'z') || (c >= L'0' && c <= L'9')))
+      return -1;
+  }
+  wchar_t name[EVENT_NAME_MAX + 32];
+  if (_snwprintf_s(name, EVENT_NAME_MAX + 32, _TRUNCATE, L"launch.%s.manifest", event) < 0)
+    return -1;
+  return read_manifest(dir, name, m);
+}
+
+int utf8_to_wide(const char *s, wchar_t *out, int cap) {
+  return MultiByteToWideChar(CP_UTF8, MB_ERR_INVALID_CHARS, s, -1, out, cap) > 0 ? 0 : -1;
+}
+
+/* The frozen blob is still the one the manifest describes (size + mtime; node
+ * reports the same FILETIME-derived mtime the attributes carry). A size-0
+ * record means the blob didn't exist at freeze time. */
+int blob_matches(const struct launch_manifest *m, const wchar_t *blob) {
+  WIN32_FILE_ATTRIBUTE_DATA a;
+  if (!m->blob_size || !GetFileAttributesExW(blob, GetFileExInfoStandard, &a) ||
+      (a.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+    return 0;
+  uint64_t size = (uint64_t)a.nFileSizeHigh << 32 | a.nFileSizeLow;
+  uint64_t ft = (uint64_t)a.ftLastWriteTime.dwHighDateTime << 32 |
+                a.ftLastWriteTime.dwLowDateTime;
+  /* FILETIME: 100 ns ticks since 1601-01-01. */
+  int64_t mtime_ns = ((int64_t)ft - 116444736000000000LL) * 100;
+  return size == m->blob_size && mtime_ns == m->blob_mtime_ns;
+}
+
+/* The manifest to boot once the full blob `m` checked out: this event's
+ * split blob (read into *em, its wide path into split_blob) when there is
+ * one and it is intact, else `m`. A split manifest whose blob no longer
+ * matches sets *split_stale (the caller heals it like a missing blob) and
+ * leaves the full blob. */
+const struct launch_manifest *select_boot(const wchar_t *dir, const wchar_t *event,
+                                          const struct launch_manifest *m,
+                                          struct launch_manifest *em,
+                                          wchar_t *split_blob, int *split_stale) {
+  if (read_event_manifest(dir, event, em) != 0) return m;
+  if (utf8_to_wide(em->blob, split_blob, WPATH_MAX) == 0 && blob_matches(em, split_blob))
+    return em;
+  *split_stale = 1;
+  return m;
+}
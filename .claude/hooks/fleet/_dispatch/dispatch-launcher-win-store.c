@@ -0,0 +1,199 @@
+/*
+ * Windows launcher: the blob store side of a launch — self-heal of a missing
+ * blob and the access log.
+ */
+
+#include "dispatch-launcher-win.h"
+
+/* Access record for the blob store's LRU sweep, as in the POSIX launcher
+ * (layout owned by scripts/fleet/_shared/snapshot-store.mts): one 128-byte
+ * append to <store root>\access.log per launch that had a manifest, rotated
+ * to access.log.1 at ACCESS_LOG_MAX. The recorded "<tag>\<file>" keeps the
+ * native separator; the reader folds it. */
+#define ACCESS_LOG_MAX (2 * 1024 * 1024)
+
+struct access_record {
+  int64_t at_ns;
+  char kind; /* H full blob, S split blob, P pre-flight, D daemon, M miss */
+  char reserved[7];
+  char blob[112];
+};
+
+typedef char access_record_layout[sizeof(struct access_record) == 128 ? 1 : -1];
+
+static int is_sep(char c) { return c == '\\' || c == '/'; }
+
+void access_note(const char *blob, char kind) {
+  const char *file = NULL;
+  for (const char *p = blob; *p; ++p)
+    if (is_sep(*p)) file = p;
+  if (!file || file == blob) return;
+  const char *tag = file - 1;
+  while (tag > blob && !is_sep(*tag)) --tag;
+  if (tag == blob) return;
+  struct access_record rec;
+  memset(&rec, 0, sizeof(rec));
+  size_t rel = strlen(tag + 1);
+  if (rel >= sizeof(rec.blob)) return;
+  memcpy(rec.blob, tag + 1, rel);
+  char root[WPATH_MAX];
+  size_t root_len = (size_t)(tag - blob);
+  if (root_len >= sizeof(root)) return;
+  memcpy(root, blob, root_len);
+  root[root_len] = '\0';
+  wchar_t wroot[WPATH_MAX], log[WPATH_MAX], old[WPATH_MAX];
+  if (utf8_to_wide(root, wroot, WPATH_MAX) != 0 ||
+      _snwprintf_s(log, WPATH_MAX, _TRUNCATE, L"%s\\access.log", wroot) < 0 ||
+      _snwprintf_s(old, WPATH_MAX, _TRUNCATE, L"%s\\access.log.1", wroot) < 0)
+    return;
+  HANDLE h = CreateFileW(log, FILE_APPEND_DATA, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                         NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (h == INVALID_HANDLE_VALUE) return;
+  LARGE_INTEGER size;
+  /* This record still lands in the renamed file, which is read too. */
+  if (GetFileSizeEx(h, &size) && size.QuadPart >= ACCESS_LOG_MAX)
+    MoveFileExW(log, old, MOVEFILE_REPLACE_EXISTING);
+  FILETIME now;
+  GetSystemTimeAsFileTime(&now);
+  uint64_t ft = (uint64_t)now.dwHighDateTime << 32 | now.dwLowDateTime;
+  rec.at_ns = ((int64_t)ft - 116444736000000000LL) * 100;
+  rec.kind = kind;
+  DWORD wrote = 0;
+  WriteFile(h, &rec, sizeof(rec), &wrote, NULL);
+  CloseHandle(h);
+}
+
+/* Self-heal, as in the POSIX launcher: a manifest whose blob is gone or
+ * changed starts ONE detached `node scripts\fleet\setup\hook-snapshot.mts
+ * --heal` and carries on down the fail-open chain. heal.lock, in the blob
+ * cache root two levels above the blob, is opened share-exclusive and the
+ * healer inherits that handle, so a second miss while it runs can't open it;
+ * its last-write time marks the last attempt (one per HEAL_RETRY_S). The
+ * healer gets only its NUL stdin, heal.log, and the lock (an explicit handle
+ * list): inheriting the hook's own pipes would hold Claude Code's read of
+ * this event open until the rebuild finished. */
+#define HEAL_RETRY_S 600
+
+/* mkdir -p, creating at most `depth` missing parents above path itself. */
+static int mkdir_tail(wchar_t *path, int depth) {
+  if (CreateDirectoryW(path, NULL) || GetLastError() == ERROR_ALREADY_EXISTS) return 0;
+  if (GetLastError() != ERROR_PATH_NOT_FOUND || depth <= 0) return -1;
+  wchar_t *sep = wcsrchr(path, L'\\');
+  if (!sep || sep == path) return -1;
+  *sep = L'\0';
+  int r = mkdir_tail(path, depth - 1);
+  *sep = L'\\';
+  return r == 0 && (CreateDirectoryW(path, NULL) || GetLastError() == ERROR_ALREADY_EXISTS)
+             ? 0
+             : -1;
+}
+
+/* Open heal.lock for a new attempt: the handle, or NULL when a heal is
+ * running or the last one was too recent. */
+static HANDLE heal_lock(const wchar_t *cache) {
+  wchar_t path[WPATH_MAX];
+  if (_snwprintf_s(path, WPATH_MAX, _TRUNCATE, L"%s\\heal.lock", cache) < 0) return NULL;
+  SECURITY_ATTRIBUTES sa = {sizeof(sa), NULL, TRUE};
+  HANDLE h = CreateFileW(path, GENERIC_READ | GENERIC_WRITE, 0, &sa, OPEN_ALWAYS,
+                         FILE_ATTRIBUTE_NORMAL, NULL);
+  if (h == INVALID_HANDLE_VALUE) return NULL;
+  LARGE_INTEGER size;
+  FILETIME written, now;
+  GetSystemTimeAsFileTime(&now);
+  uint64_t age = 0;
+  if (GetFileSizeEx(h, &size) && GetFileTime(h, NULL, NULL, &written)) {
+    uint64_t w = (uint64_t)written.dwHighDateTime << 32 | written.dwLowDateTime;
+    uint64_t n = (uint64_t)now.dwHighDateTime << 32 | now.dwLowDateTime;
+    age = n > w ? (n - w) / 10000000 : 0;
+  } else {
+    size.QuadPart = 1;
+  }
+  /* Empty = never attempted (creation alone sets a fresh write time). */
+  char stamp[32];
+  int len = snprintf(stamp, sizeof(stamp), "%llu\n",
+                     (unsigned long long)((((uint64_t)now.dwHighDateTime << 32 |
+                                            now.dwLowDateTime) -
+                                           116444736000000000ULL) /
+                                          10000000));
+  DWORD wrote = 0;
+  if ((size.QuadPart && age < HEAL_RETRY_S) || !SetEndOfFile(h) ||
+      !WriteFile(h, stamp, (DWORD)len, &wrote, NULL) || wrote != (DWORD)len) {
+    CloseHandle(h);
+    return NULL;
+  }
+  return h;
+}
+
+void heal_spawn(const wchar_t *dir, const struct launch_manifest *m,
+                       const wchar_t *node) {
+  wchar_t cache[WPATH_MAX], script[WPATH_MAX], log[WPATH_MAX];
+  if (utf8_to_wide(m->blob, cache, WPATH_MAX) != 0) return;
+  /* <cache root>\<runtime tag>\<blob> */
+  for (int up = 0; up < 2; ++up) {
+    wchar_t *sep = wcsrchr(cache, L'\\');
+    if (!sep || sep == cache) return;
+    *sep = L'\0';
+  }
+  /* A bundle-only tree ships no build scripts: nothing to heal with. */
+  if (_snwprintf_s(script, WPATH_MAX, _TRUNCATE,
+                   L"%s\\..\\..\\..\\..\\scripts\\fleet\\setup\\hook-snapshot.mts", dir) < 0 ||
+      GetFileAttributesW(script) == INVALID_FILE_ATTRIBUTES ||
+      _snwprintf_s(log, WPATH_MAX, _TRUNCATE, L"%s\\heal.log", cache) < 0 ||
+      mkdir_tail(cache, 2) != 0)
+    return;
+  HANDLE lock = heal_lock(cache);
+  if (!lock) return;
+  SECURITY_ATTRIBUTES sa = {sizeof(sa), NULL, TRUE};
+  HANDLE nul = CreateFileW(L"NUL", GENERIC_READ | GENERIC_WRITE,
+                           FILE_SHARE_READ | FILE_SHARE_WRITE, &sa, OPEN_EXISTING,
+                           FILE_ATTRIBUTE_NORMAL, NULL);
+  HANDLE out = CreateFileW(log, GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_DELETE, &sa,
+                           CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (out == INVALID_HANDLE_VALUE) out = nul;
+  SIZE_T attr_size = 0;
+  InitializeProcThreadAttributeList(NULL, 1, 0, &attr_size);
+  LPPROC_THREAD_ATTRIBUTE_LIST attrs = malloc(attr_size);
+  HANDLE inherit[3] = {nul, lock, out};
+  static wchar_t cmd[CMD_MAX];
+  if (nul != INVALID_HANDLE_VALUE && attrs &&
+      InitializeProcThreadAttributeList(attrs, 1, 0, &attr_size)) {
+    if (UpdateProcThreadAttribute(attrs, 0, PROC_THREAD_ATTRIBUTE_HANDLE_LIST, inherit,
+                                  (out == nul ? 2 : 3) * sizeof(HANDLE), NULL, NULL)) {
+      STARTUPINFOEXW si;
+      ZeroMemory(&si, sizeof(si));
+      si.StartupInfo.cb = sizeof(si);
+      si.StartupInfo.dwFlags = STARTF_USESTDHANDLES;
+      si.StartupInfo.hStdInput = nul;
+      si.StartupInfo.hStdOutput = out;
+      si.StartupInfo.hStdError = out;
+      si.lpAttributeList = attrs;
+      /* Out of the hook's job where the job allows it, so a kill-on-close
+       * job reaping this event doesn't take the rebuild with it. */
+      DWORD base = DETACHED_PROCESS | CREATE_NEW_PROCESS_GROUP | EXTENDED_STARTUPINFO_PRESENT;
+      DWORD flags[2] = {base | CREATE_BREAKAWAY_FROM_JOB, base};
+      int started = 0;
+      for (int pass = node ? 0 : 1; pass < 2 && !started; ++pass) {
+        for (int f = 0; f < 2 && !started; ++f) {
+          PROCESS_INFORMATION pi;
+          cmd[0] = L'\0';
+          append_arg(cmd, CMD_MAX, pass == 0 ? node : L"node");
+          append_arg(cmd, CMD_MAX, script);
+          append_arg(cmd, CMD_MAX, L"--heal");
+          if (CreateProcessW(pass == 0 ? node : NULL, cmd, NULL, NULL, TRUE, flags[f],
+                             NULL, NULL, &si.StartupInfo, &pi)) {
+            CloseHandle(pi.hProcess);
+            CloseHandle(pi.hThread);
+            started = 1;
+          }
+        }
+      }
+    }
+    DeleteProcThreadAttributeList(attrs);
+  }
+  free(attrs);
+  if (out != nul) CloseHandle(out);
+  if (nul != INVALID_HANDLE_VALUE) CloseHandle(nul);
+  /* Ours closed before the hook's own child is created: only the healer's
+   * copy may hold the lock. */
+  CloseHandle(lock);
+}
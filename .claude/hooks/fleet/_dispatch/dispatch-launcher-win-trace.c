@@ -0,0 +1,170 @@
+/*
+ * Windows launcher: the opt-in phase-trace ring (FLEET_DISPATCH_TRACE), shared
+ * with the POSIX launcher and the node side in dispatch-trace.mts.
+ */
+
+#include "dispatch-launcher-win.h"
+
+/* Opt-in phase tracing: FLEET_DISPATCH_TRACE=<absolute ring file>. The same
+ * ring as the POSIX launcher (layout, and the node side that appends to it,
+ * in dispatch-trace.mts): one interlocked add on the mapped cursor claims a
+ * block of TRACE_BLOCK slots for this event, the launcher writes from its
+ * front and hands the rest to node through FLEET_DISPATCH_TRACE_CTX, so no
+ * slot ever has two writers. Tracing off costs one GetEnvironmentVariableW. */
+#define TRACE_MAGIC "FLTTR\0\0\1"
+#define TRACE_RECORD 128
+#define TRACE_SLOTS 65536
+#define TRACE_BLOCK 128
+/* Slots kept back at the block's tail for phases recorded after a handoff. */
+#define TRACE_TAIL 4
+
+struct trace_header {
+  char magic[8];
+  uint32_t record_size;
+  uint32_t slots;
+  volatile LONG64 cursor;
+  char pad[TRACE_RECORD - 24];
+};
+
+struct trace_record {
+  volatile LONG check; /* FNV-1a over the rest; stored last, 0 = empty */
+  uint32_t pid;
+  uint64_t id;
+  uint64_t start_ns;
+  uint64_t dur_ns;
+  char event[32];
+  char phase[64];
+};
+
+typedef char trace_header_layout[sizeof(struct trace_header) == TRACE_RECORD ? 1 : -1];
+typedef char trace_record_layout[sizeof(struct trace_record) == TRACE_RECORD ? 1 : -1];
+
+static struct {
+  struct trace_header *hdr; /* NULL = tracing off */
+  struct trace_record *slots;
+  uint64_t id, next, end; /* the launcher's own slots are [next, end) */
+  char event[32];
+} tr;
+
+/* libuv's uv_hrtime (node's process.hrtime): the performance counter scaled
+ * to ns in double, so both sides share one axis. */
+uint64_t trace_now(void) {
+  static double ticks_per_ns;
+  LARGE_INTEGER c;
+  if (!ticks_per_ns) {
+    LARGE_INTEGER f;
+    if (!QueryPerformanceFrequency(&f) || !f.QuadPart) return 0;
+    ticks_per_ns = (double)f.QuadPart / 1e9;
+  }
+  if (!QueryPerformanceCounter(&c)) return 0;
+  return (uint64_t)((double)c.QuadPart / ticks_per_ns);
+}
+
+static uint32_t trace_check(const struct trace_record *r) {
+  const unsigned char *p = (const unsigned char *)r;
+  uint32_t h = 0x811c9dc5u;
+  for (size_t i = 4; i < sizeof(*r); ++i) h = (h ^ p[i]) * 0x01000193u;
+  return h ? h : 1;
+}
+
+/* Claim the next block; a block never straddles the ring's end. Returns the
+ * raw cursor, unique for the life of the ring file. */
+static uint64_t trace_claim(void) {
+  uint64_t base = (uint64_t)InterlockedExchangeAdd64(&tr.hdr->cursor, TRACE_BLOCK);
+  tr.next = base % TRACE_SLOTS;
+  tr.end = tr.next + TRACE_BLOCK;
+  return base;
+}
+
+/* Map the ring (creating it on first use). Never fails the launch. */
+void trace_open(const wchar_t *event) {
+  wchar_t path[WPATH_MAX];
+  DWORD n = GetEnvironmentVariableW(L"FLEET_DISPATCH_TRACE", path, WPATH_MAX);
+  if (n == 0 || n >= WPATH_MAX) return;
+  int absolute = (path[0] == L'\\' && path[1] == L'\\') ||
+                 (path[0] && path[1] == L':' && (path[2] == L'\\' || path[2] == L'/'));
+  if (!absolute) return;
+  /* Node opens the ring with the same full share mode. */
+  HANDLE f = CreateFileW(path, GENERIC_READ | GENERIC_WRITE,
+                         FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL,
+                         OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (f == INVALID_HANDLE_VALUE) return;
+  DWORD size = (DWORD)(TRACE_SLOTS + 1) * TRACE_RECORD;
+  /* A mapping larger than the file grows it (zero-filled) to that size. */
+  HANDLE map = CreateFileMappingW(f, NULL, PAGE_READWRITE, 0, size, NULL);
+  CloseHandle(f);
+  if (!map) return;
+  struct trace_header *hdr = MapViewOfFile(map, FILE_MAP_WRITE, 0, 0, size);
+  CloseHandle(map);
+  if (!hdr) return;
+  if (memcmp(hdr->magic, TRACE_MAGIC, 8) != 0) {
+    /* First use. Every initializer stores the same bytes and none touches
+     * the cursor, so a race here can't undo a concurrent claim. */
+    hdr->record_size = TRACE_RECORD;
+    hdr->slots = TRACE_SLOTS;
+    MemoryBarrier();
+    memcpy(hdr->magic, TRACE_MAGIC, 8);
+  } else if (hdr->record_size != TRACE_RECORD || hdr->slots != TRACE_SLOTS) {
+    UnmapViewOfFile(hdr);
+    return;
+  }
+  tr.hdr = hdr;
+  tr.slots = (struct trace_record *)((char *)hdr + TRACE_RECORD);
+  /* NUL-padded, not NUL-terminated: a full-width name fills its field. A
+   * name that doesn't fit in UTF-8 is recorded empty. */
+  if (event && !WideCharToMultiByte(CP_UTF8, 0, event, -1, tr.event, sizeof(tr.event), NULL, NULL))
+    memset(tr.event, 0, sizeof(tr.event));
+  tr.id = trace_claim() / TRACE_BLOCK + 1;
+}
+
+/* Record one phase ending now; returns now, the next phase's start. */
+uint64_t trace_phase(const char *phase, uint64_t start_ns) {
+  if (!tr.hdr) return 0;
+  uint64_t end_ns = trace_now();
+  if (tr.next >= tr.end) return end_ns;
+  struct trace_record *r = &tr.slots[tr.next++];
+  InterlockedExchange(&r->check, 0);
+  struct trace_record rec;
+  memset(&rec, 0, sizeof(rec));
+  rec.pid = (uint32_t)GetCurrentProcessId();
+  rec.id = tr.id;
+  rec.start_ns = start_ns;
+  rec.dur_ns = end_ns > start_ns ? end_ns - start_ns : 0;
+  memcpy(rec.event, tr.event, strnlen(tr.event, sizeof(rec.event)));
+  memcpy(rec.phase, phase, strnlen(phase, sizeof(rec.phase)));
+  memcpy((char *)r + 4, (char *)&rec + 4, sizeof(rec) - 4);
+  InterlockedExchange(&r->check, (LONG)trace_check(&rec));
+  return end_ns;
+}
+
+/* Hand node a slot range (the daemon worker or the child dispatcher appends
+ * there) stamped with the handoff time, via FLEET_DISPATCH_TRACE_CTX — the
+ * child inherits it, and build_request frames it from the environment block.
+ * The first handoff gets the unused front of the block, the launcher keeping
+ * TRACE_TAIL slots for what it records after (the child's wall time). A
+ * child after a daemon attempt — whose worker may still be writing — gets a
+ * fresh block under the same trace id; a retry after a failed CreateProcess
+ * reuses the range. */
+void trace_handoff(int to_daemon) {
+  static uint64_t first, last;
+  static int daemon_may_write;
+  if (!tr.hdr) return;
+  if (!last) {
+    first = tr.next;
+    last = tr.end - TRACE_TAIL;
+    tr.next = last;
+  } else if (daemon_may_write) {
+    uint64_t next = tr.next, end = tr.end;
+    trace_claim();
+    first = tr.next;
+    last = tr.end;
+    tr.next = next;
+    tr.end = end;
+  }
+  daemon_may_write = to_daemon;
+  wchar_t ctx[96];
+  _snwprintf_s(ctx, 96, _TRUNCATE, L"%llu:%llu:%llu:%llu", (unsigned long long)tr.id,
+               (unsigned long long)first, (unsigned long long)last,
+               (unsigned long long)trace_now());
+  SetEnvironmentVariableW(L"FLEET_DISPATCH_TRACE_CTX", ctx);
+}
@@ -14,27 +14,80 @@
  * see the build note. Correctness is guaranteed regardless by fail-open.)
  *
  * Same contract as the POSIX launcher:
- *   if <dispatch_dir>\snapshot-blob.path names an existing blob:
- *       node --snapshot-blob <blob> <Event>        (the fast path)
+ *   if <dispatch_dir>\launch.manifest names a blob still the size + mtime it
+ *   froze:
+ *       node <flags> --snapshot-blob <blob> <Event>   (the fast path)
+ *       -- with launch.<Event>.manifest's per-event blob instead, when the
+ *          build split them (--split-events) and it is intact too
  *   else:
  *       node <dispatch_dir>\index.cjs <Event>       (fail-open, always correct)
  *
- * node.path / snapshot-blob.path are build-time-frozen sidecars next to this
- * .exe (build-snapshot-launcher.mts writes them). A missing/blank sidecar, a
- * vanished blob, or ANY error falls open to index.cjs. The blob is a pure
+ * launch.manifest is the build-time-frozen binary record next to this .exe
+ * (build-snapshot-launcher.mts writes it; layout in
+ * scripts/fleet/_shared/launch-manifest.mts). Its paths are UTF-8, converted
+ * with MultiByteToWideChar, so a non-ASCII or longer-than-MAX_PATH node /
+ * blob path survives. A missing/torn manifest, a changed blob, or ANY error
+ * falls open to index.cjs. The blob is a pure
  * startup optimization; its absence is never an error. Fail-open is total —
  * every failure path lands on index.cjs (or, if even that cannot be launched,
  * exits 0, the dispatcher's universal "allow").
  *
+ * WARM DAEMON (opt-in, dispatch-daemon.mts): before any CreateProcess, the
+ * daemon.path sidecar ("<bundle-hash> <slots> <pipe-base>") names the
+ * per-user named pipes a running warm daemon's parked workers listen on, one
+ * per slot (<pipe-base>.<n>.sock). At the first slot that opens, whose server
+ * process runs as OUR user (the pipe namespace is machine-global, so a
+ * squatter's pipe is refused), the launcher ships event + cwd + environment +
+ * stdin in one frame and relays the worker's stdout / stderr / exit code —
+ * no node process created at all, which is the whole Windows tax. No live
+ * slot, a stale ('S') answer, no ack inside DAEMON_ACK_MS, or a reply cut
+ * short after the ack falls through to the run_and_wait chain below, with the
+ * drained stdin replayed into the child through an anonymous pipe.
+ *
+ * TOOL PRE-FLIGHT (ahead of both): the hook-tools.map sidecar lists per event
+ * the tool names some hook handles ("*" when an any-tool hook exists). When no
+ * hook can fire for this event + the payload's top-level tool_name, the
+ * launcher exits 0 without creating node at all — the same silent allow the
+ * dispatcher would render. Same rules as the POSIX launcher: trusted only
+ * while the frozen blob exists, and anything the scan can't read with
+ * certainty dispatches as usual with the scanned stdin replayed. Its
+ * "?<event> <tool>" trigger rules skip a handled tool too, exactly as on
+ * POSIX: no declared trigger in the raw payload, no hook for it can fire.
+ *
+ * TUNED FLAGS: a blob built under the benchmark-tuned flag profile
+ * (node-flag-profile.json) has its flag count in the manifest. The launcher
+ * waits on every child anyway, so a node replaced under the frozen path that
+ * rejects one of those flags (exit 9, before reading stdin or running a hook)
+ * just sends the event on to index.cjs, stdin drained up front and replayed.
+ *
+ * SELF-HEAL: a manifest whose blob has vanished starts one detached,
+ * lock-guarded `setup\hook-snapshot.mts --heal` before falling open, as on
+ * POSIX. There is no read-ahead hint on a hit: Windows has no
+ * posix_fadvise, and the cache manager already reads ahead on node's own
+ * sequential read of the blob.
+ *
+ * ACCESS LOG: the same 128-byte per-launch record as the POSIX launcher,
+ * appended to access.log in the blob store root for the builder's LRU sweep.
+ *
+ * PHASE TRACE (opt-in, FLEET_DISPATCH_TRACE=<absolute ring file>): the same
+ * mapped ring as the POSIX launcher; on top of its phases this one records
+ * the child's wall time ("child"), since it is still resident to see it.
+ *
  * Built UNICODE (-DUNICODE -D_UNICODE) so paths with non-ASCII survive; all
- * Win32 calls are the W variants. Cross-compiled with mingw:
- *   x86_64-w64-mingw32-gcc -O2 -municode -o dispatch-launcher.exe dispatch-launcher-win.c
+ * Win32 calls are the W variants. This file holds wmain; the manifest,
+ * daemon client, store (heal / access log) and trace ring are separate
+ * units sharing dispatch-launcher-win.h, which lists them, plus the
+ * pre-flight scan shared with POSIX. Cross-compiled with mingw:
+ *   x86_64-w64-mingw32-gcc -O2 -municode -o dispatch-launcher.exe \
+ *     dispatch-launcher-win.c dispatch-launcher-win-manifest.c \
+ *     dispatch-launcher-win-daemon.c dispatch-launcher-win-store.c \
+ *     dispatch-launcher-win-trace.c dispatch-launcher-preflight.c
+ * (WIN_SRCS in scripts/fleet/build-snapshot-launcher.mts; MSVC additionally
+ * needs advapi32.lib for the pipe-owner check.)
  */
 
-#define WIN32_LEAN_AND_MEAN
-#include <windows.h>
-#include <stdio.h>
-#include <wchar.h>
+#include "dispatch-launcher-win.h"
+#include "dispatch-launcher-preflight.h"
 
 /* Directory containing this .exe, so the sidecars + index.cjs resolve relative
  * to the launcher's own location (it lives in _dispatch\). */
@@ -51,45 +104,10 @@ static int self_dir(wchar_t *out, DWORD cap) {
   return 0;
 }
 
-/* Read the first line of <dir>\<name> into out (trimmed of trailing CR/LF/space).
- * Returns 0 on a non-empty line, -1 otherwise. The sidecars are ASCII paths
- * written by Node; read as bytes and widen, which is correct for ASCII and the
- * common case. (A non-ASCII frozen path is a rare build-host quirk; on a read
- * miss the launcher simply falls open.) */
-static int read_sidecar(const wchar_t *dir, const wchar_t *name, wchar_t *out, DWORD cap) {
-  wchar_t path[MAX_PATH];
-  if (_snwprintf_s(path, MAX_PATH, _TRUNCATE, L"%s\\%s", dir, name) < 0) return -1;
-  FILE *f = _wfopen(path, L"rb");
-  if (!f) return -1;
-  char raw[MAX_PATH * 2];
-  size_t got = fread(raw, 1, sizeof(raw) - 1, f);
-  fclose(f);
-  if (got == 0) return -1;
-  raw[got] = '\0';
-  /* Cut at the first newline. */
-  for (size_t i = 0; i < got; i++) {
-    if (raw[i] == '\n' || raw[i] == '\r') { raw[i] = '\0'; break; }
-  }
-  /* Trim trailing spaces. */
-  size_t len = strlen(raw);
-  while (len && raw[len - 1] == ' ') raw[--len] = '\0';
-  if (len == 0) return -1;
-  /* Widen ASCII bytes to wchar_t. */
-  DWORD i = 0;
-  for (; raw[i] && i + 1 < cap; i++) out[i] = (wchar_t)(unsigned char)raw[i];
-  out[i] = L'\0';
-  return i ? 0 : -1;
-}
-
-static int file_exists(const wchar_t *p) {
-  DWORD a = GetFileAttributesW(p);
-  return (a != INVALID_FILE_ATTRIBUTES) && !(a & FILE_ATTRIBUTE_DIRECTORY);
-}
-
 /* Append one argument to a Windows command line, quoting + backslash-escaping
  * per the CommandLineToArgvW rules (the de-facto MSVCRT convention) so a path
  * with spaces or trailing backslashes round-trips into argv intact. */
-static void append_arg(wchar_t *cmd, size_t cap, const wchar_t *arg) {
+void append_arg(wchar_t *cmd, size_t cap, const wchar_t *arg) {
   size_t len = wcslen(cmd);
   if (len && len + 1 < cap) cmd[len++] = L' ';
   if (len + 1 < cap) cmd[len++] = L'"';
@@ -114,10 +132,69 @@ static void append_arg(wchar_t *cmd, size_t cap, const wchar_t *arg) {
   cmd[len] = L'\0';
 }
 
+/* The tool pre-flight. Returns 1 when no hook can fire for this event +
+ * payload, 2 when the tool's trigger rule rules out every hook for it (the
+ * caller exits 0 on either), else 0. Sets *drained once stdin has been
+ * read into `in`, which the caller then replays. The map is ASCII; the event
+ * is compared as UTF-8. */
+static int preflight_skip(const wchar_t *dir, const wchar_t *event, struct buf *in,
+                          int *drained) {
+  char ev[256];
+  wchar_t path[MAX_PATH];
+  if (!event ||
+      WideCharToMultiByte(CP_UTF8, 0, event, -1, ev, (int)sizeof(ev), NULL, NULL) <= 0 ||
+      _snwprintf_s(path, MAX_PATH, _TRUNCATE, L"%s\\hook-tools.map", dir) < 0)
+    return 0;
+  HANDLE f = CreateFileW(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                         FILE_ATTRIBUTE_NORMAL, NULL);
+  if (f == INVALID_HANDLE_VALUE) return 0;
+  static char map[HOOK_TOOLS_MAX];
+  DWORD n = 0;
+  BOOL ok = ReadFile(f, map, sizeof(map), &n, NULL);
+  CloseHandle(f);
+  if (!ok || !tools_map_whole(map, n)) return 0;
+  const char *list;
+  size_t len;
+  if (!map_lookup(map, n, ev, &list, &len)) return 1;
+  if (len == 1 && list[0] == '*') return 0;
+  *drained = 1;
+  if (read_all_stdin(in) != 0) return 0;
+  return preflight_verdict(map, n, ev, list, len, in->p, in->len);
+}
+
+/* Feeds the replayed stdin into the child's pipe, then closes it (EOF). On a
+ * thread so a payload larger than the pipe buffer can't deadlock against the
+ * parent's WaitForSingleObject. */
+struct replay {
+  HANDLE w;
+  const struct buf *in;
+};
+
+static DWORD WINAPI replay_thread(LPVOID arg) {
+  struct replay *r = arg;
+  const char *p = r->in->p;
+  size_t n = r->in->len;
+  while (n) {
+    DWORD w = 0;
+    if (!WriteFile(r->w, p, n > 65536 ? 65536 : (DWORD)n, &w, NULL) || w == 0) break;
+    p += w;
+    n -= w;
+  }
+  CloseHandle(r->w);
+  return 0;
+}
+
+/* Node's exit code for an option it rejects ("bad option"), before it reads
+ * stdin or runs a hook: a boot under the tuned flag profile that ends with
+ * it is rerun untuned. */
+#define NODE_BAD_OPTION 9
+
 /* CreateProcess node with the given command line, inheriting this process's
  * std handles, wait for it, and return its exit code. Returns -1 if the process
- * could not be created at all (so the caller can try the next fallback). */
-static int run_and_wait(const wchar_t *app, wchar_t *cmdline) {
+ * could not be created at all (so the caller can try the next fallback). When
+ * `replay` is non-NULL (the daemon attempt already drained our stdin), the
+ * child's stdin is an anonymous pipe fed those exact bytes instead. */
+static int run_and_wait(const wchar_t *app, wchar_t *cmdline, const struct buf *replay) {
   STARTUPINFOW si;
   PROCESS_INFORMATION pi;
   ZeroMemory(&si, sizeof(si));
@@ -125,10 +202,35 @@ static int run_and_wait(const wchar_t *app, wchar_t *cmdline) {
   /* Children inherit our console + std handles by default (bInheritHandles
    * TRUE, no STARTF_USESTDHANDLES needed for a plain console child). */
   ZeroMemory(&pi, sizeof(pi));
+  HANDLE rd = NULL, wr = NULL;
+  if (replay) {
+    SECURITY_ATTRIBUTES sa = {sizeof(sa), NULL, TRUE};
+    if (CreatePipe(&rd, &wr, &sa, 0)) {
+      SetHandleInformation(wr, HANDLE_FLAG_INHERIT, 0);
+      si.dwFlags = STARTF_USESTDHANDLES;
+      si.hStdInput = rd;
+      si.hStdOutput = GetStdHandle(STD_OUTPUT_HANDLE);
+      si.hStdError = GetStdHandle(STD_ERROR_HANDLE);
+    }
+  }
   if (!CreateProcessW(app, cmdline, NULL, NULL, TRUE, 0, NULL, NULL, &si, &pi)) {
+    if (rd) CloseHandle(rd);
+    if (wr) CloseHandle(wr);
     return -1;
   }
+  HANDLE feeder = NULL;
+  struct replay r = {wr, replay};
+  if (rd) {
+    CloseHandle(rd);
+    feeder = CreateThread(NULL, 0, replay_thread, &r, 0, NULL);
+    if (!feeder) CloseHandle(wr);
+  }
   WaitForSingleObject(pi.hProcess, INFINITE);
+  if (feeder) {
+    /* The child exited; an unread remainder hits a broken pipe and ends. */
+    WaitForSingleObject(feeder, INFINITE);
+    CloseHandle(feeder);
+  }
   DWORD code = 0;
   if (!GetExitCodeProcess(pi.hProcess, &code)) code = 0;
   CloseHandle(pi.hProcess);
@@ -137,45 +239,122 @@ static int run_and_wait(const wchar_t *app, wchar_t *cmdline) {
 }
 
 int wmain(int argc, wchar_t **argv) {
+  const wchar_t *event = (argc > 1) ? argv[1] : NULL;
+
+  uint64_t t = trace_now();
+  trace_open(event);
+  t = trace_phase("trace-open", t);
+
   wchar_t dir[MAX_PATH];
   if (self_dir(dir, MAX_PATH) != 0) {
     /* Cannot locate ourselves -> cannot find index.cjs -> universal fail-open. */
     return 0;
   }
+  t = trace_phase("self-locate", t);
 
-  /* node binary: prefer the frozen sidecar; else "node" resolved via PATH.
-   * CreateProcessW with a NULL application name + "node" as argv[0] searches
-   * PATH (and appends .exe), matching the POSIX execvp fallback. */
-  wchar_t node[MAX_PATH] = {0};
-  int have_node = (read_sidecar(dir, L"node.path", node, MAX_PATH) == 0 && file_exists(node));
+  /* node + blob + flags from the frozen manifest; without one, "node" is
+   * resolved via PATH: CreateProcessW with a NULL application name + "node"
+   * as argv[0] searches PATH (and appends .exe), matching the POSIX execvp
+   * fallback. */
+  static struct launch_manifest m, em;
+  static wchar_t node[WPATH_MAX], blob[WPATH_MAX], split_blob[WPATH_MAX];
+  int have_node =
+      read_manifest(dir, L"launch.manifest", &m) == 0 && utf8_to_wide(m.node, node, WPATH_MAX) == 0;
 
-  const wchar_t *event = (argc > 1) ? argv[1] : NULL;
+  /* Fast path: the frozen blob, still the exact file the manifest froze, or
+   * this event's split blob in its place. */
+  int have_blob =
+      have_node && utf8_to_wide(m.blob, blob, WPATH_MAX) == 0 && blob_matches(&m, blob);
+  int split_stale = 0;
+  const struct launch_manifest *boot =
+      have_blob ? select_boot(dir, event, &m, &em, split_blob, &split_stale) : &m;
+  const wchar_t *boot_blob = boot == &em ? split_blob : blob;
+  t = trace_phase(boot == &em ? "manifest-split" : "manifest", t);
+  if (have_node && (!have_blob || split_stale)) {
+    heal_spawn(dir, &m, node);
+    t = trace_phase("heal", t);
+  }
+  if (have_node && !have_blob) access_note(m.blob, 'M');
 
-  wchar_t cmd[MAX_PATH * 6];
+  /* Tool pre-flight, then the warm daemon (opt-in: only when one is running
+   * for this dir). */
+  struct buf in = {0};
+  int drained = 0;
+  if (have_blob) {
+    int skip = preflight_skip(dir, event, &in, &drained);
+    static const char *const phase[] = {"preflight", "preflight-skip",
+                                        "trigger-skip"};
+    t = trace_phase(phase[skip], t);
+    if (skip) {
+      access_note(m.blob, 'P');
+      return 0;
+    }
+  }
+  int served = try_daemon(dir, event, &in, drained);
+  t = trace_phase(served >= 0                   ? "daemon"
+                  : served == DAEMON_TRUNCATED ? "daemon-truncated"
+                                               : "daemon-miss",
+                  t);
+  if (served >= 0) {
+    if (have_node) access_note(m.blob, 'D');
+    return served;
+  }
+  /* A tuned boot may have to run twice, so it needs the whole payload in
+   * hand to replay. */
+  int tuned = have_blob && boot->tuned_flags > 0;
+  if (tuned && !drained && !in.len) read_all_stdin(&in);
+  /* Stdin the attempts already drained is fed to the child instead. */
+  const struct buf *replay = in.len ? &in : NULL;
+
+  static wchar_t cmd[CMD_MAX];
 
-  /* Fast path: a frozen blob that still exists. */
-  wchar_t blob[MAX_PATH];
-  if (read_sidecar(dir, L"snapshot-blob.path", blob, MAX_PATH) == 0 && file_exists(blob)) {
+  if (have_blob) {
     cmd[0] = L'\0';
-    append_arg(cmd, MAX_PATH * 6, have_node ? node : L"node");
-    append_arg(cmd, MAX_PATH * 6, L"--snapshot-blob");
-    append_arg(cmd, MAX_PATH * 6, blob);
-    if (event) append_arg(cmd, MAX_PATH * 6, event);
-    int rc = run_and_wait(have_node ? node : NULL, cmd);
-    if (rc >= 0) return rc;
-    /* CreateProcess failed -> fall through to fail-open. */
+    append_arg(cmd, CMD_MAX, node);
+    int nflags = 0;
+    for (const char *f = boot->flags; *f && nflags < MAX_NODE_FLAGS; f += strlen(f) + 1, ++nflags) {
+      wchar_t wflag[944];
+      if (utf8_to_wide(f, wflag, 944) == 0) append_arg(cmd, CMD_MAX, wflag);
+    }
+    append_arg(cmd, CMD_MAX, L"--snapshot-blob");
+    append_arg(cmd, CMD_MAX, boot_blob);
+    if (event) append_arg(cmd, CMD_MAX, event);
+    /* A blob from the shared store may have been built in another checkout;
+     * its runtime requires resolve from this one (bundle-dir.mts). */
+    SetEnvironmentVariableW(L"FLEET_DISPATCH_DIR", dir);
+    access_note(boot->blob, boot == &em ? 'S' : 'H');
+    trace_handoff(0);
+    int rc = run_and_wait(node, cmd, replay);
+    if (rc >= 0 && !(tuned && rc == NODE_BAD_OPTION)) {
+      trace_phase("child", t);
+      return rc;
+    }
+    /* CreateProcess failed, or node rejected a tuned flag before any hook
+     * ran -> fall through to fail-open, which reruns the event untuned. */
+    if (rc >= 0) {
+      t = trace_phase("flags-rejected", t);
+      trace_handoff(1);
+    }
   }
 
-  /* Fail-open: node <dispatch_dir>\index.cjs <Event>. */
+  /* Fail-open: node <dispatch_dir>\index.cjs <Event>, with the frozen node
+   * and then whatever node PATH resolves. */
   wchar_t index[MAX_PATH];
   _snwprintf_s(index, MAX_PATH, _TRUNCATE, L"%s\\..\\index.cjs", dir);
-  cmd[0] = L'\0';
-  append_arg(cmd, MAX_PATH * 6, have_node ? node : L"node");
-  append_arg(cmd, MAX_PATH * 6, index);
-  if (event) append_arg(cmd, MAX_PATH * 6, event);
-  int rc = run_and_wait(have_node ? node : NULL, cmd);
-  if (rc >= 0) return rc;
+  for (int pass = have_node ? 0 : 1; pass < 2; ++pass) {
+    cmd[0] = L'\0';
+    append_arg(cmd, CMD_MAX, pass == 0 ? node : L"node");
+    append_arg(cmd, CMD_MAX, index);
+    if (event) append_arg(cmd, CMD_MAX, event);
+    trace_handoff(0);
+    int rc = run_and_wait(pass == 0 ? node : NULL, cmd, replay);
+    if (rc >= 0) {
+      trace_phase("child", t);
+      return rc;
+    }
+  }
 
   /* Even index.cjs could not be launched -> allow (exit 0). */
   return 0;
 }
+
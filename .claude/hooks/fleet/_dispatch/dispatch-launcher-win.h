@@ -0,0 +1,91 @@
+/*
+ * Shared declarations for the Windows native launcher's units (the contract
+ * and the launch flow are documented in dispatch-launcher-win.c):
+ *
+ *   dispatch-launcher-win.c           wmain: locate, pre-flight, run + wait
+ *   dispatch-launcher-win-manifest.c  launch.manifest + per-event blob choice
+ *   dispatch-launcher-win-daemon.c    warm-daemon client (named pipes)
+ *   dispatch-launcher-win-store.c     self-heal, access log
+ *   dispatch-launcher-win-trace.c     opt-in phase-trace ring
+ *   dispatch-launcher-preflight.c     hook-tools.map scan (shared with POSIX)
+ */
+
+#ifndef DISPATCH_LAUNCHER_WIN_H
+#define DISPATCH_LAUNCHER_WIN_H
+
+#define WIN32_LEAN_AND_MEAN
+#ifndef _WIN32_WINNT
+#define _WIN32_WINNT 0x0600 /* GetNamedPipeServerProcessId, CancelIoEx */
+#endif
+#include <windows.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wchar.h>
+
+/* launch.manifest, byte for byte (little-endian, like every Windows target).
+ * Mirrors scripts/fleet/_shared/launch-manifest.mts. */
+#define LAUNCH_MANIFEST_SIZE 4096
+#define LAUNCH_MANIFEST_MAGIC "FLTLM\0\0\1"
+#define MAX_NODE_FLAGS 32
+/* Wide path buffers: the manifest's 1536-byte UTF-8 fields never need more
+ * UTF-16 units than bytes. */
+#define WPATH_MAX 1536
+#define CMD_MAX 32767 /* CreateProcessW's command-line ceiling */
+
+struct launch_manifest {
+  char magic[8];
+  uint32_t size;
+  uint32_t tuned_flags; /* flags from the tuned profile; 0 = none */
+  uint64_t blob_size;
+  int64_t blob_mtime_ns;
+  uint64_t blob_ino; /* POSIX only; unchecked here */
+  char bundle_hash[40];
+  char node[1536];
+  char blob[1536];
+  char flags[944]; /* NUL-terminated flags; an empty one ends the list */
+};
+
+/* Layout check without C11 (MSVC's default C mode lacks _Static_assert). */
+typedef char launch_manifest_layout[sizeof(struct launch_manifest) == LAUNCH_MANIFEST_SIZE ? 1 : -1];
+
+/* dispatch-launcher-win-manifest.c */
+int read_sidecar(const wchar_t *dir, const wchar_t *name, wchar_t *out, DWORD cap);
+int read_manifest(const wchar_t *dir, const wchar_t *name, struct launch_manifest *m);
+int utf8_to_wide(const char *s, wchar_t *out, int cap);
+int blob_matches(const struct launch_manifest *m, const wchar_t *blob);
+const struct launch_manifest *select_boot(const wchar_t *dir, const wchar_t *event,
+                                          const struct launch_manifest *m,
+                                          struct launch_manifest *em,
+                                          wchar_t *split_blob, int *split_stale);
+
+/* dispatch-launcher-win-store.c */
+void heal_spawn(const wchar_t *dir, const struct launch_manifest *m,
+                const wchar_t *node);
+void access_note(const char *blob, char kind);
+
+/* dispatch-launcher-win-trace.c */
+uint64_t trace_now(void);
+void trace_open(const wchar_t *event);
+uint64_t trace_phase(const char *phase, uint64_t start_ns);
+void trace_handoff(int to_daemon);
+
+/* dispatch-launcher-win-daemon.c */
+/* try_daemon: acked, but the reply ended early. */
+#define DAEMON_TRUNCATED (-2)
+
+/* Growable byte buffer for the request frame + the drained stdin. */
+struct buf {
+  char *p;
+  size_t len, cap;
+};
+
+int read_all_stdin(struct buf *in);
+int try_daemon(const wchar_t *dir, const wchar_t *event, struct buf *in,
+               int drained);
+
+/* dispatch-launcher-win.c */
+void append_arg(wchar_t *cmd, size_t cap, const wchar_t *arg);
+
+#endif
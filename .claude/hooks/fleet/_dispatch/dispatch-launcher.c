@@ -10,34 +10,94 @@
  * just to spawnSync a SECOND node. That parent-node startup is the ~13-16ms the
  * loader pays and this binary removes.
  *
- *   if  <dispatch_dir>/snapshot-blob.path exists AND the blob it names exists:
- *       execv node --snapshot-blob <blob> <Event>      (the fast path)
+ *   if  <dispatch_dir>/launch.manifest names a blob that is still the one it
+ *       froze (same size, mtime and inode):
+ *       execv node <flags> --snapshot-blob <blob> <Event>   (the fast path)
+ *       -- with launch.<Event>.manifest's smaller per-event blob instead,
+ *          when the build split them (--split-events) and it is intact too
  *   else:
  *       execv node <dispatch_dir>/index.cjs <Event>     (fail-open, always correct)
  *
- * Path resolution is BUILD-TIME-FROZEN into two sidecars written next to this
- * binary by the build step (the same model the snapshot entry uses for
- * DISPATCH_DIR_FROZEN): node.path (abs path to the node binary) and
- * snapshot-blob.path (abs path to the current blob for this runtime+bundle).
- * Reading a frozen line beats re-deriving the node-ver x arch x v8tag x uid x
- * content-hash blob key in C, and keeps the launcher ~null-cost: two small
- * reads + an execv. A missing/blank sidecar or a vanished blob falls open.
+ * Path resolution is BUILD-TIME-FROZEN into launch.manifest, a fixed-layout
+ * binary record written next to this binary by the build step (the same model
+ * the snapshot entry uses for DISPATCH_DIR_FROZEN; layout in
+ * scripts/fleet/_shared/launch-manifest.mts): the node binary, the current
+ * blob for this runtime+bundle with its size / mtime / inode, the bundle hash,
+ * and the node flags the blob was built under. One open + fixed-size read +
+ * the blob stat, then an execv: no line parsing, and a blob swapped or
+ * truncated underneath the manifest is caught here instead of by node
+ * refusing to boot it. A missing/torn manifest or a changed blob falls open.
+ *
+ * TUNED FLAGS: when the blob was built under the benchmark-tuned flag
+ * profile (node-flag-profile.json), the manifest counts those flags and the
+ * launcher boots it as a child it waits on instead of exec'ing it. A node
+ * replaced under the frozen path since the build may reject one of them;
+ * it exits 9 (bad option) before reading stdin or running a hook, and the
+ * launcher reruns the event through index.cjs with the payload replayed.
+ * An untuned manifest keeps the single execv.
  *
  * Fail-open is total: any error anywhere lands on index.cjs, which is correct
  * on every platform/version. The blob is a pure startup optimization; its
  * absence is never an error.
+ *
+ * WARM DAEMON (opt-in, dispatch-daemon.mts): ahead of the execv, a third
+ * sidecar daemon.path ("<bundle-hash> <slots> <socket-base>") names the Unix
+ * sockets a running warm daemon's parked workers listen on, one per slot
+ * (<socket-base>.<n>.sock). At the first slot that exists, belongs to our uid
+ * and accepts, the launcher ships the event + cwd + environ + stdin in one
+ * frame and relays the worker's stdout / stderr / exit code verbatim — no
+ * node boot on the hook's critical path. No live slot, a stale ('S') answer,
+ * no ack inside DAEMON_ACK_MS, or a reply cut short after the ack all fall
+ * through to the execv path above, with the stdin already read replayed into
+ * the exec'd node, so the daemon can only ever make a hook faster, never
+ * different.
+ *
+ * TOOL PRE-FLIGHT (ahead of both): a fourth sidecar hook-tools.map, frozen
+ * from the same (event, tool) index dispatch()'s DISPATCH_INDEX is generated
+ * from, lists per event the tool names some hook handles ("*" when an any-tool hook exists).
+ * When the map says no hook can fire for this event + the payload's
+ * top-level tool_name — the common Read / Glob / Grep case — the launcher
+ * exits 0 without booting node, which is byte for byte what the dispatcher
+ * renders for "no hook matched". Only trusted while the frozen blob exists
+ * (the map and the blob come from the same build; the index.cjs fallback may
+ * carry a newer table). Anything it can't read with certainty — an escaped
+ * key, a non-string tool_name, a non-object payload — dispatches as usual,
+ * with the scanned stdin replayed.
+ *
+ * TRIGGER RULES (same map): a "?<event> <tool>\t<trigger>\t…" line says every
+ * hook for that tool declared `triggers` and can only fire when one of them
+ * occurs in the raw payload, the same substring test the dep-0 dispatcher
+ * applies. A handled tool whose payload holds none of them exits 0 as well;
+ * a payload with a \u or \/ escape (which could spell a trigger) dispatches.
+ *
+ * SELF-HEAL + PREWARM: a manifest whose blob has vanished (a node_modules
+ * rebuild, an image without the bake step) spawns one detached, lock-guarded
+ * `setup/hook-snapshot.mts --heal` before falling open, so later events get
+ * the fast path back unattended; on a hit, the blob gets a read-ahead hint
+ * (posix_fadvise WILLNEED / F_RDADVISE) just before the execv, so a cold page
+ * cache after a reboot overlaps node's startup instead of stalling the
+ * deserialize.
+ *
+ * ACCESS LOG: each launch with a manifest appends one 128-byte record (hit,
+ * split hit, pre-flight, daemon or miss) to access.log in the blob store
+ * root, which the builder's LRU sweep and scripts/fleet/snapshot-store.mts
+ * read (layout in scripts/fleet/_shared/snapshot-store.mts).
+ *
+ * PHASE TRACE (opt-in, FLEET_DISPATCH_TRACE=<absolute ring file>): each
+ * launcher phase above stamps a monotonic-clock record into a shared mmap'd
+ * ring that node then appends its own phases to (dispatch-trace.mts);
+ * scripts/fleet/dispatch-trace-report.mts prints the percentiles. Unset, it
+ * costs one getenv.
+ *
+ * SOURCES: this file holds main; the manifest, daemon client, store
+ * (heal / prewarm / access log), trace ring and pre-flight scan are
+ * separate units sharing dispatch-launcher.h, which lists them; the build
+ * (POSIX_SRCS in scripts/fleet/build-snapshot-launcher.mts) compiles them
+ * into one binary.
  */
 
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include <unistd.h>
-#include <limits.h>
-#include <sys/stat.h>
-
-#if defined(__APPLE__)
-#include <mach-o/dyld.h>
-#endif
+#include "dispatch-launcher.h"
+#include "dispatch-launcher-preflight.h"
 
 /* Absolute path to this executable, so the sidecars + index.cjs resolve
  * relative to the launcher's own location (it lives in _dispatch/). */
@@ -52,11 +112,17 @@ static int self_dir(char *out, size_t cap) {
   buf[n] = '\0';
 #endif
   char real[PATH_MAX];
+#if defined(__linux__)
+  /* /proc/self/exe is already the kernel's resolved path: skip realpath's
+   * per-component lstat walk. */
+  memcpy(real, buf, (size_t)n + 1);
+#else
   if (!realpath(buf, real)) {
     /* realpath can fail (e.g. dangling); fall back to the raw path. */
     strncpy(real, buf, sizeof(real) - 1);
     real[sizeof(real) - 1] = '\0';
   }
+#endif
   char *slash = strrchr(real, '/');
   if (!slash) return -1;
   *slash = '\0';
@@ -65,66 +131,209 @@ static int self_dir(char *out, size_t cap) {
   return 0;
 }
 
-/* Read the first line of <dir>/<name> into out (trimmed of trailing \n).
- * Returns 0 on a non-empty line, -1 otherwise. */
-static int read_sidecar(const char *dir, const char *name, char *out, size_t cap) {
+/* The tool pre-flight. Returns 1 when no hook can fire for this event +
+ * payload, 2 when the tool's trigger rule rules out every hook for it (the
+ * caller exits 0 on either), else 0. Sets *drained once stdin has been
+ * read into `in`, which the caller then replays. */
+static int preflight_skip(const char *dir, const char *event, struct buf *in,
+                          int *drained) {
   char path[PATH_MAX];
-  if ((size_t)snprintf(path, sizeof(path), "%s/%s", dir, name) >= sizeof(path)) return -1;
-  FILE *f = fopen(path, "r");
-  if (!f) return -1;
-  if (!fgets(out, (int)cap, f)) { fclose(f); return -1; }
-  fclose(f);
-  size_t len = strlen(out);
-  while (len && (out[len - 1] == '\n' || out[len - 1] == '\r' || out[len - 1] == ' '))
-    out[--len] = '\0';
-  return len ? 0 : -1;
+  if (!event ||
+      (size_t)snprintf(path, sizeof(path), "%s/hook-tools.map", dir) >= sizeof(path))
+    return 0;
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return 0;
+  static char map[HOOK_TOOLS_MAX];
+  size_t n = 0;
+  for (;;) {
+    ssize_t r = read(fd, map + n, sizeof(map) - n);
+    if (r < 0 && errno == EINTR) continue;
+    if (r <= 0) break;
+    n += (size_t)r;
+    if (n == sizeof(map)) break;
+  }
+  close(fd);
+  if (!tools_map_whole(map, n)) return 0;
+  const char *list;
+  size_t len;
+  if (!map_lookup(map, n, event, &list, &len)) return 1;
+  if (len == 1 && list[0] == '*') return 0;
+  *drained = 1;
+  if (read_all_fd(0, in) != 0) return 0;
+  return preflight_verdict(map, n, event, list, len, in->p, in->len);
+}
+
+/* Re-seat fd 0 on an in-memory copy of the stdin the daemon attempt drained,
+ * so the exec'd node reads exactly the payload Claude sent. */
+static void replay_stdin(const struct buf *in) {
+  int fd = -1;
+#if defined(__linux__) && defined(MFD_CLOEXEC)
+  fd = memfd_create("fleet-dispatch-stdin", 0);
+#endif
+  if (fd < 0) {
+    char tmpl[PATH_MAX];
+    const char *tmp = getenv("TMPDIR");
+    snprintf(tmpl, sizeof(tmpl), "%s/fleet-dispatch-stdin-XXXXXX",
+             (tmp && *tmp) ? tmp : "/tmp");
+    fd = mkstemp(tmpl);
+    if (fd < 0) return;
+    unlink(tmpl);
+  }
+  for (size_t off = 0; off < in->len;) {
+    ssize_t w = write(fd, in->p + off, in->len - off);
+    if (w < 0 && errno == EINTR) continue;
+    if (w <= 0) {
+      close(fd);
+      return;
+    }
+    off += (size_t)w;
+  }
+  if (lseek(fd, 0, SEEK_SET) == 0) dup2(fd, 0);
+  close(fd);
 }
 
-static int file_exists(const char *p) {
-  struct stat st;
-  return stat(p, &st) == 0;
+/* Node's exit code for an option it rejects ("bad option"), before it reads
+ * stdin or runs a hook. */
+#define NODE_BAD_OPTION 9
+
+/* Boot a blob built under the tuned flag profile as a waited-on child
+ * instead of exec'ing it: a node swapped in under the frozen path may reject
+ * one of the profile's flags, which an execv could never recover from. The
+ * child's exit code (128 + signo for a signal), or -1 when it couldn't be
+ * started; the caller reruns NODE_BAD_OPTION untuned. */
+static int run_tuned(const char *node, char *const *args) {
+  pid_t pid;
+  if (posix_spawn(&pid, node, NULL, NULL, args, environ) != 0) return -1;
+  int status;
+  while (waitpid(pid, &status, 0) < 0) {
+    if (errno != EINTR) return -1;
+  }
+  if (WIFSIGNALED(status)) return 128 + WTERMSIG(status);
+  return WIFEXITED(status) ? WEXITSTATUS(status) : 0;
 }
 
 int main(int argc, char **argv) {
+  /* The event arg Claude passes (PreToolUse/PostToolUse/Stop/...). May be absent. */
+  const char *event = (argc > 1) ? argv[1] : NULL;
+
+  uint64_t t = trace_now();
+  trace_open(event);
+  t = trace_phase("trace-open", t);
+
   char dir[PATH_MAX];
   if (self_dir(dir, sizeof(dir)) != 0) {
     /* Cannot locate ourselves -> cannot find index.cjs either; exit 0 (the
      * dispatcher's universal fail-open is "allow"). */
     return 0;
   }
+  t = trace_phase("self-locate", t);
 
-  /* node binary: prefer the frozen sidecar; else fall back to PATH via execvp. */
-  char node[PATH_MAX] = {0};
-  int have_node = (read_sidecar(dir, "node.path", node, sizeof(node)) == 0 && file_exists(node));
+  /* node + blob + flags from the frozen manifest; without one, node comes
+   * from PATH via execvp and there is no fast path. */
+  static struct launch_manifest m, em;
+  int have_node = read_manifest(dir, "launch.manifest", &m) == 0;
+  char *node = have_node ? m.node : (char *)"node";
 
-  /* The event arg Claude passes (PreToolUse/PostToolUse/Stop/...). May be absent. */
-  const char *event = (argc > 1) ? argv[1] : NULL;
+  /* The fast path: the frozen blob, still the exact file the manifest froze,
+   * or this event's split blob in its place. */
+  int have_blob = have_node && blob_matches(&m);
+  int split_stale = 0;
+  const struct launch_manifest *boot =
+      have_blob ? select_boot(dir, event, &m, &em, &split_stale) : &m;
+  t = trace_phase(boot == &em ? "manifest-split" : "manifest", t);
+  if (have_node && (!have_blob || split_stale)) {
+    heal_spawn(dir, &m);
+    t = trace_phase("heal", t);
+  }
+  if (have_node && !have_blob) access_note(m.blob, 'M');
+
+  /* Tool pre-flight, then the warm daemon (opt-in: only when one is running
+   * for this dir). */
+  struct buf in = {0};
+  int drained = 0;
+  if (have_blob) {
+    int skip = preflight_skip(dir, event, &in, &drained);
+    static const char *const phase[] = {"preflight", "preflight-skip",
+                                        "trigger-skip"};
+    t = trace_phase(phase[skip], t);
+    if (skip) {
+      access_note(m.blob, 'P');
+      return 0;
+    }
+  }
+  int served = try_daemon(dir, event, &in, drained);
+  t = trace_phase(served >= 0                   ? "daemon"
+                  : served == DAEMON_TRUNCATED ? "daemon-truncated"
+                                               : "daemon-miss",
+                  t);
+  if (served >= 0) {
+    if (have_node) access_note(m.blob, 'D');
+    return served;
+  }
+  /* A tuned boot may have to run twice, so it needs the whole payload in
+   * hand to replay. */
+  int tuned = have_blob && boot->tuned_flags > 0;
+  if (tuned && !drained && !in.len) read_all_fd(0, &in);
+  if (in.len) {
+    replay_stdin(&in);
+    t = trace_phase("replay", t);
+  }
 
-  /* Try the fast path: a frozen blob path that still exists on disk. */
-  char blob[PATH_MAX];
-  if (read_sidecar(dir, "snapshot-blob.path", blob, sizeof(blob)) == 0 && file_exists(blob)) {
-    char *args[6];
+  if (have_blob) {
+    char *args[MAX_NODE_FLAGS + 5];
     int i = 0;
-    args[i++] = have_node ? node : (char *)"node";
+    args[i++] = node;
+    for (const char *f = boot->flags; *f && i < MAX_NODE_FLAGS + 1; f += strlen(f) + 1)
+      args[i++] = (char *)f;
     args[i++] = (char *)"--snapshot-blob";
-    args[i++] = blob;
+    args[i++] = (char *)boot->blob;
     if (event) args[i++] = (char *)event;
     args[i] = NULL;
-    if (have_node) execv(node, args); else execvp("node", args);
-    /* execv only returns on failure -> fall through to fail-open. */
+    /* A blob from the shared store may have been built in another checkout;
+     * its runtime requires resolve from this one (bundle-dir.mts). */
+    setenv("FLEET_DISPATCH_DIR", dir, 1);
+    blob_prewarm(boot);
+    access_note(boot->blob, boot == &em ? 'S' : 'H');
+    t = trace_phase("prewarm", t);
+    if (tuned) {
+      /* The child may have written into its trace range; a rerun gets a
+       * fresh one. */
+      trace_handoff(1);
+      int rc = run_tuned(node, args);
+      if (rc >= 0 && rc != NODE_BAD_OPTION) {
+        trace_phase("child", t);
+        return rc;
+      }
+      if (rc == NODE_BAD_OPTION) {
+        /* Rejected before a hook ran: rerun untuned through index.cjs. */
+        trace_phase("flags-rejected", t);
+        if (in.len) replay_stdin(&in);
+      }
+    } else {
+      trace_handoff(0);
+      execv(node, args);
+    }
+    /* Only a failed start or a rejected flag gets here -> fail-open. */
   }
+  free(in.p);
 
   /* Fail-open: node <dispatch_dir>/index.cjs <Event>. */
   char index[PATH_MAX];
   snprintf(index, sizeof(index), "%s/../index.cjs", dir);
   char *fargs[4];
   int j = 0;
-  fargs[j++] = have_node ? node : (char *)"node";
+  fargs[j++] = node;
   fargs[j++] = index;
   if (event) fargs[j++] = (char *)event;
   fargs[j] = NULL;
-  if (have_node) execv(node, fargs); else execvp("node", fargs);
+  trace_handoff(0);
+  if (have_node) execv(node, fargs);
+  /* No manifest, or its node is gone: whatever node PATH resolves. */
+  fargs[0] = (char *)"node";
+  trace_handoff(0);
+  execvp("node", fargs);
 
   /* Even index.cjs exec failed -> allow (exit 0, the universal fail-open). */
   return 0;
 }
+
@@ -0,0 +1,99 @@
+/*
+ * Shared declarations for the POSIX native launcher's units (the contract
+ * and the launch flow are documented in dispatch-launcher.c):
+ *
+ *   dispatch-launcher.c           main: locate, pre-flight, exec / wait
+ *   dispatch-launcher-manifest.c  launch.manifest + per-event blob choice
+ *   dispatch-launcher-daemon.c    warm-daemon client (Unix sockets)
+ *   dispatch-launcher-store.c     self-heal, blob prewarm, access log
+ *   dispatch-launcher-trace.c     opt-in phase-trace ring
+ *   dispatch-launcher-preflight.c hook-tools.map scan (shared with Windows)
+ */
+
+#ifndef DISPATCH_LAUNCHER_H
+#define DISPATCH_LAUNCHER_H
+
+#if defined(__linux__)
+#define _GNU_SOURCE /* memfd_create */
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <limits.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <spawn.h>
+
+#if defined(__APPLE__)
+#include <mach-o/dyld.h>
+#endif
+
+/* launch.manifest, byte for byte (little-endian, like every target this
+ * builds for). Mirrors scripts/fleet/_shared/launch-manifest.mts. */
+#define LAUNCH_MANIFEST_SIZE 4096
+#define LAUNCH_MANIFEST_MAGIC "FLTLM\0\0\1"
+#define MAX_NODE_FLAGS 32
+
+struct launch_manifest {
+  char magic[8];
+  uint32_t size;
+  uint32_t tuned_flags; /* flags from the tuned profile; 0 = none */
+  uint64_t blob_size;
+  int64_t blob_mtime_ns;
+  uint64_t blob_ino;
+  char bundle_hash[40];
+  char node[1536];
+  char blob[1536];
+  char flags[944]; /* NUL-terminated flags; an empty one ends the list */
+};
+
+_Static_assert(sizeof(struct launch_manifest) == LAUNCH_MANIFEST_SIZE,
+               "launch.manifest layout");
+
+/* dispatch-launcher-manifest.c */
+int read_sidecar(const char *dir, const char *name, char *out, size_t cap);
+int read_manifest(const char *dir, const char *name, struct launch_manifest *m);
+int blob_matches(const struct launch_manifest *m);
+const struct launch_manifest *select_boot(const char *dir, const char *event,
+                                          const struct launch_manifest *m,
+                                          struct launch_manifest *em,
+                                          int *split_stale);
+
+/* dispatch-launcher-store.c */
+void heal_spawn(const char *dir, const struct launch_manifest *m);
+void access_note(const char *blob, char kind);
+void blob_prewarm(const struct launch_manifest *m);
+
+/* dispatch-launcher-trace.c */
+uint64_t trace_now(void);
+void trace_open(const char *event);
+uint64_t trace_phase(const char *phase, uint64_t start_ns);
+void trace_handoff(int to_daemon);
+
+/* dispatch-launcher-daemon.c */
+/* try_daemon: acked, but the reply ended early. */
+#define DAEMON_TRUNCATED (-2)
+
+extern char **environ;
+
+/* Growable byte buffer for the request frame + the drained stdin. */
+struct buf {
+  char *p;
+  size_t len, cap;
+};
+
+int read_all_fd(int fd, struct buf *b);
+int try_daemon(const char *dir, const char *event, struct buf *in, int drained);
+
+#endif
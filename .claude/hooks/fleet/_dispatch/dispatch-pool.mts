@@ -0,0 +1,323 @@
+/**
+ * @file The worker pool `dispatch()` runs one event's hooks through, and the
+ *   latency budget that lets it stop waiting for the advisory ones.
+ *
+ *   Hooks START in table order (under a budget: the block-capable ones, then
+ *   the advisory ones) and the pool reports every outcome by table index, so
+ *   the caller assembles the result in table order whatever the concurrency.
+ *   A block stops any hook past it from starting, and the pool finishes as
+ *   soon as every hook before the lowest block has settled.
+ *
+ *   Every hook's outcome is fail-open (`runEntry`): a throw is a silent
+ *   allow, never a wedged dispatcher.
+ */
+
+import process from 'node:process'
+
+import { analyzePayload } from '../_shared/payload-analysis.mts'
+import { invalidateProcessScope } from '../_shared/process-scheduler.mts'
+
+import {
+  OVERRUN_SUFFIX,
+  profileEnabled,
+  profileHook,
+} from './dispatch-profile.mts'
+import { traceEnabled, traceNow, tracePhase } from './dispatch-trace.mts'
+import { VERDICT_MISS } from './verdict-cache.mts'
+import type { VerdictMemo } from './verdict-cache.mts'
+
+import type {
+  DispatchHookEntry,
+  DispatchPayload,
+  DispatchVerdict,
+} from './dispatch-types.mts'
+
+/**
+ * Opt-in concurrent dispatch: `FLEET_DISPATCH_CONCURRENCY=<n>` lets up to `n`
+ * hooks of one event be in flight at once. Unset (or 1) is the strict
+ * sequential loop.
+ */
+export const CONCURRENCY_ENV = 'FLEET_DISPATCH_CONCURRENCY'
+// Past this a pool only adds contention: the heaviest event has ~90 hooks and
+// the I/O they wait on (git, the SDK, transcript reads) doesn't parallelize
+// much further.
+const MAX_CONCURRENCY = 16
+
+/**
+ * Opt-in per-event latency budget: `FLEET_DISPATCH_BUDGET_MS=<ms>` lets
+ * `dispatch()` drop advisory hooks that would run past it. Unset means there
+ * is no budget.
+ */
+export const BUDGET_ENV = 'FLEET_DISPATCH_BUDGET_MS'
+
+export interface HookPoolOptions {
+  /**
+   * Per-event latency budget in ms, counted from the start of the pool.
+   * Block-capable hooks start first and are always awaited. Past the
+   * deadline no advisory hook starts or is waited for; one still pending
+   * when the result is assembled is dropped from it and profiled with
+   * OVERRUN_SUFFIX. Omitted or <= 0 means no budget.
+   */
+  readonly budgetMs?: number | undefined
+  /**
+   * Max hooks in flight at once (default 1 = sequential). Hooks still START in
+   * table order and the result is assembled in table order, so `reminders`
+   * and the first-block-wins verdict match the sequential loop exactly; what
+   * changes is that an I/O-bound `check` no longer waits for the previous
+   * one's I/O to finish.
+   */
+  readonly concurrency?: number | undefined
+  /**
+   * Called with each hook's wall time as it settles (batch mode's per-record
+   * timings). Dropped and block-skipped hooks aren't reported.
+   */
+  readonly onHookTimed?:
+    | ((name: string, startNs: bigint, endNs: bigint) => void)
+    | undefined
+  /**
+   * Replay / record pure hooks' verdicts (verdict-cache.mts). The runners
+   * pass one per event; without it every hook runs.
+   */
+  readonly verdicts?: VerdictMemo | undefined
+}
+
+/**
+ * What the pool leaves for the caller to assemble: each hook's verdict by
+ * table index (a hole for one that was skipped, dropped or allowed), and the
+ * lowest index that blocked (`entries.length` when none did).
+ */
+export interface HookPoolResult {
+  readonly outcomes: readonly DispatchVerdict[]
+  readonly stop: number
+}
+
+/**
+ * The `concurrency` the runners pass `dispatch()`, from CONCURRENCY_ENV
+ * (clamped to 1..MAX_CONCURRENCY; anything unparseable is 1).
+ */
+export function dispatchConcurrency(
+  value: string | undefined = process.env[CONCURRENCY_ENV],
+): number {
+  const n = Number.parseInt(value ?? '', 10)
+  return n > 1 ? Math.min(n, MAX_CONCURRENCY) : 1
+}
+
+/**
+ * The `budgetMs` the runners pass `dispatch()`, from BUDGET_ENV; undefined
+ * when it's unset or not a positive number.
+ */
+export function dispatchBudgetMs(
+  value: string | undefined = process.env[BUDGET_ENV],
+): number | undefined {
+  const n = Number(value)
+  return value && n > 0 && Number.isFinite(n) ? n : undefined
+}
+
+/**
+ * One hook's outcome, never a throw: a misbehaving bundled hook must never
+ * wedge the whole dispatcher. A pure hook's verdict comes from `memo` when it
+ * has one for this payload, and lands there otherwise (a throw is never
+ * recorded).
+ */
+async function runEntry(
+  entry: DispatchHookEntry,
+  payload: DispatchPayload,
+  memo?: VerdictMemo | undefined,
+): Promise<DispatchVerdict> {
+  const cached = entry.pure && memo ? memo.get(entry.name) : VERDICT_MISS
+  if (cached !== VERDICT_MISS) {
+    return cached
+  }
+  let verdict: DispatchVerdict
+  try {
+    const analysis = analyzePayload(payload)
+    if (entry.check) {
+      verdict = await entry.check(payload, analysis)
+    } else if (entry.run) {
+      const text = entry.run(payload, analysis)
+      verdict = text
+        ? ({ __proto__: null, kind: 'notify', message: text } as DispatchVerdict)
+        : undefined
+    }
+  } catch {
+    return undefined
+  }
+  if (entry.pure && memo) {
+    memo.set(entry.name, verdict)
+  }
+  return verdict
+}
+
+/**
+ * Run `entries` (one event's hooks, in table order) against `payload`.
+ *
+ * With `budgetMs` and at least one advisory hook, hooks start in two passes:
+ * the block-capable ones first, then the advisory ones. An advisory hook is
+ * never started past the deadline. Once the deadline passes, an unsettled
+ * advisory hook no longer holds up the result, but one that has settled by
+ * the time the result is assembled is still in it. A sync `check` can't be
+ * preempted, so the deadline is only as sharp as the slowest sync advisory
+ * hook that started before it.
+ *
+ * A `stateful` hook is a start barrier: no hook after it starts until it
+ * settles, and then the process scope's settled probes are dropped
+ * (`invalidateProcessScope`). It may have committed or written the very files
+ * a later hook's `git status` reports on, so under any concurrency the hooks
+ * after it see the tree it left.
+ */
+export async function runHookPool(
+  entries: readonly DispatchHookEntry[],
+  payload: DispatchPayload,
+  options?: HookPoolOptions | undefined,
+): Promise<HookPoolResult> {
+  const opts = { __proto__: null, ...options } as HookPoolOptions
+  const { length } = entries
+  const tracing = traceEnabled()
+  const profiling = profileEnabled()
+  const onHookTimed = opts.onHookTimed
+  const timing = tracing || profiling || !!onHookTimed
+  const outcomes: DispatchVerdict[] = new Array(length)
+  const settled: boolean[] = new Array(length).fill(false)
+  const budgetMs = opts.budgetMs ?? 0
+  const budgeted = budgetMs > 0 && entries.some(e => e.advisory)
+  // Start order: table order, or the block-capable hooks then the advisory
+  // ones under a budget.
+  const order: number[] = []
+  for (let i = 0; i < length; i += 1) {
+    if (!budgeted || !entries[i]!.advisory) {
+      order.push(i)
+    }
+  }
+  if (budgeted) {
+    for (let i = 0; i < length; i += 1) {
+      if (entries[i]!.advisory) {
+        order.push(i)
+      }
+    }
+  }
+  const startedAt: bigint[] = budgeted && profiling ? new Array(length) : []
+  const deadline = budgeted
+    ? traceNow() + BigInt(Math.round(budgetMs * 1e6))
+    : 0n
+  // Past the deadline: unsettled advisory hooks stop counting.
+  let expired = false
+  // Lowest table index known to block; nothing at or past it starts.
+  let stop = length
+  // Every hook before `frontier` has settled.
+  let frontier = 0
+  let next = 0
+  let closed = false
+  // The result is being assembled: a hook settling now has nowhere to go.
+  let assembled = false
+  // The last stateful hook started: nothing after it starts until it settles.
+  let barrier: Promise<void> | undefined
+  let finish: () => void = () => {}
+  const done = new Promise<void>(resolve => {
+    finish = resolve
+  })
+  const advance = () => {
+    while (
+      frontier < stop &&
+      (settled[frontier] || (expired && entries[frontier]!.advisory))
+    ) {
+      frontier += 1
+    }
+    if (frontier >= stop && !closed) {
+      closed = true
+      finish()
+    }
+  }
+  const worker = async () => {
+    while (!closed && next < length) {
+      const i = order[next]!
+      next += 1
+      if (i >= stop) {
+        continue
+      }
+      const entry = entries[i]!
+      if (budgeted && entry.advisory) {
+        if (!expired && traceNow() >= deadline) {
+          expired = true
+          advance()
+        }
+        if (expired) {
+          continue
+        }
+      }
+      if (barrier) {
+        await barrier
+        if (i >= stop) {
+          continue
+        }
+      }
+      const started = timing ? traceNow() : 0n
+      if (budgeted && profiling) {
+        startedAt[i] = started
+      }
+      const run = runEntry(entry, payload, opts.verdicts)
+      if (entry.stateful) {
+        barrier = run.then(() => invalidateProcessScope())
+      }
+      const outcome = await run
+      if (entry.stateful) {
+        await barrier
+      }
+      if (assembled || (closed && i > stop)) {
+        // Settled after the result went out, or past the winning block:
+        // ignored, and unrecorded (a dropped advisory hook is an overrun).
+        return
+      }
+      // Past the deadline but before assembly is still in time: its side
+      // effects have happened, so its verdict must not be thrown away.
+      if (timing) {
+        const ended = traceNow()
+        if (tracing) {
+          tracePhase(`hook:${entry.name}`, started, ended)
+        }
+        if (profiling) {
+          profileHook(entry.name, started, ended)
+        }
+        onHookTimed?.(entry.name, started, ended)
+      }
+      outcomes[i] = outcome
+      settled[i] = true
+      if (outcome?.kind === 'block' && i < stop) {
+        stop = i
+      }
+      advance()
+    }
+  }
+  advance()
+  const limit = Math.min(
+    Math.max(1, Math.floor(opts.concurrency ?? 1) || 1),
+    length || 1,
+  )
+  const timer = budgeted
+    ? setTimeout(() => {
+        expired = true
+        advance()
+      }, budgetMs)
+    : undefined
+  timer?.unref?.()
+  for (let w = 0; w < limit; w += 1) {
+    void worker()
+  }
+  await done
+  assembled = true
+  if (timer) {
+    clearTimeout(timer)
+  }
+  if (budgeted && profiling) {
+    const now = traceNow()
+    for (let i = 0, last = Math.min(stop, length); i < last; i += 1) {
+      if (!settled[i] && entries[i]!.advisory) {
+        profileHook(
+          `${entries[i]!.name}${OVERRUN_SUFFIX}`,
+          startedAt[i] ?? now,
+          now,
+        )
+      }
+    }
+  }
+  return { __proto__: null, outcomes, stop } as HookPoolResult
+}
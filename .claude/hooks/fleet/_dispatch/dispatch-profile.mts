@@ -0,0 +1,407 @@
+/**
+ * @file Always-on per-hook latency histograms for the dispatcher.
+ *
+ *   The phase trace (`dispatch-trace.mts`) answers "where did THIS event
+ *   spend its time" and is opt-in. This answers the standing question —
+ *   "which hook is eating the budget, and did one just regress" — cheaply
+ *   enough to leave on everywhere: `dispatch()` times every hook it runs (the
+ *   sync `run` or the awaited `check`, one `hrtime` pair each) and buffers
+ *   the bucketed samples; `dispatchRaw` appends them as ONE line to a
+ *   per-repo samples log as it returns. Once the log passes FOLD_AT bytes
+ *   the flushing process folds it into the histogram:
+ *
+ *     <repo>/node_modules/.cache/fleet/dispatch-profile/
+ *       samples.log     <event>\t<tool | "*">\t<hook>:<bucket> <hook>:<bucket>…
+ *       histogram.json  { "v": 1, "events": { <event>: { <tool>: { <hook>:
+ *                         counts } } } }
+ *
+ *   `counts[b]` is the number of samples in log2 bucket `b`: bucket 0 is
+ *   < 1 µs, bucket b ≥ 1 is [2^(b-1), 2^b) µs, the last bucket is open-ended
+ *   (trailing zero buckets are trimmed on disk). A row whose total reaches
+ *   DECAY_AT has every bucket halved, so the histogram tracks roughly the
+ *   last thousand or two samples rather than all time — a hook that goes
+ *   from 0.2 ms to 20 ms shows in its p95 within a few hundred events.
+ *
+ *   The hot path is one O_APPEND write (+ fstat) per event, so concurrent
+ *   events never overwrite each other's samples. The fold claims the log by
+ *   renaming it (only one process wins), so two folds never double-count;
+ *   a line appended through a descriptor opened just before the rename can
+ *   be lost, and any I/O error drops that event's samples — fail-open and
+ *   lossy by design. Nothing is written when the repo has no `node_modules`
+ *   (never created just to hold this). `FLEET_DISPATCH_PROFILE=0` turns it
+ *   off. `scripts/fleet/dispatch-profile-report.mts` prints the slowest
+ *   hooks per event + tool.
+ *
+ *   Under a latency budget (`FLEET_DISPATCH_BUDGET_MS`), an advisory hook
+ *   dropped at the deadline is sampled as `<hook>@overrun` (OVERRUN_SUFFIX)
+ *   instead: its time until the drop, or 0 when it never started. A
+ *   completion files under `<hook>` as usual, so the hook's overrun rate is
+ *   overrun / (overrun + completions).
+ *
+ *   Nothing here runs at module eval (snapshot-clean): the env is read on the
+ *   first `profileStart()`.
+ */
+
+import {
+  closeSync,
+  existsSync,
+  fstatSync,
+  mkdirSync,
+  openSync,
+  readFileSync,
+  renameSync,
+  unlinkSync,
+  writeFileSync,
+  writeSync,
+} from 'node:fs'
+import path from 'node:path'
+import process from 'node:process'
+
+import { resolveProjectDir } from '../_shared/project-dir.mts'
+
+export const PROFILE_ENV = 'FLEET_DISPATCH_PROFILE'
+export const PROFILE_VERSION = 1
+// Bucket 25 opens at 2^24 µs (~16.8 s); nothing a hook does is slower and
+// still worth telling apart.
+export const PROFILE_BUCKETS = 26
+// Row total that triggers a halving.
+export const DECAY_AT = 2048
+// Samples-log size that triggers a fold: ~100-200 events' worth.
+export const FOLD_AT = 256 * 1024
+// The tool key for events that carry no tool (Stop, SessionStart, …).
+export const ANY_TOOL = '*'
+// Appended to a hook's name for a sample of an advisory hook dropped at the
+// event's latency-budget deadline.
+export const OVERRUN_SUFFIX = '@overrun'
+
+export interface ProfileStore {
+  // event → tool → hook → bucket counts
+  readonly events: Record<string, Record<string, Record<string, number[]>>>
+  readonly v: number
+}
+
+export type ProfileSample = readonly [name: string, bucket: number]
+
+interface ProfileState {
+  readonly event: string
+  readonly samples: ProfileSample[]
+  readonly tool: string
+}
+
+// undefined = env not read yet.
+let enabled: boolean | undefined
+let state: ProfileState | undefined
+
+/**
+ * The profile directory for a repo root.
+ */
+export function profileDir(projectDir: string): string {
+  return path.join(
+    projectDir,
+    'node_modules',
+    '.cache',
+    'fleet',
+    'dispatch-profile',
+  )
+}
+
+/**
+ * The log2 bucket a duration (µs) falls in.
+ */
+export function profileBucket(micros: number): number {
+  const us = micros >= 1 ? Math.min(Math.floor(micros), 0x7f_ff_ff_ff) : 0
+  return Math.min(32 - Math.clz32(us), PROFILE_BUCKETS - 1)
+}
+
+/**
+ * Upper bound (µs) of bucket `b`; the open-ended last bucket reports its
+ * lower bound.
+ */
+export function profileBucketBound(b: number): number {
+  return b >= PROFILE_BUCKETS - 1 ? 2 ** (PROFILE_BUCKETS - 2) : 2 ** b
+}
+
+/**
+ * Nearest-rank percentile of a bucketed histogram, as its bucket's upper
+ * bound in µs (0 for an empty histogram).
+ */
+export function profileQuantile(counts: readonly number[], p: number): number {
+  let total = 0
+  for (let i = 0, { length } = counts; i < length; i += 1) {
+    total += counts[i]!
+  }
+  if (!total) {
+    return 0
+  }
+  const rank = Math.max(1, Math.ceil((p / 100) * total))
+  let seen = 0
+  for (let i = 0, { length } = counts; i < length; i += 1) {
+    seen += counts[i]!
+    if (seen >= rank) {
+      return profileBucketBound(i)
+    }
+  }
+  return profileBucketBound(counts.length - 1)
+}
+
+/**
+ * An empty, current-version store.
+ */
+export function emptyProfileStore(): ProfileStore {
+  return { __proto__: null, events: {}, v: PROFILE_VERSION } as ProfileStore
+}
+
+/**
+ * Parse a histogram file's text; undefined when it isn't a current-version
+ * store.
+ */
+export function parseProfileStore(text: string): ProfileStore | undefined {
+  try {
+    const parsed = JSON.parse(text) as ProfileStore | undefined
+    if (
+      parsed?.v === PROFILE_VERSION &&
+      parsed.events &&
+      typeof parsed.events === 'object'
+    ) {
+      return parsed
+    }
+  } catch {}
+  return undefined
+}
+
+// The own object under `key` (created when absent); an inherited name like
+// `constructor` never resolves to the prototype's.
+function ownRecord<T>(
+  parent: Record<string, Record<string, T>>,
+  key: string,
+): Record<string, T> {
+  const existing = Object.hasOwn(parent, key) ? parent[key] : undefined
+  if (existing && typeof existing === 'object') {
+    return existing
+  }
+  const created = { __proto__: null } as unknown as Record<string, T>
+  parent[key] = created
+  return created
+}
+
+/**
+ * Fold one event's samples into `store` (mutated), decaying any row that
+ * reaches DECAY_AT and trimming trailing zero buckets.
+ */
+export function foldProfileSamples(
+  store: ProfileStore,
+  event: string,
+  tool: string,
+  samples: readonly ProfileSample[],
+): void {
+  if (event === '__proto__' || tool === '__proto__') {
+    return
+  }
+  const rows = ownRecord(ownRecord(store.events, event), tool)
+  for (let i = 0, { length } = samples; i < length; i += 1) {
+    const { 0: name, 1: bucket } = samples[i]!
+    if (name === '__proto__') {
+      continue
+    }
+    const b = Math.min(
+      Math.max(0, Math.floor(bucket) || 0),
+      PROFILE_BUCKETS - 1,
+    )
+    const row =
+      Object.hasOwn(rows, name) && Array.isArray(rows[name]) ? rows[name]! : []
+    while (row.length <= b) {
+      row.push(0)
+    }
+    row[b] = (Number(row[b]) || 0) + 1
+    let total = 0
+    for (let j = 0, { length: n } = row; j < n; j += 1) {
+      total += row[j]!
+    }
+    if (total >= DECAY_AT) {
+      for (let j = 0, { length: n } = row; j < n; j += 1) {
+        row[j] = Math.floor(row[j]! / 2)
+      }
+    }
+    while (row.length && !row[row.length - 1]) {
+      row.pop()
+    }
+    rows[name] = row
+  }
+}
+
+// Tabs / newlines would break the line format; nothing legitimate uses them.
+function field(text: string): string {
+  return text.replace(/[\t\n\r]/g, '_')
+}
+
+/**
+ * One samples-log line (newline included) for an event.
+ */
+export function encodeProfileLine(
+  event: string,
+  tool: string,
+  samples: readonly ProfileSample[],
+): string {
+  let body = ''
+  for (let i = 0, { length } = samples; i < length; i += 1) {
+    const { 0: name, 1: bucket } = samples[i]!
+    body += `${i ? ' ' : ''}${field(name).replace(/ /g, '_')}:${bucket}`
+  }
+  return `${field(event)}\t${field(tool)}\t${body}\n`
+}
+
+/**
+ * Fold every well-formed line of a samples log into `store` (mutated);
+ * malformed lines (a torn tail) are skipped.
+ */
+export function foldProfileLog(store: ProfileStore, text: string): void {
+  const lines = text.split('\n')
+  for (let i = 0, { length } = lines; i < length; i += 1) {
+    const parts = lines[i]!.split('\t')
+    if (parts.length !== 3 || !parts[0] || !parts[1]) {
+      continue
+    }
+    const samples: ProfileSample[] = []
+    const items = parts[2]!.split(' ')
+    for (let j = 0, { length: n } = items; j < n; j += 1) {
+      const item = items[j]!
+      const colon = item.lastIndexOf(':')
+      const bucket = Number(item.slice(colon + 1))
+      if (colon > 0 && Number.isInteger(bucket)) {
+        samples.push([item.slice(0, colon), bucket])
+      }
+    }
+    foldProfileSamples(store, parts[0], parts[1], samples)
+  }
+}
+
+/**
+ * The histogram with any not-yet-folded samples applied — a read-only view
+ * for the report; nothing on disk changes.
+ */
+export function loadProfile(dir: string): ProfileStore | undefined {
+  let store: ProfileStore | undefined
+  let found = false
+  try {
+    const text = readFileSync(path.join(dir, 'histogram.json'), 'utf8')
+    store = parseProfileStore(text)
+    found = true
+  } catch {}
+  if (found && !store) {
+    return undefined
+  }
+  store ??= emptyProfileStore()
+  try {
+    foldProfileLog(store, readFileSync(path.join(dir, 'samples.log'), 'utf8'))
+    found = true
+  } catch {}
+  return found ? store : undefined
+}
+
+/**
+ * Claim the samples log (rename — only one process wins) and fold it into
+ * the histogram. Fail-open: a lost race or I/O error just skips this fold.
+ */
+export function compactProfile(dir: string): void {
+  const log = path.join(dir, 'samples.log')
+  const claimed = `${log}.${process.pid}.fold`
+  try {
+    renameSync(log, claimed)
+  } catch {
+    return
+  }
+  try {
+    const file = path.join(dir, 'histogram.json')
+    let store: ProfileStore | undefined
+    try {
+      store = parseProfileStore(readFileSync(file, 'utf8'))
+    } catch {}
+    store ??= emptyProfileStore()
+    foldProfileLog(store, readFileSync(claimed, 'utf8'))
+    const tmp = `${file}.${process.pid}.tmp`
+    writeFileSync(tmp, JSON.stringify(store))
+    renameSync(tmp, file)
+  } catch {
+  } finally {
+    try {
+      unlinkSync(claimed)
+    } catch {}
+  }
+}
+
+/**
+ * Start collecting samples for one event. Tool-less events file under
+ * ANY_TOOL.
+ */
+export function profileStart(event: string, tool: string | undefined): void {
+  enabled ??= process.env[PROFILE_ENV] !== '0'
+  state = enabled
+    ? ({
+        __proto__: null,
+        event,
+        samples: [],
+        tool: tool || ANY_TOOL,
+      } as ProfileState)
+    : undefined
+}
+
+/**
+ * Whether the current event is being profiled (only after `profileStart`).
+ */
+export function profileEnabled(): boolean {
+  return !!state
+}
+
+/**
+ * Buffer one hook's wall time (`startNs` → `endNs`, monotonic ns).
+ */
+export function profileHook(name: string, startNs: bigint, endNs: bigint): void {
+  if (state) {
+    state.samples.push([
+      name,
+      profileBucket(endNs > startNs ? Number(endNs - startNs) / 1e3 : 0),
+    ])
+  }
+}
+
+/**
+ * Append the buffered samples to the repo's samples log (folding it once it
+ * is large) and end the event. Fail-open: any error drops the samples.
+ */
+export function profileFlush(projectDir: string = resolveProjectDir()): void {
+  const current = state
+  state = undefined
+  if (!current?.samples.length) {
+    return
+  }
+  const dir = profileDir(projectDir)
+  const log = path.join(dir, 'samples.log')
+  const line = encodeProfileLine(current.event, current.tool, current.samples)
+  let fd: number | undefined
+  try {
+    try {
+      fd = openSync(log, 'a')
+    } catch {
+      // First event in this checkout: create the dir, but never node_modules.
+      if (!existsSync(path.join(projectDir, 'node_modules'))) {
+        return
+      }
+      mkdirSync(dir, { recursive: true })
+      fd = openSync(log, 'a')
+    }
+    writeSync(fd, line)
+    const { size } = fstatSync(fd)
+    closeSync(fd)
+    fd = undefined
+    if (size >= FOLD_AT) {
+      compactProfile(dir)
+    }
+  } catch {
+  } finally {
+    if (fd !== undefined) {
+      try {
+        closeSync(fd)
+      } catch {}
+    }
+  }
+}
@@ -30,11 +30,29 @@
 // runs on Node ≥18. Feature-detected → no-op where native.
 import '../_shared/es-polyfills.mts'
 
+import path from 'node:path'
 import process from 'node:process'
 import v8 from 'node:v8'
 
-import { dispatch } from './dispatch.mts'
-import type { DispatchPayload } from './dispatch.mts'
+import {
+  BOOT_DIR_ENV,
+  adoptBootDir,
+  bundleRequire,
+} from '../_shared/bundle-dir.mts'
+import { compilePatternEngine } from '../_shared/pattern-engine.mts'
+import {
+  DAEMON_SUPERVISOR_ARG,
+  DAEMON_WORKER_ARG,
+  runDaemonSupervisor,
+  runDaemonWorker,
+} from './dispatch-daemon.mts'
+import { BATCH_ARG, runDispatchBatch } from './dispatch-batch.mts'
+import { dispatchRaw, emitDispatchOutput } from './dispatch-cli.mts'
+import type { DispatchEventIndex } from './dispatch-types.mts'
+import { EXCLUDED_HOOK_HINTS } from './dispatch-table.mts'
+import { registerLazyHooks } from './lazy-hooks.mts'
+import type { LazyHooks } from './lazy-hooks.mts'
+import { traceNow, tracePhase, traceStart } from './dispatch-trace.mts'
 
 // FULL COVERAGE (190/190 in ONE bundle): every candidate hook is now frozen into
 // the snapshot, so the prior hybrid's runtime `loadBundleB()` is gone — there is
@@ -42,26 +60,71 @@ import type { DispatchPayload } from './dispatch.mts'
 // The acorn-WASM guards (now frozen in bundle A) load the parser at RUNTIME via
 // `require('@ultrathink/acorn.wasm')` (the npm catalog dep, resolved from
 // node_modules) — nothing acorn-related is vendored or staged in this `_dispatch/` dir.
+//
+// The exception is the hooks the snapshot table leaves out: any
+// `@dispatch-snapshot-exclude` hook, plus the `@dispatch-lazy` cold hooks of
+// a `--lazy-cold` build. `loadExcludedIndex` requires their
+// `excluded-bundle.cjs` under the compile cache the first time a dispatch can
+// reach one (EXCLUDED_HOOK_HINTS), and `hooksFor` splices them in table order
+// (`lazy-hooks.mts`). That bundle carries its own copy of `_shared/`, so
+// module state (the literal prefilter, the process scheduler's dispatch
+// scope) isn't shared with it.
+//
+// A blob in the shared per-user store is booted by every checkout at its hook
+// revision, so nothing here may resolve against the build checkout: the
+// launcher passes its own `_dispatch/` dir (BOOT_DIR_ENV), and the excluded
+// bundle, its compile cache and the acorn-WASM parser all resolve from that
+// (`bundle-dir.mts`).
+
+/**
+ * Require `excluded-bundle.cjs` from the booting checkout's `_dispatch/`,
+ * compile-cached the way `index.cjs` caches `bundle.cjs`. Undefined (hooks
+ * stay out, fail-open) when it is missing or throws.
+ */
+function loadExcludedIndex(): Record<string, DispatchEventIndex> | undefined {
+  try {
+    const require = bundleRequire(import.meta.url)
+    const { findRepoRoot } = require('./snapshot-cache-path.cjs') as {
+      findRepoRoot: (start: string) => string | undefined
+    }
+    const repoRoot = findRepoRoot(
+      path.dirname(require.resolve('./excluded-bundle.cjs')),
+    )
+    if (repoRoot) {
+      try {
+        require('node:module').enableCompileCache?.(
+          path.join(repoRoot, 'node_modules', '.cache', 'fleet', 'fleet-hooks'),
+        )
+      } catch {}
+    }
+    return (
+      require('./excluded-bundle.cjs') as {
+        EXCLUDED_INDEX?: Record<string, DispatchEventIndex> | undefined
+      }
+    ).EXCLUDED_INDEX
+  } catch {
+    return undefined
+  }
+}
 
 /**
  * Drain stdin to a string. Local to the deserialize-main path — the snapshot
  * build pass must NEVER touch stdin (a pending read = a pending promise = a
- * build-constraint violation). Mirrors the shared `readStdin`, inlined here so
- * the build entry has zero module-eval I/O wiring.
+ * build-constraint violation). Mirrors the shared `readStdin` (Buffer chunks,
+ * decoded once), inlined here so the build entry has zero module-eval I/O
+ * wiring.
  */
 function readStdin(): Promise<string> {
   return new Promise(resolve => {
-    let buf = ''
-    process.stdin.setEncoding('utf8')
-    process.stdin.on('data', chunk => {
-      buf += chunk
-    })
-    process.stdin.on('end', () => {
-      resolve(buf)
-    })
-    process.stdin.on('error', () => {
-      resolve(buf)
+    const chunks: Buffer[] = []
+    const done = () => {
+      resolve(Buffer.concat(chunks).toString('utf8'))
+    }
+    process.stdin.on('data', (chunk: Buffer) => {
+      chunks.push(chunk)
     })
+    process.stdin.on('end', done)
+    process.stdin.on('error', done)
   })
 }
 
@@ -69,6 +132,13 @@ function readStdin(): Promise<string> {
  * The runtime entry: everything per-run lives here, run only when booting from
  * the blob. Reads the event from argv[1] (snapshot argv layout), drains stdin,
  * dispatches, surfaces reminders/blocks, exits. Fail-open on every error.
+ *
+ * Two argv[1] sentinels reuse the same blob for the opt-in warm daemon
+ * (`dispatch-daemon.mts`): `__fleet-daemon <base> <pid> <hash> <slots>`
+ * boots the supervisor, `__fleet-daemon-worker <slot-socket> <hash>` one of
+ * its parked workers. No hook event is spelled like either, so a real event
+ * can never route there. `__fleet-batch [file…]` (BATCH_ARG) runs batch /
+ * replay mode (`dispatch-batch.mts`) in this one booted process.
  */
 async function deserializeMain(): Promise<void> {
   // Snapshot argv layout: [nodeBinary, <Event>] — no script path. The event is
@@ -77,40 +147,44 @@ async function deserializeMain(): Promise<void> {
   if (!event) {
     process.exit(0)
   }
-  let raw: string
-  try {
-    raw = await readStdin()
-  } catch {
-    process.exit(0)
+  adoptBootDir(process.env[BOOT_DIR_ENV])
+  registerLazyHooks({
+    __proto__: null,
+    hints: EXCLUDED_HOOK_HINTS,
+    load: loadExcludedIndex,
+  } as LazyHooks)
+  if (event === DAEMON_SUPERVISOR_ARG) {
+    const { 2: base, 3: pidPath, 4: bundleHash } = process.argv
+    const slotCount = Number(process.argv[5])
+    if (!base || !pidPath || !bundleHash || !(slotCount > 0)) {
+      process.exit(0)
+    }
+    runDaemonSupervisor(base, pidPath, bundleHash, slotCount)
+    return
   }
-  if (!raw.trim()) {
-    process.exit(0)
+  if (event === DAEMON_WORKER_ARG) {
+    const { 2: socketPath, 3: bundleHash } = process.argv
+    if (!socketPath || !bundleHash) {
+      process.exit(0)
+    }
+    runDaemonWorker(socketPath, bundleHash)
+    return
   }
-  let payload: DispatchPayload
-  try {
-    payload = JSON.parse(raw) as DispatchPayload
-  } catch {
+  if (event === BATCH_ARG) {
+    await runDispatchBatch(process.argv.slice(2), dispatchRaw)
     process.exit(0)
   }
-  let result
+  // Launcher handoff → here: node boot + snapshot deserialize.
+  traceStart(event, 'deserialize')
+  let raw: string
+  const stdinStart = traceNow()
   try {
-    result = await dispatch(event, payload)
+    raw = await readStdin()
   } catch {
     process.exit(0)
   }
-  if (result.reminders.length) {
-    process.stderr.write(result.reminders.join('\n') + '\n')
-  }
-  if (result.decision === 'block' && result.blockReason !== undefined) {
-    if (payload.tool_name === undefined) {
-      process.stdout.write(
-        JSON.stringify({ decision: 'block', reason: result.blockReason }),
-      )
-      process.exit(0)
-    }
-    process.exit(2)
-  }
-  process.exit(0)
+  tracePhase('stdin', stdinStart)
+  emitDispatchOutput(await dispatchRaw(event, raw))
 }
 
 // Register the runtime entry with V8's snapshot machinery, but only during a
@@ -118,6 +192,9 @@ async function deserializeMain(): Promise<void> {
 // dev sanity check), fall back to running deserializeMain directly so the
 // entry is still exercisable outside the snapshot flow.
 if (v8.startupSnapshot.isBuildingSnapshot()) {
+  // Every content guard has registered its literals by now (module eval), so
+  // the shared prefilter's automaton is frozen into the blob pre-built.
+  compilePatternEngine()
   v8.startupSnapshot.setDeserializeMainFunction(() => {
     void deserializeMain()
   })
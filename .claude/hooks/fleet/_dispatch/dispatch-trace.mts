@@ -0,0 +1,346 @@
+/**
+ * @file Opt-in phase tracing for the hook dispatch path
+ *   (`FLEET_DISPATCH_TRACE=<absolute ring file>`).
+ *
+ *   Every stage of one hook event — the native launcher's self-locate /
+ *   manifest / pre-flight / daemon attempt, node's boot or snapshot
+ *   deserialize, the stdin drain, the parse, and each hook that ran — stamps
+ *   one fixed-size record into a shared ring file, so a slow hook on a real
+ *   machine can be pinned on a phase instead of guessed from fixture
+ *   benchmarks. `scripts/fleet/dispatch-trace-report.mts` prints p50 / p95 /
+ *   p99 per phase and per event.
+ *
+ *   Ring layout (integers little-endian; the C structs in
+ *   `dispatch-launcher-trace.c` / `dispatch-launcher-win-trace.c` mirror it):
+ *
+ *     header (TRACE_RECORD_SIZE bytes)
+ *       0   8  magic "FLTTR\0\0\1"
+ *       8   4  u32 record size
+ *      12   4  u32 slot count
+ *      16   8  u64 cursor — next free slot, claimed TRACE_BLOCK at a time
+ *     record (TRACE_RECORD_SIZE bytes, TRACE_SLOTS of them after the header)
+ *       0   4  u32 check — FNV-1a over bytes 4.., written LAST; 0 = empty
+ *       4   4  u32 pid
+ *       8   8  u64 trace id — shared by every record of one hook event
+ *      16   8  u64 phase start, ns on the monotonic clock node's hrtime uses
+ *      24   8  u64 phase duration, ns
+ *      32  32  event name (NUL-padded)
+ *      64  64  phase name (NUL-padded)
+ *
+ *   Lock-free: the launcher claims a whole block of slots with one atomic
+ *   fetch-add on the mmap'd cursor and hands the rest of that block to node
+ *   through `FLEET_DISPATCH_TRACE_CTX` (`<id>:<first>:<end>:<handoff ns>`),
+ *   so no two writers ever share a slot and node — which cannot mmap or do a
+ *   cross-process atomic — only ever writes its own slots, with ONE
+ *   positional write at the end of the dispatch. A node run the launcher
+ *   didn't start (`node index.cjs <Event>` wired directly) has no context and
+ *   takes a random block instead; a collision there costs a sample, never a
+ *   torn read, because the reader drops any record whose check doesn't match.
+ *
+ *   Nothing here runs at module eval (snapshot-clean): the env is read on the
+ *   first `traceStart()`, from the runtime entry points only.
+ */
+
+import {
+  closeSync,
+  constants as fsConstants,
+  fstatSync,
+  ftruncateSync,
+  openSync,
+  readSync,
+  writeSync,
+} from 'node:fs'
+import process from 'node:process'
+
+export const TRACE_ENV = 'FLEET_DISPATCH_TRACE'
+export const TRACE_CTX_ENV = 'FLEET_DISPATCH_TRACE_CTX'
+export const TRACE_RECORD_SIZE = 128
+// 65536 records = an 8 MiB ring (~512 hook events); the oldest blocks are
+// overwritten first.
+export const TRACE_SLOTS = 65_536
+// Slots one hook event claims: the heaviest event runs ~90 hooks, plus the
+// launcher's and node's own phases.
+export const TRACE_BLOCK = 128
+
+const MAGIC = Buffer.from([0x46, 0x4c, 0x54, 0x54, 0x52, 0x00, 0x00, 0x01])
+const EVENT_OFF = 32
+const EVENT_LEN = 32
+const PHASE_OFF = 64
+const PHASE_LEN = 64
+
+export interface TraceRecord {
+  readonly durationNs: bigint
+  readonly event: string
+  readonly phase: string
+  readonly pid: number
+  readonly startNs: bigint
+  readonly traceId: bigint
+}
+
+interface TraceState {
+  readonly end: number
+  readonly event: string
+  // Next slot a flush writes; advances as records land.
+  next: number
+  readonly path: string
+  readonly pending: Buffer[]
+  readonly traceId: bigint
+}
+
+// undefined = env not read yet; null = tracing off for this process.
+let state: TraceState | null | undefined
+
+/**
+ * FNV-1a over the record bytes after the check field; never 0, so a zeroed
+ * (never written) slot can't pass as a record.
+ */
+export function traceChecksum(record: Buffer): number {
+  let h = 0x81_1c_9d_c5
+  for (let i = 4; i < TRACE_RECORD_SIZE; i += 1) {
+    h = Math.imul(h ^ record[i]!, 0x01_00_01_93)
+  }
+  return h >>> 0 || 1
+}
+
+function putName(out: Buffer, offset: number, cap: number, text: string) {
+  // Truncated on a byte boundary; the reader decodes leniently.
+  Buffer.from(text, 'utf8').copy(out, offset, 0, cap)
+}
+
+function getName(buf: Buffer, offset: number, cap: number): string {
+  const field = buf.subarray(offset, offset + cap)
+  const end = field.indexOf(0)
+  return field.subarray(0, end === -1 ? cap : end).toString('utf8')
+}
+
+/**
+ * Encode one record into a fresh TRACE_RECORD_SIZE buffer, check included.
+ */
+export function encodeTraceRecord(rec: TraceRecord): Buffer {
+  const out = Buffer.alloc(TRACE_RECORD_SIZE)
+  out.writeUInt32LE(rec.pid >>> 0, 4)
+  out.writeBigUInt64LE(rec.traceId, 8)
+  out.writeBigUInt64LE(rec.startNs, 16)
+  out.writeBigUInt64LE(rec.durationNs, 24)
+  putName(out, EVENT_OFF, EVENT_LEN, rec.event)
+  putName(out, PHASE_OFF, PHASE_LEN, rec.phase)
+  out.writeUInt32LE(traceChecksum(out), 0)
+  return out
+}
+
+/**
+ * Decode every committed record in a ring file's bytes (any order — the
+ * report groups by trace id). Undefined when the header isn't a trace ring.
+ */
+export function decodeTraceRing(buf: Buffer): TraceRecord[] | undefined {
+  if (
+    buf.length < TRACE_RECORD_SIZE ||
+    !buf.subarray(0, MAGIC.length).equals(MAGIC) ||
+    buf.readUInt32LE(8) !== TRACE_RECORD_SIZE
+  ) {
+    return undefined
+  }
+  const slots = Math.min(
+    buf.readUInt32LE(12),
+    Math.floor(buf.length / TRACE_RECORD_SIZE) - 1,
+  )
+  const records: TraceRecord[] = []
+  for (let i = 0; i < slots; i += 1) {
+    const off = (i + 1) * TRACE_RECORD_SIZE
+    const rec = buf.subarray(off, off + TRACE_RECORD_SIZE)
+    const check = rec.readUInt32LE(0)
+    if (check === 0 || check !== traceChecksum(rec)) {
+      continue
+    }
+    records.push({
+      __proto__: null,
+      durationNs: rec.readBigUInt64LE(24),
+      event: getName(rec, EVENT_OFF, EVENT_LEN),
+      phase: getName(rec, PHASE_OFF, PHASE_LEN),
+      pid: rec.readUInt32LE(4),
+      startNs: rec.readBigUInt64LE(16),
+      traceId: rec.readBigUInt64LE(8),
+    } as TraceRecord)
+  }
+  return records
+}
+
+/**
+ * Open (creating + sizing + stamping the header on first use) the ring file.
+ * Returns the fd, or undefined when it isn't a ring this layout can write.
+ */
+function openRing(ringPath: string): number | undefined {
+  const size = (TRACE_SLOTS + 1) * TRACE_RECORD_SIZE
+  let fd: number | undefined
+  try {
+    fd = openSync(ringPath, fsConstants.O_RDWR | fsConstants.O_CREAT, 0o600)
+    if (fstatSync(fd).size < size) {
+      ftruncateSync(fd, size)
+    }
+    const header = Buffer.alloc(16)
+    readSync(fd, header, 0, 16, 0)
+    if (header.subarray(0, MAGIC.length).equals(MAGIC)) {
+      if (
+        header.readUInt32LE(8) !== TRACE_RECORD_SIZE ||
+        header.readUInt32LE(12) !== TRACE_SLOTS
+      ) {
+        closeSync(fd)
+        return undefined
+      }
+    } else {
+      // Same bytes whoever wins a first-use race; the cursor is never
+      // written, so a concurrent launcher's claim is never reset.
+      header.writeUInt32LE(TRACE_RECORD_SIZE, 8)
+      header.writeUInt32LE(TRACE_SLOTS, 12)
+      writeSync(fd, header, 8, 8, 8)
+      writeSync(fd, MAGIC, 0, MAGIC.length, 0)
+    }
+    return fd
+  } catch {
+    if (fd !== undefined) {
+      try {
+        closeSync(fd)
+      } catch {}
+    }
+    return undefined
+  }
+}
+
+/**
+ * The slot range + identity a launcher handed this process.
+ */
+export interface TraceContext {
+  readonly end: number
+  readonly first: number
+  readonly handoffNs: bigint
+  readonly traceId: bigint
+}
+
+/**
+ * Parse the launcher's `<id>:<first>:<end>:<handoff ns>` context.
+ */
+export function parseTraceContext(text: string): TraceContext | undefined {
+  const m = /^(\d+):(\d+):(\d+):(\d+)$/.exec(text)
+  if (!m) {
+    return undefined
+  }
+  const first = Number(m[2])
+  const end = Number(m[3])
+  if (!(end > first) || end - first > TRACE_BLOCK || end > TRACE_SLOTS) {
+    return undefined
+  }
+  return {
+    __proto__: null,
+    end,
+    first,
+    handoffNs: BigInt(m[4]!),
+    traceId: BigInt(m[1]!),
+  } as TraceContext
+}
+
+/**
+ * Monotonic now, ns — the clock the launchers stamp with too.
+ */
+export function traceNow(): bigint {
+  return process.hrtime.bigint()
+}
+
+/**
+ * Whether this process is tracing (only true after `traceStart`).
+ */
+export function traceEnabled(): boolean {
+  return !!state
+}
+
+/**
+ * Start tracing `event` when FLEET_DISPATCH_TRACE names a ring. With a
+ * launcher context, `entryPhase` (e.g. `deserialize`, `boot`, `handoff`)
+ * records the gap from the launcher's handoff stamp to now.
+ */
+export function traceStart(event: string, entryPhase: string): void {
+  if (state !== undefined) {
+    return
+  }
+  state = null
+  const ringPath = process.env[TRACE_ENV]
+  // Absolute only: a relative ring would land in whatever cwd the hook ran in.
+  if (!ringPath || !/^(?:\/|[A-Za-z]:[\\/]|\\\\)/.test(ringPath)) {
+    return
+  }
+  const ctx = parseTraceContext(process.env[TRACE_CTX_ENV] ?? '')
+  let first: number
+  let end: number
+  let traceId: bigint
+  if (ctx) {
+    ;({ end, first, traceId } = ctx)
+  } else {
+    first =
+      Math.floor((Math.random() * TRACE_SLOTS) / TRACE_BLOCK) * TRACE_BLOCK
+    end = first + TRACE_BLOCK
+    // High bit set: can't collide with a launcher's counter-derived id.
+    traceId =
+      (1n << 63n) |
+      BigInt(Math.floor(Math.random() * Number.MAX_SAFE_INTEGER))
+  }
+  state = {
+    __proto__: null,
+    end,
+    event,
+    next: first,
+    path: ringPath,
+    pending: [],
+    traceId,
+  } as TraceState
+  if (ctx) {
+    tracePhase(entryPhase, ctx.handoffNs)
+  }
+}
+
+/**
+ * Buffer one phase record (`startNs` → `endNs`, default now). A no-op when
+ * tracing is off or this event's slots are used up.
+ */
+export function tracePhase(
+  phase: string,
+  startNs: bigint,
+  endNs: bigint = traceNow(),
+): void {
+  if (!state || state.next + state.pending.length >= state.end) {
+    return
+  }
+  state.pending.push(
+    encodeTraceRecord({
+      __proto__: null,
+      durationNs: endNs > startNs ? endNs - startNs : 0n,
+      event: state.event,
+      phase,
+      pid: process.pid,
+      startNs,
+      traceId: state.traceId,
+    } as TraceRecord),
+  )
+}
+
+/**
+ * Write the buffered records into this event's slots in one positional
+ * write. Fail-open: a ring that can't be opened just drops the samples.
+ */
+export function traceFlush(): void {
+  if (!state || !state.pending.length) {
+    return
+  }
+  const records = Buffer.concat(state.pending)
+  const offset = (state.next + 1) * TRACE_RECORD_SIZE
+  state.next += state.pending.length
+  state.pending.length = 0
+  const fd = openRing(state.path)
+  if (fd === undefined) {
+    return
+  }
+  try {
+    writeSync(fd, records, 0, records.length, offset)
+  } catch {
+  } finally {
+    closeSync(fd)
+  }
+}
@@ -0,0 +1,126 @@
+/**
+ * @file The shapes the dispatcher modules, the generated dispatch table
+ *   (`dispatch-table.mts`) and the runners share: a payload, a hook entry,
+ *   its verdict, and the per-event index `dispatch-index.mts` looks hooks up
+ *   in. Types only, so importing it never pulls a module into the bundle.
+ */
+
+import type { PayloadAnalysis } from '../_shared/payload-analysis.mts'
+
+export interface DispatchPayload {
+  readonly cwd?: string | undefined
+  readonly hook_event_name?: string | undefined
+  readonly tool_input?: Record<string, unknown> | undefined
+  readonly tool_name?: string | undefined
+  readonly transcript_path?: string | undefined
+}
+
+/**
+ * A guard verdict the dispatcher understands. Mirrors `_shared/guard.mts`'s
+ * `GuardResult` but lives here so the dispatch table can carry `defineHook`
+ * hooks (which return a verdict) alongside the legacy pure-`run` hooks (which
+ * return a reminder string) WITHOUT the dispatcher importing the guard module.
+ * `'block'` sets exitCode 2 + prints `message`; `'notify'` prints `message`
+ * (stderr, exit 0); `undefined` is silent allow.
+ */
+export type DispatchVerdict =
+  | { readonly kind: 'block'; readonly message: string }
+  | { readonly kind: 'notify'; readonly message: string }
+  | undefined
+
+export interface DispatchHookEntry {
+  /**
+   * The hook leaf name (the `fleet/<name>` dir), for diagnostics.
+   */
+  readonly name: string
+  /**
+   * Tool names this hook handles. Empty/omitted means "any tool" (e.g. Stop
+   * hooks). The dispatcher uses this for the trigger pre-flight early-exit.
+   */
+  readonly tools?: readonly string[] | undefined
+  /**
+   * The hook declared `@dispatch-pure`: its verdict depends on the payload's
+   * event, tool and input alone, so `dispatch()` may replay a verdict it
+   * recorded for the same payload (verdict-cache.mts) instead of running it.
+   */
+  readonly pure?: boolean | undefined
+  /**
+   * The hook is a nudge that never blocks and didn't declare
+   * `@dispatch-must-run`. Under a latency budget `dispatch()` starts it after
+   * every block-capable hook and may drop it past the deadline.
+   */
+  readonly advisory?: boolean | undefined
+  /**
+   * The hook changes state beside its verdict (a ledger, a throttle stamp, a
+   * log, a process, a commit): `@dispatch-must-run`, `@dispatch-stateful`, or
+   * a write the maker spotted in its source. Batch / replay skips it. In a
+   * dispatch nothing after it starts until it settles, and then the event's
+   * settled git probes are forgotten (`invalidateProcessScope`).
+   */
+  readonly stateful?: boolean | undefined
+  /**
+   * The hook's position in the FULL table. Set only in the snapshot and
+   * excluded tables, so entries spliced in from `excluded-bundle.cjs` land
+   * where the full table has them (lazy-hooks.mts).
+   */
+  readonly seq?: number | undefined
+  /**
+   * Legacy pure entry: returns reminder text to surface on stderr, or
+   * `undefined`. Mutually exclusive with `check` — exactly one is set per entry.
+   * (bundle-stale-reminder style.)
+   */
+  readonly run?:
+    | ((
+        payload: DispatchPayload,
+        analysis?: PayloadAnalysis | undefined,
+      ) => string | undefined)
+    | undefined
+  /**
+   * `defineHook`-contract entry: returns a verdict (block / notify / allow).
+   * The maker wraps each eligible `defineHook` hook's `check` into this seam so
+   * the dispatcher can run a blocking guard from the snapshot WITHOUT a dynamic
+   * import. `check` may be sync OR async; the dispatcher awaits it.
+   *
+   * Both seams get the payload's shared `PayloadAnalysis` as a second
+   * argument, so the parsed command / edit content / normalized text are
+   * computed once per dispatch rather than once per hook.
+   */
+  readonly check?: ((
+    payload: DispatchPayload,
+    analysis?: PayloadAnalysis | undefined,
+  ) => DispatchVerdict | Promise<DispatchVerdict>) | undefined
+}
+
+export interface DispatchResult {
+  /**
+   * `'block'` when any fired guard returned a block verdict; else `'allow'`.
+   */
+  readonly decision: 'allow' | 'block'
+  /**
+   * Reminder / notify / block lines collected from the hooks that fired (in
+   * fire order). All are surfaced on stderr by the CLI.
+   */
+  readonly reminders: readonly string[]
+  /**
+   * The block reason to surface, when `decision === 'block'`. The CLI prints
+   * this on stderr and sets exitCode 2 (PreToolUse / PostToolUse protocol).
+   */
+  readonly blockReason?: string | undefined
+}
+
+/**
+ * One event's precomputed (tool → hooks) index, generated into the dispatch
+ * table next to `DISPATCH_TABLE` (which holds the same entry objects).
+ */
+export interface DispatchEventIndex {
+  /**
+   * The hooks that declare no tools, in table order: everything that can
+   * fire for a tool no hook names, or for a payload without `tool_name`.
+   */
+  readonly any: readonly DispatchHookEntry[]
+  /**
+   * Per declared tool, every hook that fires for it (its own plus the
+   * any-tool ones), in table order.
+   */
+  readonly byTool: Record<string, readonly DispatchHookEntry[]>
+}
@@ -21,16 +21,64 @@
  *   reminder/notify text to stderr; a blocking hook's verdict sets exit code 2
  *   (PreToolUse / PostToolUse) or emits the stdout-JSON decision protocol
  *   (Stop), via `DispatchResult.decision`.
+ *
+ *   Hooks run one at a time by default. `FLEET_DISPATCH_CONCURRENCY=<n>` lets
+ *   up to `n` be in flight, so an event's I/O-bound checks (SDK lookups, git
+ *   probes, transcript reads) overlap their waits instead of summing them —
+ *   with the same reminders, in the same order, and the same first-block
+ *   verdict as the sequential loop.
+ *
+ *   `FLEET_DISPATCH_BUDGET_MS=<ms>` gives each event a latency budget. The
+ *   block-capable hooks start first and always run to completion. The ADVISORY
+ *   ones (`advisory: true`: nudges that can only notify) run in whatever is
+ *   left. An advisory hook that was never started, or is still running when
+ *   the result is assembled, is dropped: the verdict and exit code go out
+ *   without it. Every drop is profiled as an overrun. A hook that settles
+ *   past the deadline but before then is kept, since its side effects (a
+ *   nudge's once-per-window stamp) have already happened. Output stays in
+ *   table order, so an event that finishes inside its budget renders exactly
+ *   as it would without one.
+ *
+ *   `node index.cjs __fleet-batch [file…]` runs a whole NDJSON stream of
+ *   events, or a replayed transcript, through one warm process instead
+ *   (`dispatch-batch.mts`).
+ *
+ *   Hooks that spawn git and friends go through the shared process scheduler
+ *   (`_shared/process-scheduler.mts`); each event is one scheduler scope, so
+ *   an identical probe from several hooks runs once and every spawn of the
+ *   event shares one deadline.
+ *
+ *   Every hook's wall time also lands in a per-repo latency histogram
+ *   (`dispatch-profile.mts`, on unless `FLEET_DISPATCH_PROFILE=0`), so a hook
+ *   that regresses shows up in `scripts/fleet/dispatch-profile-report.mts`.
+ *
+ *   Layout: this module is `dispatch()` and the block-chain addendum. The
+ *   (event, tool) lookup is `dispatch-index.mts`, the worker pool and budget
+ *   `dispatch-pool.mts`, the stdin / render / CLI shell `dispatch-cli.mts`,
+ *   and the shared shapes `dispatch-types.mts`.
  */
 
+
 import process from 'node:process'
 
+import { analyzePayload } from '../_shared/payload-analysis.mts'
+import {
+  closeProcessScope,
+  openProcessScope,
+} from '../_shared/process-scheduler.mts'
 import { parseCommands } from '../_shared/shell-command.mts'
-import { readStdin } from '../_shared/transcript.mts'
-
-import { DISPATCH_TABLE } from './dispatch-table.mts'
 import { isHookEntrypoint } from '../_shared/entrypoint.mts'
 
+import { runDispatcherCli } from './dispatch-cli.mts'
+import { hooksFor } from './dispatch-index.mts'
+import { runHookPool } from './dispatch-pool.mts'
+import type { HookPoolOptions, HookPoolResult } from './dispatch-pool.mts'
+
+import type {
+  DispatchPayload,
+  DispatchResult,
+} from './dispatch-types.mts'
+
 // State-mutating segment families whose SILENT cancellation strands work. A
 // block on one segment of a compound Bash command cancels the whole chain —
 // including a `git commit` / `git push` chained before the blocked step — and
@@ -82,11 +130,8 @@ export function cancelledChainAddendum(
   if (payload.tool_name !== 'Bash') {
     return undefined
   }
-  const command = payload.tool_input?.['command']
-  if (typeof command !== 'string' || !command) {
-    return undefined
-  }
-  if (parseCommands(command).length < 2) {
+  const { command, commands } = analyzePayload(payload)
+  if (!command || commands.length < 2) {
     return undefined
   }
   const cancelled = mutatingSegments(command)
@@ -104,135 +149,73 @@ export function cancelledChainAddendum(
   ].join('\n')
 }
 
-export interface DispatchPayload {
-  readonly cwd?: string | undefined
-  readonly hook_event_name?: string | undefined
-  readonly tool_input?: Record<string, unknown> | undefined
-  readonly tool_name?: string | undefined
-  readonly transcript_path?: string | undefined
-}
-
-/**
- * A guard verdict the dispatcher understands. Mirrors `_shared/guard.mts`'s
- * `GuardResult` but lives here so the dispatch table can carry `defineHook`
- * hooks (which return a verdict) alongside the legacy pure-`run` hooks (which
- * return a reminder string) WITHOUT the dispatcher importing the guard module.
- * `'block'` sets exitCode 2 + prints `message`; `'notify'` prints `message`
- * (stderr, exit 0); `undefined` is silent allow.
- */
-export type DispatchVerdict =
-  | { readonly kind: 'block'; readonly message: string }
-  | { readonly kind: 'notify'; readonly message: string }
-  | undefined
-
-export interface DispatchHookEntry {
-  /**
-   * The hook leaf name (the `fleet/<name>` dir), for diagnostics.
-   */
-  readonly name: string
-  /**
-   * Tool names this hook handles. Empty/omitted means "any tool" (e.g. Stop
-   * hooks). The dispatcher uses this for the trigger pre-flight early-exit.
-   */
-  readonly tools?: readonly string[] | undefined
-  /**
-   * Legacy pure entry: returns reminder text to surface on stderr, or
-   * `undefined`. Mutually exclusive with `check` — exactly one is set per entry.
-   * (bundle-stale-reminder style.)
-   */
-  readonly run?: (payload: DispatchPayload) => string | undefined
+export interface DispatchOptions extends HookPoolOptions {
   /**
-   * `defineHook`-contract entry: returns a verdict (block / notify / allow).
-   * The maker wraps each eligible `defineHook` hook's `check` into this seam so
-   * the dispatcher can run a blocking guard from the snapshot WITHOUT a dynamic
-   * import. `check` may be sync OR async; the dispatcher awaits it.
+   * Leave `stateful` hooks out entirely (batch / replay mode), so a recorded
+   * event can't write the live project's runtime state.
    */
-  readonly check?: ((
-    payload: DispatchPayload,
-  ) => DispatchVerdict | Promise<DispatchVerdict>) | undefined
-}
-
-export interface DispatchResult {
-  /**
-   * `'block'` when any fired guard returned a block verdict; else `'allow'`.
-   */
-  readonly decision: 'allow' | 'block'
-  /**
-   * Reminder / notify / block lines collected from the hooks that fired (in
-   * fire order). All are surfaced on stderr by the CLI.
-   */
-  readonly reminders: readonly string[]
-  /**
-   * The block reason to surface, when `decision === 'block'`. The CLI prints
-   * this on stderr and sets exitCode 2 (PreToolUse / PostToolUse protocol).
-   */
-  readonly blockReason?: string | undefined
-}
-
-/**
- * Returns true when the hook entry handles the payload's tool. An entry with
- * no declared tools handles every event (Stop / SessionStart style).
- */
-export function hookHandlesTool(
-  entry: DispatchHookEntry,
-  toolName: string | undefined,
-): boolean {
-  if (!entry.tools || entry.tools.length === 0) {
-    return true
-  }
-  if (!toolName) {
-    return false
-  }
-  return entry.tools.includes(toolName)
+  readonly skipStateful?: boolean | undefined
 }
 
 /**
- * Run every bundled hook registered for `event` against `payload`. Pure: no
- * process I/O (it only invokes the hooks' pure `run`/`check` fns), so it is
- * unit-testable and the bundler can tree-shake freely. Async because a
- * `defineHook` `check` may be async; legacy pure-`run` hooks resolve sync.
+ * Run every bundled hook registered for `event` against `payload`, through
+ * the worker pool (`dispatch-pool.mts`), and assemble their verdicts in table
+ * order. Async because a `defineHook` `check` may be async; legacy pure-`run`
+ * hooks resolve sync.
+ *
+ * Not pure. The event is one process-scheduler scope, so the hooks' git
+ * probes are shared and share one deadline. A pure hook's verdict may come
+ * from, or land in, `verdicts`. On a snapshot boot the lookup may load
+ * `excluded-bundle.cjs` (`lazy-hooks.mts`). And the hooks themselves do
+ * whatever I/O they do.
  *
  * A `block` verdict short-circuits: once a guard blocks, later hooks are
  * skipped (a block is terminal — the tool call is rejected — so there is no
  * point running the rest, and it matches the per-process guard semantics).
+ * With `concurrency > 1` hooks after the block may already be running; none
+ * past it is started, dispatch returns as soon as every hook BEFORE it has
+ * settled (an earlier block would win), and whatever the later ones return
+ * is ignored. A latency budget (`budgetMs`) drops advisory hooks as
+ * `runHookPool` describes; the result is still assembled in table order.
  */
 export async function dispatch(
   event: string,
   payload: DispatchPayload,
+  options?: DispatchOptions | undefined,
 ): Promise<DispatchResult> {
-  const entries = DISPATCH_TABLE[event] ?? []
+  const opts = { __proto__: null, ...options } as DispatchOptions
+  const entries = opts.skipStateful
+    ? hooksFor(event, payload.tool_name).filter(e => !e.stateful)
+    : hooksFor(event, payload.tool_name)
+  const { length } = entries
+  // One process scope per event: hooks asking git the same question share
+  // one spawn and one deadline (_shared/process-scheduler.mts).
+  openProcessScope()
+  let pool: HookPoolResult
+  try {
+    pool = await runHookPool(entries, payload, opts)
+  } finally {
+    closeProcessScope()
+  }
+  const { outcomes, stop } = pool
   const reminders: string[] = []
-  const toolName = payload.tool_name
   let blockReason: string | undefined
-  for (let i = 0, { length } = entries; i < length; i += 1) {
-    const entry = entries[i]!
-    if (!hookHandlesTool(entry, toolName)) {
+  // Through the winning block, when there is one.
+  for (let i = 0, last = Math.min(stop + 1, length); i < last; i += 1) {
+    const outcome = outcomes[i]
+    if (!outcome) {
       continue
     }
-    try {
-      if (entry.check) {
-        const verdict = await entry.check(payload)
-        if (verdict) {
-          if (verdict.kind === 'block') {
-            const addendum = cancelledChainAddendum(payload)
-            blockReason =
-              addendum === undefined
-                ? verdict.message
-                : `${verdict.message}\n${addendum}`
-            reminders.push(blockReason)
-            break
-          }
-          reminders.push(verdict.message)
-        }
-      } else if (entry.run) {
-        const text = entry.run(payload)
-        if (text) {
-          reminders.push(text)
-        }
-      }
-    } catch {
-      // A misbehaving bundled hook must never wedge the whole dispatcher.
+    if (outcome.kind === 'block') {
+      const addendum = cancelledChainAddendum(payload)
+      blockReason =
+        addendum === undefined
+          ? outcome.message
+          : `${outcome.message}\n${addendum}`
+      reminders.push(blockReason)
+      break
     }
+    reminders.push(outcome.message)
   }
   return {
     __proto__: null,
@@ -242,60 +225,16 @@ export async function dispatch(
   } as DispatchResult
 }
 
-/**
- * The dispatcher CLI: read the event arg (`process.argv[2]`) + stdin once, run
- * the bundled hooks, surface reminders on stderr, exit 0. Exported (not
- * auto-run) so the rolldown bundle entry (`dispatch-entry.mts`) can call it
- * unconditionally while unit tests / the source module stay import-safe — a
- * CJS bundle has no `import.meta`, so an entrypoint-guard can't gate it there.
- */
-export async function runDispatcherCli(): Promise<void> {
-  const event = process.argv[2]
-  if (!event) {
-    process.exit(0)
-  }
-  let raw: string
-  try {
-    raw = await readStdin()
-  } catch {
-    process.exit(0)
-  }
-  if (!raw.trim()) {
-    process.exit(0)
-  }
-  let payload: DispatchPayload
-  try {
-    payload = JSON.parse(raw) as DispatchPayload
-  } catch {
-    process.exit(0)
-  }
-  const result = await dispatch(event, payload)
-  if (result.reminders.length) {
-    process.stderr.write(result.reminders.join('\n') + '\n')
-  }
-  // A Stop-event block uses Claude Code's stdout-JSON decision protocol; a
-  // PreToolUse / PostToolUse block uses exitCode 2 + the reason on stderr
-  // (already written above as a reminder line).
-  if (result.decision === 'block' && result.blockReason !== undefined) {
-    if (payload.tool_name === undefined) {
-      process.stdout.write(
-        JSON.stringify({ decision: 'block', reason: result.blockReason }),
-      )
-      process.exit(0)
-    }
-    process.exit(2)
-  }
-  process.exit(0)
-}
-
 // Direct `node dispatch.mts <Event>` execution (dev / test harness) runs the
 // CLI; importing the module for its pure helpers does not. The snapshot-build
 // short circuit is load-bearing: `dispatch-snapshot-entry.mts` imports
-// `dispatch` from here, so this whole module — including this guard — is in
-// the snapshot bundle's top-level eval graph, and the dispatcher must run ONLY
-// from the registered deserialize-main. `isHookEntrypoint` owns that gating
-// (plus the realpath comparison); the hazard detail lives in
-// `../_shared/entrypoint.mts`.
+// `dispatch-cli.mts`, which imports `dispatch` from here, so this whole module
+// — including this guard — is in the snapshot bundle's top-level eval graph,
+// and the dispatcher must run ONLY from the registered deserialize-main.
+// `isHookEntrypoint` owns that gating (plus the realpath comparison); the
+// hazard detail lives in `../_shared/entrypoint.mts`. The import cycle with
+// `dispatch-cli.mts` is benign: neither module calls into the other at eval
+// except this guard, which runs once both are evaluated.
 if (isHookEntrypoint(import.meta.url)) {
   runDispatcherCli().catch(() => {
     process.exit(0)
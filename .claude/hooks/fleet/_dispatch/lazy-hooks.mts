@@ -0,0 +1,132 @@
+/**
+ * @file The hooks a snapshot boot leaves out of its frozen table, spliced
+ *   back into the dispatch on demand. The snapshot table omits every
+ *   `@dispatch-snapshot-exclude` hook and, in a `--lazy-cold` build
+ *   (`build-hook-snapshot.mts`), the `@dispatch-lazy` cold hooks; all of them
+ *   live in `excluded-bundle.cjs` instead.
+ *
+ *   `dispatch-snapshot-entry.mts` registers the generated
+ *   EXCLUDED_HOOK_HINTS (event → the tools those hooks handle) with a loader
+ *   for that bundle. `dispatchRaw` calls `ensureLazyHooks` once the payload's
+ *   tool is known: the first event and tool the hints name loads the bundle
+ *   and splices its index in, and any other event never pays for it.
+ *   `hooksFor` then merges the two indexes by each entry's `seq`, its
+ *   position in the full table, so a spliced dispatch runs the same hooks in
+ *   the same order as the `index.cjs` path.
+ *
+ *   Nothing here runs at module eval; the normal `index.cjs` bundle never
+ *   registers, so it never splices.
+ */
+
+import { traceNow, tracePhase } from './dispatch-trace.mts'
+import type { DispatchEventIndex, DispatchHookEntry } from './dispatch-types.mts'
+
+/**
+ * The left-out hooks and how to get them: `hints` is the generated
+ * EXCLUDED_HOOK_HINTS (`null` for an event with an any-tool hook), `load`
+ * requires the bundle holding them (undefined when it can't, fail-open).
+ */
+export interface LazyHooks {
+  readonly hints: Record<string, readonly string[] | null>
+  readonly load: () => Record<string, DispatchEventIndex> | undefined
+}
+
+let lazyHooks: LazyHooks | undefined
+let splicedIndex: Record<string, DispatchEventIndex> | undefined
+// (event, tool) → the merged list, built on first use.
+const splicedLists = new Map<string, readonly DispatchHookEntry[]>()
+
+function lookup(
+  index: DispatchEventIndex,
+  toolName: string | undefined,
+): readonly DispatchHookEntry[] {
+  return (toolName && index.byTool[toolName]) || index.any
+}
+
+function mergeBySeq(
+  a: readonly DispatchHookEntry[],
+  b: readonly DispatchHookEntry[],
+): DispatchHookEntry[] {
+  const out: DispatchHookEntry[] = []
+  let i = 0
+  let j = 0
+  while (i < a.length || j < b.length) {
+    const takeA =
+      j >= b.length || (i < a.length && (a[i]!.seq ?? 0) <= (b[j]!.seq ?? 0))
+    if (takeA) {
+      out.push(a[i]!)
+      i += 1
+    } else {
+      out.push(b[j]!)
+      j += 1
+    }
+  }
+  return out
+}
+
+/**
+ * Register the snapshot's left-out hooks; called from deserialize-main.
+ */
+export function registerLazyHooks(lazy: LazyHooks): void {
+  lazyHooks = lazy
+}
+
+/**
+ * Add a separately loaded index to every later `hooksFor`.
+ */
+export function spliceDispatchIndex(
+  extra: Record<string, DispatchEventIndex>,
+): void {
+  splicedIndex = extra
+  splicedLists.clear()
+}
+
+/**
+ * Load and splice the registered hooks if `event` + `toolName` can reach
+ * one. At most one load per process; a failed load leaves them out.
+ */
+export function ensureLazyHooks(
+  event: string,
+  toolName: string | undefined,
+): void {
+  const hint = lazyHooks?.hints[event]
+  if (
+    hint === undefined ||
+    (hint !== null && !(toolName && hint.includes(toolName)))
+  ) {
+    return
+  }
+  const { load } = lazyHooks!
+  lazyHooks = undefined
+  const loadStart = traceNow()
+  const index = load()
+  if (index) {
+    spliceDispatchIndex(index)
+  }
+  tracePhase('lazy-hooks', loadStart)
+}
+
+/**
+ * The (event, tool) list with the spliced hooks merged in by `seq`, or
+ * undefined when nothing spliced touches `event` (use `own` as is).
+ */
+export function splicedHooksFor(
+  event: string,
+  toolName: string | undefined,
+  own: DispatchEventIndex | undefined,
+): readonly DispatchHookEntry[] | undefined {
+  const extra = splicedIndex?.[event]
+  if (!extra) {
+    return undefined
+  }
+  if (!own) {
+    return lookup(extra, toolName)
+  }
+  const key = `${event}\0${toolName ?? ''}`
+  let merged = splicedLists.get(key)
+  if (!merged) {
+    merged = mergeBySeq(lookup(own, toolName), lookup(extra, toolName))
+    splicedLists.set(key, merged)
+  }
+  return merged
+}
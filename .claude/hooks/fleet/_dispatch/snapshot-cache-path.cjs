@@ -17,7 +17,9 @@
 //       tag += "-" + std::to_string(getuid())         // decimal; OMITTED on Windows
 
 const path = require('node:path')
+const crypto = require('node:crypto')
 const fs = require('node:fs')
+const os = require('node:os')
 const v8 = require('node:v8')
 
 // 8 lowercase zero-padded hex, matching Node's Uint32ToHex() — nodejs/node
@@ -47,7 +49,7 @@ function versionTag() {
 // sweep. node_modules/.cache persists until an explicit node_modules rebuild, at
 // which point the next hook-bundle build regenerates the blob; a missing blob is
 // never an error (launcher fail-opens, builder recreates). Build-time only — the
-// launcher reads the frozen snapshot-blob.path sidecar, never this module.
+// launcher reads the frozen launch.manifest, never this module.
 //
 // Walk to the workspace marker instead of assuming this file has a fixed depth:
 // the canonical template copy lives below template/base/, while the dogfooded
@@ -67,7 +69,66 @@ function findRepoRoot(start) {
   return undefined
 }
 
-function snapshotCacheDir() {
+// Opt-in SHARED store: one per-user blob store for every fleet checkout on
+// the machine, in the platform cache home (XDG_CACHE_HOME or ~/.cache,
+// ~/Library/Caches on macOS, %LOCALAPPDATA% on Windows). Blob names already
+// carry everything that decides a boot (runtime tag dir + bundle hash + flag
+// tag) and nothing about the checkout, so two repos at the same hook revision
+// resolve to the same file and share one copy on disk and in the page cache.
+// Each repo still freezes its own launch.manifest, naming the shared blob's
+// absolute path; the launcher needs nothing new.
+//
+// `FLEET_SNAPSHOT_SHARED_STORE=1` turns it on and `=0` off. Unset, the store
+// is in use exactly when its root holds the SHARED_STORE_MARKER a `=1` run
+// drops, so the opt-in sticks for every later build and for the launcher's
+// `--heal` (which runs in the hook's env, not the shell's that opted in). A
+// marker rather than the bare root: the launcher mkdir's the root for its
+// heal.lock, and that must not opt anyone in. Delete the root to opt out.
+const SHARED_STORE_ENV = 'FLEET_SNAPSHOT_SHARED_STORE'
+const SHARED_STORE_MARKER = 'shared-store'
+
+function userCacheHome() {
+  const home = os.homedir()
+  if (process.platform === 'win32') {
+    return process.env['LOCALAPPDATA'] || path.join(home, 'AppData', 'Local')
+  }
+  if (process.platform === 'darwin') {
+    return path.join(home, 'Library', 'Caches')
+  }
+  const xdg = process.env['XDG_CACHE_HOME']
+  // The XDG spec says to ignore a relative value.
+  return xdg && path.isAbsolute(xdg) ? xdg : path.join(home, '.cache')
+}
+
+function sharedStoreRoot() {
+  return path.join(userCacheHome(), 'socket-fleet', 'node-snapshot-cache')
+}
+
+function sharedStoreEnabled() {
+  const flag = process.env[SHARED_STORE_ENV]
+  const marker = path.join(sharedStoreRoot(), SHARED_STORE_MARKER)
+  if (flag === '0') {
+    return false
+  }
+  if (flag !== '1') {
+    return fs.existsSync(marker)
+  }
+  if (!fs.existsSync(marker)) {
+    try {
+      fs.mkdirSync(path.dirname(marker), { recursive: true })
+      fs.writeFileSync(marker, '')
+    } catch {
+      // Fail-open: this run still uses the store; the next may not.
+    }
+  }
+  return true
+}
+
+// The store root: the runtime dirs, access.log and heal.{lock,log} live here.
+function snapshotStoreRoot() {
+  if (sharedStoreEnabled()) {
+    return sharedStoreRoot()
+  }
   const repoRoot = findRepoRoot(__dirname)
   if (!repoRoot) {
     throw new Error('Cannot locate the fleet workspace root')
@@ -78,17 +139,213 @@ function snapshotCacheDir() {
     '.cache',
     'fleet',
     'node-snapshot-cache',
-    versionTag(),
   )
 }
 
+function snapshotCacheDir() {
+  return path.join(snapshotStoreRoot(), versionTag())
+}
+
 // Per-blob filename is content-addressed on the entry's source hash, so editing
 // a guard yields a different blob (the old one orphaned, reaped when tmpdir
 // clears) and a stale source can NEVER boot old logic: a miss falls open to the
 // non-snapshot path. This is the fail-open-correct half of "Node only validates
 // version, not payload" — content keying is ours to own.
-function blobPath(entryId, sourceHash) {
-  return path.join(snapshotCacheDir(), `${entryId}-${sourceHash}.blob`)
+//
+// A blob built under the tuned flag profile (below) carries a short hash of
+// its flags as well, so the tuned and untuned blobs of one bundle sit side
+// by side and a profile change misses cleanly instead of booting a blob V8
+// would refuse (see SNAPSHOT_NODE_FLAGS).
+function blobPath(entryId, sourceHash, nodeFlags = SNAPSHOT_NODE_FLAGS) {
+  const tag = nodeFlags.length ? `-f${flagsTag(nodeFlags)}` : ''
+  return path.join(snapshotCacheDir(), `${entryId}-${sourceHash}${tag}.blob`)
+}
+
+function flagsTag(nodeFlags) {
+  return crypto
+    .createHash('sha256')
+    .update(nodeFlags.join('\0'))
+    .digest('hex')
+    .slice(0, 8)
+}
+
+// Per-event SPLIT blobs (opt-in, build-hook-snapshot.mts --split-events): one
+// extra bundle + blob per hook event holding only that event's hooks, so a
+// PreToolUse boot deserializes its own slice instead of all ~190 hooks. The
+// full `dispatch` blob is always built beside them and stays the fallback.
+// An event name becomes part of a filename here and in the launcher, so only
+// a plain identifier qualifies — anything else just never gets a split blob.
+const SPLIT_EVENT_RE = /^[A-Za-z][A-Za-z0-9]{0,63}$/
+
+function isSplitEvent(event) {
+  return typeof event === 'string' && SPLIT_EVENT_RE.test(event)
+}
+
+function eventEntryId(event) {
+  return `dispatch-${event}`
+}
+
+// `snapshot-bundle.<Event>.cjs`, beside the full snapshot-bundle.cjs.
+function splitBundleName(event) {
+  return `snapshot-bundle.${event}.cjs`
+}
+
+// The events that currently have a split bundle in `dispatchDir`, sorted.
+function splitBundleEvents(dispatchDir) {
+  let names
+  try {
+    names = fs.readdirSync(dispatchDir)
+  } catch {
+    return []
+  }
+  const events = []
+  for (const name of names) {
+    const match = /^snapshot-bundle\.(.+)\.cjs$/.exec(name)
+    if (match && isSplitEvent(match[1])) {
+      events.push(match[1])
+    }
+  }
+  return events.sort()
+}
+
+// Node / V8 flags the blob is BUILT and BOOTED under. V8 folds its flag hash
+// into the snapshot checksum, so a blob built under one flag set refuses to
+// boot under another ("built with a different version of V8 or with different
+// V8 configurations", exit 14) — the build step passes these to
+// --build-snapshot and freezes the same list into the launcher's
+// launch.manifest, which prepends them to every snapshot boot. Empty today.
+const SNAPSHOT_NODE_FLAGS = Object.freeze([])
+
+// The benchmark-tuned flag profile (young-generation sizing, GC threads,
+// tiering) for a short-lived hook process, frozen per `<platform>-<arch>` in
+// node-flag-profile.json beside this file. `bench/tune-flags.mts` picks it:
+// a candidate is kept only when it beats the untuned boot AND its hook output
+// is byte-identical to the untuned one on every bench fixture. A profile flag
+// must be one plain `--name[=value]` token; anything else (a hand-edit gone
+// wrong) drops the whole profile, as does a missing or unreadable file.
+//
+// Fail-open happens twice. At BUILD time, build-hook-snapshot.mts first asks
+// THIS node to start under the profile and builds the tuned blob only when
+// it does (falling back to an untuned one when either step fails), and the
+// launch manifest freezes the flags of whichever blob exists (`bootBlob`),
+// with their count. At LAUNCH time a node swapped in under the frozen path
+// may still reject them (exit 9, bad option): the launchers and
+// snapshot-loader.cjs boot a tuned blob as a waited-on child and rerun the
+// event through index.cjs when it exits 9.
+const NODE_FLAG_PROFILE_FILE = 'node-flag-profile.json'
+const PROFILE_FLAG_RE = /^--[a-z][a-z0-9-]*(?:=[A-Za-z0-9._-]+)?$/
+const MAX_PROFILE_FLAGS = 16
+
+function tunedNodeFlags(platformArch = `${process.platform}-${process.arch}`) {
+  let flags
+  try {
+    const profile = JSON.parse(
+      fs.readFileSync(path.join(__dirname, NODE_FLAG_PROFILE_FILE), 'utf8'),
+    )
+    flags = profile?.profiles?.[platformArch]?.flags
+  } catch {
+    return SNAPSHOT_NODE_FLAGS
+  }
+  if (
+    !Array.isArray(flags) ||
+    flags.length > MAX_PROFILE_FLAGS ||
+    !flags.every(f => typeof f === 'string' && PROFILE_FLAG_RE.test(f))
+  ) {
+    return SNAPSHOT_NODE_FLAGS
+  }
+  return Object.freeze([...SNAPSHOT_NODE_FLAGS, ...flags])
+}
+
+// The blob to boot for (entryId, sourceHash), the flags it must boot under
+// and how many of those the tuned profile added (`tunedFlags`, 0 when none):
+// the tuned blob when one was built, else the untuned one. Either may be
+// missing; the caller's existence check falls open as before.
+function bootBlob(entryId, sourceHash) {
+  const tuned = tunedNodeFlags()
+  const tunedFlags = tuned.length - SNAPSHOT_NODE_FLAGS.length
+  if (tunedFlags > 0) {
+    const blob = blobPath(entryId, sourceHash, tuned)
+    if (fs.existsSync(blob)) {
+      return { __proto__: null, blob, nodeFlags: tuned, tunedFlags }
+    }
+  }
+  return {
+    __proto__: null,
+    blob: blobPath(entryId, sourceHash),
+    nodeFlags: SNAPSHOT_NODE_FLAGS,
+    tunedFlags: 0,
+  }
+}
+
+// Node's exit code for an option it rejects ("bad option"), before any hook
+// runs: a tuned boot that ends with it is rerun untuned.
+const NODE_BAD_OPTION_EXIT = 9
+
+// Rendezvous base for the opt-in warm daemon (dispatch-daemon.mts): the slot
+// sockets are `<base>.<n>.sock`. A socket can't live under node_modules/.cache:
+// sun_path caps at ~104 bytes and a deep repo checkout blows straight through
+// it. So on POSIX it lives in a per-uid 0700 dir under tmpdir, named by a hash
+// of the dispatch dir so two checkouts never share a daemon. tmpdir reaping
+// here is harmless — a reaped socket is just "daemon not running", the
+// launcher's ordinary fallback. Windows has no AF_UNIX rendezvous here: the
+// slots are named pipes, `\\.\pipe\fleet-dispatch-<id>.<n>.sock`, with the
+// user folded into <id> (the pipe namespace is machine-global) so the name
+// stays pure ASCII for the launcher's sidecar read.
+//
+// Slot count: one parked worker per slot. Two covers the PreToolUse →
+// PostToolUse pair a single tool call fires back to back; a third concurrent
+// event finds every slot taken and takes the launcher's execv path rather than
+// queueing behind a boot. Frozen into the daemon.path sidecar at build time.
+const DAEMON_SLOTS = 2
+
+function daemonId(dispatchDir) {
+  const owner =
+    process.platform === 'win32' ? `${os.userInfo().username}\0` : ''
+  return crypto
+    .createHash('sha256')
+    .update(owner + path.resolve(dispatchDir))
+    .digest('hex')
+    .slice(0, 12)
 }
 
-module.exports = { v8Tag, versionTag, findRepoRoot, snapshotCacheDir, blobPath }
+function daemonStateDir() {
+  const uid = typeof process.getuid === 'function' ? `-${process.getuid()}` : ''
+  return path.join(os.tmpdir(), `fleet-dispatch${uid}`)
+}
+
+function daemonSocketBase(dispatchDir) {
+  if (process.platform === 'win32') {
+    return `\\\\.\\pipe\\fleet-dispatch-${daemonId(dispatchDir)}`
+  }
+  return path.join(daemonStateDir(), daemonId(dispatchDir))
+}
+
+// The supervisor's pid file. Always a real file under tmpdir (per-user on
+// Windows already), never beside a named pipe: `\\.\pipe\` is not a
+// filesystem.
+function daemonPidPath(dispatchDir) {
+  return path.join(daemonStateDir(), `${daemonId(dispatchDir)}.pid`)
+}
+
+module.exports = {
+  v8Tag,
+  versionTag,
+  findRepoRoot,
+  SHARED_STORE_ENV,
+  sharedStoreRoot,
+  snapshotStoreRoot,
+  snapshotCacheDir,
+  blobPath,
+  bootBlob,
+  isSplitEvent,
+  eventEntryId,
+  splitBundleName,
+  splitBundleEvents,
+  SNAPSHOT_NODE_FLAGS,
+  NODE_BAD_OPTION_EXIT,
+  NODE_FLAG_PROFILE_FILE,
+  tunedNodeFlags,
+  DAEMON_SLOTS,
+  daemonPidPath,
+  daemonSocketBase,
+}
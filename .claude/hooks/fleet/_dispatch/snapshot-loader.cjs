@@ -24,7 +24,13 @@ const path = require('node:path')
 const fs = require('node:fs')
 const crypto = require('node:crypto')
 const { spawnSync } = require('node:child_process')
-const { blobPath } = require('./snapshot-cache-path.cjs')
+const {
+  NODE_BAD_OPTION_EXIT,
+  bootBlob,
+  eventEntryId,
+  isSplitEvent,
+  splitBundleName,
+} = require('./snapshot-cache-path.cjs')
 
 const DIR = __dirname
 const event = process.argv[2]
@@ -34,10 +40,26 @@ const event = process.argv[2]
 // its compile cache; we add the bundle's content hash as the filename so a guard
 // edit (new bundle → new hash) misses cleanly instead of booting stale logic.
 // Hashing the bundle is sub-millisecond against the hundreds of ms a hit saves.
-function currentBlobPath() {
-  const src = fs.readFileSync(path.join(DIR, 'snapshot-bundle.cjs'))
+// The result carries the node flags the blob was built under (the tuned
+// profile's when its blob exists), which the boot must repeat.
+function currentBlob(bundleName, entryId) {
+  const src = fs.readFileSync(path.join(DIR, bundleName))
   const sha = crypto.createHash('sha256').update(src).digest('hex').slice(0, 16)
-  return blobPath('dispatch', sha)
+  return bootBlob(entryId, sha)
+}
+
+// This event's split blob (build-hook-snapshot.mts --split-events), when its
+// bundle and blob both exist; undefined otherwise, and the full blob is used.
+function splitBlob() {
+  if (!isSplitEvent(event)) {
+    return undefined
+  }
+  try {
+    const found = currentBlob(splitBundleName(event), eventEntryId(event))
+    return fs.existsSync(found.blob) ? found : undefined
+  } catch {
+    return undefined
+  }
 }
 
 function failOpenToIndex() {
@@ -60,27 +82,33 @@ if (!event) {
 // A miss or throw anywhere here is non-fatal: the blob is a pure startup
 // optimization, so any failure to find/compute it falls open to the
 // always-correct compile-cache path rather than wedging the hook.
-let blob
-try {
-  blob = currentBlobPath()
-} catch {
-  blob = undefined
+let boot = splitBlob()
+if (!boot) {
+  try {
+    boot = currentBlob('snapshot-bundle.cjs', 'dispatch')
+  } catch {
+    boot = undefined
+  }
 }
 
-if (!blob || !hasBlobFile(blob)) {
+if (!boot || !hasBlobFile(boot.blob)) {
   failOpenToIndex()
 } else {
   // The snapshot-booted process reads the event from argv[1] (no script path in
   // a snapshot-booted argv), so pass the event as the sole arg after the flag.
   const res = spawnSync(
     process.execPath,
-    ['--snapshot-blob', blob, event],
+    [...boot.nodeFlags, '--snapshot-blob', boot.blob, event],
     { stdio: 'inherit' },
   )
   if (res.error) {
     // The blob failed to load (a version/arch/V8 mismatch slipped past the key,
     // or corruption — Node refuse-to-boots either) — fall back, don't wedge.
     failOpenToIndex()
+  } else if (boot.tunedFlags && res.status === NODE_BAD_OPTION_EXIT) {
+    // This node rejected a tuned-profile flag before any hook ran; stdin is
+    // still unread, so the event reruns untuned.
+    failOpenToIndex()
   } else {
     process.exit(res.status === null ? 0 : res.status)
   }
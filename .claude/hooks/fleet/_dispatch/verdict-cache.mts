@@ -0,0 +1,345 @@
+/**
+ * @file Cross-invocation verdict cache for PURE hooks. An agent that gets
+ *   blocked often re-issues the identical Bash command or Edit, and every
+ *   retry re-ran every hook from scratch. A hook that declares
+ *   `@dispatch-pure` in its header (verdict is a function of the event,
+ *   `tool_name`, `tool_input` and `tool_response` alone: no transcript, git,
+ *   filesystem, env or clock) gets `pure: true` in its dispatch entry, and
+ *   `dispatch()` replays its recorded verdict for a payload it has already
+ *   judged instead of running it. The maker refuses the marker on a hook
+ *   whose `defineHook` wrapping reads state anyway (convention scope,
+ *   auto-bypass, `fleetOnly`, the post-edit document); see dispatch-scan.mts.
+ *
+ *   KEY: sha256 over the code identity, the event, `tool_name`, and
+ *   `tool_input` / `tool_response` as JSON, then per hook over that plus the
+ *   hook name. The code identity is the snapshot blob's file name when booted
+ *   from one (blob names are content-addressed on the bundle), or the size +
+ *   mtime + inode of `_dist/bundle.cjs` under `index.cjs`. A dev run from
+ *   source has no identity and never caches, so an edited hook can't replay
+ *   its old verdict.
+ *
+ *   FILE: `<repo>/node_modules/.cache/fleet/verdict-cache/verdicts.bin`, a
+ *   fixed HEADER_SIZE header plus SLOT_COUNT direct-mapped SLOT_SIZE slots
+ *   (fixed layout, so a native reader can map it). A slot is chosen by the
+ *   key's first four bytes; a colliding key just evicts it. Little-endian:
+ *
+ *     header:  0  8  magic "FLTVC\0\0\2"
+ *              8  4  u32 slot size
+ *             12  4  u32 slot count
+ *     slot:    0 16  key digest (first 16 bytes)
+ *             16  8  i64 expiry, ms since the epoch
+ *             24  1  kind: 'A' allow, 'N' notify, 'B' block
+ *             25  3  reserved (0)
+ *             28  4  u32 message length in bytes
+ *             32 16  sha256(bytes 0..32 + message), first 16 bytes: a
+ *                    torn write of any field fails it
+ *             48  …  message, UTF-8
+ *
+ *   An entry lives VERDICT_TTL_MS. A verdict whose message doesn't fit the
+ *   slot, or from a hook that threw, is never stored. Fail-open: any I/O
+ *   error is a miss. Nothing is written when the repo has no
+ *   `node_modules`.
+ *
+ *   OPT-IN: `FLEET_VERDICT_CACHE=1`. Off, a dispatch pays nothing. On, every
+ *   event with a pure hook in play pays a file open, a key hash and a pread
+ *   or pwrite per pure hook, and the key JSON-encodes `tool_input`, which
+ *   materializes a lazily decoded Write/Edit body. The current pure hooks
+ *   are cheap regex nudges, so turn it on only where the dispatch bench
+ *   shows a win.
+ *
+ *   Nothing here runs at module eval (snapshot-clean).
+ */
+
+import { createHash } from 'node:crypto'
+import {
+  closeSync,
+  existsSync,
+  fstatSync,
+  ftruncateSync,
+  mkdirSync,
+  openSync,
+  readSync,
+  statSync,
+  writeSync,
+} from 'node:fs'
+import path from 'node:path'
+import process from 'node:process'
+
+import { resolveProjectDir } from '../_shared/project-dir.mts'
+
+import type { DispatchPayload, DispatchVerdict } from './dispatch-types.mts'
+
+export const VERDICT_CACHE_ENV = 'FLEET_VERDICT_CACHE'
+export const VERDICT_TTL_MS = 10 * 60 * 1000
+
+export const HEADER_SIZE = 64
+export const SLOT_SIZE = 4096
+export const SLOT_COUNT = 256
+
+const MAGIC = Buffer.from([0x46, 0x4c, 0x54, 0x56, 0x43, 0x00, 0x00, 0x02])
+const OFF_EXPIRY = 16
+const OFF_KIND = 24
+const OFF_LEN = 28
+const OFF_SUM = 32
+const OFF_MSG = 48
+const MSG_MAX = SLOT_SIZE - OFF_MSG
+const FILE_SIZE = HEADER_SIZE + SLOT_SIZE * SLOT_COUNT
+
+/**
+ * The value `VerdictMemo.get` returns for a key it has nothing for.
+ */
+export const VERDICT_MISS: unique symbol = Symbol('verdict-miss')
+
+export interface VerdictMemo {
+  close(): void
+  get(hook: string): DispatchVerdict | typeof VERDICT_MISS
+  set(hook: string, verdict: DispatchVerdict): void
+}
+
+/**
+ * What the running dispatcher code is, for the key; undefined when it isn't
+ * a built artifact.
+ */
+export function codeIdentity(
+  execArgv: readonly string[] = process.execArgv,
+  main: string | undefined = process.argv[1],
+): string | undefined {
+  const at = execArgv.indexOf('--snapshot-blob')
+  if (at !== -1 && execArgv[at + 1]) {
+    return `blob:${path.basename(execArgv[at + 1]!)}`
+  }
+  if (main && path.basename(main) === 'index.cjs') {
+    try {
+      const st = statSync(path.join(path.dirname(main), '_dist', 'bundle.cjs'), {
+        bigint: true,
+      })
+      return `bundle:${st.size}:${st.mtimeNs}:${st.ino}`
+    } catch {}
+  }
+  return undefined
+}
+
+function digest(text: string): Buffer {
+  return createHash('sha256').update(text).digest()
+}
+
+/**
+ * The per-payload half of the key. PURE.
+ */
+export function verdictBaseKey(
+  identity: string,
+  event: string,
+  payload: DispatchPayload,
+): string {
+  const response = (payload as Record<string, unknown>)['tool_response']
+  return [
+    identity,
+    event,
+    payload.tool_name ?? '',
+    JSON.stringify(payload.tool_input ?? null),
+    JSON.stringify(response ?? null),
+  ].join('\0')
+}
+
+/**
+ * The slot checksum: every field ahead of it (key, expiry, kind, reserved,
+ * length) plus the message, so a torn write of any of them misses.
+ */
+function slotSum(slot: Buffer, message: Buffer): Buffer {
+  return createHash('sha256')
+    .update(slot.subarray(0, OFF_SUM))
+    .update(message)
+    .digest()
+}
+
+/**
+ * Encode one slot, or undefined when the message doesn't fit. PURE.
+ */
+export function encodeVerdictSlot(
+  key: Buffer,
+  verdict: DispatchVerdict,
+  expiresMs: number,
+): Buffer | undefined {
+  const message = Buffer.from(verdict?.message ?? '', 'utf8')
+  if (message.length > MSG_MAX) {
+    return undefined
+  }
+  const slot = Buffer.alloc(OFF_MSG + message.length)
+  key.copy(slot, 0, 0, 16)
+  slot.writeBigInt64LE(BigInt(Math.floor(expiresMs)), OFF_EXPIRY)
+  slot[OFF_KIND] =
+    verdict === undefined ? 0x41 : verdict.kind === 'block' ? 0x42 : 0x4e
+  slot.writeUInt32LE(message.length, OFF_LEN)
+  message.copy(slot, OFF_MSG)
+  slotSum(slot, message).copy(slot, OFF_SUM, 0, 16)
+  return slot
+}
+
+/**
+ * Decode a slot read back for `key`: the verdict, or VERDICT_MISS when the
+ * slot holds another key, has expired, or is torn. PURE.
+ */
+export function decodeVerdictSlot(
+  slot: Buffer,
+  key: Buffer,
+  nowMs: number,
+): DispatchVerdict | typeof VERDICT_MISS {
+  if (slot.length < OFF_MSG || slot.compare(key, 0, 16, 0, 16) !== 0) {
+    return VERDICT_MISS
+  }
+  if (Number(slot.readBigInt64LE(OFF_EXPIRY)) <= nowMs) {
+    return VERDICT_MISS
+  }
+  const length = slot.readUInt32LE(OFF_LEN)
+  if (length > MSG_MAX || OFF_MSG + length > slot.length) {
+    return VERDICT_MISS
+  }
+  const message = slot.subarray(OFF_MSG, OFF_MSG + length)
+  const sum = slotSum(slot, message)
+  if (sum.compare(slot, OFF_SUM, OFF_SUM + 16, 0, 16) !== 0) {
+    return VERDICT_MISS
+  }
+  switch (slot[OFF_KIND]) {
+    case 0x41:
+      return undefined
+    case 0x42:
+      return {
+        __proto__: null,
+        kind: 'block',
+        message: message.toString('utf8'),
+      } as DispatchVerdict
+    case 0x4e:
+      return {
+        __proto__: null,
+        kind: 'notify',
+        message: message.toString('utf8'),
+      } as DispatchVerdict
+    default:
+      return VERDICT_MISS
+  }
+}
+
+function slotOffset(key: Buffer): number {
+  return HEADER_SIZE + (key.readUInt32LE(0) % SLOT_COUNT) * SLOT_SIZE
+}
+
+function header(): Buffer {
+  const out = Buffer.alloc(HEADER_SIZE)
+  MAGIC.copy(out, 0)
+  out.writeUInt32LE(SLOT_SIZE, 8)
+  out.writeUInt32LE(SLOT_COUNT, 12)
+  return out
+}
+
+function openCacheFile(file: string, projectDir: string): number | undefined {
+  let fd: number | undefined
+  try {
+    try {
+      fd = openSync(file, 'r+')
+    } catch {
+      if (!existsSync(path.join(projectDir, 'node_modules'))) {
+        return undefined
+      }
+      mkdirSync(path.dirname(file), { recursive: true })
+      fd = openSync(file, 'a+')
+      closeSync(fd)
+      fd = openSync(file, 'r+')
+    }
+    const want = header()
+    const got = Buffer.alloc(HEADER_SIZE)
+    const valid =
+      fstatSync(fd).size === FILE_SIZE &&
+      readSync(fd, got, 0, HEADER_SIZE, 0) === HEADER_SIZE &&
+      got.equals(want)
+    if (!valid) {
+      // New, foreign or another layout: start over.
+      ftruncateSync(fd, 0)
+      ftruncateSync(fd, FILE_SIZE)
+      writeSync(fd, want, 0, HEADER_SIZE, 0)
+    }
+    return fd
+  } catch {
+    if (fd !== undefined) {
+      try {
+        closeSync(fd)
+      } catch {}
+    }
+    return undefined
+  }
+}
+
+/**
+ * The verdict memo for one dispatch of `event` / `payload`, or undefined
+ * when caching isn't opted into, the code has no identity, or the file can't be
+ * opened. The file is opened lazily, on the first pure hook's lookup.
+ */
+export function openVerdictMemo(
+  event: string,
+  payload: DispatchPayload,
+  projectDir: string = resolveProjectDir(),
+): VerdictMemo | undefined {
+  if (process.env[VERDICT_CACHE_ENV] !== '1') {
+    return undefined
+  }
+  const identity = codeIdentity()
+  if (!identity) {
+    return undefined
+  }
+  const file = path.join(
+    projectDir,
+    'node_modules',
+    '.cache',
+    'fleet',
+    'verdict-cache',
+    'verdicts.bin',
+  )
+  let base: string | undefined
+  // undefined = not opened yet; -1 = unusable.
+  let fd: number | undefined
+  const handle = (): number => {
+    fd ??= openCacheFile(file, projectDir) ?? -1
+    return fd
+  }
+  const keyFor = (hook: string): Buffer => {
+    base ??= verdictBaseKey(identity, event, payload)
+    return digest(`${base}\0${hook}`)
+  }
+  return {
+    __proto__: null,
+    close() {
+      if (fd !== undefined && fd >= 0) {
+        try {
+          closeSync(fd)
+        } catch {}
+      }
+      fd = -1
+    },
+    get(hook: string) {
+      const h = handle()
+      if (h < 0) {
+        return VERDICT_MISS
+      }
+      try {
+        const key = keyFor(hook)
+        const slot = Buffer.alloc(SLOT_SIZE)
+        const n = readSync(h, slot, 0, SLOT_SIZE, slotOffset(key))
+        return decodeVerdictSlot(slot.subarray(0, n), key, Date.now())
+      } catch {
+        return VERDICT_MISS
+      }
+    },
+    set(hook: string, verdict: DispatchVerdict) {
+      const h = handle()
+      if (h < 0) {
+        return
+      }
+      try {
+        const key = keyFor(hook)
+        const slot = encodeVerdictSlot(key, verdict, Date.now() + VERDICT_TTL_MS)
+        if (slot) {
+          writeSync(h, slot, 0, slot.length, slotOffset(key))
+        }
+      } catch {}
+    },
+  } as VerdictMemo
+}
@@ -11,29 +11,47 @@
  *   2. Pure ledger core (`pruneLedger`, `isActorLive`, `lookupPath`) — all
  *      IO-free so tests run without a real filesystem or clock.
  *
- *   3. Thin fs shell (`readActorLedger`, `writeActorLedger`,
- *      `listOtherActorLedgerPaths`, `sweepStaleLedgers`) — wraps the pure
- *      core with real disk IO under `node_modules/.cache/fleet/socket-active-edits/`
- *      (dep-0 runtime-state store; never tracked).
+ *   3. Thin fs shell (`readActorLedger`, `appendActorEdit`,
+ *      `writeActorLedger`, `listOtherActorLedgerPaths`, `sweepStaleLedgers`) —
+ *      wraps the pure core with real disk IO under
+ *      `node_modules/.cache/fleet/socket-active-edits/` (dep-0 runtime-state
+ *      store; never tracked).
+ *
+ * On disk each actor owns one append-only log, `<actorId>.log`
+ * (`append-log.mts`): one `<epoch ms>\t<JSON path>` line per edit, oldest
+ * first. The recorder appends a line instead of rewriting the file. Several
+ * processes append to one log (a subagent's edits land in its parent's
+ * ledger), so once it passes COMPACT_BYTES it is compacted with `compactLog`:
+ * the log is set aside and its index (one `=`-marked line per live path, the
+ * path → last-write index) appended to the fresh log, so an append made
+ * meanwhile is kept. Edit lines are in time order, so
+ * `readActorLedger(file, since)` reads backwards only to the first edit older
+ * than `since` — a collision check over a 5-minute window touches the last
+ * few lines of each foreign log, not its whole history. Index lines can sit
+ * after newer edits, so they never end that read, and every read keeps the
+ * newest time per path whatever order the lines come in.
  *
  * Fail-open contract: every function returns a safe default on IO / parse
  * errors. A broken ledger must never block a tool call.
  */
 
 import crypto from 'node:crypto'
-import {
-  existsSync,
-  mkdirSync,
-  readdirSync,
-  readFileSync,
-  statSync,
-  writeFileSync,
-} from 'node:fs'
+import { existsSync, readdirSync, statSync } from 'node:fs'
 import path from 'node:path'
 
 import { safeDeleteSync } from '@socketsecurity/lib-stable/fs/safe'
 import { normalizePath } from '@socketsecurity/lib-stable/paths/normalize'
 
+import {
+  COMPACT_LOCK_SUFFIX,
+  COMPACTING_SUFFIX,
+  appendLogLine,
+  compactLog,
+  logSize,
+  readCompactingLogTail,
+  rewriteLog,
+} from './append-log.mts'
+
 // TTL after which a ledger file is considered stale (actor exited or idle).
 // 15 minutes — generous enough for a slow turn; tight enough to not persist
 // across the next session started in the same project.
@@ -56,6 +74,16 @@ export const CHILD_LIVE_WINDOW_MS = 5 * 60 * 1000
 // tracked. Falls back to OS temp when node_modules/.cache is unavailable.
 const STORE_NAME = 'socket-active-edits'
 
+const LEDGER_EXT = '.log'
+// A log set aside mid-compaction: its actor is still live until it's folded.
+const ASIDE_EXT = `${LEDGER_EXT}${COMPACTING_SUFFIX}`
+// The pre-log whole-file JSON ledgers; only ever swept now.
+const LEGACY_LEDGER_EXT = '.json'
+
+// A log past this size is compacted on the next append. ~1000 edit lines:
+// many turns of history, yet a full read stays one small file read.
+export const COMPACT_BYTES = 64 * 1024
+
 /**
  * The on-disk shape for one actor's ledger. `paths` maps repo-relative
  * normalized path → last-write epoch (ms). `updatedAt` is the ledger's own
@@ -117,7 +145,7 @@ export function resolveStoreRoot(projectDir: string | undefined): string {
  * Resolve the ledger file path for a given actor ID + store root.
  */
 export function ledgerFilePath(storeRoot: string, actorId: string): string {
-  return path.join(storeRoot, `${actorId}.json`)
+  return path.join(storeRoot, `${actorId}${LEDGER_EXT}`)
 }
 
 // ── Pure ledger core ──────────────────────────────────────────────────────
@@ -223,55 +251,136 @@ export function recordPath(
 
 // ── Thin fs shell ─────────────────────────────────────────────────────────
 
+// Prefix of a compaction's index lines (`compactLog`): appended after
+// whatever edits landed during the compaction, so out of time order.
+const INDEX_MARK = '='
+
+function formatEdit(normalizedPath: string, ts: number): string {
+  return `${ts}\t${JSON.stringify(normalizedPath)}`
+}
+
 /**
- * Parse and return one actor's ledger from disk. Returns `undefined` on
- * missing file, parse error, or malformed shape. Fail-open.
+ * One log line as [path, ts, indexed]; `indexed` for a compaction's index
+ * line. Undefined for a torn or foreign line.
  */
-export function readActorLedger(filePath: string): ActorLedger | undefined {
-  if (!existsSync(filePath)) {
+function parseEdit(line: string): [string, number, boolean] | undefined {
+  const tab = line.indexOf('\t')
+  if (tab === -1) {
+    return undefined
+  }
+  const indexed = line.startsWith(INDEX_MARK)
+  const ts = Number(line.slice(indexed ? INDEX_MARK.length : 0, tab))
+  if (!Number.isFinite(ts)) {
     return undefined
   }
-  let raw: string
   try {
-    raw = readFileSync(filePath, 'utf8')
+    const p = JSON.parse(line.slice(tab + 1)) as unknown
+    return typeof p === 'string' ? [p, ts, indexed] : undefined
   } catch {
     return undefined
   }
-  try {
-    const parsed = JSON.parse(raw)
-    if (
-      !parsed ||
-      typeof parsed !== 'object' ||
-      typeof parsed.actorId !== 'string' ||
-      typeof parsed.updatedAt !== 'number' ||
-      !parsed.paths ||
-      typeof parsed.paths !== 'object'
-    ) {
-      return undefined
+}
+
+/**
+ * Read one actor's ledger from its log, counting a compaction's set-aside
+ * copy (`readCompactingLogTail`). With `since`, reads backwards only until an
+ * edit older than `since`: `paths` then holds just the newer edits, while
+ * `updatedAt` is still the newest edit's time. Returns `undefined` on a
+ * missing or empty log. Fail-open.
+ */
+export function readActorLedger(
+  filePath: string,
+  since?: number | undefined,
+): ActorLedger | undefined {
+  const paths: Record<string, number> = {}
+  let updatedAt: number | undefined
+  readCompactingLogTail(filePath, line => {
+    const edit = parseEdit(line)
+    if (!edit) {
+      return true
     }
-    return parsed as ActorLedger
-  } catch {
+    const { 0: p, 1: ts, 2: indexed } = edit
+    if (updatedAt === undefined || ts > updatedAt) {
+      updatedAt = ts
+    }
+    if (since !== undefined && ts < since) {
+      // Every edit line before an old one is older still; an index line
+      // can precede newer edits made while the log was compacting.
+      return indexed
+    }
+    // Newest wins: a compaction can leave a path's lines out of order.
+    if (paths[p] === undefined || ts > paths[p]) {
+      paths[p] = ts
+    }
+    return true
+  })
+  if (updatedAt === undefined) {
     return undefined
   }
+  return {
+    actorId: path.basename(filePath, LEDGER_EXT),
+    paths,
+    updatedAt,
+  }
 }
 
 /**
- * Flush an actor's ledger to disk. Creates the store directory if needed.
- * Fail-open: swallows all IO errors (a broken store must not block edits).
+ * Replace an actor's log with `ledger`'s index: one line per path, in
+ * last-write order. Creates the store directory if needed. Single-writer
+ * (`rewriteLog`): an append another process makes meanwhile is lost, so the
+ * recorder compacts with `compactLog` instead. Fail-open: swallows all IO
+ * errors (a broken store must not block edits).
  */
 export function writeActorLedger(filePath: string, ledger: ActorLedger): void {
-  try {
-    mkdirSync(path.dirname(filePath), { recursive: true })
-    writeFileSync(filePath, JSON.stringify(ledger), 'utf8')
-  } catch {
-    // Fail-open.
+  const entries = Object.entries(ledger.paths).toSorted(
+    (a, b) => a[1] - b[1] || a[0].localeCompare(b[0]),
+  )
+  rewriteLog(filePath, entries.map(({ 0: p, 1: ts }) => formatEdit(p, ts)))
+}
+
+/**
+ * Record that this actor wrote `normalizedPath` at `now`: one appended line,
+ * plus a compaction (stale paths dropped, one index line per path) once the
+ * log passes COMPACT_BYTES. Fail-open.
+ */
+export function appendActorEdit(
+  filePath: string,
+  normalizedPath: string,
+  config: { now: number; ttlMs: number },
+): void {
+  const { now, ttlMs } = { __proto__: null, ...config } as typeof config
+  if (!appendLogLine(filePath, formatEdit(normalizedPath, now))) {
+    return
   }
+  if (logSize(filePath) <= COMPACT_BYTES) {
+    return
+  }
+  // Another actor's subagent may be appending too: compactLog keeps its
+  // lines, and the newest-wins fold doesn't mind order or repeats.
+  const threshold = now - ttlMs
+  compactLog(filePath, lines => {
+    const paths: Record<string, number> = {}
+    for (let i = 0, { length } = lines; i < length; i += 1) {
+      const edit = parseEdit(lines[i]!)
+      if (
+        edit &&
+        edit[1] >= threshold &&
+        (paths[edit[0]] === undefined || edit[1] > paths[edit[0]]!)
+      ) {
+        paths[edit[0]] = edit[1]
+      }
+    }
+    return Object.entries(paths)
+      .toSorted((a, b) => a[1] - b[1] || a[0].localeCompare(b[0]))
+      .map(({ 0: p, 1: ts }) => `${INDEX_MARK}${formatEdit(p, ts)}`)
+  })
 }
 
 /**
  * List all actor ledger files in the store EXCEPT the one belonging to
- * `ownActorId`. Returns full file paths. Fail-open: returns empty array on
- * any IO error.
+ * `ownActorId`. Returns full `.log` paths, one per actor, including an actor
+ * whose log is set aside mid-compaction (`readActorLedger` reads both).
+ * Fail-open: returns empty array on any IO error.
  */
 export function listOtherActorLedgerPaths(
   storeRoot: string,
@@ -283,15 +392,23 @@ export function listOtherActorLedgerPaths(
     }
     const entries = readdirSync(storeRoot)
     const out: string[] = []
+    const seen = new Set<string>()
     for (const entry of entries) {
-      if (!entry.endsWith('.json')) {
+      // A log set aside mid-compaction may have no fresh log yet.
+      const ext = entry.endsWith(LEDGER_EXT)
+        ? LEDGER_EXT
+        : entry.endsWith(ASIDE_EXT)
+          ? ASIDE_EXT
+          : undefined
+      if (!ext) {
         continue
       }
-      const actorId = entry.slice(0, -5)
-      if (actorId === ownActorId) {
+      const actorId = entry.slice(0, -ext.length)
+      if (actorId === ownActorId || seen.has(actorId)) {
         continue
       }
-      out.push(path.join(storeRoot, entry))
+      seen.add(actorId)
+      out.push(ledgerFilePath(storeRoot, actorId))
     }
     return out
   } catch {
@@ -300,9 +417,11 @@ export function listOtherActorLedgerPaths(
 }
 
 /**
- * Expire ledger files whose mtime is past `ttlMs`. Fire-and-forget; errors
- * are suppressed. Runs opportunistically from the recorder hook to bound
- * store growth.
+ * Expire ledger files whose mtime is past `ttlMs` (a log's mtime is its last
+ * append), a dead compaction's lock and set-aside copy included, along with
+ * any left-over pre-log `.json` ledger. Fire-and-forget; errors are
+ * suppressed. Runs opportunistically from the recorder hook to bound store
+ * growth.
  */
 export function sweepStaleLedgers(
   storeRoot: string,
@@ -315,14 +434,20 @@ export function sweepStaleLedgers(
     }
     const entries = readdirSync(storeRoot)
     for (const entry of entries) {
-      if (!entry.endsWith('.json')) {
+      if (
+        !entry.endsWith(LEDGER_EXT) &&
+        !entry.endsWith(ASIDE_EXT) &&
+        !entry.endsWith(`${LEDGER_EXT}${COMPACT_LOCK_SUFFIX}`) &&
+        !entry.endsWith(LEGACY_LEDGER_EXT) &&
+        !entry.endsWith('.tmp')
+      ) {
         continue
       }
       const fp = path.join(storeRoot, entry)
       try {
         // oxlint-disable-next-line socket/prefer-exists-sync -- statSync for mtime, not just existence; we need the modification timestamp
         const stat = statSync(fp)
-        if (now - stat.mtimeMs > ttlMs) {
+        if (entry.endsWith(LEGACY_LEDGER_EXT) || now - stat.mtimeMs > ttlMs) {
           safeDeleteSync(fp)
         }
       } catch {
@@ -12,8 +12,14 @@
 // human-readable doctrine (with fixes) is that file; this is its enforceable
 // subset.
 
+import { mayMatch, registerLiterals } from './pattern-engine.mts'
+
 export interface SlopPattern {
   readonly label: string
+  // Substrings at least one of which every match contains (case-insensitive,
+  // like the regex): the shared prefilter skips the regex on text that has
+  // none of them. See pattern-engine.mts.
+  readonly literals: readonly string[]
   readonly regex: RegExp
   readonly why: string
 }
@@ -21,6 +27,13 @@ export interface SlopPattern {
 export const AI_SLOP_PATTERNS: readonly SlopPattern[] = [
   {
     label: 'purple-prose word',
+    literals: [
+      'delve',
+      'ever-evolving',
+      'paradigm shift',
+      'supercharge',
+      'tapestry',
+    ],
     // Two alternatives: a word-boundary-anchored set of single slop words
     // (delve / ever-evolving / supercharge / tapestry), or the fixed two-word
     // phrase "paradigm shift". Case-insensitive.
@@ -30,6 +43,13 @@ export const AI_SLOP_PATTERNS: readonly SlopPattern[] = [
   },
   {
     label: 'importance puffery',
+    literals: [
+      'marks a pivotal moment',
+      'plays a vital role',
+      'solidifies its ',
+      'stands as a testament',
+      'underscores its significance',
+    ],
     // One word-boundary-anchored alternation of fixed puffery phrases;
     // "solidifies its" accepts either "place" or "position". Case-insensitive.
     regex:
@@ -38,6 +58,12 @@ export const AI_SLOP_PATTERNS: readonly SlopPattern[] = [
   },
   {
     label: 'weasel attribution',
+    literals: [
+      'experts agree',
+      'industry reports suggest',
+      'studies show',
+      'widely regarded as',
+    ],
     // One word-boundary-anchored alternation of fixed sourceless-attribution
     // phrases. Case-insensitive.
     regex:
@@ -46,6 +72,7 @@ export const AI_SLOP_PATTERNS: readonly SlopPattern[] = [
   },
   {
     label: 'colon reveal',
+    literals: ['best part:', 'kicker:'],
     // "the best part" or "here's the kicker/best part", each immediately
     // followed by a colon (the reveal). Case-insensitive.
     regex: /\b(?:here's the (?:best part|kicker)|the best part):/i,
@@ -53,6 +80,7 @@ export const AI_SLOP_PATTERNS: readonly SlopPattern[] = [
   },
   {
     label: 'faux-insight setup',
+    literals: ['the part everyone misses', 'what most people ', 'what nobody '],
     // Two alternatives: "what most people/nobody get(s) wrong / tell(s) you"
     // (optional plural s), or the fixed phrase "the part everyone misses".
     regex:
@@ -61,6 +89,7 @@ export const AI_SLOP_PATTERNS: readonly SlopPattern[] = [
   },
   {
     label: 'summary-recap ending',
+    literals: ['at the end of the day', 'in conclusion', 'in summary'],
     // A recap opener (In conclusion / In summary / At the end of the day) at
     // the start of the content or of any line (leading whitespace allowed).
     regex: /(?:^|\n)\s*(?:At the end of the day|In conclusion|In summary)\b/i,
@@ -68,6 +97,11 @@ export const AI_SLOP_PATTERNS: readonly SlopPattern[] = [
   },
 ]
 
+for (let i = 0, { length } = AI_SLOP_PATTERNS; i < length; i += 1) {
+  const { literals, regex } = AI_SLOP_PATTERNS[i]!
+  registerLiterals(regex, literals)
+}
+
 /**
  * Scan `content` for AI-slop tells. Returns the matched patterns (empty when
  * clean). Every regex is stateless (no /g), so `.test` is safe across calls.
@@ -76,7 +110,7 @@ export function findAiSlop(content: string): SlopPattern[] {
   const hits: SlopPattern[] = []
   for (let i = 0, { length } = AI_SLOP_PATTERNS; i < length; i += 1) {
     const pattern = AI_SLOP_PATTERNS[i]!
-    if (pattern.regex.test(content)) {
+    if (mayMatch(pattern.regex, content) && pattern.regex.test(content)) {
       hits.push(pattern)
     }
   }
@@ -0,0 +1,314 @@
+/*
+ * @file Append-only line logs for the runtime-state ledgers
+ *   (`active-edits-ledger.mts`, `learning-ledger.mts`). Those used to
+ *   read-parse-stringify-rewrite a whole JSON file per record, so every
+ *   Edit/Write paid for the ledger's full size, and two processes rewriting
+ *   the same file could each drop the other's record.
+ *
+ *   A log here is one record per `\n`-terminated line:
+ *
+ *   - `appendLogLine` writes a record with ONE `O_APPEND` write. A short
+ *     line lands whole at the current end and never interleaves with another
+ *     process's, so concurrent writers can't clobber each other.
+ *   - `readLogTail` visits lines newest first, reading backwards from the
+ *     end in fixed chunks, and stops as soon as the visitor returns false.
+ *     When records are appended in time order, a reader asking "anything
+ *     since T" reads only the lines newer than T, however long the log is.
+ *   - `rewriteLog` replaces the whole log through a temp file + rename. It is
+ *     used for compaction once `logSize` passes the owner's threshold. A
+ *     reader sees either the old log or the new one, never a mix. Only safe
+ *     for a log with one writer: another process's append that lands between
+ *     the owner's read and the rename is lost.
+ *   - `compactLog` is the compaction for a log several processes append to.
+ *     It never replaces the live log: it sets it aside, folds that, and
+ *     appends the fold to the fresh log, so it needs an owner whose fold
+ *     doesn't care about line order or a line read twice. Readers of such a
+ *     log use `readCompactingLogLines` / `readCompactingLogTail`.
+ *
+ *   A torn line (a writer killed mid-append) is just a line its owner fails to
+ *   parse and skips. Fail-open throughout: a log that can't be read reads as
+ *   empty, and a write that fails is dropped.
+ */
+
+import {
+  appendFileSync,
+  closeSync,
+  existsSync,
+  fstatSync,
+  mkdirSync,
+  openSync,
+  readFileSync,
+  readSync,
+  renameSync,
+  statSync,
+  writeFileSync,
+} from 'node:fs'
+import path from 'node:path'
+import process from 'node:process'
+
+import { safeDeleteSync } from '@socketsecurity/lib-stable/fs/safe'
+
+// Backward read granularity: one chunk covers a few hundred short records.
+const TAIL_CHUNK_BYTES = 16 * 1024
+
+const NEWLINE = 0x0a
+
+// A compaction lock older than this belongs to a compactor that died.
+const COMPACT_LOCK_STALE_MS = 30 * 1000
+
+/**
+ * Suffixes `compactLog` adds to a log's name: its lock, and the set-aside
+ * copy it folds. A store that sweeps or lists its logs by extension has to
+ * know both.
+ */
+export const COMPACT_LOCK_SUFFIX = '.compact'
+export const COMPACTING_SUFFIX = '.compacting'
+
+/**
+ * Append one record. `line` must not contain a newline. Fail-open: false
+ * when the write failed.
+ */
+export function appendLogLine(file: string, line: string): boolean {
+  try {
+    mkdirSync(path.dirname(file), { recursive: true })
+    appendFileSync(file, `${line}\n`, 'utf8')
+    return true
+  } catch {
+    return false
+  }
+}
+
+/**
+ * Append several records in ONE `O_APPEND` write, so they land together.
+ * No line may contain a newline. Fail-open: false when the write failed.
+ */
+export function appendLogLines(
+  file: string,
+  lines: readonly string[],
+): boolean {
+  if (!lines.length) {
+    return true
+  }
+  return appendLogLine(file, lines.join('\n'))
+}
+
+/**
+ * Visit the log's lines newest first until `visit` returns false. Blank lines
+ * are skipped. Reads only as far back as the visitor goes.
+ */
+export function readLogTail(
+  file: string,
+  visit: (line: string) => boolean,
+): void {
+  let fd: number | undefined
+  try {
+    fd = openSync(file, 'r')
+    let pos = fstatSync(fd).size
+    let carry = Buffer.alloc(0)
+    while (pos > 0) {
+      const n = Math.min(TAIL_CHUNK_BYTES, pos)
+      pos -= n
+      const chunk = Buffer.alloc(n)
+      let filled = 0
+      while (filled < n) {
+        const got = readSync(fd, chunk, filled, n - filled, pos + filled)
+        if (got <= 0) {
+          return
+        }
+        filled += got
+      }
+      const buf = carry.length ? Buffer.concat([chunk, carry]) : chunk
+      let end = buf.length
+      while (end > 0) {
+        const nl = buf.lastIndexOf(NEWLINE, end - 1)
+        if (nl === -1) {
+          break
+        }
+        if (nl + 1 < end && !visit(buf.toString('utf8', nl + 1, end))) {
+          return
+        }
+        end = nl
+      }
+      carry = buf.subarray(0, end)
+    }
+    if (carry.length) {
+      visit(carry.toString('utf8'))
+    }
+  } catch {
+    // Fail-open: whatever was visited stands.
+  } finally {
+    if (fd !== undefined) {
+      try {
+        closeSync(fd)
+      } catch {}
+    }
+  }
+}
+
+/**
+ * Every line of the log, oldest first, blanks dropped. Empty on any error.
+ */
+export function readLogLines(file: string): string[] {
+  try {
+    return readFileSync(file, 'utf8')
+      .split('\n')
+      .filter(line => line.length > 0)
+  } catch {
+    return []
+  }
+}
+
+/**
+ * Replace the log with `lines` through a same-dir temp file + rename.
+ * Fail-open: false when the rewrite failed and the old log is untouched.
+ */
+export function rewriteLog(file: string, lines: readonly string[]): boolean {
+  const tmp = `${file}.${process.pid}.tmp`
+  try {
+    mkdirSync(path.dirname(file), { recursive: true })
+    writeFileSync(tmp, lines.length ? `${lines.join('\n')}\n` : '', 'utf8')
+    renameSync(tmp, file)
+    return true
+  } catch {
+    try {
+      safeDeleteSync(tmp, { force: true })
+    } catch {}
+    return false
+  }
+}
+
+/**
+ * The log's size in bytes; 0 when it doesn't exist.
+ */
+export function logSize(file: string): number {
+  try {
+    // oxlint-disable-next-line socket/prefer-exists-sync -- statSync for the size, not just existence
+    return statSync(file).size
+  } catch {
+    return 0
+  }
+}
+
+function compactingPath(file: string): string {
+  return `${file}${COMPACTING_SUFFIX}`
+}
+
+/**
+ * Whether the log exists, counting a compaction's set-aside copy.
+ */
+export function logExists(file: string): boolean {
+  return existsSync(file) || existsSync(compactingPath(file))
+}
+
+/**
+ * `readLogLines` for a log compacted by `compactLog`: the set-aside copy of
+ * a compaction in flight (or left by a crashed one) first, then the live
+ * log. A line can show up twice while a compaction finishes; the owner's
+ * fold absorbs that.
+ */
+export function readCompactingLogLines(file: string): string[] {
+  const aside = compactingPath(file)
+  return existsSync(aside)
+    ? [...readLogLines(aside), ...readLogLines(file)]
+    : readLogLines(file)
+}
+
+/**
+ * `readLogTail` for a log compacted by `compactLog`: the live log newest
+ * first, then (when the visitor hasn't stopped) the set-aside copy of a
+ * compaction in flight, whose lines all predate the live log's appends.
+ */
+export function readCompactingLogTail(
+  file: string,
+  visit: (line: string) => boolean,
+): void {
+  let stopped = false
+  const until = (line: string) => {
+    stopped = !visit(line)
+    return !stopped
+  }
+  readLogTail(file, until)
+  const aside = compactingPath(file)
+  if (!stopped && existsSync(aside)) {
+    readLogTail(aside, until)
+  }
+}
+
+function takeCompactLock(lock: string): boolean {
+  for (let attempt = 0; attempt < 2; attempt += 1) {
+    try {
+      closeSync(openSync(lock, 'wx'))
+      return true
+    } catch {}
+    try {
+      // oxlint-disable-next-line socket/prefer-exists-sync -- statSync for the lock's age, not just existence
+      if (Date.now() - statSync(lock).mtimeMs < COMPACT_LOCK_STALE_MS) {
+        return false
+      }
+      safeDeleteSync(lock, { force: true })
+    } catch {
+      return false
+    }
+  }
+  return false
+}
+
+/**
+ * Compact a log that several processes append to, without losing any of
+ * their lines. `compact` maps the folded lines to their replacement; the
+ * owner's fold must read the same whatever the line order and when a line
+ * is read twice.
+ *
+ *   1. `<file>.compact` is created O_EXCL, so one compactor runs at a time.
+ *      A lock older than COMPACT_LOCK_STALE_MS is a dead compactor's.
+ *   2. The live log is renamed to `<file>.compacting`. Appends from then on
+ *      create a fresh log; readers fold both (`readCompactingLogLines`).
+ *   3. The set-aside lines are compacted and the result APPENDED to the
+ *      fresh log in one write, so an append made meanwhile stays.
+ *   4. Bytes a writer still holding the old file landed after step 3's read
+ *      are carried over too, then the set-aside copy is dropped.
+ *
+ * A compactor that dies leaves `<file>.compacting`; readers still fold it,
+ * and the next compaction finishes it instead of setting the log aside
+ * again. False when another compaction holds the lock or a step failed (the
+ * lines are then all still on disk).
+ */
+export function compactLog(
+  file: string,
+  compact: (lines: readonly string[]) => string[],
+): boolean {
+  const lock = `${file}${COMPACT_LOCK_SUFFIX}`
+  const aside = compactingPath(file)
+  try {
+    mkdirSync(path.dirname(file), { recursive: true })
+  } catch {}
+  if (!takeCompactLock(lock)) {
+    return false
+  }
+  try {
+    if (!existsSync(aside)) {
+      renameSync(file, aside)
+    }
+    const folded = readFileSync(aside)
+    const lines = folded
+      .toString('utf8')
+      .split('\n')
+      .filter(line => line.length > 0)
+    if (!appendLogLines(file, compact(lines))) {
+      return false
+    }
+    const late = readFileSync(aside).subarray(folded.length).toString('utf8')
+    const lateLines = late.split('\n').filter(line => line.length > 0)
+    if (!appendLogLines(file, lateLines)) {
+      return false
+    }
+    safeDeleteSync(aside, { force: true })
+    return true
+  } catch {
+    return false
+  } finally {
+    try {
+      safeDeleteSync(lock, { force: true })
+    } catch {}
+  }
+}
@@ -0,0 +1,225 @@
+/**
+ * @file Per-dispatch parse cache for the AST helpers. One Edit / Write of a
+ *   `.mts` file reaches up to eight acorn-WASM guards in the same dispatch,
+ *   and each used to parse the same text on its own. `parseSource(source,
+ *   options)` parses once per distinct (source, parse options) and hands every
+ *   caller the same `ParsedSource`: the AST, the parser's comment records, and
+ *   indexes built on first use — every node in walk order, nodes by type,
+ *   `splitLines` output, and a line-start table so offset → line / column is
+ *   a binary search instead of a rescan from offset 0.
+ *
+ *   `tryParse` / `walkSimple` (core.mts), `walkComments` (comments.mts) and
+ *   the `calls` / `literals` detectors all go through here, so a hook that
+ *   keeps calling them directly shares the work. The parse always collects
+ *   comments: the record is shared between hooks that want them and hooks
+ *   that don't, and collecting is cheap next to a second parse.
+ *
+ *   The AST and every index are SHARED — read them, never mutate them.
+ *   Small and recency-ordered like `parseCommands`' memo: a dispatch sees one
+ *   edited document, a long-lived daemon one per event, and a check script
+ *   walking a tree only ever needs the file in hand.
+ */
+
+import type { AcornNode, ParseOptions } from './core.mts'
+import { DEFAULT_PARSE_OPTIONS, parseWasm, splitLines } from './core.mts'
+
+const PARSE_MEMO_SIZE = 4
+
+export interface ParsedSource {
+  /**
+   * The root node, or undefined when the parser rejected the source.
+   */
+  readonly ast: AcornNode | undefined
+  /**
+   * The parser's comment records (`collectComments`), or undefined when the
+   * parse failed.
+   */
+  readonly comments: readonly unknown[] | undefined
+  /**
+   * `splitLines(source)`.
+   */
+  readonly lines: readonly string[]
+  /**
+   * Every node, children before parents (the order a simple walk calls its
+   * visitors in). Empty when the parse failed.
+   */
+  readonly nodes: readonly AcornNode[]
+  readonly source: string
+  /**
+   * 1-based line + 0-based column of `offset`; same answer as
+   * `offsetToLineCol(source, offset)`.
+   */
+  lineColOf(offset: number): { line: number; column: number }
+  /**
+   * The nodes of one `type`, in `nodes` order.
+   */
+  nodesOfType(type: string): readonly AcornNode[]
+}
+
+const parseMemo = new Map<string, Map<string, ParsedSource>>()
+
+// Only the options that change the parse: callers pass extras (a lint rule
+// name, `comments`) through the same bag.
+function parserConfig(options: ParseOptions | undefined): ParseOptions {
+  const o = { __proto__: null, ...DEFAULT_PARSE_OPTIONS, ...options }
+  return {
+    __proto__: null,
+    ecmaVersion: o.ecmaVersion,
+    jsx: o.jsx,
+    sourceType: o.sourceType,
+    typescript: o.typescript,
+  } as ParseOptions
+}
+
+function optionsKey(config: ParseOptions): string {
+  return `${config.ecmaVersion}:${config.sourceType}:${config.typescript ? 1 : 0}:${config.jsx ? 1 : 0}`
+}
+
+function isNode(value: unknown): value is AcornNode {
+  return (
+    !!value &&
+    typeof value === 'object' &&
+    typeof (value as AcornNode).type === 'string' &&
+    typeof (value as AcornNode).start === 'number'
+  )
+}
+
+// Every node under `root`, post-order. Generic over the node's own fields, so
+// TypeScript-only node types are reached too.
+function collectNodes(root: AcornNode): AcornNode[] {
+  const out: AcornNode[] = []
+  const visit = (node: AcornNode): void => {
+    const keyList = Object.keys(node)
+    for (let j = 0, { length: jlen } = keyList; j < jlen; j += 1) {
+      const key = keyList[j]!
+      if (key === 'parent' || (node === root && key === 'comments')) {
+        continue
+      }
+      const child = node[key]
+      if (Array.isArray(child)) {
+        for (let i = 0, { length } = child; i < length; i += 1) {
+          if (isNode(child[i])) {
+            visit(child[i] as AcornNode)
+          }
+        }
+      } else if (isNode(child)) {
+        visit(child)
+      }
+    }
+    out.push(node)
+  }
+  visit(root)
+  return out
+}
+
+// Offset of the first character of every line, by the same `\r\n` / `\n` /
+// `\r` rules as `offsetToLineCol`.
+function lineStartsOf(source: string): number[] {
+  const starts = [0]
+  for (let i = 0, { length } = source; i < length; i += 1) {
+    const code = source.charCodeAt(i)
+    if (code === 13 /* \r */) {
+      if (source.charCodeAt(i + 1) === 10) {
+        i += 1
+      }
+      starts.push(i + 1)
+    } else if (code === 10 /* \n */) {
+      starts.push(i + 1)
+    }
+  }
+  return starts
+}
+
+function createParsed(source: string, config: ParseOptions): ParsedSource {
+  let ast: AcornNode | undefined
+  try {
+    ast = parseWasm(source, {
+      __proto__: null,
+      ...config,
+      collectComments: true,
+    } as unknown as ParseOptions)
+  } catch {
+    // Fragment or syntax error: callers fail open on `ast === undefined`.
+  }
+  const rawComments = ast?.['comments']
+  let byType: Map<string, AcornNode[]> | undefined
+  let lines: string[] | undefined
+  let lineStarts: number[] | undefined
+  let nodes: AcornNode[] | undefined
+  const parsed: ParsedSource = {
+    __proto__: null,
+    ast,
+    comments: Array.isArray(rawComments) ? rawComments : undefined,
+    get lines() {
+      lines ??= splitLines(source)
+      return lines
+    },
+    get nodes() {
+      nodes ??= ast ? collectNodes(ast) : []
+      return nodes
+    },
+    source,
+    lineColOf(offset: number) {
+      lineStarts ??= lineStartsOf(source)
+      const at = Math.min(Math.max(offset, 0), source.length)
+      let lo = 0
+      let hi = lineStarts.length - 1
+      while (lo < hi) {
+        const mid = (lo + hi + 1) >> 1
+        if (lineStarts[mid]! <= at) {
+          lo = mid
+        } else {
+          hi = mid - 1
+        }
+      }
+      return { line: lo + 1, column: offset - lineStarts[lo]! }
+    },
+    nodesOfType(type: string) {
+      if (!byType) {
+        byType = new Map()
+        const all = parsed.nodes
+        for (let i = 0, { length } = all; i < length; i += 1) {
+          const node = all[i]!
+          let list = byType.get(node.type)
+          if (!list) {
+            list = []
+            byType.set(node.type, list)
+          }
+          list.push(node)
+        }
+      }
+      return byType.get(type) ?? []
+    },
+  } as ParsedSource
+  return parsed
+}
+
+/**
+ * The shared parse of `source` under `options` (defaults as `tryParse`).
+ * Same object for every call with the same text and parse options while it
+ * stays in the memo.
+ */
+export function parseSource(
+  source: string,
+  options?: ParseOptions | undefined,
+): ParsedSource {
+  const config = parserConfig(options)
+  const key = optionsKey(config)
+  let byOptions = parseMemo.get(source)
+  if (byOptions) {
+    // Refresh recency: Map iteration order is insertion order.
+    parseMemo.delete(source)
+  } else {
+    byOptions = new Map()
+    if (parseMemo.size >= PARSE_MEMO_SIZE) {
+      parseMemo.delete(parseMemo.keys().next().value!)
+    }
+  }
+  parseMemo.set(source, byOptions)
+  let parsed = byOptions.get(key)
+  if (!parsed) {
+    parsed = createParsed(source, config)
+    byOptions.set(key, parsed)
+  }
+  return parsed
+}
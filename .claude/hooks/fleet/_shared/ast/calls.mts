@@ -6,8 +6,9 @@
  *   `../ast/*.mts` module.
  */
 
+import { parseSource } from './cache.mts'
 import type { AcornNode, CallSite, ParseOptions } from './core.mts'
-import { offsetToLineCol, splitLines, walkSimple } from './core.mts'
+import { walkSimple } from './core.mts'
 
 /**
  * Find every BARE call to the named identifier in `source`. "Bare" means the
@@ -38,7 +39,8 @@ export function findBareCallsTo(
 ): CallSite[] {
   const opts = { __proto__: null, ...options } as typeof options
   const matches: CallSite[] = []
-  const lines = splitLines(source)
+  const parsed = parseSource(source, options)
+  const { lines } = parsed
   const disableMarker = opts?.oxlintRuleName
     ? `oxlint-disable-next-line ${opts.oxlintRuleName}`
     : undefined
@@ -58,7 +60,7 @@ export function findBareCallsTo(
         if (typeof start !== 'number') {
           return
         }
-        const { line, column } = offsetToLineCol(source, start)
+        const { line, column } = parsed.lineColOf(start)
         if (disableMarker && line >= 2) {
           const prev = lines[line - 2] ?? ''
           if (prev.includes(disableMarker)) {
@@ -119,7 +121,8 @@ export function findMemberCalls(
   options?: ParseOptions | undefined,
 ): MemberCallSite[] {
   const matches: MemberCallSite[] = []
-  const lines = splitLines(source)
+  const parsed = parseSource(source, options)
+  const { lines } = parsed
   const objectChain = object.split('.')
 
   function calleeMatches(callee: AcornNode | undefined): boolean {
@@ -202,7 +205,7 @@ export function findMemberCalls(
             }
           }
         }
-        const { line, column } = offsetToLineCol(source, start)
+        const { line, column } = parsed.lineColOf(start)
         matches.push({
           line,
           column,
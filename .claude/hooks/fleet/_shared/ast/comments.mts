@@ -12,13 +12,9 @@ import type {
   CommentPosition,
   CommentSite,
 } from './comment-types.mts'
-import type { AcornNode, ParseOptions } from './core.mts'
-import {
-  DEFAULT_PARSE_OPTIONS,
-  offsetToLineCol,
-  parseWasm,
-  splitLines,
-} from './core.mts'
+import { parseSource } from './cache.mts'
+import type { ParsedSource } from './cache.mts'
+import type { ParseOptions } from './core.mts'
 
 /**
  * Wire-shape of a single Comment record on the AST root, emitted by the
@@ -70,60 +66,64 @@ export function walkComments(
   if (options?.comments !== true) {
     return []
   }
-  // Fast path: parser-level collection. The acorn-wasm parser exposes
-  // Options.collectComments — when set, the AST root carries a `comments`
+  // One walk per parse: every comment-grading hook of a dispatch asks for the
+  // same document's comments. Callers own the returned list; the sites are
+  // shared.
+  const parsed = parseSource(source, options)
+  let sites = commentMemo.get(parsed)
+  if (!sites) {
+    sites = collectComments(parsed)
+    commentMemo.set(parsed, sites)
+  }
+  return sites.slice()
+}
+
+const commentMemo = new WeakMap<ParsedSource, readonly CommentSite[]>()
+
+function collectComments(parsed: ParsedSource): CommentSite[] {
+  const { lines, source } = parsed
+  // Fast path: parser-level collection. The shared parse always sets the
+  // acorn-wasm Options.collectComments, so the AST root carries a `comments`
   // array of oxc-shape records ready-classified (kind / content / position /
   // attachedTo / newlineBefore+after). We just bolt on the legacy `line` +
   // `text` + `value` fields that pre-date the parser support.
-  try {
-    const parsed = parseWasm(source, {
-      __proto__: null,
-      ...DEFAULT_PARSE_OPTIONS,
-      ...options,
-      collectComments: true,
-    } as unknown as ParseOptions) as
-      | (AcornNode & { comments?: ParsedComment[] | undefined })
-      | undefined
-    const parsedComments = parsed?.['comments']
-    if (Array.isArray(parsedComments) && parsedComments.length >= 0) {
-      const lines = splitLines(source)
-      return parsedComments.map((pc): CommentSite => {
-        const { line } = offsetToLineCol(source, pc.start)
-        const fullText = source.slice(pc.start, pc.end)
-        let value: string
-        if (pc.kind === 'Line') {
-          value = fullText.startsWith('//') ? fullText.slice(2) : fullText
-        } else if (pc.kind === 'Hashbang') {
-          value = fullText.startsWith('#!') ? fullText.slice(2) : fullText
-        } else {
-          // SingleLineBlock or MultiLineBlock.
-          value =
-            fullText.startsWith('/*') && fullText.endsWith('*/')
-              ? fullText.slice(2, -2)
-              : fullText
-        }
-        return {
-          kind: pc.kind,
-          content: pc.content,
-          position: pc.position,
-          newlines: {
-            before: pc.newlineBefore,
-            after: pc.newlineAfter,
-          },
-          start: pc.start,
-          end: pc.end,
-          attachedTo: pc.attachedTo == null ? -1 : pc.attachedTo,
-          value,
-          line,
-          text: (lines[line - 1] ?? '').trim(),
-        }
-      })
-    }
-  } catch {
-    // Parser rejected the input (fragment, syntax error, future-syntax not yet
-    // supported). Fall through to the legacy scanner — it's tolerant of
-    // incomplete inputs and is the documented escape hatch.
+  const parsedComments = parsed.comments as ParsedComment[] | undefined
+  if (parsedComments) {
+    return parsedComments.map((pc): CommentSite => {
+      const { line } = parsed.lineColOf(pc.start)
+      const fullText = source.slice(pc.start, pc.end)
+      let value: string
+      if (pc.kind === 'Line') {
+        value = fullText.startsWith('//') ? fullText.slice(2) : fullText
+      } else if (pc.kind === 'Hashbang') {
+        value = fullText.startsWith('#!') ? fullText.slice(2) : fullText
+      } else {
+        // SingleLineBlock or MultiLineBlock.
+        value =
+          fullText.startsWith('/*') && fullText.endsWith('*/')
+            ? fullText.slice(2, -2)
+            : fullText
+      }
+      return {
+        kind: pc.kind,
+        content: pc.content,
+        position: pc.position,
+        newlines: {
+          before: pc.newlineBefore,
+          after: pc.newlineAfter,
+        },
+        start: pc.start,
+        end: pc.end,
+        attachedTo: pc.attachedTo == null ? -1 : pc.attachedTo,
+        value,
+        line,
+        text: (lines[line - 1] ?? '').trim(),
+      }
+    })
   }
+  // Parser rejected the input (fragment, syntax error, future-syntax not yet
+  // supported). Fall through to the legacy scanner — it's tolerant of
+  // incomplete inputs and is the documented escape hatch.
   // Internal record shape during the scan. We fill in `position`, `newlines`,
   // `attachedTo`, and `content` in a second pass after the full comment list is
   // known.
@@ -137,7 +137,6 @@ export function walkComments(
     text: string
   }
   const pending: PendingComment[] = []
-  const lines = splitLines(source)
   const len = source.length
   let i = 0
   let stringQuote: string | undefined
@@ -209,7 +208,7 @@ export function walkComments(
       while (j < len && source.charCodeAt(j) !== 10) {
         j += 1
       }
-      const { line } = offsetToLineCol(source, start)
+      const { line } = parsed.lineColOf(start)
       pending.push({
         kind: 'Line',
         start,
@@ -236,7 +235,7 @@ export function walkComments(
       // SingleLine vs MultiLine block — does the body contain a newline?
       const isMulti = body.includes('\n') || body.includes('\r')
       const kind: CommentKind = isMulti ? 'MultiLineBlock' : 'SingleLineBlock'
-      const { line } = offsetToLineCol(source, start)
+      const { line } = parsed.lineColOf(start)
       pending.push({
         kind,
         start,
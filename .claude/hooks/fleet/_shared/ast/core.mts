@@ -10,9 +10,8 @@
  *   stays safe; instantiation happens at runtime.
  */
 
-import { createRequire } from 'node:module'
-
-const require = createRequire(import.meta.url)
+import { bundleRequire } from '../bundle-dir.mts'
+import { parseSource } from './cache.mts'
 
 export interface AcornNode {
   type: string
@@ -78,62 +77,91 @@ export const DEFAULT_PARSE_OPTIONS: Required<ParseOptions> = {
 }
 
 // The narrow slice of the wasm parser API the fleet helpers use: raw `parse`
-// (AST, plus a `comments` array when `collectComments` is set) + the `simple`
-// visitor walk. The full package exposes more (walk / findNode* / aqs_match);
-// the fleet surface stays intentionally small.
+// (AST, plus a `comments` array when `collectComments` is set). The full
+// package exposes more (simple / walk / findNode* / aqs_match); the fleet walks
+// the cached tree itself (`cache.mts`) so one parse serves every hook.
 interface AcornWasm {
   parse: (source: string, options: ParseOptions) => AcornNode
-  simple: (
-    source: string,
-    visitors: Record<string, (node: unknown) => void>,
-    options: ParseOptions,
-  ) => void
 }
 
 let cachedWasm: AcornWasm | undefined
 
 // Lazy so the WASM is never touched during a snapshot build pass (module eval);
-// runtime-only, where `WebAssembly` is present.
+// runtime-only, where `WebAssembly` is present. Resolved from the bundle dir,
+// not a module-eval `createRequire`: a shared blob booted by another checkout
+// must load that checkout's parser, not the build checkout's.
 function acornWasm(): AcornWasm {
   if (cachedWasm === undefined) {
-    cachedWasm = require('@ultrathink/acorn.wasm') as AcornWasm
+    cachedWasm = bundleRequire(import.meta.url)(
+      '@ultrathink/acorn.wasm',
+    ) as AcornWasm
   }
   return cachedWasm
 }
 
 /**
- * Raw parse against the wasm parser. `comments`/`calls`/`literals` go through
- * the tolerant `tryParse` / `walkSimple`; `walkComments` uses this directly to
- * pass the parser-level `collectComments` option.
+ * Raw, uncached parse against the wasm parser; throws on a syntax error. The
+ * helpers go through `parseSource` (`cache.mts`), which calls this once per
+ * distinct text.
  */
 export function parseWasm(source: string, config: ParseOptions): AcornNode {
   return acornWasm().parse(source, config)
 }
 
+// A few lines touching the parser's common paths (imports, TypeScript
+// annotations, a template, a regex, a throw, comments) for `primeAcornWasm`.
+const PRIME_SOURCE = [
+  "import path from 'node:path'",
+  '// line comment',
+  '/** block comment */',
+  'export function f(options?: { a: string }): string {',
+  '  const re = /[a-z]+/g',
+  '  if (!options) throw new Error(`missing ${re.source}`)',
+  "  return path.join(options.a, 'b')",
+  '}',
+  '',
+].join('\n')
+
+/**
+ * Load the wasm parser and run one small parse through it, for a process that
+ * is booted AHEAD of the work it will do (the warm daemon's parked workers).
+ * `WebAssembly` is absent while a startup snapshot is built, so a blob can't
+ * freeze a compiled module, and V8 gives node no way to persist one: the
+ * first AST guard of every process pays the module compile plus the lazy
+ * per-function compiles of the parse it runs. Priming moves both off the
+ * hook path. Uncached (nothing lands in the `cache.mts` memo); best-effort,
+ * never throws.
+ */
+export function primeAcornWasm(): void {
+  try {
+    parseWasm(PRIME_SOURCE, {
+      __proto__: null,
+      ...DEFAULT_PARSE_OPTIONS,
+      collectComments: true,
+    } as unknown as ParseOptions)
+  } catch {}
+}
+
 /**
  * Parse a JS/TS source string into an acorn AST. Returns `undefined` on parse
  * failure — hooks see incomplete fragments (Edit's `new_string` is a snippet,
  * not a whole file) and shouldn't crash on syntax error.
+ *
+ * The AST comes from the shared parse cache (`cache.mts`): every hook asking
+ * for the same text gets the same tree, so treat it as read-only.
  */
 export function tryParse(
   source: string,
   options?: ParseOptions | undefined,
 ): AcornNode | undefined {
-  try {
-    return parseWasm(source, {
-      __proto__: null,
-      ...DEFAULT_PARSE_OPTIONS,
-      ...options,
-    } as unknown as ParseOptions)
-  } catch {
-    return undefined
-  }
+  return parseSource(source, options).ast
 }
 
 /**
- * Visit every node in `source` whose type matches a key in `visitors`. Errors
- * during parse are silently swallowed — see `tryParse` for the
- * fragment-tolerance rationale.
+ * Visit every node in `source` whose type matches a key in `visitors`,
+ * children before parents. Errors during parse are silently swallowed — see
+ * `tryParse` for the fragment-tolerance rationale. Served from the shared
+ * parse cache, so several walks over one text cost one parse.
  */
 export function walkSimple(
   source: string,
@@ -141,17 +169,18 @@ export function walkSimple(
   options?: ParseOptions | undefined,
 ): void {
   try {
-    acornWasm().simple(
-      source,
-      visitors as unknown as Record<string, (node: unknown) => void>,
-      {
-        __proto__: null,
-        ...DEFAULT_PARSE_OPTIONS,
-        ...options,
-      } as unknown as ParseOptions,
-    )
+    const parsed = parseSource(source, options)
+    const types = Object.keys(visitors)
+    // One visitor type (the common case) reads the by-type index; several
+    // walk every node so their calls stay interleaved in walk order.
+    const nodes =
+      types.length === 1 ? parsed.nodesOfType(types[0]!) : parsed.nodes
+    for (let i = 0, { length } = nodes; i < length; i += 1) {
+      const node = nodes[i]!
+      visitors[node.type]?.(node)
+    }
   } catch {
-    // Parse failure — caller's hook should fail open.
+    // Parse failure or a throwing visitor — caller's hook should fail open.
   }
 }
 
@@ -5,8 +5,9 @@
  *   `../ast/*.mts` module.
  */
 
+import { parseSource } from './cache.mts'
 import type { AcornNode, CallSite, ParseOptions } from './core.mts'
-import { offsetToLineCol, splitLines, walkSimple } from './core.mts'
+import { walkSimple } from './core.mts'
 
 export interface RegexLiteralSite extends CallSite {
   /**
@@ -32,7 +33,8 @@ export function findRegexLiterals(
   options?: ParseOptions | undefined,
 ): RegexLiteralSite[] {
   const matches: RegexLiteralSite[] = []
-  const lines = splitLines(source)
+  const parsed = parseSource(source, options)
+  const { lines } = parsed
 
   walkSimple(
     source,
@@ -48,7 +50,7 @@ export function findRegexLiterals(
         if (typeof start !== 'number') {
           return
         }
-        const { line, column } = offsetToLineCol(source, start)
+        const { line, column } = parsed.lineColOf(start)
         matches.push({
           line,
           column,
@@ -94,7 +96,8 @@ export function findTemplateLiterals(
   options?: ParseOptions | undefined,
 ): TemplateLiteralSite[] {
   const matches: TemplateLiteralSite[] = []
-  const lines = splitLines(source)
+  const parsed = parseSource(source, options)
+  const { lines } = parsed
 
   walkSimple(
     source,
@@ -129,7 +132,7 @@ export function findTemplateLiterals(
             parts.push('\0')
           }
         }
-        const { line, column } = offsetToLineCol(source, start)
+        const { line, column } = parsed.lineColOf(start)
         matches.push({
           line,
           column,
@@ -171,7 +174,8 @@ export function findThrowNew(
   options?: ParseOptions | undefined,
 ): ThrowSite[] {
   const matches: ThrowSite[] = []
-  const lines = splitLines(source)
+  const parsed = parseSource(source, options)
+  const { lines } = parsed
 
   walkSimple(
     source,
@@ -209,7 +213,7 @@ export function findThrowNew(
         if (typeof start !== 'number') {
           return
         }
-        const { line, column } = offsetToLineCol(source, start)
+        const { line, column } = parsed.lineColOf(start)
         matches.push({
           line,
           column,
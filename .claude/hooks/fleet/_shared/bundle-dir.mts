@@ -0,0 +1,54 @@
+/*
+ * @file Where the running hook bundle lives, for runtime lookups. A module's
+ *   `import.meta.url` is read at module eval, and in a V8 startup snapshot
+ *   that happens at BUILD time: it names the `_dispatch/` dir of the checkout
+ *   that built the blob. Under the per-user shared blob store
+ *   (`FLEET_SNAPSHOT_SHARED_STORE`) another checkout boots that same blob, so
+ *   the native launcher exports its own `_dispatch/` dir as
+ *   `FLEET_DISPATCH_DIR` and the snapshot entry adopts it (`adoptBootDir`).
+ *   Lookups that must hit the BOOTING checkout — the excluded bundle and its
+ *   compile cache, the acorn-WASM parser, the last-resort project root — go
+ *   through here. Outside a snapshot boot nothing is adopted and every helper
+ *   is the plain `import.meta.url` answer.
+ */
+
+import { createRequire } from 'node:module'
+import path from 'node:path'
+import { fileURLToPath } from 'node:url'
+
+/**
+ * Env var the launchers (and `hook-daemon.mts`) set to their `_dispatch/` dir
+ * before booting a blob.
+ */
+export const BOOT_DIR_ENV = 'FLEET_DISPATCH_DIR'
+
+let bootDir: string | undefined
+
+/**
+ * Adopt the booting checkout's `_dispatch/` dir. Called once by the snapshot
+ * entry's deserialize-main; a missing or relative value adopts nothing.
+ */
+export function adoptBootDir(dir: string | undefined): void {
+  bootDir = dir && path.isAbsolute(dir) ? dir : undefined
+}
+
+/**
+ * The bundle dir: the adopted boot dir, else the dir of `moduleUrl` (the
+ * caller's `import.meta.url`). Source and bundle sit at the same depth under
+ * `.claude/hooks/fleet/`, so fixed `..` walks from it hold for both.
+ */
+export function bundleDir(moduleUrl: string): string {
+  return bootDir ?? path.dirname(fileURLToPath(moduleUrl))
+}
+
+/**
+ * A `require` anchored in `bundleDir(moduleUrl)`. Call it at use, not at
+ * module eval — a module-level one is frozen with the build checkout's path.
+ */
+export function bundleRequire(
+  moduleUrl: string,
+): ReturnType<typeof createRequire> {
+  return bootDir === undefined
+    ? createRequire(moduleUrl)
+    : createRequire(path.join(bootDir, 'bundle.cjs'))
+}
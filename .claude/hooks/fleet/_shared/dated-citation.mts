@@ -21,10 +21,18 @@
 
 import { normalizePath } from '@socketsecurity/lib-stable/paths/normalize'
 
+import { literalOffsets, registerLiterals } from './pattern-engine.mts'
+
 // A line is "rationale" if it carries one of these markers. Only rationale
 // lines are candidates — this keeps the matcher off required-date annotations.
 const RATIONALE_MARKER_RE =
   /\*\*Why:\*\*|\b(?:past\s+)?incident\b|\bred-lined?\b|\bregressed?\b|\bregression\b/i
+registerLiterals(RATIONALE_MARKER_RE, [
+  '**why:**',
+  'incident',
+  'red-line',
+  'regress',
+])
 
 // Specificity tokens that turn a generic example into a dated incident log.
 const SPECIFICITY_PATTERNS: ReadonlyArray<{ label: string; regex: RegExp }> = [
@@ -72,10 +80,28 @@ export interface DatedCitationHit {
  * the trimmed offending line, truncated for display.
  */
 export function findDatedCitations(content: string): DatedCitationHit[] {
+  // Where a marker could start; only the lines holding one are tested.
+  const markers = literalOffsets(RATIONALE_MARKER_RE, content)
+  if (markers && !markers.length) {
+    return []
+  }
   const lines = content.split('\n')
   const hits: DatedCitationHit[] = []
+  let next = 0
+  let start = 0
   for (let i = 0, { length } = lines; i < length; i += 1) {
     const line = lines[i]!
+    const end = start + line.length
+    const lineStart = start
+    start = end + 1
+    if (markers) {
+      while (next < markers.length && markers[next]! < lineStart) {
+        next += 1
+      }
+      if (next === markers.length || markers[next]! >= end) {
+        continue
+      }
+    }
     if (!RATIONALE_MARKER_RE.test(line)) {
       continue
     }
@@ -25,9 +25,23 @@ const HOMOGLYPHS: ReadonlyMap<string, string> = new Map([
   ['ι', 'i'],
 ])
 
+// Last input → output: both guards normalize the same edit content within one
+// dispatch, so the per-code-point walk runs once.
+let lastInput: string | undefined
+let lastOutput = ''
+
 // Strip invisible chars + Unicode Tag-block codepoints, fold homoglyphs.
 // Iterating by code point (for…of) handles the astral Tag block.
 export function normalizeForScan(text: string): string {
+  if (text === lastInput) {
+    return lastOutput
+  }
+  lastOutput = normalizeUncached(text)
+  lastInput = text
+  return lastOutput
+}
+
+function normalizeUncached(text: string): string {
   const stripped = text.replace(INVISIBLE_RE, '')
   let out = ''
   for (const ch of stripped) {
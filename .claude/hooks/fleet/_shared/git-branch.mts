@@ -7,22 +7,94 @@
 
 import { spawnSync } from '@socketsecurity/lib-stable/process/spawn/child'
 
+import { cachedGitFact } from './git-facts.mts'
+import type { GitAnswer } from './git-facts.mts'
+import { runProcess } from './process-scheduler.mts'
 import { spawnTimeoutMs } from './spawn-timeout.mts'
 
-// Run a git command in `repoDir`, returning trimmed stdout, or undefined on a
-// non-zero exit / spawn error / missing repo.
-export function gitOut(
-  repoDir: string,
-  args: readonly string[],
-): string | undefined {
+// The origin refs whose loose files git-facts.mts keys on. Any other ref
+// could change without touching the cache key, so it isn't cached.
+const CACHED_ORIGIN_REFS = new Set([
+  'refs/remotes/origin/HEAD',
+  'refs/remotes/origin/main',
+  'refs/remotes/origin/master',
+])
+
+// Queries whose answer depends only on the metadata git-facts.mts keys on
+// (HEAD, config, the origin HEAD/main/master refs), so they're served from
+// its cache. Anything reading the index, objects, worktree or another ref is
+// spawned every time.
+function isMetadataQuery(args: readonly string[]): boolean {
+  const [sub, ...rest] = args
+  switch (sub) {
+    case 'config':
+      return (
+        rest.length <= 2 &&
+        (rest.length === 1 || rest[0] === '--get') &&
+        !rest[rest.length - 1]!.startsWith('-')
+      )
+    case 'rev-parse':
+      return (
+        rest.length === 1 &&
+        (rest[0] === '--show-toplevel' ||
+          rest[0] === '--git-dir' ||
+          rest[0] === '--git-common-dir')
+      )
+    case 'show-ref':
+      return (
+        rest.length === 3 &&
+        rest[0] === '--verify' &&
+        rest[1] === '--quiet' &&
+        CACHED_ORIGIN_REFS.has(rest[2]!)
+      )
+    case 'symbolic-ref':
+      return (
+        args.join(' ') === 'symbolic-ref --quiet --short HEAD' ||
+        args.join(' ') === 'symbolic-ref refs/remotes/origin/HEAD'
+      )
+    default:
+      return false
+  }
+}
+
+function spawnGit(repoDir: string, args: readonly string[]): GitAnswer {
   const r = spawnSync('git', [...args], {
     cwd: repoDir,
     timeout: spawnTimeoutMs(5000),
   })
+  const settled = !r.error && !r.signal && typeof r.status === 'number'
   if (r.status !== 0 || typeof r.stdout !== 'string') {
-    return undefined
+    return [undefined, settled]
+  }
+  return [r.stdout.trim(), settled]
+}
+
+// Run a git command in `repoDir`, returning trimmed stdout, or undefined on a
+// non-zero exit / spawn error / missing repo. Metadata-only queries are
+// answered from the cross-invocation git-facts cache.
+export function gitOut(
+  repoDir: string,
+  args: readonly string[],
+): string | undefined {
+  if (isMetadataQuery(args)) {
+    return cachedGitFact(repoDir, args, () => spawnGit(repoDir, args))
+  }
+  return spawnGit(repoDir, args)[0]
+}
+
+// gitOut for a check that can await: a metadata query is still answered from
+// the git-facts cache, anything else goes through the shared process
+// scheduler, so identical probes from several hooks of one dispatch spawn
+// git once and share the dispatch's deadline.
+export async function gitOutAsync(
+  repoDir: string,
+  args: readonly string[],
+): Promise<string | undefined> {
+  if (isMetadataQuery(args)) {
+    return gitOut(repoDir, args)
   }
-  return r.stdout.trim()
+  const r = await runProcess('git', args, { cwd: repoDir })
+  return r.status === 0 ? r.stdout.trim() : undefined
 }
 
 // The current branch, or undefined when detached / not a repo.
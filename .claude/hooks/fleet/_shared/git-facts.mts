@@ -0,0 +1,293 @@
+/*
+ * @file Cross-invocation cache for git answers that only depend on a repo's
+ *   metadata files: the current branch, `origin/HEAD` and the default-branch
+ *   probes, `git config --get` lookups (identity, remote URL), and
+ *   `rev-parse --show-toplevel` / `--git-dir`. A single tool call fans out to
+ *   a dozen git-aware hooks, each forking git for the same few questions;
+ *   `gitOut` (git-branch.mts) now routes those through `cachedGitFact`, so
+ *   after the first event a repo answers them with a handful of `stat` calls.
+ *
+ *   Validity is a STAT SIGNATURE (inode + size + mtime in ns) of every file
+ *   the cached answers are read from:
+ *
+ *   - `<gitdir>/HEAD`, `config.worktree`, and the in-progress markers
+ *     (`CHERRY_PICK_HEAD`, `MERGE_HEAD`, `rebase-apply`, `rebase-merge`)
+ *   - `<commondir>/config`, `packed-refs`, and the loose
+ *     `refs/remotes/origin/{HEAD,main,master}`
+ *   - the global and system config files, wherever the environment puts them
+ *   - every `GIT_*` environment variable, by value
+ *
+ *   Git rewrites each of these by lockfile + rename, so any change lands as a
+ *   new inode and drops every cached answer for that repo at once.
+ *   `.git/index` is deliberately NOT keyed: no cached answer reads it, and
+ *   every `git add` rewrites it. Queries that do read the index, the object
+ *   store or the working tree (`status`, `rev-list`, `log`, `merge-base`) are
+ *   never cached. Nor are config values that come in through an `[include]`
+ *   of a file outside this list; such a setup sees a stale value until one of
+ *   the keyed files changes.
+ *
+ *   Persisted as JSON under `node_modules/.cache/fleet/git-facts/<hash>.json`,
+ *   one file per git dir. In-process the record is loaded once and every
+ *   lookup re-checks the signature, so a hook that runs `git config` itself
+ *   (or a warm daemon serving the next event) never reads a stale answer.
+ *   Fail-open: an unlocatable repo, an unreadable record or a failed write
+ *   just means git is spawned as before. Nothing is written in a repo without
+ *   `node_modules`. An answer from a spawn that errored or timed out is
+ *   returned but never cached.
+ */
+
+import { createHash } from 'node:crypto'
+import {
+  existsSync,
+  mkdirSync,
+  readFileSync,
+  renameSync,
+  statSync,
+  writeFileSync,
+} from 'node:fs'
+import os from 'node:os'
+import path from 'node:path'
+import process from 'node:process'
+
+import { resolveProjectDir } from './project-dir.mts'
+
+// A record holding more answers than this is reset rather than grown: cwd is
+// part of the key, so a session hopping across many subdirs would otherwise
+// grow it without bound.
+export const GIT_FACTS_MAX = 256
+
+const RECORD_VERSION = 1
+
+const GITDIR_FILES = [
+  'HEAD',
+  'config.worktree',
+  'CHERRY_PICK_HEAD',
+  'MERGE_HEAD',
+  'rebase-apply',
+  'rebase-merge',
+]
+// The origin refs here are the only ones git-branch.mts caches a `show-ref`
+// for (CACHED_ORIGIN_REFS); add a ref to both or neither.
+const COMMONDIR_FILES = [
+  'config',
+  'packed-refs',
+  'refs/remotes/origin/HEAD',
+  'refs/remotes/origin/main',
+  'refs/remotes/origin/master',
+]
+
+/**
+ * One git answer: the trimmed stdout (undefined when git exited non-zero),
+ * and whether git actually ran to completion. Only settled answers are
+ * cached; a killed or unspawnable git says nothing about the repo.
+ */
+export type GitAnswer = readonly [value: string | undefined, settled: boolean]
+
+interface GitDirs {
+  readonly commonDir: string
+  readonly gitDir: string
+}
+
+interface FactsRecord {
+  readonly facts: Record<string, string | null>
+  readonly sig: string
+  readonly v: number
+}
+
+interface LoadedRecord {
+  facts: Record<string, string | null>
+  file: string | undefined
+  sig: string
+}
+
+const loaded = new Map<string, LoadedRecord>()
+
+// undefined = not resolved yet; '' = no node_modules, don't persist.
+let factsRoot: string | undefined
+
+function factsDir(): string {
+  if (factsRoot === undefined) {
+    const projectDir = resolveProjectDir()
+    factsRoot = existsSync(path.join(projectDir, 'node_modules'))
+      ? path.join(projectDir, 'node_modules', '.cache', 'fleet', 'git-facts')
+      : ''
+  }
+  return factsRoot
+}
+
+function readGitLink(file: string): string | undefined {
+  try {
+    const m = /^gitdir:\s*(.+?)\s*$/m.exec(readFileSync(file, 'utf8'))
+    return m ? path.resolve(path.dirname(file), m[1]!) : undefined
+  } catch {
+    return undefined
+  }
+}
+
+/**
+ * The git dir and common dir git would use for `repoDir`: the nearest
+ * `.git` dir or `gitdir:` link walking up, the common dir from `commondir`
+ * for a linked worktree. Undefined when there is none, or when GIT_DIR
+ * overrides discovery.
+ */
+export function resolveGitDirs(repoDir: string): GitDirs | undefined {
+  if (process.env['GIT_DIR']) {
+    return undefined
+  }
+  let dir = path.resolve(repoDir)
+  for (;;) {
+    const dotGit = path.join(dir, '.git')
+    const st = statSync(dotGit, { throwIfNoEntry: false })
+    if (st) {
+      const gitDir = st.isDirectory() ? dotGit : readGitLink(dotGit)
+      if (!gitDir) {
+        return undefined
+      }
+      let commonDir = gitDir
+      try {
+        commonDir = path.resolve(
+          gitDir,
+          readFileSync(path.join(gitDir, 'commondir'), 'utf8').trim(),
+        )
+      } catch {}
+      return { __proto__: null, commonDir, gitDir } as GitDirs
+    }
+    const parent = path.dirname(dir)
+    if (parent === dir) {
+      return undefined
+    }
+    dir = parent
+  }
+}
+
+function globalConfigFiles(): string[] {
+  const { env } = process
+  const home = env['HOME'] ?? os.homedir()
+  const xdg = env['XDG_CONFIG_HOME'] || path.join(home, '.config')
+  return [
+    env['GIT_CONFIG_GLOBAL'] ?? path.join(home, '.gitconfig'),
+    path.join(xdg, 'git', 'config'),
+    env['GIT_CONFIG_SYSTEM'] ?? '/etc/gitconfig',
+  ]
+}
+
+function statPart(file: string): string {
+  try {
+    const st = statSync(file, { bigint: true, throwIfNoEntry: false })
+    return st ? `${st.ino}:${st.size}:${st.mtimeNs}` : '-'
+  } catch {
+    return '?'
+  }
+}
+
+/**
+ * The stat signature the cached answers for `dirs` are valid under (see the
+ * file header).
+ */
+export function gitFactsSignature(dirs: GitDirs): string {
+  const parts: string[] = []
+  for (let i = 0, { length } = GITDIR_FILES; i < length; i += 1) {
+    parts.push(statPart(path.join(dirs.gitDir, GITDIR_FILES[i]!)))
+  }
+  for (let i = 0, { length } = COMMONDIR_FILES; i < length; i += 1) {
+    parts.push(statPart(path.join(dirs.commonDir, COMMONDIR_FILES[i]!)))
+  }
+  const globals = globalConfigFiles()
+  for (let i = 0, { length } = globals; i < length; i += 1) {
+    parts.push(statPart(globals[i]!))
+  }
+  const { env } = process
+  for (const name of Object.keys(env).toSorted()) {
+    if (name.startsWith('GIT_')) {
+      parts.push(`${name}=${env[name]}`)
+    }
+  }
+  return parts.join('|')
+}
+
+function recordFile(gitDir: string): string | undefined {
+  const root = factsDir()
+  if (!root) {
+    return undefined
+  }
+  const hash = createHash('sha256').update(gitDir).digest('hex').slice(0, 16)
+  return path.join(root, `${hash}.json`)
+}
+
+function readRecord(file: string | undefined, sig: string): LoadedRecord {
+  if (file) {
+    try {
+      const rec = JSON.parse(readFileSync(file, 'utf8')) as FactsRecord
+      if (
+        rec?.v === RECORD_VERSION &&
+        rec.sig === sig &&
+        rec.facts &&
+        typeof rec.facts === 'object'
+      ) {
+        return {
+          __proto__: null,
+          facts: { __proto__: null, ...rec.facts },
+          file,
+          sig,
+        } as LoadedRecord
+      }
+    } catch {}
+  }
+  return {
+    __proto__: null,
+    facts: { __proto__: null } as Record<string, string | null>,
+    file,
+    sig,
+  } as LoadedRecord
+}
+
+function writeRecord(rec: LoadedRecord): void {
+  if (!rec.file) {
+    return
+  }
+  try {
+    mkdirSync(path.dirname(rec.file), { recursive: true })
+    const tmp = `${rec.file}.${process.pid}.tmp`
+    writeFileSync(
+      tmp,
+      JSON.stringify({ facts: rec.facts, sig: rec.sig, v: RECORD_VERSION }),
+    )
+    renameSync(tmp, rec.file)
+  } catch {}
+}
+
+/**
+ * Answer the git query `args` run in `repoDir` from the cache, or via
+ * `compute` (which spawns git) on a miss. `args` must be a query whose
+ * answer only depends on the keyed metadata files (see the file header);
+ * `gitOut` decides that.
+ */
+export function cachedGitFact(
+  repoDir: string,
+  args: readonly string[],
+  compute: () => GitAnswer,
+): string | undefined {
+  const dirs = resolveGitDirs(repoDir)
+  if (!dirs) {
+    return compute()[0]
+  }
+  const sig = gitFactsSignature(dirs)
+  let rec = loaded.get(dirs.gitDir)
+  if (!rec || rec.sig !== sig) {
+    rec = readRecord(recordFile(dirs.gitDir), sig)
+    loaded.set(dirs.gitDir, rec)
+  }
+  const key = `${path.resolve(repoDir)}\0${args.join('\0')}`
+  if (key in rec.facts) {
+    return rec.facts[key] ?? undefined
+  }
+  const [value, settled] = compute()
+  if (settled) {
+    if (Object.keys(rec.facts).length >= GIT_FACTS_MAX) {
+      rec.facts = { __proto__: null } as Record<string, string | null>
+    }
+    rec.facts[key] = value ?? null
+    writeRecord(rec)
+  }
+  return value
+}
@@ -12,6 +12,7 @@
 
 import { spawnSync } from '@socketsecurity/lib-stable/process/spawn/child'
 
+import { gitOut } from './git-branch.mts'
 import { spawnTimeoutMs } from './spawn-timeout.mts'
 import { resolveProjectDir } from './project-dir.mts'
 
@@ -43,18 +44,10 @@ export function isPlaceholderEmail(email: string): boolean {
 /**
  * The EFFECTIVE git `user.email` resolved from `dir` (local over global, the
  * value git itself would stamp on a commit). Empty string when git is
- * unavailable or no identity is set.
+ * unavailable or no identity is set. Served from the git-facts cache.
  */
 export function effectiveUserEmail(dir: string): string {
-  const r = spawnSync('git', ['config', '--get', 'user.email'], {
-    cwd: dir,
-    encoding: 'utf8',
-    timeout: spawnTimeoutMs(5000),
-  })
-  if (r.status !== 0) {
-    return ''
-  }
-  return String(r.stdout).trim()
+  return gitOut(dir, ['config', '--get', 'user.email']) ?? ''
 }
 
 /**
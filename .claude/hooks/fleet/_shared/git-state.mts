@@ -7,11 +7,11 @@
  *   source of truth so the two paths can't drift.
  */
 
-// oxlint-disable-next-line socket/prefer-async-spawn -- hook + sync runner need sync stdin/stdout + typed string return; v5 lib spawnSync omits 'encoding'.
-import { spawnSync } from '@socketsecurity/lib-stable/process/spawn/child'
 import { existsSync } from 'node:fs'
 import path from 'node:path'
 
+import { currentBranch } from './git-branch.mts'
+
 /**
  * True when a fresh commit in `repoDir` would land on a stale or transient ref.
  * Covers a missing `.git`, detached HEAD, and in-progress rebase / merge /
@@ -22,14 +22,7 @@ export function isInTransientGitState(repoDir: string): boolean {
   if (!existsSync(gitDir)) {
     return true
   }
-  const head = spawnSync(
-    'git',
-    ['symbolic-ref', '--quiet', '--short', 'HEAD'],
-    {
-      cwd: repoDir,
-    },
-  )
-  if (head.status !== 0) {
+  if (currentBranch(repoDir) === undefined) {
     // Detached HEAD — symbolic-ref exits non-zero.
     return true
   }
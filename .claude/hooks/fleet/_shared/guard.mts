@@ -29,12 +29,9 @@ import { getDefaultLogger } from '@socketsecurity/lib-stable/logger/default'
 
 import { bypassFooter, bypassPhrasesFor } from './bypass.mts'
 import { isFleetManagedDir, isFleetManagedPath } from './fleet-repo.mts'
-import {
-  readCommand,
-  readFilePath,
-  readPayload,
-  readWriteContent,
-} from './payload.mts'
+import { analyzePayload } from './payload-analysis.mts'
+import type { PayloadAnalysis } from './payload-analysis.mts'
+import { readPayload } from './payload.mts'
 import type { ToolCallPayload } from './payload.mts'
 import { commandWorkingDir } from './shell-command.mts'
 import { bypassPhrasePresent } from './transcript.mts'
@@ -82,10 +79,14 @@ export interface GuardNotify {
 export type GuardResult = GuardBlock | GuardNotify | undefined
 
 /**
- * The uniform guard signature: payload in, verdict out.
+ * The uniform guard signature: payload in, verdict out. The dispatcher also
+ * passes the payload's shared `PayloadAnalysis` (parsed command, edit
+ * content, normalized text — each computed once per dispatch); a check may
+ * ignore it, and a direct caller may omit it.
  */
 export type GuardCheck = (
   payload: ToolCallPayload,
+  analysis?: PayloadAnalysis | undefined,
 ) => GuardResult | Promise<GuardResult>
 
 export interface GuardOptions {
@@ -197,22 +198,24 @@ export function bashGuard(
   fn: (
     command: string,
     payload: ToolCallPayload,
+    analysis: PayloadAnalysis,
   ) => GuardResult | Promise<GuardResult>,
   options?: GuardOptions | undefined,
 ): GuardCheck {
   const opts = { __proto__: null, ...options } as GuardOptions
-  return async payload => {
+  return async (payload, analysis) => {
     if (payload?.tool_name !== 'Bash') {
       return undefined
     }
-    const command = readCommand(payload)
+    const info = analysis ?? analyzePayload(payload)
+    const command = info.command
     if (!command) {
       return undefined
     }
     if (opts.fleetOnly && !isFleetManagedDir(commandWorkingDir(command))) {
       return undefined
     }
-    return fn(command, payload)
+    return fn(command, payload, info)
   }
 }
 
@@ -226,23 +229,25 @@ export function editGuard(
     filePath: string,
     content: string | undefined,
     payload: ToolCallPayload,
+    analysis: PayloadAnalysis,
   ) => GuardResult | Promise<GuardResult>,
   options?: GuardOptions | undefined,
 ): GuardCheck {
   const opts = { __proto__: null, ...options } as GuardOptions
-  return async payload => {
+  return async (payload, analysis) => {
     const tool = payload?.tool_name
     if (tool !== 'Edit' && tool !== 'MultiEdit' && tool !== 'Write') {
       return undefined
     }
-    const filePath = readFilePath(payload)
+    const info = analysis ?? analyzePayload(payload)
+    const filePath = info.filePath
     if (!filePath) {
       return undefined
     }
     if (opts.fleetOnly && !isFleetManagedPath(filePath)) {
       return undefined
     }
-    return fn(filePath, readWriteContent(payload), payload)
+    return fn(filePath, info.content, payload, info)
   }
 }
 
@@ -369,8 +374,8 @@ function withBypass(
   options?: BypassMatchOptions | undefined,
 ): GuardCheck {
   const phrases = bypassPhrasesFor(slugs)
-  return async (payload: ToolCallPayload) => {
-    const result = await base(payload)
+  return async (payload: ToolCallPayload, analysis?: PayloadAnalysis) => {
+    const result = await base(payload, analysis)
     if (!result) {
       return result
     }
@@ -405,8 +410,10 @@ function withBypass(
 export function defineHook(spec: HookSpec): Hook {
   const scoped: GuardCheck =
     spec.scope === 'convention'
-      ? payload =>
-          payloadTargetIsFleetManaged(payload) ? spec.check(payload) : undefined
+      ? (payload, analysis) =>
+          payloadTargetIsFleetManaged(payload)
+            ? spec.check(payload, analysis)
+            : undefined
       : spec.check
   // Auto-bypass wrapping — only when phrases are declared AND detection is not
   // hand-owned. Applied OUTSIDE the convention scope so a foreign-repo stand-
@@ -15,6 +15,8 @@
 // is why the bare ban is safe to share across all three surfaces without
 // per-surface softening.
 
+import { mayMatch, registerLiterals } from './pattern-engine.mts'
+
 // Three branches. The bare word (`honest`/`honestly`/`honesty`) is the
 // categorical ban — it ALREADY subsumes every framing phrase the three source
 // patterns spelled out ("in all honesty", "to be honest", "if I'm honest",
@@ -24,6 +26,9 @@
 export const HONESTY_FRAMING_RE =
   /\bhonest(?:ly|y)?\b|(?:^|\n)\s*frankly,|\bpapered over\b/i
 
+// One literal per branch, for the shared prefilter (pattern-engine.mts).
+registerLiterals(HONESTY_FRAMING_RE, ['frankly,', 'honest', 'papered over'])
+
 // Shared label + rationale so consumers render one consistent message.
 export const HONESTY_LABEL =
   'BANNED honesty framing — hard rule, this match is a VERDICT not a heuristic'
@@ -34,5 +39,5 @@ export const HONESTY_WHY =
 // True when `text` carries any honesty-filler framing. HONESTY_FRAMING_RE has
 // no /g flag, so `.test` is stateless across calls.
 export function matchesHonestyFraming(text: string): boolean {
-  return HONESTY_FRAMING_RE.test(text)
+  return mayMatch(HONESTY_FRAMING_RE, text) && HONESTY_FRAMING_RE.test(text)
 }
@@ -0,0 +1,150 @@
+/*
+ * @file JSON.parse for hook payloads that defers the big strings. A Write /
+ *   Edit payload carries the whole file in `tool_input.content` /
+ *   `new_string`, and a PostToolUse Read carries it again in
+ *   `tool_response`: megabytes, while most hooks only look at `tool_name`, a
+ *   path, or a command. `parseJsonLazy(text)` parses the envelope eagerly
+ *   but leaves every string value of LAZY_STRING_MIN+ chars as an accessor
+ *   that decodes its slice of `text` on first read (and then becomes a plain
+ *   data property). A payload nothing reads the content of never allocates
+ *   it, nor pays to unescape it.
+ *
+ *   How: one pass over `text` jumping quote to quote with `indexOf` finds
+ *   each string token. The quote count is the cost, so a prose-heavy write
+ *   scans in well under a millisecond. Each long value token is swapped for
+ *   a short placeholder, JSON.parse runs on the (small) rest, and the
+ *   placeholders are then replaced by accessors. Below LAZY_TEXT_MIN, or when
+ *   anything looks off (no closing quote, a top-level non-object, text that
+ *   already contains the placeholder marker), it is plain JSON.parse.
+ *
+ *   One difference from JSON.parse: a malformed escape INSIDE a deferred
+ *   string throws when that field is read instead of failing the whole
+ *   parse. The dispatcher fails each hook open on a throw, so such a payload
+ *   still ends as an allow.
+ */
+
+// Texts shorter than this go straight to JSON.parse: the scan can't win.
+export const LAZY_TEXT_MIN = 256 * 1024
+// String values at least this long (in chars, quotes included) are deferred.
+export const LAZY_STRING_MIN = 64 * 1024
+
+const MARKER = '\u0000fleet-lazy:'
+// The marker as it appears in JSON text.
+const MARKER_JSON = '\\u0000fleet-lazy:'
+
+const BACKSLASH = 92
+
+function isWhitespace(code: number): boolean {
+  return code === 32 || code === 10 || code === 13 || code === 9
+}
+
+/**
+ * Parse `text` like JSON.parse, deferring long string values (see the file
+ * header). Throws exactly when JSON.parse would on the envelope.
+ */
+export function parseJsonLazy(text: string): unknown {
+  if (text.length < LAZY_TEXT_MIN || text.includes(MARKER_JSON)) {
+    return JSON.parse(text)
+  }
+  // [start, end) of each deferred string token, quotes included.
+  const spans: number[] = []
+  let from = 0
+  for (;;) {
+    const open = text.indexOf('"', from)
+    if (open === -1) {
+      break
+    }
+    let close = open
+    for (;;) {
+      close = text.indexOf('"', close + 1)
+      if (close === -1) {
+        return JSON.parse(text)
+      }
+      // Escaped when preceded by an odd run of backslashes.
+      let k = close - 1
+      while (text.charCodeAt(k) === BACKSLASH) {
+        k -= 1
+      }
+      if ((close - 1 - k) % 2 === 0) {
+        break
+      }
+    }
+    from = close + 1
+    if (close + 1 - open < LAZY_STRING_MIN) {
+      continue
+    }
+    // A key (followed by `:`) must stay a key.
+    let next = from
+    while (next < text.length && isWhitespace(text.charCodeAt(next))) {
+      next += 1
+    }
+    if (text.charCodeAt(next) !== 58) {
+      spans.push(open, from)
+    }
+  }
+  if (!spans.length) {
+    return JSON.parse(text)
+  }
+  const pieces: string[] = []
+  let prev = 0
+  for (let i = 0, { length } = spans; i < length; i += 2) {
+    pieces.push(text.slice(prev, spans[i]), `"${MARKER_JSON}${i}"`)
+    prev = spans[i + 1]!
+  }
+  pieces.push(text.slice(prev))
+  const root = JSON.parse(pieces.join('')) as unknown
+  if (root === null || typeof root !== 'object') {
+    return JSON.parse(text)
+  }
+  installDeferred(root as Record<string, unknown>, text, spans)
+  return root
+}
+
+function installDeferred(
+  node: Record<string, unknown>,
+  text: string,
+  spans: readonly number[],
+): void {
+  for (const key of Object.keys(node)) {
+    const value = node[key]
+    if (typeof value === 'string') {
+      if (value.startsWith(MARKER)) {
+        const at = Number(value.slice(MARKER.length))
+        defer(node, key, text, spans[at]!, spans[at + 1]!)
+      }
+    } else if (value !== null && typeof value === 'object') {
+      installDeferred(value as Record<string, unknown>, text, spans)
+    }
+  }
+}
+
+function defer(
+  owner: Record<string, unknown>,
+  key: string,
+  text: string,
+  start: number,
+  end: number,
+): void {
+  const settle = (value: unknown) => {
+    Object.defineProperty(owner, key, {
+      __proto__: null,
+      configurable: true,
+      enumerable: true,
+      value,
+      writable: true,
+    } as PropertyDescriptor)
+  }
+  Object.defineProperty(owner, key, {
+    __proto__: null,
+    configurable: true,
+    enumerable: true,
+    get() {
+      const value = JSON.parse(text.slice(start, end)) as string
+      settle(value)
+      return value
+    },
+    set(value: unknown) {
+      settle(value)
+    },
+  } as PropertyDescriptor)
+}
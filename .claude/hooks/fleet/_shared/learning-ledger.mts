@@ -21,14 +21,36 @@
  *      dep-0 runtime-state store at `node_modules/.cache/fleet/socket-learning-ledger/`
  *      — never tracked; OS-temp fallback.
  *
+ *   The store is one append-only log, `ledger.log` (`append-log.mts`): an
+ *   `{"o":…}` line per observation, and `{"e":…}` lines for entries already
+ *   folded by a compaction. `recordOccurrence` appends its observation
+ *   instead of rewriting the ledger, so two sessions recording at once both
+ *   count. Folding the log replays `foldObservation` over it and merges each
+ *   `e` line into its similar entry, so the fold is the same whatever the
+ *   line order and however often a line repeats. That lets a compaction past
+ *   COMPACT_BYTES (`compactLog`) set the log aside and append its pruned fold
+ *   to the fresh one, rather than rewrite a file other sessions are still
+ *   appending to. A pre-log `ledger.json` seeds the first log.
+ *
  *   Fail-open contract: every fs function returns a safe default on IO / parse
  *   errors. A broken ledger must never block a tool call or a Stop hook.
  */
 
-import { existsSync, mkdirSync, readFileSync, writeFileSync } from 'node:fs'
+import { existsSync, readFileSync } from 'node:fs'
 import path from 'node:path'
 import process from 'node:process'
 
+import { safeDeleteSync } from '@socketsecurity/lib-stable/fs/safe'
+
+import {
+  appendLogLine,
+  appendLogLines,
+  compactLog,
+  logExists,
+  logSize,
+  readCompactingLogLines,
+} from './append-log.mts'
+
 // The canonical learning taxonomy. Caliber ships two divergent vocabularies
 // (an auto-distill set and a manual `save-learning` set); this reconciles them
 // into ONE, taking the auto set (marked authoritative in its prompt) as the
@@ -57,6 +79,12 @@ export const LEDGER_TTL_MS = 90 * 24 * 60 * 60 * 1000
 
 const STORE_NAME = 'socket-learning-ledger'
 
+// The pre-log whole-file ledger, read once to seed the log.
+const LEGACY_LEDGER_NAME = 'ledger.json'
+
+// A log past this size is compacted on the next record.
+export const COMPACT_BYTES = 64 * 1024
+
 // ── Taxonomy + pure text ops ────────────────────────────────────────────────
 
 const TYPE_PREFIX_RE = /^\s*(?:[-*]\s*)?\*\*\[[a-z-]+\]\*\*\s*/i
@@ -173,7 +201,7 @@ export function resolveStoreRoot(projectDir: string | undefined): string {
 }
 
 export function ledgerFilePath(storeRoot: string): string {
-  return path.join(storeRoot, 'ledger.json')
+  return path.join(storeRoot, 'ledger.log')
 }
 
 /**
@@ -238,24 +266,102 @@ export function foldObservation(
     sessions: seenThisSession
       ? existing.sessions
       : [...existing.sessions, obs.sessionId],
-    firstSeen: existing.firstSeen,
-    lastSeen: obs.now,
+    firstSeen: Math.min(existing.firstSeen, obs.now),
+    lastSeen: Math.max(existing.lastSeen, obs.now),
   }
   entries[idx] = merged
-  return { ledger: { entries, updatedAt: obs.now }, occurrences }
+  return {
+    ledger: { entries, updatedAt: Math.max(ledger.updatedAt, obs.now) },
+    occurrences,
+  }
+}
+
+/**
+ * Fold a compacted entry into a ledger: merged into the entry it is similar
+ * to (sessions unioned, each session new to that entry one more occurrence),
+ * else appended. Merging the same entry twice changes nothing. Pure.
+ */
+export function mergeEntry(
+  ledger: LearningLedger,
+  entry: LedgerEntry,
+): LearningLedger {
+  const updatedAt = Math.max(ledger.updatedAt, entry.lastSeen)
+  const idx = ledger.entries.findIndex(e =>
+    isSimilarLearning(e.key, entry.key),
+  )
+  if (idx === -1) {
+    return { entries: [...ledger.entries, entry], updatedAt }
+  }
+  const existing = ledger.entries[idx]!
+  const added = entry.sessions.filter(id => !existing.sessions.includes(id))
+  const entries = [...ledger.entries]
+  entries[idx] = {
+    key: existing.key,
+    type: existing.type ?? entry.type,
+    occurrences: existing.occurrences + added.length,
+    sessions: [...existing.sessions, ...added],
+    firstSeen: Math.min(existing.firstSeen, entry.firstSeen),
+    lastSeen: Math.max(existing.lastSeen, entry.lastSeen),
+  }
+  return { entries, updatedAt }
 }
 
 // ── Thin fs shell (fail-open) ───────────────────────────────────────────────
 
+interface ObservationRecord {
+  readonly k: string
+  readonly s: string
+  readonly t: number
+  readonly y?: LearningType | undefined
+}
+
+function isEntry(value: unknown): value is LedgerEntry {
+  const e = value as LedgerEntry | undefined
+  return (
+    !!e &&
+    typeof e.key === 'string' &&
+    typeof e.occurrences === 'number' &&
+    Array.isArray(e.sessions) &&
+    typeof e.firstSeen === 'number' &&
+    typeof e.lastSeen === 'number'
+  )
+}
+
 /**
- * Read the ledger for a project dir. Returns an empty ledger on any IO / parse
- * error — a broken store must never block a hook.
+ * Fold log lines into a ledger. Order-insensitive and idempotent (see the
+ * file header). Unparseable lines (a torn append) are skipped. Pure.
  */
-export function readLedger(projectDir: string | undefined): LearningLedger {
+export function foldLogLines(lines: readonly string[]): LearningLedger {
+  let ledger: LearningLedger = EMPTY_LEDGER
+  for (let i = 0, { length } = lines; i < length; i += 1) {
+    let record: { e?: unknown; o?: ObservationRecord } | undefined
+    try {
+      record = JSON.parse(lines[i]!) as typeof record
+    } catch {
+      continue
+    }
+    if (isEntry(record?.e)) {
+      ledger = mergeEntry(ledger, record.e)
+      continue
+    }
+    const o = record?.o
+    if (o && typeof o.k === 'string' && typeof o.t === 'number') {
+      ledger = foldObservation(ledger, {
+        now: o.t,
+        sessionId: String(o.s),
+        text: o.k,
+        type: o.y,
+      }).ledger
+    }
+  }
+  return ledger
+}
+
+function readLegacyLedger(root: string): LearningLedger | undefined {
   try {
-    const file = ledgerFilePath(resolveStoreRoot(projectDir))
+    const file = path.join(root, LEGACY_LEDGER_NAME)
     if (!existsSync(file)) {
-      return EMPTY_LEDGER
+      return undefined
     }
     const parsed = JSON.parse(readFileSync(file, 'utf8')) as unknown
     if (
@@ -263,17 +369,41 @@ export function readLedger(projectDir: string | undefined): LearningLedger {
       typeof parsed !== 'object' ||
       !Array.isArray((parsed as LearningLedger).entries)
     ) {
-      return EMPTY_LEDGER
+      return undefined
     }
     return parsed as LearningLedger
+  } catch {
+    return undefined
+  }
+}
+
+/**
+ * Read the ledger for a project dir. Returns an empty ledger on any IO / parse
+ * error — a broken store must never block a hook.
+ */
+export function readLedger(projectDir: string | undefined): LearningLedger {
+  try {
+    const root = resolveStoreRoot(projectDir)
+    const file = ledgerFilePath(root)
+    if (!logExists(file)) {
+      return readLegacyLedger(root) ?? EMPTY_LEDGER
+    }
+    return foldLogLines(readCompactingLogLines(file))
   } catch {
     return EMPTY_LEDGER
   }
 }
 
+function entryLines(ledger: LearningLedger): string[] {
+  return ledger.entries.map(e => JSON.stringify({ e }))
+}
+
 /**
- * Write the ledger. Best-effort: swallows IO errors (fail-open). Creates the
- * store dir if absent.
+ * Append the ledger's entries to the log, one `{"e":…}` line each, in one
+ * write. The fold merges them into whatever the log already holds, so this
+ * seeds a new log and is harmless on a busy one. Drops a pre-log
+ * `ledger.json` once its entries are in the log. Best-effort: swallows IO
+ * errors (fail-open).
  */
 export function writeLedger(
   projectDir: string | undefined,
@@ -281,10 +411,9 @@ export function writeLedger(
 ): void {
   try {
     const root = resolveStoreRoot(projectDir)
-    if (!existsSync(root)) {
-      mkdirSync(root, { recursive: true })
+    if (appendLogLines(ledgerFilePath(root), entryLines(ledger))) {
+      safeDeleteSync(path.join(root, LEGACY_LEDGER_NAME), { force: true })
     }
-    writeFileSync(ledgerFilePath(root), JSON.stringify(ledger), 'utf8')
   } catch {
     // Fail-open: a store that cannot be written just loses recurrence history.
   }
@@ -292,7 +421,8 @@ export function writeLedger(
 
 /**
  * Record one observation and return its current cross-session occurrence count.
- * Prunes stale entries on the same pass. Fail-open — returns 0 on any error.
+ * Prunes stale entries on the same pass (they leave the log at its next
+ * compaction). Fail-open — returns 0 on any error.
  */
 export function recordOccurrence(
   projectDir: string | undefined,
@@ -310,13 +440,36 @@ export function recordOccurrence(
       now,
       ttlMs: LEDGER_TTL_MS,
     })
-    const { ledger, occurrences } = foldObservation(pruned, {
+    const { occurrences } = foldObservation(pruned, {
       text: obs.text,
       sessionId: obs.sessionId,
       type: obs.type,
       now,
     })
-    writeLedger(projectDir, ledger)
+    if (!occurrences) {
+      return 0
+    }
+    const file = ledgerFilePath(resolveStoreRoot(projectDir))
+    // First record since the log format: carry the old ledger over whole.
+    if (!logExists(file)) {
+      writeLedger(projectDir, pruned)
+    }
+    const record: ObservationRecord = {
+      k: normalizeLearning(obs.text),
+      s: obs.sessionId,
+      t: now,
+      y: obs.type,
+    }
+    appendLogLine(file, JSON.stringify({ o: record }))
+    if (logSize(file) > COMPACT_BYTES) {
+      // Folds the log as it stands on disk, other sessions' lines included,
+      // not the `ledger` this call read before its own append.
+      compactLog(file, lines =>
+        entryLines(
+          pruneLedger(foldLogLines(lines), { now, ttlMs: LEDGER_TTL_MS }),
+        ),
+      )
+    }
     return occurrences
   } catch {
     return 0
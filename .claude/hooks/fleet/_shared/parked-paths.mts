@@ -16,18 +16,13 @@
 import { existsSync, mkdirSync, readFileSync, writeFileSync } from 'node:fs'
 import os from 'node:os'
 import path from 'node:path'
-import { fileURLToPath } from 'node:url'
+
+import { bundleDir } from './bundle-dir.mts'
 
 // Generous by hook standards: a park typically waits on a doc/decision that
 // arrives within a working day. Re-park to extend.
 export const PARKED_TTL_MS = 24 * 60 * 60 * 1000
 
-// Last-resort fallback when a caller passes no projectDir and the agent
-// runner hasn't set CLAUDE_PROJECT_DIR: walk up from this file's own location
-// (`.claude/hooks/fleet/_shared/`) to the repo root.
-const HERE = path.dirname(fileURLToPath(import.meta.url))
-const FALLBACK_PROJECT_DIR = path.join(HERE, '..', '..', '..', '..')
-
 export interface ParkedEntry {
   readonly note?: string | undefined
   readonly parkedAt: number
@@ -41,8 +36,13 @@ export interface ParkedEntry {
  * under OS temp when node_modules doesn't exist yet.
  */
 export function resolveParkedFile(projectDir: string | undefined): string {
+  // Last-resort fallback when a caller passes no projectDir and the agent
+  // runner hasn't set CLAUDE_PROJECT_DIR: walk up from the bundle dir
+  // (`.claude/hooks/fleet/_shared/` or `_dispatch/`) to the repo root.
   const base =
-    projectDir ?? process.env['CLAUDE_PROJECT_DIR'] ?? FALLBACK_PROJECT_DIR
+    projectDir ??
+    process.env['CLAUDE_PROJECT_DIR'] ??
+    path.join(bundleDir(import.meta.url), '..', '..', '..', '..')
   const cacheDir = path.join(base, 'node_modules', '.cache')
   if (existsSync(path.join(base, 'node_modules'))) {
     return path.join(cacheDir, 'fleet', 'socket-parked-paths', 'parked.json')
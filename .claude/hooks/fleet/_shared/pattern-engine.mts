@@ -0,0 +1,273 @@
+/**
+ * @file Shared literal prefilter for the content guards. The secret-value
+ *   catalog (`token-patterns.mts`), the AI-slop and honesty tables
+ *   (`ai-slop-patterns.mts`, `honesty-framing.mts`) and the dated-citation
+ *   markers (`dated-citation.mts`) each used to run their whole regex list
+ *   over the same command / edit content, so one multi-KB Write was scanned
+ *   dozens of times per dispatch.
+ *
+ *   Each of those modules registers, per regex, the LITERALS a match can't
+ *   exist without (`registerLiterals`). Every registered literal from every
+ *   module goes into ONE Aho-Corasick automaton, so a text is walked once no
+ *   matter how many guards ask about it, and `mayMatch(regex, text)` is then
+ *   a set lookup. Consumers keep their regex loops and just skip a regex
+ *   `mayMatch` rules out; the regexes still decide every verdict, so results
+ *   are unchanged. An unregistered regex (a hook's own local pattern) always
+ *   "may match".
+ *
+ *   Literals are ASCII. The automaton runs over ASCII-case-folded text; a
+ *   regex with the `i` flag matches its literals that way, any other regex
+ *   has each hit confirmed case-exactly against the original text. (Without
+ *   the `u` flag, `/i` folds ASCII only against ASCII, so the fold is exact.)
+ *   A regex registered with a non-ASCII or empty literal is never ruled out.
+ *
+ *   The automaton is a dense transition table over the characters that occur
+ *   in some literal (every other character resets to the root). It is built
+ *   on the first scan after a registration, and `compilePatternEngine()`
+ *   builds it eagerly: the snapshot entry calls it during the build pass, so
+ *   the blob boots with the table already in the heap. Per-text results are
+ *   memoized for the last few texts (recency-ordered, like `parseCommands`),
+ *   since every guard of a dispatch scans the same one or two fields.
+ */
+
+const SCAN_MEMO_SIZE = 4
+
+interface Literal {
+  readonly caseInsensitive: boolean
+  readonly text: string
+}
+
+interface Automaton {
+  readonly classOf: Uint8Array
+  readonly classes: number
+  readonly delta: Int32Array
+  readonly outputs: ReadonlyArray<readonly number[] | undefined>
+}
+
+const literals: Literal[] = []
+// Registered regex → its literal ids; undefined = registered but never
+// ruled out.
+const registered = new WeakMap<RegExp, readonly number[] | undefined>()
+let automaton: Automaton | undefined
+// Bumped on every registration so a memoized scan from before it is redone.
+let generation = 0
+
+interface ScanResult {
+  readonly generation: number
+  // Literal id → start offsets, ascending; absent when it never occurred.
+  readonly starts: Map<number, number[]>
+}
+
+const scanMemo = new Map<string, ScanResult>()
+
+function foldAscii(code: number): number {
+  return code >= 65 && code <= 90 ? code + 32 : code
+}
+
+function isAscii(text: string): boolean {
+  for (let i = 0, { length } = text; i < length; i += 1) {
+    if (text.charCodeAt(i) > 127) {
+      return false
+    }
+  }
+  return true
+}
+
+function buildAutomaton(): Automaton {
+  // Character classes: 0 = "in no literal", then one per folded character.
+  const classOf = new Uint8Array(128)
+  let classes = 1
+  for (let id = 0, { length } = literals; id < length; id += 1) {
+    const { text } = literals[id]!
+    for (let i = 0, { length: tlen } = text; i < tlen; i += 1) {
+      const code = foldAscii(text.charCodeAt(i))
+      if (classOf[code] === 0) {
+        classOf[code] = classes
+        classes += 1
+      }
+    }
+  }
+  for (let code = 65; code <= 90; code += 1) {
+    classOf[code] = classOf[code + 32]!
+  }
+  // Trie.
+  const child: Array<Map<number, number>> = [new Map()]
+  const ends: number[][] = [[]]
+  for (let id = 0, { length } = literals; id < length; id += 1) {
+    const { text } = literals[id]!
+    let node = 0
+    for (let i = 0, { length: tlen } = text; i < tlen; i += 1) {
+      const cls = classOf[foldAscii(text.charCodeAt(i))]!
+      let next = child[node]!.get(cls)
+      if (next === undefined) {
+        next = child.length
+        child.push(new Map())
+        ends.push([])
+        child[node]!.set(cls, next)
+      }
+      node = next
+    }
+    ends[node]!.push(id)
+  }
+  // Breadth-first: failure links folded straight into a dense table, and
+  // each node's outputs merged with its failure node's.
+  const nodeCount = child.length
+  const delta = new Int32Array(nodeCount * classes)
+  const fail = new Int32Array(nodeCount)
+  const outputs: Array<number[] | undefined> = new Array(nodeCount)
+  const queue: number[] = []
+  for (let cls = 1; cls < classes; cls += 1) {
+    const next = child[0]!.get(cls)
+    if (next !== undefined) {
+      delta[cls] = next
+      queue.push(next)
+    }
+  }
+  for (let q = 0; q < queue.length; q += 1) {
+    const node = queue[q]!
+    const merged = [...ends[node]!, ...(outputs[fail[node]!] ?? [])]
+    outputs[node] = merged.length ? merged : undefined
+    for (let cls = 1; cls < classes; cls += 1) {
+      const next = child[node]!.get(cls)
+      const viaFail = delta[fail[node]! * classes + cls]!
+      if (next === undefined) {
+        delta[node * classes + cls] = viaFail
+      } else {
+        fail[next] = viaFail
+        delta[node * classes + cls] = next
+        queue.push(next)
+      }
+    }
+  }
+  return { __proto__: null, classOf, classes, delta, outputs } as Automaton
+}
+
+function scanUncached(text: string): ScanResult {
+  automaton ??= buildAutomaton()
+  const { classOf, classes, delta, outputs } = automaton
+  const starts = new Map<number, number[]>()
+  let state = 0
+  for (let i = 0, { length } = text; i < length; i += 1) {
+    const code = text.charCodeAt(i)
+    state = delta[state * classes + (code < 128 ? classOf[code]! : 0)]!
+    const out = outputs[state]
+    if (out === undefined) {
+      continue
+    }
+    for (let j = 0, { length: olen } = out; j < olen; j += 1) {
+      const id = out[j]!
+      const lit = literals[id]!
+      const start = i - lit.text.length + 1
+      if (!lit.caseInsensitive && !text.startsWith(lit.text, start)) {
+        continue
+      }
+      let list = starts.get(id)
+      if (!list) {
+        list = []
+        starts.set(id, list)
+      }
+      list.push(start)
+    }
+  }
+  return { __proto__: null, generation, starts } as ScanResult
+}
+
+function scan(text: string): ScanResult {
+  let result = scanMemo.get(text)
+  if (result) {
+    // Refresh recency: Map iteration order is insertion order.
+    scanMemo.delete(text)
+  }
+  if (!result || result.generation !== generation) {
+    result = scanUncached(text)
+    if (scanMemo.size >= SCAN_MEMO_SIZE) {
+      scanMemo.delete(scanMemo.keys().next().value!)
+    }
+  }
+  scanMemo.set(text, result)
+  return result
+}
+
+/**
+ * Register the literals at least one of which every match of `regex`
+ * contains. Call at module eval, next to the regex, so the snapshot build
+ * sees every registration. The `i` flag makes them case-insensitive.
+ */
+export function registerLiterals(
+  regex: RegExp,
+  literalList: readonly string[],
+): void {
+  if (
+    !literalList.length ||
+    !literalList.every(l => l.length > 0 && isAscii(l))
+  ) {
+    registered.set(regex, undefined)
+    return
+  }
+  const caseInsensitive = regex.flags.includes('i')
+  const ids: number[] = []
+  for (let i = 0, { length } = literalList; i < length; i += 1) {
+    ids.push(literals.length)
+    literals.push({
+      __proto__: null,
+      caseInsensitive,
+      text: caseInsensitive ? literalList[i]!.toLowerCase() : literalList[i]!,
+    } as Literal)
+  }
+  registered.set(regex, ids)
+  automaton = undefined
+  generation += 1
+}
+
+/**
+ * False only when `regex` is registered and `text` contains none of its
+ * literals, i.e. `regex` cannot match `text`.
+ */
+export function mayMatch(regex: RegExp, text: string): boolean {
+  const ids = registered.get(regex)
+  if (!ids) {
+    return true
+  }
+  const { starts } = scan(text)
+  for (let i = 0, { length } = ids; i < length; i += 1) {
+    if (starts.has(ids[i]!)) {
+      return true
+    }
+  }
+  return false
+}
+
+/**
+ * Start offsets, ascending, of every occurrence in `text` of a literal
+ * registered for `regex`: where a match could be. Undefined when `regex` is
+ * unregistered or never ruled out (no offsets to offer).
+ */
+export function literalOffsets(
+  regex: RegExp,
+  text: string,
+): readonly number[] | undefined {
+  const ids = registered.get(regex)
+  if (!ids) {
+    return undefined
+  }
+  const { starts } = scan(text)
+  if (ids.length === 1) {
+    return starts.get(ids[0]!) ?? []
+  }
+  const all: number[] = []
+  for (let i = 0, { length } = ids; i < length; i += 1) {
+    const list = starts.get(ids[i]!)
+    if (list) {
+      all.push(...list)
+    }
+  }
+  return [...new Set(all)].sort((a, b) => a - b)
+}
+
+/**
+ * Build the automaton now instead of on the first scan. The snapshot entry
+ * calls this during the build pass so the table is part of the blob's heap.
+ */
+export function compilePatternEngine(): void {
+  automaton ??= buildAutomaton()
+}
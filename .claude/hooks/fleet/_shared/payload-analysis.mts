@@ -0,0 +1,115 @@
+/*
+ * @file Per-payload analysis shared by every hook of one dispatch. One tool
+ *   call fans out to dozens of hooks, and most of them derive the same few
+ *   facts from it: the Bash command parsed into segments, the about-to-land
+ *   edit content, the full post-edit document (a disk read), the
+ *   evasion-normalized form of that content. `analyzePayload(payload)`
+ *   returns one lazily-populated view per payload object — each field is
+ *   computed on first read and cached, so a dispatch pays for each at most
+ *   once no matter how many hooks ask.
+ *
+ *   The dispatcher passes it as the second argument of every `check` (see
+ *   `GuardCheck` in guard.mts); a hook invoked standalone can call
+ *   `analyzePayload` itself and gets the same memoized view. Keyed on the
+ *   payload object through a WeakMap, so the view lives exactly as long as
+ *   the payload it describes. The underlying helpers (`parseCommands`,
+ *   `resolveEditedText`, `normalizeForScan`) memoize on their own too, so a
+ *   hook that keeps calling them directly still shares the work.
+ */
+
+import { normalizeForScan } from './evasion-normalize.mts'
+import {
+  readCommand,
+  readFilePath,
+  readWriteContent,
+  resolveEditedText,
+} from './payload.mts'
+import type { ToolCallPayload } from './payload.mts'
+import { parseCommands } from './shell-command.mts'
+import type { Command } from './shell-command.mts'
+
+export interface PayloadAnalysis {
+  /**
+   * `tool_input.command`, or undefined when absent / not a string.
+   */
+  readonly command: string | undefined
+  /**
+   * The command parsed into segments (shared; do not mutate). Empty when
+   * there is no command.
+   */
+  readonly commands: readonly Command[]
+  /**
+   * The about-to-land text: Write `content` / Edit `new_string`.
+   */
+  readonly content: string | undefined
+  /**
+   * The full document after the edit applies (`resolveEditedText`).
+   */
+  readonly editedText: string | undefined
+  /**
+   * `tool_input.file_path`, or undefined when absent / not a string.
+   */
+  readonly filePath: string | undefined
+  /**
+   * `content` with invisible Unicode stripped and homoglyphs folded; '' when
+   * there is no content.
+   */
+  readonly normalizedContent: string
+}
+
+const analyses = new WeakMap<ToolCallPayload, PayloadAnalysis>()
+
+/**
+ * The shared, lazily-populated analysis of `payload`. Same object for every
+ * call with the same payload.
+ */
+export function analyzePayload(payload: ToolCallPayload): PayloadAnalysis {
+  let analysis = analyses.get(payload)
+  if (!analysis) {
+    analysis = createAnalysis(payload)
+    analyses.set(payload, analysis)
+  }
+  return analysis
+}
+
+function createAnalysis(payload: ToolCallPayload): PayloadAnalysis {
+  // Each slot: undefined = not computed yet; the box holds the result
+  // (which may itself be undefined).
+  let command: { value: string | undefined } | undefined
+  let commands: readonly Command[] | undefined
+  let content: { value: string | undefined } | undefined
+  let editedText: { value: string | undefined } | undefined
+  let filePath: { value: string | undefined } | undefined
+  let normalizedContent: string | undefined
+  const analysis: PayloadAnalysis = {
+    __proto__: null,
+    get command() {
+      command ??= { value: readCommand(payload) }
+      return command.value
+    },
+    get commands() {
+      if (!commands) {
+        const line = analysis.command
+        commands = line ? parseCommands(line) : []
+      }
+      return commands
+    },
+    get content() {
+      content ??= { value: readWriteContent(payload) }
+      return content.value
+    },
+    get editedText() {
+      editedText ??= { value: resolveEditedText(payload) }
+      return editedText.value
+    },
+    get filePath() {
+      filePath ??= { value: readFilePath(payload) }
+      return filePath.value
+    },
+    get normalizedContent() {
+      normalizedContent ??= normalizeForScan(analysis.content ?? '')
+      return normalizedContent
+    },
+  } as PayloadAnalysis
+  return analysis
+}
@@ -32,6 +32,7 @@ import { safeReadFileSync } from '@socketsecurity/lib-stable/fs/read-file'
 
 import { isFleetManagedDir, isFleetManagedPath } from './fleet-repo.mts'
 import { commandWorkingDir } from './shell-command.mts'
+import { parseJsonLazy } from './lazy-json.mts'
 import { readStdin } from './transcript.mts'
 
 /**
@@ -131,7 +132,25 @@ export function readWriteContent(payload: ToolCallPayload): string | undefined {
 export function resolveEditedText(
   payload: ToolCallPayload,
 ): string | undefined {
-  const input = payload?.tool_input
+  if (!payload || typeof payload !== 'object') {
+    return undefined
+  }
+  // Keyed on the payload object: every hook of one dispatch gets the same
+  // payload, so the disk read + edit replay runs once per tool call.
+  if (editedTextMemo.has(payload)) {
+    return editedTextMemo.get(payload)
+  }
+  const text = resolveEditedTextUncached(payload)
+  editedTextMemo.set(payload, text)
+  return text
+}
+
+const editedTextMemo = new WeakMap<ToolCallPayload, string | undefined>()
+
+function resolveEditedTextUncached(
+  payload: ToolCallPayload,
+): string | undefined {
+  const input = payload.tool_input
   if (!input) {
     return undefined
   }
@@ -194,7 +213,7 @@ export async function readPayload(): Promise<ToolCallPayload | undefined> {
     return undefined
   }
   try {
-    return JSON.parse(raw) as ToolCallPayload
+    return parseJsonLazy(raw) as ToolCallPayload
   } catch {
     return undefined
   }
@@ -0,0 +1,275 @@
+/**
+ * @file Shared async scheduler for the subprocesses hooks spawn (git, gh,
+ *   actionlint…). Several hooks of one event ask git the same question —
+ *   `git diff --cached --name-only` from the staging guards,
+ *   `git status --porcelain` from the dirty-tree checks — and each used to
+ *   pay its own spawnSync for it, under its own timeout, one after another.
+ *
+ *   `runProcess` instead:
+ *
+ *   - Dedupes: an identical [command, args, cwd] already in flight is
+ *     awaited rather than spawned again. Inside a dispatch scope
+ *     (`openProcessScope` / `closeProcessScope`, opened by `dispatch()`) a
+ *     SETTLED result is reused too, until `invalidateProcessScope()`. Most
+ *     hooks only read, but not all: on Stop, `auto-land-on-stop` commits
+ *     between `ai-config-drift-nudge` listing the worktree and
+ *     `dirty-worktree-stop-guard` blocking on it. So the dispatcher
+ *     invalidates each time a `stateful` hook settles, and a probe started
+ *     before that is never joined by one started after it. Pass
+ *     `dedupe: false` for a command with side effects.
+ *   - Caps concurrency: at most `maxConcurrentProcesses()` children run at
+ *     once (2 on win32, where process creation is the bottleneck); the rest
+ *     queue FIFO.
+ *   - Shares one deadline: a scope's spawns all count against one
+ *     `spawnTimeoutMs(base)` from when the scope opened, so ten probes can't
+ *     stack ten timeouts into one event. A spawn past the deadline resolves
+ *     as timed out without running, and the caller fails open on it exactly
+ *     as it does on a killed probe.
+ *
+ *   Nothing runs at module eval, so the module is snapshot-safe.
+ */
+
+import os from 'node:os'
+
+import { WIN32 } from '@socketsecurity/lib-stable/constants/platform'
+import { spawn } from '@socketsecurity/lib-stable/process/spawn/child'
+import { isSpawnError } from '@socketsecurity/lib-stable/process/spawn/errors'
+
+import { spawnTimeoutMs } from './spawn-timeout.mts'
+
+// The fleet's standard local probe timeout, before the win32 multiplier.
+const DEFAULT_TIMEOUT_MS = 5000
+
+// A whole dispatch scope's spawns share this much wall time.
+const SCOPE_BUDGET_MS = 10_000
+
+const POSIX_MAX_CONCURRENT = 8
+const WIN32_MAX_CONCURRENT = 2
+
+export interface ProcessOptions {
+  readonly cwd?: string | undefined
+  // false for a command with side effects: always spawned, never shared.
+  readonly dedupe?: boolean | undefined
+  // Per-spawn ceiling, before the win32 multiplier; the scope deadline can
+  // only shorten it.
+  readonly timeoutMs?: number | undefined
+}
+
+export interface ProcessResult {
+  readonly error: boolean
+  readonly signal: string | undefined
+  // Exit code; undefined when the process never exited normally.
+  readonly status: number | undefined
+  readonly stderr: string
+  readonly stdout: string
+  readonly timedOut: boolean
+}
+
+interface ProcessScope {
+  readonly deadline: number
+  depth: number
+  readonly settled: Map<string, ProcessResult>
+}
+
+let scope: ProcessScope | undefined
+// Bumped by invalidateProcessScope: part of every dedupe key, so a probe
+// started before a state change is never shared with one started after it.
+let generation = 0
+const inFlight = new Map<string, Promise<ProcessResult>>()
+const queue: Array<() => void> = []
+let running = 0
+
+export function maxConcurrentProcesses(): number {
+  return WIN32
+    ? WIN32_MAX_CONCURRENT
+    : Math.max(1, Math.min(os.availableParallelism(), POSIX_MAX_CONCURRENT))
+}
+
+function timedOutResult(): ProcessResult {
+  return {
+    __proto__: null,
+    error: false,
+    signal: undefined,
+    status: undefined,
+    stderr: '',
+    stdout: '',
+    timedOut: true,
+  } as ProcessResult
+}
+
+function acquireSlot(): Promise<void> {
+  if (running < maxConcurrentProcesses()) {
+    running += 1
+    return Promise.resolve()
+  }
+  return new Promise<void>(resolve => {
+    queue.push(() => {
+      running += 1
+      resolve()
+    })
+  })
+}
+
+function releaseSlot(): void {
+  running -= 1
+  queue.shift()?.()
+}
+
+async function spawnScheduled(
+  command: string,
+  args: readonly string[],
+  cwd: string | undefined,
+  timeoutMs: number,
+  deadline: number | undefined,
+): Promise<ProcessResult> {
+  await acquireSlot()
+  try {
+    // Waiting for a slot spends the shared deadline too.
+    const left =
+      deadline === undefined
+        ? timeoutMs
+        : Math.min(timeoutMs, deadline - Date.now())
+    if (left <= 0) {
+      return timedOutResult()
+    }
+    const pending = spawn(command, [...args], {
+      cwd,
+      stdio: 'pipe',
+      stdioString: true,
+      windowsHide: true,
+    })
+    let timedOut = false
+    const timer = setTimeout(() => {
+      timedOut = true
+      pending.process?.kill()
+    }, left)
+    timer.unref?.()
+    try {
+      const r = await pending
+      return {
+        __proto__: null,
+        error: false,
+        signal: undefined,
+        status: typeof r.code === 'number' ? r.code : undefined,
+        stderr: String(r.stderr ?? ''),
+        stdout: String(r.stdout ?? ''),
+        timedOut,
+      } as ProcessResult
+    } catch (e) {
+      if (isSpawnError(e)) {
+        return {
+          __proto__: null,
+          error: false,
+          signal:
+            typeof e.signal === 'string'
+              ? e.signal
+              : timedOut
+                ? 'SIGTERM'
+                : undefined,
+          status: typeof e.code === 'number' ? e.code : undefined,
+          stderr: String(e.stderr ?? ''),
+          stdout: String(e.stdout ?? ''),
+          timedOut,
+        } as ProcessResult
+      }
+      // ENOENT and friends: the binary never ran.
+      return {
+        __proto__: null,
+        error: true,
+        signal: undefined,
+        status: undefined,
+        stderr: '',
+        stdout: '',
+        timedOut,
+      } as ProcessResult
+    } finally {
+      clearTimeout(timer)
+    }
+  } finally {
+    releaseSlot()
+  }
+}
+
+/**
+ * Run `command args` under the shared scheduler. Never rejects: a spawn
+ * error, a kill or a blown deadline all come back as a result with no
+ * `status`, which the caller treats like any failed probe.
+ */
+export function runProcess(
+  command: string,
+  args: readonly string[],
+  options?: ProcessOptions | undefined,
+): Promise<ProcessResult> {
+  const opts = { __proto__: null, ...options } as ProcessOptions
+  const timeoutMs = spawnTimeoutMs(opts.timeoutMs ?? DEFAULT_TIMEOUT_MS)
+  const current = scope
+  const deadline = current?.deadline
+  if (opts.dedupe === false) {
+    return spawnScheduled(command, args, opts.cwd, timeoutMs, deadline)
+  }
+  const key = JSON.stringify([generation, command, args, opts.cwd ?? ''])
+  const startedIn = generation
+  const reused = current?.settled.get(key)
+  if (reused) {
+    return Promise.resolve(reused)
+  }
+  const shared = inFlight.get(key)
+  if (shared) {
+    return shared
+  }
+  const promise = spawnScheduled(
+    command,
+    args,
+    opts.cwd,
+    timeoutMs,
+    deadline,
+  ).then(result => {
+    inFlight.delete(key)
+    // A timed-out probe is not an answer worth replaying.
+    if (
+      scope === current &&
+      current &&
+      generation === startedIn &&
+      !result.timedOut
+    ) {
+      current.settled.set(key, result)
+    }
+    return result
+  })
+  inFlight.set(key, promise)
+  return promise
+}
+
+/**
+ * Open the dispatch scope: settled results are reused and every spawn shares
+ * one deadline until the matching `closeProcessScope()`. Nested opens join
+ * the outer scope.
+ */
+export function openProcessScope(): void {
+  if (scope) {
+    scope.depth += 1
+    return
+  }
+  scope = {
+    __proto__: null,
+    deadline: Date.now() + spawnTimeoutMs(SCOPE_BUDGET_MS),
+    depth: 1,
+    settled: new Map(),
+  } as ProcessScope
+}
+
+/**
+ * Forget the scope's settled results after something may have changed the
+ * repo (a hook that commits, stages or writes files): the next identical
+ * probe spawns again. Outside a scope it only retires in-flight sharing.
+ */
+export function invalidateProcessScope(): void {
+  generation += 1
+  scope?.settled.clear()
+}
+
+export function closeProcessScope(): void {
+  if (scope && (scope.depth -= 1) <= 0) {
+    scope = undefined
+  }
+}
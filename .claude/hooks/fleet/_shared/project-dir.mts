@@ -3,18 +3,17 @@
  *   `.claude/hooks/` (socket/no-process-cwd-in-scripts-hooks) — the agent
  *   runner may invoke a hook from any directory. Resolution order: the
  *   caller's preferred dir (usually the hook payload's `cwd`), then the
- *   agent-provided `CLAUDE_PROJECT_DIR`, then a last-resort walk up from this
- *   file's own location (`.claude/hooks/fleet/_shared/`) to the repo root.
+ *   agent-provided `CLAUDE_PROJECT_DIR`, then a last-resort walk up from the
+ *   bundle dir (`bundle-dir.mts`: this file's own `.claude/hooks/fleet/_shared/`,
+ *   or the booting checkout's `_dispatch/` under a snapshot) to the repo root.
  *   The bundled copy lives at `.claude/hooks/fleet/_dispatch/` — the same
  *   depth, so the fixed walk holds for both source and bundle.
  */
 
 import path from 'node:path'
 import process from 'node:process'
-import { fileURLToPath } from 'node:url'
 
-const HERE = path.dirname(fileURLToPath(import.meta.url))
-const FALLBACK_PROJECT_DIR = path.join(HERE, '..', '..', '..', '..')
+import { bundleDir } from './bundle-dir.mts'
 
 /**
  * The project root a hook should operate on. `preferred` (the hook payload's
@@ -22,5 +21,9 @@ const FALLBACK_PROJECT_DIR = path.join(HERE, '..', '..', '..', '..')
  * repo root this hook tree is installed in. Empty strings fall through.
  */
 export function resolveProjectDir(preferred?: string | undefined): string {
-  return preferred || process.env['CLAUDE_PROJECT_DIR'] || FALLBACK_PROJECT_DIR
+  return (
+    preferred ||
+    process.env['CLAUDE_PROJECT_DIR'] ||
+    path.join(bundleDir(import.meta.url), '..', '..', '..', '..')
+  )
 }
@@ -12,7 +12,8 @@
  *   - `parseCommands(command)` — split a command line into Command segments, one
  *     per shell command (separated by `;`, `&&`, `||`, `|`, `&`, and the
  *     boundaries of `$(…)` substitutions). Each segment carries its binary,
- *     args, leading `VAR=val` assignments, and indirection flags.
+ *     args, leading `VAR=val` assignments, and indirection flags. Memoized
+ *     per command line, so every guard of one dispatch shares one tokenize.
  *   - `findInvocation(command, { binary, subcommand })` — true when any segment
  *     invokes `binary` (optionally with `subcommand` as its first non-flag
  *     argument). Sees through chains, substitution, and quoting.
@@ -90,6 +91,14 @@ export interface Command {
   readonly viaEval: boolean
 }
 
+// One Bash payload is parsed by ~30 hooks per dispatch (every guard that
+// calls parseCommands / findInvocation / commandsFor on the same command
+// line). Memoize the last few lines so the shell-quote tokenize runs once per
+// dispatch, not once per hook. Small and recency-ordered: a long-lived daemon
+// sees one command per event, so eight entries is plenty.
+const PARSE_MEMO_SIZE = 8
+const parseMemo = new Map<string, readonly Command[]>()
+
 function isOp(e: ParseEntry): e is { op: string } {
   return typeof e === 'object' && e !== null && 'op' in e
 }
@@ -115,6 +124,22 @@ const ASSIGNMENT_RE = /^[A-Za-z_][A-Za-z0-9_]*=/
  * - An empty-string binary token means the binary was `$VAR`-sourced.
  */
 export function parseCommands(command: string): Command[] {
+  let parsed = parseMemo.get(command)
+  if (parsed) {
+    // Refresh recency: Map iteration order is insertion order.
+    parseMemo.delete(command)
+  } else {
+    parsed = parseCommandsUncached(command)
+    if (parseMemo.size >= PARSE_MEMO_SIZE) {
+      parseMemo.delete(parseMemo.keys().next().value!)
+    }
+  }
+  parseMemo.set(command, parsed)
+  // Callers own the returned list; the segments themselves are readonly.
+  return parsed.slice()
+}
+
+function parseCommandsUncached(command: string): Command[] {
   let entries: ParseEntry[]
   try {
     entries = parseShell(command)
@@ -14,6 +14,7 @@
 
 import process from 'node:process'
 
+import { mayMatch } from './pattern-engine.mts'
 import {
   readLastAssistantText,
   readStdin,
@@ -116,6 +117,9 @@ export async function scanReminderText(
   const hits: ReminderHit[] = []
   for (let i = 0, { length } = patterns; i < length; i += 1) {
     const pattern = patterns[i]!
+    if (!mayMatch(pattern.regex, text)) {
+      continue
+    }
     const match = pattern.regex.exec(text)
     if (!match) {
       continue
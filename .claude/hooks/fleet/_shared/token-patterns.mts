@@ -25,6 +25,8 @@
  *     comment naming the vendor / product) — don't dump it into MISC.
  */
 
+import { mayMatch, registerLiterals } from './pattern-engine.mts'
+
 // ── Socket fleet ─────────────────────────────────────────────────────
 export const SOCKET_FLEET_TOKEN_PATTERNS: readonly RegExp[] = [
   /^SOCKET_API_(?:KEY|TOKEN)$/,
@@ -219,6 +221,9 @@ export interface SecretValuePattern {
   re: RegExp
   // Human label naming the vendor / kind, used in the block message.
   label: string
+  // A literal every match contains (the prefix), registered with the shared
+  // prefilter so `re` only runs on text that has it; see pattern-engine.mts.
+  literal: string
 }
 
 // Literal secret-VALUE shapes — if any matches in arbitrary text, a real
@@ -228,62 +233,140 @@ export interface SecretValuePattern {
 // `secret-content-guard`, and the commit-time scanners — one catalog so a new
 // vendor shape is added once and every gate picks it up (code is law, DRY).
 export const SECRET_VALUE_PATTERNS: readonly SecretValuePattern[] = [
-  { re: /sktsec_[A-Za-z0-9]{20,}/, label: 'Socket API key (sktsec_)' },
-  { re: /\bvtwn_[A-Za-z0-9_-]{8,}/, label: 'Val Town token (vtwn_)' },
-  { re: /\blin_api_[A-Za-z0-9_-]{8,}/, label: 'Linear API token (lin_api_)' },
-  { re: /\bsk-ant-[A-Za-z0-9_-]{20,}/, label: 'Anthropic API key (sk-ant-)' },
+  {
+    re: /sktsec_[A-Za-z0-9]{20,}/,
+    literal: 'sktsec_',
+    label: 'Socket API key (sktsec_)',
+  },
+  {
+    re: /\bvtwn_[A-Za-z0-9_-]{8,}/,
+    literal: 'vtwn_',
+    label: 'Val Town token (vtwn_)',
+  },
+  {
+    re: /\blin_api_[A-Za-z0-9_-]{8,}/,
+    literal: 'lin_api_',
+    label: 'Linear API token (lin_api_)',
+  },
+  {
+    re: /\bsk-ant-[A-Za-z0-9_-]{20,}/,
+    literal: 'sk-ant-',
+    label: 'Anthropic API key (sk-ant-)',
+  },
   {
     re: /\bsk-proj-[A-Za-z0-9_-]{20,}/,
+    literal: 'sk-proj-',
     label: 'OpenAI project key (sk-proj-)',
   },
-  { re: /\bhf_[A-Za-z0-9]{30,}/, label: 'Hugging Face token (hf_)' },
-  { re: /\bnpm_[A-Za-z0-9]{36}/, label: 'npm access token (npm_)' },
-  { re: /\bdop_v1_[a-f0-9]{64}/, label: 'DigitalOcean PAT (dop_v1_)' },
+  {
+    re: /\bhf_[A-Za-z0-9]{30,}/,
+    literal: 'hf_',
+    label: 'Hugging Face token (hf_)',
+  },
+  {
+    re: /\bnpm_[A-Za-z0-9]{36}/,
+    literal: 'npm_',
+    label: 'npm access token (npm_)',
+  },
+  {
+    re: /\bdop_v1_[a-f0-9]{64}/,
+    literal: 'dop_v1_',
+    label: 'DigitalOcean PAT (dop_v1_)',
+  },
   {
     re: /\bsk-[A-Za-z0-9_-]{20,}/,
+    literal: 'sk-',
     label: 'OpenAI/Anthropic-style secret key (sk-)',
   },
   {
     re: /\bsk_live_[A-Za-z0-9_-]{16,}/,
+    literal: 'sk_live_',
     label: 'Stripe live secret (sk_live_)',
   },
   {
     re: /\bsk_test_[A-Za-z0-9_-]{16,}/,
+    literal: 'sk_test_',
     label: 'Stripe test secret (sk_test_)',
   },
   {
     re: /\bpk_live_[A-Za-z0-9_-]{16,}/,
+    literal: 'pk_live_',
     label: 'Stripe live publishable (pk_live_)',
   },
   {
     re: /\brk_live_[A-Za-z0-9_-]{16,}/,
+    literal: 'rk_live_',
     label: 'Stripe live restricted (rk_live_)',
   },
   {
     re: /\bghp_[A-Za-z0-9]{30,}/,
+    literal: 'ghp_',
     label: 'GitHub personal access token (ghp_)',
   },
-  { re: /\bgho_[A-Za-z0-9]{30,}/, label: 'GitHub OAuth token (gho_)' },
+  {
+    re: /\bgho_[A-Za-z0-9]{30,}/,
+    literal: 'gho_',
+    label: 'GitHub OAuth token (gho_)',
+  },
   // ghs_ / ghu_ char classes include `.` and `_` to match both the classic
   // opaque format AND the stateless JWT format (≥36 is the min for both).
-  { re: /\bghs_[A-Za-z0-9._]{36,}/, label: 'GitHub app server token (ghs_)' },
-  { re: /\bghu_[A-Za-z0-9._]{36,}/, label: 'GitHub user access token (ghu_)' },
-  { re: /\bghr_[A-Za-z0-9]{30,}/, label: 'GitHub refresh token (ghr_)' },
-  { re: /\bgithub_pat_[A-Za-z0-9_]{20,}/, label: 'GitHub fine-grained PAT' },
-  { re: /\bglpat-[A-Za-z0-9_-]{16,}/, label: 'GitLab PAT (glpat-)' },
-  { re: /\bAKIA[0-9A-Z]{16}/, label: 'AWS access key ID (AKIA)' },
-  { re: /\bxox[baprs]-[A-Za-z0-9-]{10,}/, label: 'Slack token (xox_-)' },
-  { re: /\bAIza[0-9A-Za-z_-]{35}/, label: 'Google API key (AIza)' },
+  {
+    re: /\bghs_[A-Za-z0-9._]{36,}/,
+    literal: 'ghs_',
+    label: 'GitHub app server token (ghs_)',
+  },
+  {
+    re: /\bghu_[A-Za-z0-9._]{36,}/,
+    literal: 'ghu_',
+    label: 'GitHub user access token (ghu_)',
+  },
+  {
+    re: /\bghr_[A-Za-z0-9]{30,}/,
+    literal: 'ghr_',
+    label: 'GitHub refresh token (ghr_)',
+  },
+  {
+    re: /\bgithub_pat_[A-Za-z0-9_]{20,}/,
+    literal: 'github_pat_',
+    label: 'GitHub fine-grained PAT',
+  },
+  {
+    re: /\bglpat-[A-Za-z0-9_-]{16,}/,
+    literal: 'glpat-',
+    label: 'GitLab PAT (glpat-)',
+  },
+  {
+    re: /\bAKIA[0-9A-Z]{16}/,
+    literal: 'AKIA',
+    label: 'AWS access key ID (AKIA)',
+  },
+  {
+    re: /\bxox[baprs]-[A-Za-z0-9-]{10,}/,
+    literal: 'xox',
+    label: 'Slack token (xox_-)',
+  },
+  {
+    re: /\bAIza[0-9A-Za-z_-]{35}/,
+    literal: 'AIza',
+    label: 'Google API key (AIza)',
+  },
   {
     re: /\beyJ[A-Za-z0-9_-]{10,}\.[A-Za-z0-9_-]{10,}\.[A-Za-z0-9_-]{10,}/,
+    literal: 'eyJ',
     label: 'JWT',
   },
   {
     re: /-----BEGIN [A-Z ]*PRIVATE KEY(?: BLOCK)?-----/,
+    literal: 'PRIVATE KEY',
     label: 'private key (PEM block)',
   },
 ]
 
+for (let i = 0, { length } = SECRET_VALUE_PATTERNS; i < length; i += 1) {
+  const { literal, re } = SECRET_VALUE_PATTERNS[i]!
+  registerLiterals(re, [literal])
+}
+
 export interface SecretValueHit {
   label: string
   // The matched secret substring, for the block message. Callers MUST redact
@@ -296,6 +379,9 @@ export interface SecretValueHit {
 export function scanSecretValues(text: string): SecretValueHit | undefined {
   for (let i = 0, { length } = SECRET_VALUE_PATTERNS; i < length; i += 1) {
     const { label, re } = SECRET_VALUE_PATTERNS[i]!
+    if (!mayMatch(re, text)) {
+      continue
+    }
     const m = re.exec(text)
     if (m) {
       return { label, match: m[0] }
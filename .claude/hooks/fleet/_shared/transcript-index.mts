@@ -0,0 +1,485 @@
+/*
+ * @file Incremental, checkpointed index over a Claude Code transcript JSONL.
+ *   Every turn-walker in `transcript.mts` used to read the transcript's last
+ *   8 MB, decode it, split it and JSON.parse its way back from the newest line
+ *   — on every call, from every hook. On a long session's Stop event that was
+ *   dozens of multi-MB reads and parse passes per event. This module keeps one
+ *   index per transcript instead:
+ *
+ *   - Each non-blank line within the tail window gets a byte offset and a
+ *     one-char kind (`EntryKind` below). The kinds are enough for a walker to
+ *     skip straight to the lines it wants, such as the last 8 human messages
+ *     or the newest assistant entry, without parsing anything else.
+ *   - The index is persisted under
+ *     `node_modules/.cache/fleet/transcript-index/<hash>.idx`, with a
+ *     checkpoint: the end of the last complete line it has classified. The
+ *     next process reads and classifies only the bytes appended since the
+ *     checkpoint. A transcript that shrank, was replaced (another inode), or
+ *     no longer has a newline at the checkpoint is re-indexed from scratch.
+ *   - In-process, `openTranscript` memoizes the view per path (keyed on
+ *     size + mtime + inode), and each view memoizes every line it parses. So
+ *     all hooks of one dispatch share ONE parsed turn list. Line text is
+ *     loaded lazily, newest first, growing the loaded region backwards in
+ *     doubling chunks, so a walker that stops after a few entries never
+ *     reads the rest of the window.
+ *
+ *   Index layout (little-endian; a big-endian host just doesn't persist):
+ *
+ *     0   8  magic "FLTTX\0\0\1"
+ *     8   4  u32 entry count (n)
+ *    12   4  u32 reserved (0)
+ *    16   8  f64 checkpoint — byte offset just past the last indexed newline
+ *    24   8  f64 inode of the transcript the index describes
+ *    32  8n  f64 line start offsets, ascending
+ *    ..   n  kind bytes (ASCII)
+ *
+ *   Fail-open throughout: an unreadable transcript is an empty view; an
+ *   unreadable, foreign or stale index is rebuilt; a write failure just
+ *   leaves the next process to classify the same lines again. Nothing is
+ *   written in a repo without `node_modules`.
+ */
+
+import { createHash } from 'node:crypto'
+import {
+  closeSync,
+  existsSync,
+  fstatSync,
+  mkdirSync,
+  openSync,
+  readFileSync,
+  readSync,
+  renameSync,
+  writeFileSync,
+} from 'node:fs'
+import os from 'node:os'
+import path from 'node:path'
+import process from 'node:process'
+
+import { resolveProjectDir } from './project-dir.mts'
+
+// Read at most this many bytes from the transcript TAIL. A long session grows
+// past Node's max-string size (~536MB), where a whole-file readFileSync throws
+// ERR_STRING_TOO_LONG and every phrase/turn scan silently sees an EMPTY
+// transcript: bypass phrases stop working and guards fail closed. The signals
+// these scans need (bypass phrases, recent turns) are recent by contract, so a
+// bounded tail is both correct and far cheaper than slurping the whole file on
+// every hook invocation.
+export const TRANSCRIPT_TAIL_BYTES = 8 * 1024 * 1024
+
+/**
+ * One char per transcript line:
+ *
+ * - `h` user entry carrying author text (a human message; ends a turn)
+ * - `u` user entry without author text (tool results)
+ * - `a` / `A` assistant entry with text (main / sidechain)
+ * - `b` / `B` assistant entry without text, e.g. tool uses only (main /
+ *   sidechain)
+ * - `o` any other resolvable entry (summary, system, …)
+ * - `x` unparseable or unresolvable line
+ */
+export type EntryKind = 'A' | 'B' | 'a' | 'b' | 'h' | 'o' | 'u' | 'x'
+
+export interface TranscriptTurn {
+  readonly content: unknown
+  readonly isSidechain: boolean
+  readonly role: string | undefined
+}
+
+/**
+ * Classify one line: its kind plus its resolved turn (undefined when the
+ * line is malformed). Supplied by `transcript.mts`, which owns the parser.
+ */
+export type EntryClassifier = (
+  line: string,
+) => readonly [EntryKind, TranscriptTurn | undefined]
+
+/**
+ * The tail window of one transcript, oldest entry first.
+ */
+export interface TranscriptView {
+  readonly length: number
+  kind(i: number): EntryKind
+  line(i: number): string
+  turn(i: number): TranscriptTurn | undefined
+}
+
+export interface IndexState {
+  // Offset just past the last classified newline.
+  readonly checkpoint: number
+  readonly ino: number
+  // Kinds of the complete lines, one char each.
+  readonly kinds: string
+  readonly offsets: Float64Array
+}
+
+interface CachedView {
+  readonly index: IndexState
+  readonly mtimeMs: number
+  readonly size: number
+  readonly view: TranscriptView
+}
+
+const MAGIC = Buffer.from([0x46, 0x4c, 0x54, 0x54, 0x58, 0x00, 0x00, 0x01])
+const HEADER_SIZE = 32
+// The offsets block is copied straight into / out of a Float64Array, which
+// uses host byte order.
+const PERSIST = os.endianness() === 'LE'
+// Smallest backward extension of a view's loaded bytes.
+const MIN_LOAD = 64 * 1024
+
+const EMPTY_VIEW: TranscriptView = {
+  __proto__: null,
+  length: 0,
+  kind: () => 'x',
+  line: () => '',
+  turn: () => undefined,
+} as TranscriptView
+
+const views = new Map<string, CachedView>()
+// undefined = not resolved yet; '' = no node_modules, don't persist.
+let indexRoot: string | undefined
+
+function indexDir(): string {
+  if (indexRoot === undefined) {
+    const projectDir = resolveProjectDir()
+    indexRoot = existsSync(path.join(projectDir, 'node_modules'))
+      ? path.join(
+          projectDir,
+          'node_modules',
+          '.cache',
+          'fleet',
+          'transcript-index',
+        )
+      : ''
+  }
+  return indexRoot
+}
+
+/**
+ * The persisted index file for a transcript, or undefined when this repo has
+ * nowhere to keep one.
+ */
+export function transcriptIndexPath(
+  transcriptPath: string,
+): string | undefined {
+  const dir = indexDir()
+  if (!dir) {
+    return undefined
+  }
+  const id = createHash('sha256')
+    .update(path.resolve(transcriptPath))
+    .digest('hex')
+    .slice(0, 24)
+  return path.join(dir, `${id}.idx`)
+}
+
+/**
+ * Decode an index file; undefined when it isn't one.
+ */
+export function decodeTranscriptIndex(buf: Buffer): IndexState | undefined {
+  if (
+    buf.length < HEADER_SIZE ||
+    !buf.subarray(0, MAGIC.length).equals(MAGIC)
+  ) {
+    return undefined
+  }
+  const count = buf.readUInt32LE(8)
+  if (buf.length < HEADER_SIZE + count * 9) {
+    return undefined
+  }
+  const from = buf.byteOffset + HEADER_SIZE
+  // Copy into a fresh (8-byte aligned) ArrayBuffer.
+  const offsets = new Float64Array(buf.buffer.slice(from, from + count * 8))
+  const kindsAt = HEADER_SIZE + count * 8
+  return {
+    __proto__: null,
+    checkpoint: buf.readDoubleLE(16),
+    ino: buf.readDoubleLE(24),
+    kinds: buf.toString('latin1', kindsAt, kindsAt + count),
+    offsets,
+  } as IndexState
+}
+
+/**
+ * Encode an index for disk.
+ */
+export function encodeTranscriptIndex(state: IndexState): Buffer {
+  const count = state.offsets.length
+  const buf = Buffer.alloc(HEADER_SIZE + count * 9)
+  MAGIC.copy(buf, 0)
+  buf.writeUInt32LE(count, 8)
+  buf.writeDoubleLE(state.checkpoint, 16)
+  buf.writeDoubleLE(state.ino, 24)
+  Buffer.from(
+    state.offsets.buffer,
+    state.offsets.byteOffset,
+    count * 8,
+  ).copy(buf, HEADER_SIZE)
+  buf.write(state.kinds, HEADER_SIZE + count * 8, 'latin1')
+  return buf
+}
+
+function loadIndex(file: string | undefined): IndexState | undefined {
+  if (!file || !PERSIST) {
+    return undefined
+  }
+  try {
+    return decodeTranscriptIndex(readFileSync(file))
+  } catch {
+    return undefined
+  }
+}
+
+function saveIndex(file: string | undefined, state: IndexState): void {
+  if (!file || !PERSIST) {
+    return
+  }
+  try {
+    mkdirSync(path.dirname(file), { recursive: true })
+    const tmp = `${file}.${process.pid}.tmp`
+    writeFileSync(tmp, encodeTranscriptIndex(state))
+    renameSync(tmp, file)
+  } catch {}
+}
+
+function readRange(fd: number, start: number, end: number): Buffer {
+  const buf = Buffer.alloc(end - start)
+  let filled = 0
+  while (filled < buf.length) {
+    const n = readSync(fd, buf, filled, buf.length - filled, start + filled)
+    if (n <= 0) {
+      break
+    }
+    filled += n
+  }
+  return filled === buf.length ? buf : buf.subarray(0, filled)
+}
+
+/**
+ * The indexed tail window of `transcriptPath`, brought up to date with
+ * whatever was appended since the last index. Empty on any read failure.
+ */
+export function openTranscript(
+  transcriptPath: string | undefined,
+  classify: EntryClassifier,
+): TranscriptView {
+  if (!transcriptPath) {
+    return EMPTY_VIEW
+  }
+  let fd: number | undefined
+  try {
+    fd = openSync(transcriptPath, 'r')
+    const { ino, mtimeMs, size } = fstatSync(fd)
+    const cached = views.get(transcriptPath)
+    if (
+      cached &&
+      cached.size === size &&
+      cached.mtimeMs === mtimeMs &&
+      cached.index.ino === ino
+    ) {
+      return cached.view
+    }
+    const windowStart =
+      size > TRANSCRIPT_TAIL_BYTES ? size - TRANSCRIPT_TAIL_BYTES : 0
+    const indexFile = transcriptIndexPath(transcriptPath)
+    let base =
+      cached && cached.index.ino === ino ? cached.index : loadIndex(indexFile)
+    if (
+      base &&
+      (base.ino !== ino ||
+        base.checkpoint > size ||
+        base.checkpoint < windowStart ||
+        (base.checkpoint > 0 &&
+          readRange(fd, base.checkpoint - 1, base.checkpoint)[0] !== 0x0a))
+    ) {
+      base = undefined
+    }
+    const scanFrom = base ? base.checkpoint : windowStart
+    const tail = readRange(fd, scanFrom, size)
+    closeSync(fd)
+    fd = undefined
+
+    // Keep the still-in-window part of the old index. A window that doesn't
+    // start at byte 0 drops its first (almost certainly partial) line.
+    let kept = new Float64Array(0)
+    let kinds = ''
+    if (base) {
+      // First kept entry: binary search for the first offset past the
+      // window start (offsets are ascending).
+      let lo = 0
+      let hi = base.offsets.length
+      while (windowStart && lo < hi) {
+        const mid = (lo + hi) >>> 1
+        if (base.offsets[mid]! > windowStart) {
+          hi = mid
+        } else {
+          lo = mid + 1
+        }
+      }
+      kept = base.offsets.subarray(lo)
+      kinds = base.kinds.slice(lo)
+    }
+    const added: number[] = []
+    let addedKinds = ''
+    let pos = 0
+    if (!base && windowStart) {
+      const nl = tail.indexOf(0x0a)
+      pos = nl === -1 ? tail.length : nl + 1
+    }
+    let checkpoint = scanFrom + pos
+    const turns = new Map<number, TranscriptTurn | null>()
+    // A last line still being written (no newline yet) is visible in this
+    // view but never persisted — the next index re-reads it once complete.
+    let transient: [number, EntryKind] | undefined
+    while (pos < tail.length) {
+      const nl = tail.indexOf(0x0a, pos)
+      const end = nl === -1 ? tail.length : nl
+      if (end > pos) {
+        const offset = scanFrom + pos
+        const { 0: kind, 1: turn } = classify(tail.toString('utf8', pos, end))
+        turns.set(offset, turn ?? null)
+        if (nl === -1) {
+          transient = [offset, kind]
+        } else {
+          added.push(offset)
+          addedKinds += kind
+        }
+      }
+      if (nl === -1) {
+        break
+      }
+      pos = nl + 1
+      checkpoint = scanFrom + pos
+    }
+    let offsets = kept
+    if (added.length) {
+      offsets = new Float64Array(kept.length + added.length)
+      offsets.set(kept)
+      offsets.set(added, kept.length)
+    }
+    const index = {
+      __proto__: null,
+      checkpoint,
+      ino,
+      kinds: kinds + addedKinds,
+      offsets,
+    } as IndexState
+    if (
+      !base ||
+      checkpoint !== base.checkpoint ||
+      offsets.length !== base.offsets.length
+    ) {
+      saveIndex(indexFile, index)
+    }
+    const view = createView(
+      transcriptPath,
+      index,
+      transient,
+      turns,
+      { __proto__: null, buf: tail, start: scanFrom } as LoadedBytes,
+      windowStart,
+      classify,
+    )
+    views.set(transcriptPath, {
+      __proto__: null,
+      index,
+      mtimeMs,
+      size,
+      view,
+    } as CachedView)
+    return view
+  } catch {
+    return EMPTY_VIEW
+  } finally {
+    if (fd !== undefined) {
+      try {
+        closeSync(fd)
+      } catch {}
+    }
+  }
+}
+
+interface LoadedBytes {
+  buf: Buffer
+  start: number
+}
+
+function createView(
+  transcriptPath: string,
+  index: IndexState,
+  transient: readonly [number, EntryKind] | undefined,
+  turns: Map<number, TranscriptTurn | null>,
+  loaded: LoadedBytes,
+  windowStart: number,
+  classify: EntryClassifier,
+): TranscriptView {
+  const { offsets } = index
+  const count = offsets.length + (transient ? 1 : 0)
+  const offsetOf = (i: number) =>
+    i < offsets.length ? offsets[i]! : transient![0]
+  // Grow the loaded bytes backwards to cover `offset`: at least double
+  // what's loaded, never past the window start.
+  const cover = (offset: number) => {
+    if (offset >= loaded.start) {
+      return
+    }
+    const start = Math.max(
+      windowStart,
+      Math.min(offset, loaded.start - Math.max(MIN_LOAD, loaded.buf.length)),
+    )
+    const fd = openSync(transcriptPath, 'r')
+    try {
+      const head = readRange(fd, start, loaded.start)
+      loaded.buf = Buffer.concat([head, loaded.buf])
+      loaded.start = start
+    } finally {
+      closeSync(fd)
+    }
+  }
+  const lines: Array<string | undefined> = new Array(count)
+  const line = (i: number): string => {
+    if (i < 0 || i >= count) {
+      return ''
+    }
+    let text = lines[i]
+    if (text === undefined) {
+      text = ''
+      try {
+        const offset = offsetOf(i)
+        cover(offset)
+        const from = offset - loaded.start
+        const nl = loaded.buf.indexOf(0x0a, from)
+        text = loaded.buf.toString(
+          'utf8',
+          from,
+          nl === -1 ? loaded.buf.length : nl,
+        )
+      } catch {}
+      lines[i] = text
+    }
+    return text
+  }
+  return {
+    __proto__: null,
+    length: count,
+    kind(i: number): EntryKind {
+      if (i < 0 || i >= count) {
+        return 'x'
+      }
+      return i < offsets.length ? (index.kinds[i] as EntryKind) : transient![1]
+    },
+    line,
+    turn(i: number): TranscriptTurn | undefined {
+      if (i < 0 || i >= count) {
+        return undefined
+      }
+      const offset = offsetOf(i)
+      let turn = turns.get(offset)
+      if (turn === undefined) {
+        turn = classify(line(i))[1] ?? null
+        turns.set(offset, turn)
+      }
+      return turn ?? undefined
+    },
+  } as TranscriptView
+}
@@ -8,8 +8,8 @@
  *      transcript JSONL for a canonical `Allow <X> bypass` phrase. The
  *      transcript format has 3 variant shapes across harness versions;
  *      centralizing the parser means a schema change is a one-file fix. Why one
- *      file: KISS. Both helpers want the same imports (`node:fs` + the JSONL
- *      parser); separating into two files would just shuffle imports. The file
+ *      file: KISS. Both helpers want the same imports (the transcript index +
+ *      the JSONL parser); separating into two files would just shuffle imports. The file
  *      is small (~100 LOC) so cohesion wins. Fail-open contract: every helper
  *      here returns a safe default on any parse / I/O error rather than
  *      throwing. A hook that crashes blocks every Claude Code call
@@ -17,16 +17,18 @@
  *      simply falls through to the hook's default decision. Per the fleet's
  *      hook contract: "a buggy hook silently allows" is preferable to "a buggy
  *      hook wedges the session."
+ *
+ *   Every walker reads through `transcriptView()`: the incremental,
+ *   persisted line index in `transcript-index.mts`, shared by all hooks of a
+ *   dispatch, so a walker parses only the lines it actually inspects.
  */
 
-import {
-  closeSync,
-  existsSync,
-  openSync,
-  readFileSync,
-  readSync,
-  statSync,
-} from 'node:fs'
+import { openTranscript } from './transcript-index.mts'
+import type {
+  EntryKind,
+  TranscriptTurn,
+  TranscriptView,
+} from './transcript-index.mts'
 
 /**
  * How many recent USER turns the bypass-phrase scans read by default. Small
@@ -474,35 +476,26 @@ const TURN_SCAN_CAP = 400
 export function readLastAssistantTurnText(
   transcriptPath: string | undefined,
 ): string {
-  const lines = readLines(transcriptPath)
+  const view = transcriptView(transcriptPath)
   const out: string[] = []
   let scope: boolean | undefined
-  const stop = Math.max(0, lines.length - TURN_SCAN_CAP)
-  for (let i = lines.length - 1; i >= stop; i -= 1) {
-    let evt: unknown
-    try {
-      evt = JSON.parse(lines[i]!)
-    } catch {
-      continue
+  const stop = Math.max(0, view.length - TURN_SCAN_CAP)
+  for (let i = view.length - 1; i >= stop; i -= 1) {
+    const kind = view.kind(i)
+    if (kind === 'h') {
+      break
     }
-    const r = resolveRoleAndContent(evt)
-    if (!r) {
+    if (!isAssistantKind(kind)) {
       continue
     }
-    if (r.role === 'assistant') {
-      if (scope === undefined) {
-        scope = r.isSidechain
-      } else if (r.isSidechain !== scope) {
-        continue
-      }
-      const pieces = extractTurnPieces(r.content)
-      if (pieces.length) {
-        out.push(pieces.join('\n'))
-      }
+    const sidechain = kind === 'A' || kind === 'B'
+    if (scope === undefined) {
+      scope = sidechain
+    } else if (sidechain !== scope) {
       continue
     }
-    if (r.role === 'user' && extractTurnPieces(r.content).length > 0) {
-      break
+    if (hasTextKind(kind)) {
+      out.push(extractTurnPieces(view.turn(i)?.content).join('\n'))
     }
   }
   return out.toReversed().join('\n')
@@ -536,17 +529,11 @@ export function readLastAssistantTurnText(
 export function mostRecentAssistantIsSidechain(
   transcriptPath: string | undefined,
 ): boolean {
-  const lines = readLines(transcriptPath)
-  for (let i = lines.length - 1; i >= 0; i -= 1) {
-    let evt: unknown
-    try {
-      evt = JSON.parse(lines[i]!)
-    } catch {
-      continue
-    }
-    const r = resolveRoleAndContent(evt)
-    if (r?.role === 'assistant') {
-      return r.isSidechain
+  const view = transcriptView(transcriptPath)
+  for (let i = view.length - 1; i >= 0; i -= 1) {
+    const kind = view.kind(i)
+    if (isAssistantKind(kind)) {
+      return kind === 'A' || kind === 'B'
     }
   }
   return false
@@ -555,28 +542,22 @@ export function mostRecentAssistantIsSidechain(
 export function readLastAssistantTextSameActor(
   transcriptPath: string | undefined,
 ): string {
-  const lines = readLines(transcriptPath)
+  const view = transcriptView(transcriptPath)
   let scope: boolean | undefined
-  for (let i = lines.length - 1; i >= 0; i -= 1) {
-    let evt: unknown
-    try {
-      evt = JSON.parse(lines[i]!)
-    } catch {
-      continue
-    }
-    const r = resolveRoleAndContent(evt)
-    if (!r || r.role !== 'assistant') {
+  for (let i = view.length - 1; i >= 0; i -= 1) {
+    const kind = view.kind(i)
+    if (!isAssistantKind(kind)) {
       continue
     }
+    const sidechain = kind === 'A' || kind === 'B'
     if (scope === undefined) {
-      scope = r.isSidechain
-    } else if (r.isSidechain !== scope) {
+      scope = sidechain
+    } else if (sidechain !== scope) {
       // Crossed into the other actor's turns — stop before reading them.
       break
     }
-    const pieces = extractTurnPieces(r.content)
-    if (pieces.length) {
-      return pieces.join('\n')
+    if (hasTextKind(kind)) {
+      return extractTurnPieces(view.turn(i)?.content).join('\n')
     }
   }
   return ''
@@ -592,19 +573,11 @@ export function readLastAssistantTextSameActor(
 export function readLastAssistantToolUses(
   transcriptPath: string | undefined,
 ): readonly ToolUseEvent[] {
-  const lines = readLines(transcriptPath)
-  for (let i = lines.length - 1; i >= 0; i -= 1) {
-    let evt: unknown
-    try {
-      evt = JSON.parse(lines[i]!)
-    } catch {
-      continue
-    }
-    const r = resolveRoleAndContent(evt)
-    if (!r || r.role !== 'assistant') {
-      continue
+  const view = transcriptView(transcriptPath)
+  for (let i = view.length - 1; i >= 0; i -= 1) {
+    if (isAssistantKind(view.kind(i))) {
+      return extractToolUseBlocks(view.turn(i)?.content)
     }
-    return extractToolUseBlocks(r.content)
   }
   return []
 }
@@ -622,26 +595,19 @@ export function readPriorAssistantToolUses(
   transcriptPath: string | undefined,
   lookback: number,
 ): readonly ToolUseEvent[] {
-  const lines = readLines(transcriptPath)
+  const view = transcriptView(transcriptPath)
   const out: ToolUseEvent[] = []
   let assistantTurnsSeen = 0
   let skippedMostRecent = false
-  for (let i = lines.length - 1; i >= 0; i -= 1) {
-    let evt: unknown
-    try {
-      evt = JSON.parse(lines[i]!)
-    } catch {
-      continue
-    }
-    const r = resolveRoleAndContent(evt)
-    if (!r || r.role !== 'assistant') {
+  for (let i = view.length - 1; i >= 0; i -= 1) {
+    if (!isAssistantKind(view.kind(i))) {
       continue
     }
     if (!skippedMostRecent) {
       skippedMostRecent = true
       continue
     }
-    const events = extractToolUseBlocks(r.content)
+    const events = extractToolUseBlocks(view.turn(i)?.content)
     for (let j = 0, { length } = events; j < length; j += 1) {
       out.push(events[j]!)
     }
@@ -653,52 +619,73 @@ export function readPriorAssistantToolUses(
   return out
 }
 
+// Malformed / unresolvable line: no turn to hand back.
+const UNRESOLVED = ['x', undefined] as const
+
 /**
- * Read the transcript JSONL file into newline-filtered lines. Returns an empty
- * array on missing path or read error — every caller in this module wants the
- * same empty-on-failure semantics.
+ * Classify one transcript line for the index (`transcript-index.mts`): the
+ * same role / sidechain / author-text tests the walkers below apply, decided
+ * once per line instead of once per walker.
  */
-// Read at most this many bytes from the transcript TAIL. A long session grows
-// past Node's max-string size (~536MB), where a whole-file readFileSync throws
-// ERR_STRING_TOO_LONG and every phrase/turn scan silently sees an EMPTY
-// transcript: bypass phrases stop working and guards fail closed. The signals
-// these scans need (bypass phrases, recent turns) are recent by contract, so a
-// bounded tail is both correct and far cheaper than slurping the whole file on
-// every hook invocation.
-const TRANSCRIPT_TAIL_BYTES = 8 * 1024 * 1024
-
-export function readLines(transcriptPath: string | undefined): string[] {
-  if (!transcriptPath || !existsSync(transcriptPath)) {
-    return []
-  }
-  let raw: string
+export function classifyTranscriptLine(
+  line: string,
+): readonly [EntryKind, TranscriptTurn | undefined] {
+  let evt: unknown
   try {
-    const { size } = statSync(transcriptPath)
-    if (size > TRANSCRIPT_TAIL_BYTES) {
-      const fd = openSync(transcriptPath, 'r')
-      try {
-        const buf = Buffer.alloc(TRANSCRIPT_TAIL_BYTES)
-        const read = readSync(
-          fd,
-          buf,
-          0,
-          TRANSCRIPT_TAIL_BYTES,
-          size - TRANSCRIPT_TAIL_BYTES,
-        )
-        raw = buf.subarray(0, read).toString('utf8')
-      } finally {
-        closeSync(fd)
-      }
-      // Drop the first (almost certainly partial) line of the tail window.
-      const firstNewline = raw.indexOf('\n')
-      raw = firstNewline === -1 ? '' : raw.slice(firstNewline + 1)
-    } else {
-      raw = readFileSync(transcriptPath, 'utf8')
-    }
+    evt = JSON.parse(line)
   } catch {
-    return []
+    return UNRESOLVED
+  }
+  const r = resolveRoleAndContent(evt)
+  if (!r) {
+    return UNRESOLVED
+  }
+  if (r.role === 'user') {
+    return [extractTurnPieces(r.content).length ? 'h' : 'u', r]
+  }
+  if (r.role === 'assistant') {
+    const text = extractTurnPieces(r.content).length > 0
+    if (r.isSidechain) {
+      return [text ? 'A' : 'B', r]
+    }
+    return [text ? 'a' : 'b', r]
+  }
+  return ['o', r]
+}
+
+function isAssistantKind(kind: EntryKind): boolean {
+  return kind === 'a' || kind === 'A' || kind === 'b' || kind === 'B'
+}
+
+// An entry that contributes author text to its role's reads.
+function hasTextKind(kind: EntryKind): boolean {
+  return kind === 'h' || kind === 'a' || kind === 'A'
+}
+
+/**
+ * The indexed tail window of a transcript — the shared, memoized view every
+ * walker here reads, so the hooks of one dispatch parse each line at most
+ * once. (Empty on a missing path or read error.)
+ */
+export function transcriptView(
+  transcriptPath: string | undefined,
+): TranscriptView {
+  return openTranscript(transcriptPath, classifyTranscriptLine)
+}
+
+/**
+ * The transcript's tail window as newline-filtered lines. Returns an empty
+ * array on missing path or read error — every caller wants the same
+ * empty-on-failure semantics. Prefer `transcriptView`, which skips by kind
+ * and parses lazily; this materializes every line.
+ */
+export function readLines(transcriptPath: string | undefined): string[] {
+  const view = transcriptView(transcriptPath)
+  const lines: string[] = new Array(view.length)
+  for (let i = 0, { length } = view; i < length; i += 1) {
+    lines[i] = view.line(i)
   }
-  return raw.split('\n').filter(Boolean)
+  return lines
 }
 
 /**
@@ -715,32 +702,22 @@ export function readRoleText(
   role: Role,
   lookback?: number | undefined,
 ): string {
-  const lines = readLines(transcriptPath)
+  const view = transcriptView(transcriptPath)
   const out: string[] = []
   let matched = 0
-  for (let i = lines.length - 1; i >= 0; i -= 1) {
-    let evt: unknown
-    try {
-      evt = JSON.parse(lines[i]!)
-    } catch {
-      continue
-    }
-    const r = resolveRoleAndContent(evt)
-    if (!r || r.role !== role) {
-      continue
-    }
-    const pieces = extractTurnPieces(r.content)
-    if (!pieces.length) {
-      // Tool-result carrier events share the user role but hold no author
-      // prose. They must not consume lookback slots — a lookback of "8 user
-      // turns" means 8 things the USER said, not 8 tool calls; otherwise a
-      // busy turn evicts a freshly typed bypass phrase before the very
-      // command it authorizes runs.
+  for (let i = view.length - 1; i >= 0; i -= 1) {
+    const kind = view.kind(i)
+    // Tool-result carrier events share the user role but hold no author
+    // prose (kind `u`). They must not consume lookback slots — a lookback of
+    // "8 user turns" means 8 things the USER said, not 8 tool calls;
+    // otherwise a busy turn evicts a freshly typed bypass phrase before the
+    // very command it authorizes runs.
+    if (role === 'user' ? kind !== 'h' : kind !== 'a' && kind !== 'A') {
       continue
     }
     // Buffer this turn's blocks together so the final reverse swaps
     // *turn order*, not intra-turn block order.
-    out.push(pieces.join('\n'))
+    out.push(extractTurnPieces(view.turn(i)?.content).join('\n'))
     matched += 1
     if (lookback !== undefined && matched >= lookback) {
       break
@@ -753,7 +730,9 @@ export function readRoleText(
 
 /**
  * Read the entire stdin buffer into a string. Used by every PreToolUse hook to
- * slurp the JSON payload Claude Code sends.
+ * slurp the JSON payload Claude Code sends. Collected as raw Buffer chunks and
+ * decoded once at the end: a multi-MB Write payload arrives in 64 KiB reads,
+ * and per-chunk string appends would build (then flatten) a rope of them.
  */
 // A per-event dispatcher reads stdin ONCE and re-exposes the raw payload via
 // this env var, so many guards run in a single process without each racing for
@@ -770,14 +749,14 @@ export function readStdin(): Promise<string> {
     return Promise.resolve(cachedStdin)
   }
   return new Promise(resolve => {
-    let buf = ''
-    process.stdin.setEncoding('utf8')
-    process.stdin.on('data', chunk => {
-      buf += chunk
+    const chunks: Buffer[] = []
+    process.stdin.on('data', (chunk: Buffer) => {
+      chunks.push(chunk)
     })
     process.stdin.on('end', () => {
-      cachedStdin = buf
-      resolve(buf)
+      const text = Buffer.concat(chunks).toString('utf8')
+      cachedStdin = text
+      resolve(text)
     })
   })
 }
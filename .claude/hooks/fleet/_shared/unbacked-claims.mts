@@ -12,9 +12,8 @@
 import { commandsFor } from './shell-command.mts'
 import {
   extractToolUseBlocks,
-  readLines,
-  resolveRoleAndContent,
   stripCodeFences,
+  transcriptView,
 } from './transcript.mts'
 
 export interface InvocationSignal {
@@ -117,20 +116,14 @@ export interface UnbackedClaim {
 export function sessionBashCommands(
   transcriptPath: string | undefined,
 ): string[] {
-  const lines = readLines(transcriptPath)
+  const view = transcriptView(transcriptPath)
   const commands: string[] = []
-  for (let i = 0, { length } = lines; i < length; i += 1) {
-    let evt: unknown
-    try {
-      evt = JSON.parse(lines[i]!)
-    } catch {
+  for (let i = 0, { length } = view; i < length; i += 1) {
+    const kind = view.kind(i)
+    if (kind !== 'a' && kind !== 'A' && kind !== 'b' && kind !== 'B') {
       continue
     }
-    const r = resolveRoleAndContent(evt)
-    if (!r || r.role !== 'assistant') {
-      continue
-    }
-    const tools = extractToolUseBlocks(r.content)
+    const tools = extractToolUseBlocks(view.turn(i)?.content)
     for (let j = 0, { length: tl } = tools; j < tl; j += 1) {
       const t = tools[j]!
       if (t.name !== 'Bash') {
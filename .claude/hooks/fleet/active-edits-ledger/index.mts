@@ -23,20 +23,22 @@
 // its same-turn ledger.
 //
 // Store: `CLAUDE_PROJECT_DIR/node_modules/.cache/fleet/socket-active-edits/`
-// (dep-0 runtime state; never tracked).
+// (dep-0 runtime state; never tracked). Each edit is one line appended to
+// the actor's log — no read-modify-write of the whole ledger per edit.
+//
+// @dispatch-must-run — never deferred by the latency budget: it is the only
+// write path to the edits ledger.
 
 import path from 'node:path'
 
 import {
+  appendActorEdit,
   computeActorId,
   LEDGER_TTL_MS,
   ledgerFilePath,
   normalizeForLedger,
-  readActorLedger,
-  recordPath,
   resolveStoreRoot,
   sweepStaleLedgers,
-  writeActorLedger,
 } from '../_shared/active-edits-ledger.mts'
 import { defineHook, runHook } from '../_shared/guard.mts'
 import type { GuardResult } from '../_shared/guard.mts'
@@ -69,12 +71,7 @@ export const check = (payload: ToolCallPayload): GuardResult => {
   const now = Date.now()
   const absPath = path.resolve(projectDir, filePath)
   const normalizedPath = normalizeForLedger(absPath)
-  const existing = readActorLedger(fp)
-  const updated = recordPath(existing, actorId, normalizedPath, {
-    now,
-    ttlMs: LEDGER_TTL_MS,
-  })
-  writeActorLedger(fp, updated)
+  appendActorEdit(fp, normalizedPath, { now, ttlMs: LEDGER_TTL_MS })
   sweepStaleLedgers(storeRoot, { now, ttlMs: LEDGER_TTL_MS })
   return undefined
 }
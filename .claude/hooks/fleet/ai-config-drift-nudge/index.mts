@@ -19,10 +19,9 @@
  */
 
 import { normalizePath } from '@socketsecurity/lib-stable/paths/normalize'
-import { spawnSync } from '@socketsecurity/lib-stable/process/spawn/child'
 
 import { defineHook, notify, runHook } from '../_shared/guard.mts'
-import { spawnTimeoutMs } from '../_shared/spawn-timeout.mts'
+import { runProcess } from '../_shared/process-scheduler.mts'
 import { resolveProjectDir } from '../_shared/project-dir.mts'
 
 // AI-assistant config dirs a worm targets. Matched as a leading or
@@ -63,13 +62,14 @@ export function parseAiConfigDrift(out: string): DriftEntry[] {
 }
 
 export const hook = defineHook({
-  check: () => {
+  check: async () => {
     const repoDir = getProjectDir()
-    const r = spawnSync('git', ['status', '--porcelain'], {
+    // Same listing dirty-worktree-stop-guard takes at this Stop; the shared
+    // scheduler spawns it once.
+    const r = await runProcess('git', ['status', '--porcelain'], {
       cwd: repoDir,
-      timeout: spawnTimeoutMs(5000),
     })
-    if (r.error || r.status !== 0 || typeof r.stdout !== 'string') {
+    if (r.status !== 0) {
       return undefined
     }
     const drift = parseAiConfigDrift(r.stdout)
@@ -7,6 +7,7 @@
 
 import { AI_SLOP_PATTERNS } from '../_shared/ai-slop-patterns.mts'
 import { HONESTY_FRAMING_RE } from '../_shared/honesty-framing.mts'
+import { mayMatch } from '../_shared/pattern-engine.mts'
 
 export interface ProsePattern {
   readonly label: string
@@ -61,7 +62,7 @@ export function findProseAntipatterns(content: string): ProsePattern[] {
   const hits: ProsePattern[] = []
   for (let i = 0, { length } = PROSE_PATTERNS; i < length; i += 1) {
     const pattern = PROSE_PATTERNS[i]!
-    if (pattern.regex.test(content)) {
+    if (mayMatch(pattern.regex, content) && pattern.regex.test(content)) {
       hits.push(pattern)
     }
   }
@@ -16,6 +16,8 @@
  * scripted-editor rebase has legitimate uses beyond message rewrites (todo
  * reordering, autosquash), so the nudge routes rather than gates. Detail:
  * docs/agents.md/fleet/history-rewrites.md
+ *
+ * @dispatch-pure — reads tool_input.command only.
  */
 
 import { bashGuard, defineHook, notify, runHook } from '../_shared/guard.mts'
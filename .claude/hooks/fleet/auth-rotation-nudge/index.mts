@@ -47,6 +47,9 @@
 //     Idle timeout in hours: how long the session must sit idle (no
 //     Stop events) before the next Stop triggers rotation. Set to 0 to
 //     rotate on every Stop event after the first (verbose).
+//
+// @dispatch-must-run — never deferred by the latency budget: it logs out CLIs
+// and stamps the idle clock.
 
 import { spawnSync } from '@socketsecurity/lib-stable/process/spawn/child'
 import {
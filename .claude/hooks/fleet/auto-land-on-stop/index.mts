@@ -30,6 +30,9 @@
 // A session that sees a commit it didn't personally issue should recognize it as
 // this auto-lander (see docs/agents.md/fleet/parallel-claude-sessions.md ->
 // "Auto-landed commits are expected"), not a rival — run `whose-work` to confirm.
+//
+// @dispatch-must-run — never deferred by the latency budget: it lands commits;
+// a cut-off run would strand them.
 
 import { existsSync } from 'node:fs'
 import path from 'node:path'
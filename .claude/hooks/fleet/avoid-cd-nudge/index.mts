@@ -32,6 +32,11 @@
 
 import { bashGuard, defineHook, notify, runHook } from '../_shared/guard.mts'
 
+// Pre-flight triggers: the dispatcher (and the native launcher's trigger
+// rules) skip this nudge unless the raw payload contains `cd`. Every bare-cd
+// match below needs the literal `cd` token, so nothing it flags can lack it.
+export const triggers: readonly string[] = ['cd']
+
 // Matches `cd <something>` not preceded by `(` (subshell) and not
 // followed by anything that suggests evidence-capture.
 function detectsBareCd(command: string): boolean {
@@ -101,6 +106,7 @@ export const hook = defineHook({
   }),
   event: 'PreToolUse',
   matcher: ['Bash'],
+  triggers,
   type: 'nudge',
 })
 
@@ -24,6 +24,9 @@
 // Slopsquatting defense + audit log live in `./audit.mts` — see that
 // module's file-header comment for the Threat 2.2 mitigation.
 //
+// @dispatch-stateful — every check appends to the audit log (`./audit.mts`),
+// so a batch replay of recorded events must not run it.
+//
 // Verdict:
 //   undefined = allow (no new deps, all clean, or non-dep file)
 //   block(...) = block (malware detected by Socket.dev)
@@ -19,6 +19,7 @@
  *   detection logic lives in ./detect.mts (unit-tested directly); command
  *   segments + args come from commandsFor()/findInvocation() (shell-quote
  *   tokenized), never a raw regex over the whole command line.
+ * @dispatch-pure — both arms parse tool_input.command and nothing else.
  */
 
 import { bashGuard, defineHook, notify, runHook } from '../_shared/guard.mts'
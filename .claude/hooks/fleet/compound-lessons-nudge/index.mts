@@ -34,6 +34,8 @@
 //   2. A `**Why:**` line in the current turn's written content — the
 //      canonical shape for citing the original incident.
 //
+// @dispatch-must-run — never deferred by the latency budget: it records each
+// occurrence it counts.
 
 import { existsSync } from 'node:fs'
 import path from 'node:path'
@@ -24,6 +24,7 @@ import {
   HONESTY_FRAMING_RE,
   HONESTY_LABEL,
 } from '../_shared/honesty-framing.mts'
+import { mayMatch } from '../_shared/pattern-engine.mts'
 import { commandsFor } from '../_shared/shell-command.mts'
 import type { Command } from '../_shared/shell-command.mts'
 
@@ -121,7 +122,7 @@ export function findAiScaffoldingPhrases(body: string): string[] {
   const hits: string[] = []
   for (let i = 0, { length } = ANTIPATTERN_CHECKS; i < length; i += 1) {
     const entry = ANTIPATTERN_CHECKS[i]!
-    if (entry.re.test(body)) {
+    if (mayMatch(entry.re, body) && entry.re.test(body)) {
       hits.push(entry.label)
     }
   }
@@ -33,6 +33,7 @@ import { spawnSync } from '@socketsecurity/lib-stable/process/spawn/child'
 
 import { actedOnPath } from '../_shared/fleet-context.mts'
 import { bashGuard, defineHook, notify, runHook } from '../_shared/guard.mts'
+import { runProcess } from '../_shared/process-scheduler.mts'
 import { commandsFor } from '../_shared/shell-command.mts'
 import { spawnTimeoutMs } from '../_shared/spawn-timeout.mts'
 import type { ToolCallPayload } from '../_shared/payload.mts'
@@ -83,15 +84,16 @@ export function dirtyLockfilesFromPorcelain(out: string): string[] {
   return dirty
 }
 
-export function listDirtyLockfiles(repoDir: string): string[] {
-  const r = spawnSync('git', ['status', '--porcelain'], {
+export async function listDirtyLockfiles(repoDir: string): Promise<string[]> {
+  // The porcelain listing is shared with the other dirty-tree checks of this
+  // dispatch (_shared/process-scheduler.mts).
+  const r = await runProcess('git', ['status', '--porcelain'], {
     cwd: repoDir,
-    timeout: spawnTimeoutMs(5000),
   })
   if (r.status !== 0) {
     return []
   }
-  return dirtyLockfilesFromPorcelain(String(r.stdout))
+  return dirtyLockfilesFromPorcelain(r.stdout)
 }
 
 // `git diff HEAD` for the lockfile — captures staged + unstaged changes vs the
@@ -210,7 +212,7 @@ export function getRepoDir(payload: ToolCallPayload): string | undefined {
   return actedOnPath(payload) || resolveProjectDir()
 }
 
-export const check = bashGuard((command, payload) => {
+export const check = bashGuard(async (command, payload) => {
   if (!commandTouchesTrigger(command)) {
     return undefined
   }
@@ -219,7 +221,7 @@ export const check = bashGuard((command, payload) => {
   if (!repoDir) {
     return undefined
   }
-  const dirty = listDirtyLockfiles(repoDir)
+  const dirty = await listDirtyLockfiles(repoDir)
   if (dirty.length === 0) {
     return undefined
   }
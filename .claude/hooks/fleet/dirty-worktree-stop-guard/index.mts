@@ -103,6 +103,7 @@ import type { ParkedEntry } from '../_shared/parked-paths.mts'
 import { block, defineHook, notify, runHook } from '../_shared/guard.mts'
 import type { GuardResult } from '../_shared/guard.mts'
 import type { ToolCallPayload } from '../_shared/payload.mts'
+import { runProcess } from '../_shared/process-scheduler.mts'
 import { spawnTimeoutMs } from '../_shared/spawn-timeout.mts'
 import { bypassPhrasePresent } from '../_shared/transcript.mts'
 import { resolveProjectDir } from '../_shared/project-dir.mts'
@@ -200,15 +201,18 @@ export function parsePorcelain(out: string): DirtyEntry[] {
   return entries
 }
 
-export function listDirtyEntries(repoDir: string): DirtyEntry[] {
-  const r = spawnSync('git', ['status', '--porcelain'], {
+export async function listDirtyEntries(
+  repoDir: string,
+): Promise<DirtyEntry[]> {
+  // Through the shared scheduler: the same listing other Stop checks ask for
+  // is spawned once, and sibling repos are probed concurrently.
+  const r = await runProcess('git', ['status', '--porcelain'], {
     cwd: repoDir,
-    timeout: spawnTimeoutMs(5000),
   })
   if (r.status !== 0) {
     return []
   }
-  return parsePorcelain(String(r.stdout))
+  return parsePorcelain(r.stdout)
 }
 
 export interface SiblingDirt {
@@ -229,10 +233,10 @@ export interface SiblingDirt {
  * Scoped to the session-touched set so a parallel agent's unrelated dirt in the
  * same sibling is never attributed to this turn.
  */
-export function listTouchedSiblingDirt(
+export async function listTouchedSiblingDirt(
   touched: ReadonlySet<string>,
   primaryRoot: string,
-): SiblingDirt[] {
+): Promise<SiblingDirt[]> {
   if (touched.size === 0) {
     return []
   }
@@ -252,9 +256,14 @@ export function listTouchedSiblingDirt(
     }
     set.add(p)
   }
+  const roots = [...touchedByRoot]
+  const listed = await Promise.all(
+    roots.map(({ 0: root }) => listDirtyEntries(root)),
+  )
   const out: SiblingDirt[] = []
-  for (const [root, touchedInRoot] of touchedByRoot) {
-    const dirty = listDirtyEntries(root).filter(e =>
+  for (let i = 0, { length } = roots; i < length; i += 1) {
+    const { 0: root, 1: touchedInRoot } = roots[i]!
+    const dirty = listed[i]!.filter(e =>
       touchedInRoot.has(path.resolve(root, e.path)),
     )
     if (dirty.length) {
@@ -317,10 +326,12 @@ export function partitionByLedger(
     return { blocking: dirty, sanctioned: [] }
   }
 
-  // Load all foreign ledgers once — fail-open per file.
+  // Load all foreign ledgers once — fail-open per file. Edits past the TTL
+  // are pruned anyway, so each log is read back only that far.
+  const since = now - LEDGER_TTL_MS
   const foreignLedgers: Array<ReturnType<typeof readActorLedger>> = []
   for (let i = 0, { length } = otherLedgerPaths; i < length; i += 1) {
-    const raw = readActorLedger(otherLedgerPaths[i]!)
+    const raw = readActorLedger(otherLedgerPaths[i]!, since)
     if (
       raw &&
       raw.actorId !== ownActorId &&
@@ -334,7 +345,7 @@ export function partitionByLedger(
   // unreadable): any IO error here defaults to blocking (not sanctioning) because
   // we can't prove foreign recency beats own recency.
   const ownFp = ledgerFilePath(storeRoot, ownActorId)
-  const ownLedger = readActorLedger(ownFp)
+  const ownLedger = readActorLedger(ownFp, since)
 
   const blocking: DirtyEntry[] = []
   const sanctioned: SanctionedEntry[] = []
@@ -505,7 +516,9 @@ export function decideStopAction(inputs: StopInputs): StopAction {
   return 'block'
 }
 
-export const check = (payload: ToolCallPayload): GuardResult => {
+export const check = async (
+  payload: ToolCallPayload,
+): Promise<GuardResult> => {
   const repoDir = getProjectDir()
   /* c8 ignore start - getProjectDir() always returns resolveProjectDir() as fallback; this guard is defensive */
   if (!repoDir) {
@@ -539,7 +552,7 @@ export const check = (payload: ToolCallPayload): GuardResult => {
           return true
         })
   const allPrimaryDirty = dropParked(
-    filterTouchedDirty(listDirtyEntries(repoDir), repoDir, touched),
+    filterTouchedDirty(await listDirtyEntries(repoDir), repoDir, touched),
     repoDir,
   )
 
@@ -556,7 +569,7 @@ export const check = (payload: ToolCallPayload): GuardResult => {
     storeRoot,
   )
 
-  const siblingDirt = listTouchedSiblingDirt(touched, primaryRoot)
+  const siblingDirt = (await listTouchedSiblingDirt(touched, primaryRoot))
     .map(s => ({ ...s, dirty: dropParked(s.dirty, s.root) }))
     .filter(s => s.dirty.length > 0)
   let siblingDirtyCount = 0
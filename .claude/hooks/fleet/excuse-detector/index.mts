@@ -225,7 +225,8 @@ export function hasLiveForeignActor(
   const otherPaths = listOtherActorLedgerPaths(storeRoot, ownActorId)
   const now = Date.now()
   for (let i = 0, { length } = otherPaths; i < length; i += 1) {
-    const raw = readActorLedger(otherPaths[i]!)
+    // Liveness needs only the newest edit: a bounded read of the last line.
+    const raw = readActorLedger(otherPaths[i]!, now)
     if (
       raw &&
       raw.actorId !== ownActorId &&
@@ -25,6 +25,8 @@
  * are ignored; fails open on parse errors — a nudge must never wedge a call.
  *
  * Convention: docs/agents.md/fleet/hook-registry.md.
+ *
+ * @dispatch-pure — the edited path and new text (or the command) decide it.
  */
 
 import { normalizePath } from '@socketsecurity/lib-stable/paths/normalize'
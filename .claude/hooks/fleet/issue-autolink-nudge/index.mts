@@ -13,6 +13,8 @@
 // blocks (notify, exit 0). Universal: bare `#N` auto-links on ANY GitHub repo,
 // so this is not fleet-scoped. Internal task lists in the agent's own prose
 // (never sent to a public surface) are unaffected.
+//
+// @dispatch-pure — matches the command text only.
 
 import { bashGuard, defineHook, notify, runHook } from '../_shared/guard.mts'
 import { isPublicSurface } from '../_shared/public-surfaces.mts'
@@ -32,6 +32,10 @@
 //
 // This is a NUDGE (never blocks): when hits are found it returns
 // `notify(message)` so the runner prints to stderr and exits 0.
+//
+// @dispatch-lazy — the inlined compromise.js is most of the snapshot bundle,
+// and the hook runs once a turn. A `--lazy-cold` snapshot build leaves it out
+// of the blob every event boots; it loads from excluded-bundle.cjs at Stop.
 
 import { defineHook, notify, runHook } from '../_shared/guard.mts'
 import type { GuardResult } from '../_shared/guard.mts'
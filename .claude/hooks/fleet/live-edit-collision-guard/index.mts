@@ -86,7 +86,8 @@ export function detectCollision(
   } as typeof config
   for (let i = 0, { length } = otherLedgerPaths; i < length; i += 1) {
     const fp = otherLedgerPaths[i]!
-    const raw = readActorLedger(fp)
+    // Only writes inside the window can collide: read no further back.
+    const raw = readActorLedger(fp, now - collisionWindowMs)
     if (!raw) {
       continue
     }
@@ -143,8 +144,9 @@ export function check(payload: ToolCallPayload): GuardResult {
 
   // Fail-open: if own ledger lookup is unavailable, skip any self-check.
   const ownFp = ledgerFilePath(storeRoot, ownActorId)
-  const ownLedger = readActorLedger(ownFp)
   const now = Date.now()
+  // An own write older than the window can't supersede a foreign one in it.
+  const ownLedger = readActorLedger(ownFp, now - COLLISION_WINDOW_MS)
   // Our own write timestamp for this path — used to determine recency vs foreign.
   const ownWrite = ownLedger ? lookupPath(ownLedger, normalizedPath) : undefined
 
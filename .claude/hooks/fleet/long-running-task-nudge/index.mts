@@ -27,6 +27,9 @@
 // store maps each task id to the highest tier warned; a task re-warns only when
 // it crosses a higher tier. Fail-open everywhere — a broken read never blocks a
 // tool call.
+//
+// @dispatch-must-run — never deferred by the latency budget: it keeps the
+// warned-tier store for every task.
 
 import {
   existsSync,
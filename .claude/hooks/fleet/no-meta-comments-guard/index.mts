@@ -24,6 +24,7 @@
 //
 // Fails open on malformed payloads (exit 0 + stderr log).
 
+import { parseSource } from '../_shared/ast/cache.mts'
 import { walkComments } from '../_shared/ast/comments.mts'
 import { splitLines } from '../_shared/ast/core.mts'
 import { block, defineHook, editGuard, runHook } from '../_shared/guard.mts'
@@ -143,7 +144,8 @@ const REMOVED_CODE_BODY_PATTERNS: readonly RegExp[] = [
  */
 export function findMetaCommentsAst(text: string): MetaCommentFinding[] {
   const findings: MetaCommentFinding[] = []
-  const lines = splitLines(text)
+  // The parse (and its line split) is shared with the other AST guards.
+  const { lines } = parseSource(text)
   for (const c of walkComments(text, { comments: true })) {
     const bodyLines = splitLines(c.value)
     for (let li = 0; li < bodyLines.length; li += 1) {
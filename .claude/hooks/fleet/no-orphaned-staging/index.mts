@@ -29,11 +29,9 @@
 // the next message includes the warning. The agent can then either
 // commit or explicitly explain why the staged state is intentional.
 
-import { spawnSync } from '@socketsecurity/lib-stable/process/spawn/child'
-
+import { gitOutAsync } from '../_shared/git-branch.mts'
 import { defineHook, notify, runHook } from '../_shared/guard.mts'
 import type { GuardResult } from '../_shared/guard.mts'
-import { spawnTimeoutMs } from '../_shared/spawn-timeout.mts'
 import { resolveProjectDir } from '../_shared/project-dir.mts'
 
 export function getProjectDir(): string | undefined {
@@ -42,21 +40,19 @@ export function getProjectDir(): string | undefined {
   return resolveProjectDir()
 }
 
-export function listStagedFiles(repoDir: string): string[] {
-  const r = spawnSync('git', ['diff', '--cached', '--name-only'], {
-    cwd: repoDir,
-    timeout: spawnTimeoutMs(5000),
-  })
-  if (r.status !== 0) {
+export async function listStagedFiles(repoDir: string): Promise<string[]> {
+  // Shared with the other staging checks of this dispatch.
+  const out = await gitOutAsync(repoDir, ['diff', '--cached', '--name-only'])
+  if (out === undefined) {
     return []
   }
-  return String(r.stdout)
+  return out
     .split('\n')
     .map((s: string) => s.trim())
     .filter(Boolean)
 }
 
-export const check = (): GuardResult => {
+export const check = async (): Promise<GuardResult> => {
   const repoDir = getProjectDir()
   /* c8 ignore start - getProjectDir() always falls back to resolveProjectDir(), which is never empty */
   if (!repoDir) {
@@ -64,7 +60,7 @@ export const check = (): GuardResult => {
   }
   /* c8 ignore stop */
 
-  const staged = listStagedFiles(repoDir)
+  const staged = await listStagedFiles(repoDir)
   if (staged.length === 0) {
     return undefined
   }
@@ -28,12 +28,11 @@
 // Bypass phrase: `Allow options-param-naming bypass` (whole session).
 //
 // Fragment tolerance: Edit's `new_string` is a snippet that may not parse
-// standalone. `tryParse` returns undefined on parse failure and the hook stays
+// standalone. `parseSource` yields no AST on parse failure and the hook stays
 // fail-open. The hook fails OPEN on its own bugs (exit 0 + stderr log) so a
 // bad deploy can't brick the session.
 
-import { offsetToLineCol, tryParse } from '../_shared/ast/core.mts'
-import type { AcornNode } from '../_shared/ast/core.mts'
+import { parseSource } from '../_shared/ast/cache.mts'
 import { block, defineHook, editGuard, runHook } from '../_shared/guard.mts'
 
 const ALLOW_MARKER = '// socket-lint: allow options-param-naming'
@@ -70,63 +69,44 @@ export function isApplicable(filePath: string): boolean {
   return APPLICABLE_EXTS.has(filePath.slice(dot))
 }
 
-// Walk the AST and collect the source offset of every function param that is a
-// plain Identifier named `opts`. Destructured / rest params and any `opts`
-// that is a property or type member are not param Identifiers, so they never
-// appear here. Pure AST — no regex over source structure.
+// Collect the source offset of every function param that is a plain
+// Identifier named `opts`, in source order. Destructured / rest params and any
+// `opts` that is a property or type member are not param Identifiers, so they
+// never appear here. Pure AST — no regex over source structure.
 export function findOptsParams(source: string): number[] {
   // No options: the `_shared/ast/core.mts` defaults already enable TypeScript and the
   // fleet's ES2026 floor, which is exactly what a hook parsing `.ts`/`.mts`
-  // source wants.
-  const ast = tryParse(source)
-  if (!ast) {
+  // source wants. The parse (and its by-type node index) is shared with the
+  // other AST guards of this dispatch.
+  const parsed = parseSource(source)
+  if (!parsed.ast) {
     return []
   }
   const offsets: number[] = []
-  const visit = (node: AcornNode | undefined): void => {
-    if (!node || typeof node !== 'object') {
-      return
-    }
-    const type = (node as { type?: string | undefined }).type
-    if (typeof type === 'string' && FUNCTION_NODE_TYPES.has(type)) {
-      const params = (node as { params?: AcornNode[] | undefined }).params
+  for (const type of FUNCTION_NODE_TYPES) {
+    const fns = parsed.nodesOfType(type)
+    for (let i = 0, { length } = fns; i < length; i += 1) {
+      const params = fns[i]!['params']
       /* c8 ignore next - acorn always emits params as an array on function nodes; defensive type-guard */
-      if (Array.isArray(params)) {
-        for (let i = 0, { length } = params; i < length; i += 1) {
-          const p = params[i] as
-            | {
-                type?: string | undefined
-                name?: string | undefined
-                start?: number | undefined
-              }
-            | undefined
-          if (p?.type === 'Identifier' && p.name === BANNED_PARAM_NAME) {
-            /* c8 ignore next - acorn always sets start on Identifier nodes; defensive fallback */
-            offsets.push(p.start ?? 0)
-          }
-        }
-      }
-    }
-    const keyList = Object.keys(node)
-    for (let j = 0, { length: jlen } = keyList; j < jlen; j += 1) {
-      const key = keyList[j]!
-      /* c8 ignore start - acorn never emits a parent back-reference; defensive guard for enriched ASTs */
-      if (key === 'parent') {
+      if (!Array.isArray(params)) {
         continue
       }
-      /* c8 ignore stop */
-      const child = (node as Record<string, unknown>)[key]
-      if (Array.isArray(child)) {
-        for (let i = 0, { length } = child; i < length; i += 1) {
-          visit(child[i] as AcornNode)
+      for (let j = 0, { length: plen } = params; j < plen; j += 1) {
+        const p = params[j] as
+          | {
+              type?: string | undefined
+              name?: string | undefined
+              start?: number | undefined
+            }
+          | undefined
+        if (p?.type === 'Identifier' && p.name === BANNED_PARAM_NAME) {
+          /* c8 ignore next - acorn always sets start on Identifier nodes; defensive fallback */
+          offsets.push(p.start ?? 0)
         }
-      } else if (child && typeof child === 'object') {
-        visit(child as AcornNode)
       }
     }
   }
-  visit(ast)
-  return offsets
+  return offsets.sort((x, y) => x - y)
 }
 
 // Drop offenses whose param line, or the line immediately above the enclosing
@@ -135,11 +115,12 @@ export function applyAllowMarkerFilter(
   source: string,
   offsets: number[],
 ): Offense[] {
-  const lines = source.split('\n')
+  const parsed = parseSource(source)
+  const { lines } = parsed
   const out: Offense[] = []
   for (let i = 0, { length } = offsets; i < length; i += 1) {
-    const { line } = offsetToLineCol(source, offsets[i]!)
-    /* c8 ignore next - offsetToLineCol always maps to an existing line; defensive fallback */
+    const { line } = parsed.lineColOf(offsets[i]!)
+    /* c8 ignore next - lineColOf always maps to an existing line; defensive fallback */
     const onLine = lines[line - 1] ?? ''
     /* c8 ignore next - lines[line-2] is always present when line>=2 for valid source; defensive fallback */
     const prev = line >= 2 ? (lines[line - 2] ?? '') : ''
@@ -50,6 +50,7 @@ import { spawnSync } from '@socketsecurity/lib-stable/process/spawn/child'
 import { isGitCommit } from '../_shared/commit-command.mts'
 import { isSquashOptIn } from '../_shared/fleet-roster.mts'
 import { readSessionTouchedPaths } from '../_shared/foreign-paths.mts'
+import { gitOutAsync } from '../_shared/git-branch.mts'
 import { extractGitCwd } from '../_shared/git-cwd.mts'
 import { bashGuard, block, defineHook, runHook } from '../_shared/guard.mts'
 import type { ToolCallPayload } from '../_shared/payload.mts'
@@ -153,15 +154,13 @@ export function isMidMergeCommit(repoDir: string): boolean {
     .some(p => existsSync(path.isAbsolute(p) ? p : path.join(repoDir, p)))
 }
 
-export function listStagedFiles(repoDir: string): string[] {
-  const r = spawnSync('git', ['diff', '--cached', '--name-only'], {
-    cwd: repoDir,
-    timeout: spawnTimeoutMs(5000),
-  })
-  if (r.status !== 0) {
+export async function listStagedFiles(repoDir: string): Promise<string[]> {
+  // Shared with the other staging checks of this dispatch.
+  const out = await gitOutAsync(repoDir, ['diff', '--cached', '--name-only'])
+  if (out === undefined) {
     return []
   }
-  return String(r.stdout)
+  return out
     .split('\n')
     .map((s: string) => s.trim())
     .filter(Boolean)
@@ -198,7 +197,10 @@ export function listStagedRenamedPaths(repoDir: string): Set<string> {
   return renamed
 }
 
-export function checkCommand(command: string, payload: ToolCallPayload) {
+export async function checkCommand(
+  command: string,
+  payload: ToolCallPayload,
+) {
   const repoDir = getRepoDir(command, payload.cwd)
   const transcriptPath = payload.transcript_path
 
@@ -277,7 +279,7 @@ export function checkCommand(command: string, payload: ToolCallPayload) {
     if (isMidMergeCommit(repoDir)) {
       return undefined
     }
-    const staged = listStagedFiles(repoDir)
+    const staged = await listStagedFiles(repoDir)
     if (staged.length === 0) {
       return undefined
     }
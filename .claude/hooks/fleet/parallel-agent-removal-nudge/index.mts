@@ -37,6 +37,8 @@
 //
 // Never blocks — always a notify (exit 0). Informational.
 //
+// @dispatch-must-run — never deferred by the latency budget: it prunes its own
+// read-tracking state.
 
 import process from 'node:process'
 import { existsSync, readFileSync } from 'node:fs'
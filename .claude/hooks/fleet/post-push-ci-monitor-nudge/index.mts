@@ -23,6 +23,9 @@
 //
 // PostToolUse, not PreToolUse: we react after the push has gone out and CI
 // has been triggered; we don't predict it. Never blocks (notify, exit 0).
+//
+// @dispatch-pure — the push command alone decides it, never its output or
+// the remote.
 
 import { bashGuard, defineHook, notify, runHook } from '../_shared/guard.mts'
 import { commandsFor } from '../_shared/shell-command.mts'
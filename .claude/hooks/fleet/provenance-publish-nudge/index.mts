@@ -30,6 +30,9 @@
 //
 // The hook NEVER fails the turn. Stop hooks shouldn't gate; they
 // nudge. The warning surfaces so the operator decides what to do.
+//
+// @dispatch-must-run — never deferred by the latency budget: it records which
+// releases it has checked.
 
 import { existsSync, mkdirSync, readFileSync, writeFileSync } from 'node:fs'
 import path from 'node:path'
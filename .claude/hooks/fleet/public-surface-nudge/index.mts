@@ -20,6 +20,8 @@
 //
 // Reads a Claude Code PreToolUse JSON payload from stdin:
 //   { "tool_name": "Bash", "tool_input": { "command": "..." } }
+//
+// @dispatch-pure — classifies the command text only.
 
 import { bashGuard, defineHook, notify, runHook } from '../_shared/guard.mts'
 import { isPublicSurface } from '../_shared/public-surfaces.mts'
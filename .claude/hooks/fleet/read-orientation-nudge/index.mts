@@ -134,6 +134,9 @@ export function check(payload: ToolCallPayload): GuardResult {
 export const hook = defineHook({
   check,
   event: 'PreToolUse',
+  // `check` already ignores every other tool; declaring it lets the dispatcher
+  // (and the launcher's tool pre-flight) skip the hook instead of calling it.
+  matcher: ['Read'],
   type: 'nudge',
 })
 void runHook(hook, import.meta.url)
@@ -17,6 +17,9 @@
 // edit.
 //
 // Stderr reminder; never blocks.
+//
+// @dispatch-pure — file_path and the about-to-land content decide it, never
+// the file on disk.
 
 import { normalizePath } from '@socketsecurity/lib-stable/paths/normalize'
 import { defineHook, editGuard, notify, runHook } from '../_shared/guard.mts'
@@ -27,6 +27,7 @@
 
 import { bashGuard, block, defineHook, runHook } from '../_shared/guard.mts'
 import type { GuardResult } from '../_shared/guard.mts'
+import { mayMatch } from '../_shared/pattern-engine.mts'
 import {
   SECRET_VALUE_PATTERNS,
   SENSITIVE_NAME_FRAGMENTS,
@@ -166,7 +167,7 @@ export function findViolation(command: string): BlockError | undefined {
   // A real token value already landed in the command, which itself is
   // logged. We refuse to echo it further and urge rotation.
   for (const { label, re } of SECRET_VALUE_PATTERNS) {
-    if (re.test(command)) {
+    if (mayMatch(re, command) && re.test(command)) {
       return new BlockError(
         `literal ${label} found in command string`,
         'Rotate the exposed token immediately. Never paste tokens into commands; read them from .env.local or a keychain at subprocess spawn time.',
@@ -20,6 +20,9 @@
 //     no enforcer citation.
 //
 // Fail-open on parse / payload errors.
+//
+// @dispatch-must-run — never deferred by the latency budget: it records each
+// occurrence it counts.
 
 import process from 'node:process'
 
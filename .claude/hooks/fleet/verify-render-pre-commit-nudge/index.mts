@@ -18,12 +18,11 @@
 //
 // No-op when the staged set is purely non-UI source.
 
-import { spawnSync } from '@socketsecurity/lib-stable/process/spawn/child'
 import { readFileSync } from 'node:fs'
 
 import { isGitCommit } from '../_shared/commit-command.mts'
+import { gitOutAsync } from '../_shared/git-branch.mts'
 import { bashGuard, defineHook, notify, runHook } from '../_shared/guard.mts'
-import { spawnTimeoutMs } from '../_shared/spawn-timeout.mts'
 import { resolveProjectDir } from '../_shared/project-dir.mts'
 
 // Files whose changes likely affect rendered output.
@@ -162,27 +161,25 @@ export function readTranscript(transcriptPath: string): TranscriptEntry[] {
   return out
 }
 
-export function stagedFiles(cwd: string): string[] {
-  const r = spawnSync('git', ['diff', '--cached', '--name-only'], {
-    cwd,
-    timeout: spawnTimeoutMs(5000),
-  })
-  if (r.status !== 0) {
+export async function stagedFiles(cwd: string): Promise<string[]> {
+  // Shared with the staging guards of this dispatch.
+  const out = await gitOutAsync(cwd, ['diff', '--cached', '--name-only'])
+  if (out === undefined) {
     return []
   }
-  return String(r.stdout)
+  return out
     .split('\n')
     .map((s: string) => s.trim())
     .filter(Boolean)
 }
 
-export const check = bashGuard((command, payload) => {
+export const check = bashGuard(async (command, payload) => {
   if (!isGitCommit(command)) {
     return undefined
   }
 
   const cwd = resolveProjectDir(payload.cwd)
-  const staged = stagedFiles(cwd)
+  const staged = await stagedFiles(cwd)
   const uiStaged = staged.filter(f => UI_FILE_RE.test(f))
   if (uiStaged.length === 0) {
     return undefined
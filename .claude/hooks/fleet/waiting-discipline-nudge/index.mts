@@ -21,6 +21,8 @@
 // single `sleep` invocation totals WAIT_SLEEP_NUDGE_SECONDS (120s) or more.
 // Skips detached commands (`run_in_background: true`) — a background shell
 // does not silence the turn. Reminder only; never blocks.
+//
+// @dispatch-pure — reads the command and run_in_background only.
 
 import { bashGuard, defineHook, notify, runHook } from '../_shared/guard.mts'
 import {
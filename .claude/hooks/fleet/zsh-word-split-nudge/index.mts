@@ -23,6 +23,8 @@
  * variable unquoted as a standalone argument. Stderr reminder; never
  * blocks. Skips `${=name}` (already split), `"${name}"`/`"$name"`
  * (deliberately one word), and `${name[@]}` (array expansion).
+ *
+ * @dispatch-pure — a scan of the command text and nothing else.
  */
 
 import { bashGuard, defineHook, notify, runHook } from '../_shared/guard.mts'
@@ -0,0 +1,228 @@
+/**
+ * @file Prime the hook bundle's V8 compile cache at build time. `index.cjs` is
+ *   the fleet-wide baseline, the Windows default and the launcher's fail-open
+ *   target, yet it only ran warm after a first hook run had filled
+ *   `node_modules/.cache/fleet/fleet-hooks`. That cache is empty in every fresh
+ *   CI container and after every node_modules rebuild.
+ *
+ *   Node writes a module's cache entry when it compiles the module, so the
+ *   entry holds only the functions compiled eagerly at that point: the same
+ *   entry a first hook run would write, only written ahead of it. The bundle
+ *   carries no `//# allFunctionsCalledOnLoad` hint to widen that. The hint
+ *   can't be confined to the prime (the entry is checked against the
+ *   bundle's content, so a primed variant would never be hit), and in the
+ *   shipped bundle it makes every load compile, or deserialize, all of
+ *   `bundle.cjs`. Add it back only with dispatch-bench numbers for the cold
+ *   and warm `index.cjs` paths that show it wins.
+ *
+ *   Priming runs the real loader, `node index.cjs` with no event, under the
+ *   host node. The loader enables the cache exactly as a hook run would and
+ *   requires the bundle. The dispatcher exits at once with no event to
+ *   dispatch, and no hook runs. An `exit` listener flushes the cache, so the
+ *   entry reaches disk however the dispatcher exits. Cache entries are keyed
+ *   on the bundle's path and checked against its content, so the entry this
+ *   leaves is the one every later `index.cjs` run loads.
+ *
+ *   The cache dir sits in `node_modules/.cache` beside the snapshot blobs. An
+ *   image bake keeps it the same way: run the build in the image layer. Each
+ *   prime records its runtime in `compile-cache-manifest.json` at the cache
+ *   root: node, the bundle hash, and the files under that runtime's tag dir.
+ *   Failures are reported, never thrown. The cache is pure speed, and a
+ *   missing entry only means the first hook run compiles.
+ */
+
+import { spawnSync } from '@socketsecurity/lib-stable/process/spawn/child'
+import crypto from 'node:crypto'
+import {
+  existsSync,
+  mkdirSync,
+  readFileSync,
+  readdirSync,
+  statSync,
+  writeFileSync,
+} from 'node:fs'
+import { createRequire } from 'node:module'
+import path from 'node:path'
+import process from 'node:process'
+
+import {
+  DISPATCH_DIR,
+  FLEET_HOOKS_DIR,
+  HOOK_BUNDLE_PATH,
+  HOOK_COMPILE_CACHE_DIR,
+  REPO_ROOT,
+} from '../paths.mts'
+
+const require = createRequire(import.meta.url)
+// Node keys its compile-cache subdir the way snapshot-cache-path.cjs keys the
+// blob dirs (that file mirrors Node's GetCacheVersionTag).
+const { versionTag } = require(
+  path.join(DISPATCH_DIR, 'snapshot-cache-path.cjs'),
+) as { versionTag: () => string }
+
+export const COMPILE_CACHE_MANIFEST_NAME = 'compile-cache-manifest.json'
+export const COMPILE_CACHE_MANIFEST_VERSION = 1
+
+const PRIME_TIMEOUT_MS = 60_000
+
+// index.cjs's reportBundleLoadFailure line.
+const LOAD_FAILURE_PREFIX = '[fleet-hook-dispatch] bundle load failed'
+
+// Run in the priming node: flush on exit, then load the real loader with no
+// event. argv[1] is index.cjs, and the dispatcher reads its event from
+// argv[2], which stays unset.
+const PRIME_SCRIPT =
+  "const m=require('node:module');" +
+  "process.on('exit',()=>{try{m.flushCompileCache?.()}catch{}});" +
+  'require(process.argv[1])'
+
+export type PrimeStatus = 'failed' | 'primed' | 'unsupported'
+
+export interface PrimeOutcome {
+  readonly detail: string
+  readonly dir: string
+  readonly files: number
+  readonly status: PrimeStatus
+}
+
+interface CacheFile {
+  readonly name: string
+  readonly size: number
+}
+
+interface ManifestRuntime {
+  readonly arch: string
+  readonly bundleSha256: string
+  readonly dir: string
+  readonly files: readonly CacheFile[]
+  readonly node: string
+  readonly platform: string
+  readonly primedAt: string
+  readonly version: string
+}
+
+function listCacheFiles(dir: string): CacheFile[] {
+  const files: CacheFile[] = []
+  let names: string[]
+  try {
+    names = readdirSync(dir)
+  } catch {
+    return files
+  }
+  for (let i = 0, { length } = names; i < length; i += 1) {
+    try {
+      const st = statSync(path.join(dir, names[i]!))
+      if (st.isFile() && st.size > 0) {
+        files.push({
+          __proto__: null,
+          name: names[i]!,
+          size: st.size,
+        } as CacheFile)
+      }
+    } catch {}
+  }
+  return files.toSorted((a, b) => (a.name < b.name ? -1 : 1))
+}
+
+/**
+ * Record this runtime's primed entry in the cache root's manifest, keeping
+ * every other runtime's.
+ */
+function writeCacheManifest(tag: string, entry: ManifestRuntime): void {
+  const file = path.join(HOOK_COMPILE_CACHE_DIR, COMPILE_CACHE_MANIFEST_NAME)
+  let runtimes: Record<string, ManifestRuntime> = {}
+  try {
+    const prior = JSON.parse(readFileSync(file, 'utf8')) as {
+      runtimes?: Record<string, ManifestRuntime>
+    }
+    runtimes = { ...prior.runtimes }
+  } catch {}
+  runtimes[tag] = entry
+  mkdirSync(HOOK_COMPILE_CACHE_DIR, { recursive: true })
+  const manifest = { v: COMPILE_CACHE_MANIFEST_VERSION, runtimes }
+  writeFileSync(file, `${JSON.stringify(manifest, undefined, 2)}\n`)
+}
+
+/**
+ * Prime the compile cache for `bundle.cjs` under the host node and record it.
+ */
+export function primeHookCompileCache(): PrimeOutcome {
+  const tag = versionTag()
+  const dir = path.join(HOOK_COMPILE_CACHE_DIR, tag)
+  const outcome = (status: PrimeStatus, detail: string, files = 0) =>
+    ({ __proto__: null, detail, dir, files, status }) as PrimeOutcome
+  if (!existsSync(HOOK_BUNDLE_PATH)) {
+    return outcome('failed', 'bundle.cjs is not built')
+  }
+  if (typeof require('node:module').enableCompileCache !== 'function') {
+    return outcome(
+      'unsupported',
+      `${process.version} has no module.enableCompileCache`,
+    )
+  }
+  const env: NodeJS.ProcessEnv = { ...process.env }
+  // Either would point the loader's cache elsewhere, or turn it off.
+  delete env['NODE_COMPILE_CACHE']
+  delete env['NODE_DISABLE_COMPILE_CACHE']
+  const r = spawnSync(
+    process.execPath,
+    ['-e', PRIME_SCRIPT, path.join(FLEET_HOOKS_DIR, 'index.cjs')],
+    {
+      cwd: REPO_ROOT,
+      encoding: 'utf8',
+      env,
+      input: '',
+      timeout: PRIME_TIMEOUT_MS,
+    },
+  )
+  if (r.status !== 0) {
+    return outcome(
+      'failed',
+      `priming run exited ${String(r.status)}: ` +
+        (String(r.stderr ?? '').trim().split('\n')[0] || 'no output'),
+    )
+  }
+  // The loader reports a bundle that won't load on stderr and exits 0.
+  const loadFailure = String(r.stderr ?? '')
+    .split('\n')
+    .find(line => line.startsWith(LOAD_FAILURE_PREFIX))
+  if (loadFailure) {
+    return outcome('failed', loadFailure)
+  }
+  const files = listCacheFiles(dir)
+  if (!files.length) {
+    return outcome('failed', `no cache entries under ${dir}`)
+  }
+  try {
+    writeCacheManifest(tag, {
+      __proto__: null,
+      arch: process.arch,
+      bundleSha256: crypto
+        .createHash('sha256')
+        .update(readFileSync(HOOK_BUNDLE_PATH))
+        .digest('hex'),
+      dir,
+      files,
+      node: process.execPath,
+      platform: process.platform,
+      primedAt: new Date().toISOString(),
+      version: process.version,
+    } as ManifestRuntime)
+  } catch (e) {
+    return outcome(
+      'failed',
+      `manifest not written: ${String(e)}`,
+      files.length,
+    )
+  }
+  let bytes = 0
+  for (let i = 0, { length } = files; i < length; i += 1) {
+    bytes += files[i]!.size
+  }
+  return outcome(
+    'primed',
+    `${files.length} entr${files.length === 1 ? 'y' : 'ies'}, ` +
+      `${(bytes / 1024).toFixed(0)} KiB`,
+    files.length,
+  )
+}
@@ -21,15 +21,56 @@ const EXPORT_HOOK_RE = /export\s+const\s+hook\s*=\s*defineHook\s*\(/
 // (index.cjs path) but is split out of the snapshot bundle into
 // `excluded-bundle.cjs`, which deserialize-main splices in at runtime.
 const SNAPSHOT_EXCLUDE_RE = /@dispatch-snapshot-exclude\b/
+// Cold-hook opt-in: a heavy hook that fires rarely (a large inlined library,
+// one event a turn) declares `@dispatch-lazy`. It is snapshot-safe and
+// frozen like any other by default; `build-hook-snapshot.mts --lazy-cold`
+// moves it into `excluded-bundle.cjs` instead, so the blob every event boots
+// no longer carries it and only a dispatch that can reach it loads it.
+const DISPATCH_LAZY_RE = /@dispatch-lazy\b/
+// Verdict-cache opt-in (`_dispatch/verdict-cache.mts`): a hook whose verdict
+// depends on the payload's event, tool and input alone declares
+// `@dispatch-pure` in its header. The marker is ignored on a hook whose
+// defineHook wrapping reads state regardless — a convention-scoped hook
+// resolves the target repo, an auto-bypass reads the transcript, `fleetOnly`
+// probes the filesystem, the post-edit document is a disk read — so a stale
+// replay can't come from a hook that only looks pure.
+const DISPATCH_PURE_RE = /@dispatch-pure\b/
+const IMPURE_WRAPPING_RE =
+  /\bscope\s*:\s*['"]convention['"]|\bbypass\s*:|\bfleetOnly\b|\beditedText\b|\bresolveEditedText\b/
+// Latency-budget class (`dispatch()`'s `budgetMs`): a `type: 'nudge'` hook
+// whose source never imports or calls `block` can only notify, so it is
+// ADVISORY and may be dropped past the event's deadline. `type` is read from
+// the `defineHook` call itself; the block test is deliberately blunt, so a
+// nudge that reaches `block` anywhere stays block-capable. A nudge that keeps
+// state every matching event must update (a ledger, a counter, a landing)
+// declares `@dispatch-must-run` and is never deferred.
+const DISPATCH_TYPE_RE = /\btype\s*:\s*['"](guard|nudge)['"]/
+const BLOCK_USE_RE =
+  /\bblock\s*\(|import\s*\{[^}]*\bblock\b[^}]*\}\s*from\s*['"][^'"]*guard\.mts['"]/
+const MUST_RUN_RE = /@dispatch-must-run\b/
+// Batch / replay (`_dispatch/dispatch-batch.mts`) runs recorded events
+// against the live project, so a hook that changes state beside its verdict
+// (a ledger, a throttle stamp, a log, a killed process, a landed commit) is
+// STATEFUL and skipped there. A `@dispatch-must-run` hook is stateful by
+// definition. Past that the test is blunt, like BLOCK_USE_RE: an fs write or
+// delete, a kill, or a call to a shared ledger's writer anywhere in the
+// hook's own source. A hook whose writes live in a sibling module the scan
+// doesn't read declares `@dispatch-stateful`.
+const STATEFUL_RE =
+  /@dispatch-stateful\b|\b(?:appendFile|appendFileSync|mkdir|mkdirSync|rename|renameSync|rmSync|safeDelete|unlinkSync|utimesSync|writeFile|writeFileSync|writeSync)\s*\(|\.kill\s*\(|\b(?:appendActorEdit|clearParked|parkPaths|recordOccurrence|recordTouchedFromBash|recordTouchedPath|sweepStaleLedgers|writeActorLedger|writeLedger|writeParked)\s*\(/
 const DISPATCH_EVENT_RE = /\bevent\s*:\s*['"]([^'"]+)['"]/
 const DISPATCH_TOOLS_RE = /\bmatcher\s*:\s*\[([^\]]*)\]/
 const EXPORT_TRIGGERS_RE = /\bexport\s+const\s+triggers\b/
 const INLINE_TRIGGERS_RE = /\btriggers\s*:\s*\[/
 
 export interface EligibleHook {
+  readonly advisory: boolean
   readonly event: string
+  readonly lazy: boolean
   readonly name: string
+  readonly pure: boolean
   readonly snapshotExcluded: boolean
+  readonly stateful: boolean
   readonly tools: readonly string[]
   readonly triggers: readonly string[]
 }
@@ -123,11 +164,20 @@ export function parseHookSource(
         .map(s => s.trim().replace(/^['"]|['"]$/g, ''))
         .filter(Boolean)
     : []
+  const hookAt = EXPORT_HOOK_RE.exec(source)!.index
+  const typeMatch = DISPATCH_TYPE_RE.exec(source.slice(hookAt))
   return {
     __proto__: null,
+    advisory:
+      typeMatch?.[1] === 'nudge' &&
+      !BLOCK_USE_RE.test(source) &&
+      !MUST_RUN_RE.test(source),
     event,
+    lazy: DISPATCH_LAZY_RE.test(source),
     name,
+    pure: DISPATCH_PURE_RE.test(source) && !IMPURE_WRAPPING_RE.test(source),
     snapshotExcluded: SNAPSHOT_EXCLUDE_RE.test(source),
+    stateful: MUST_RUN_RE.test(source) || STATEFUL_RE.test(source),
     tools,
     triggers: parseTriggers(source),
   } as EligibleHook
@@ -0,0 +1,169 @@
+/*
+ * @file The native dispatch launcher's LAUNCH MANIFEST — one fixed-layout
+ *   binary file (`_dispatch/launch.manifest`) that replaces the old
+ *   `node.path` + `snapshot-blob.path` text sidecars. The launcher reads it
+ *   with a single open + fixed-size read (no line parsing, no per-field
+ *   fopen) and validates the blob against the frozen size / mtime / inode in
+ *   the one `stat` it already paid for the existence check, so a blob swapped
+ *   out or truncated underneath the sidecar is caught at launch and falls open
+ *   to `index.cjs` — instead of surfacing as node refusing to boot.
+ *
+ *   Layout (LAUNCH_MANIFEST_SIZE bytes, integers little-endian, strings UTF-8
+ *   NUL-terminated inside their fixed field; the C structs in
+ *   `dispatch-launcher.h` / `dispatch-launcher-win.h` mirror it):
+ *
+ *     off   size  field
+ *       0      8  magic "FLTLM\0\0\1" (the last byte is the layout version)
+ *       8      4  u32 total size — a torn or foreign file fails this check
+ *      12      4  u32 tuned flag count: how many of the frozen flags come
+ *                 from the benchmark-tuned profile (0 = none). The launcher
+ *                 boots a tuned blob so it can fall back to index.cjs when
+ *                 node rejects those flags (exit 9); 0 keeps the plain exec.
+ *      16      8  u64 blob size
+ *      24      8  i64 blob mtime, ns since the epoch
+ *      32      8  u64 blob inode (POSIX only; the Windows launcher skips it)
+ *      40     40  bundle content hash (hex)
+ *      80   1536  node binary path
+ *    1616   1536  snapshot blob path
+ *    3152    944  frozen node flags, each NUL-terminated, list ends at an
+ *                 empty string
+ *
+ *   Per-event split blobs (`build-hook-snapshot.mts --split-events`) each get
+ *   their own manifest in this same layout, `launch.<Event>.manifest`, which
+ *   the launcher tries for its argv[1] event before `launch.manifest`.
+ *
+ *   PURE: no I/O. The builder (`build-snapshot-launcher.mts`) writes the
+ *   encoded bytes; `hook-daemon.mts` decodes them to boot the same blob.
+ */
+
+export const LAUNCH_MANIFEST_NAME = 'launch.manifest'
+export const LAUNCH_MANIFEST_SIZE = 4096
+
+/**
+ * The manifest file for one event's split blob.
+ */
+export function eventLaunchManifestName(event: string): string {
+  return `launch.${event}.manifest`
+}
+
+const MAGIC = Buffer.from([0x46, 0x4c, 0x54, 0x4c, 0x4d, 0x00, 0x00, 0x01])
+const OFF_SIZE = 8
+const OFF_TUNED = 12
+const OFF_BLOB_SIZE = 16
+const OFF_BLOB_MTIME = 24
+const OFF_BLOB_INO = 32
+const OFF_HASH = 40
+const HASH_LEN = 40
+const OFF_NODE = 80
+const OFF_BLOB = 1616
+const PATH_LEN = 1536
+const OFF_FLAGS = 3152
+
+export interface LaunchManifest {
+  readonly blobIno: bigint
+  readonly blobMtimeNs: bigint
+  readonly blobPath: string
+  readonly blobSize: bigint
+  readonly bundleHash: string
+  readonly nodeFlags: readonly string[]
+  readonly nodePath: string
+  readonly tunedFlags?: number | undefined
+}
+
+/**
+ * Copy `text` NUL-terminated into its fixed field; false when it (plus the
+ * NUL) doesn't fit or already contains a NUL.
+ */
+function putString(
+  out: Buffer,
+  offset: number,
+  cap: number,
+  text: string,
+): boolean {
+  const bytes = Buffer.from(text, 'utf8')
+  if (bytes.length + 1 > cap || bytes.includes(0)) {
+    return false
+  }
+  bytes.copy(out, offset)
+  return true
+}
+
+function getString(buf: Buffer, offset: number, cap: number): string {
+  const field = buf.subarray(offset, offset + cap)
+  const end = field.indexOf(0)
+  return field.subarray(0, end === -1 ? cap : end).toString('utf8')
+}
+
+/**
+ * Encode the manifest, or undefined when a path / the flag list doesn't fit
+ * its field — the builder then writes no manifest and the launcher takes its
+ * `index.cjs` fail-open, rather than a truncated path it would exec.
+ */
+export function encodeLaunchManifest(m: LaunchManifest): Buffer | undefined {
+  const out = Buffer.alloc(LAUNCH_MANIFEST_SIZE)
+  MAGIC.copy(out, 0)
+  out.writeUInt32LE(LAUNCH_MANIFEST_SIZE, OFF_SIZE)
+  out.writeUInt32LE(m.tunedFlags ?? 0, OFF_TUNED)
+  out.writeBigUInt64LE(m.blobSize, OFF_BLOB_SIZE)
+  out.writeBigInt64LE(m.blobMtimeNs, OFF_BLOB_MTIME)
+  out.writeBigUInt64LE(m.blobIno, OFF_BLOB_INO)
+  if (
+    (m.tunedFlags ?? 0) > m.nodeFlags.length ||
+    !putString(out, OFF_HASH, HASH_LEN, m.bundleHash) ||
+    !putString(out, OFF_NODE, PATH_LEN, m.nodePath) ||
+    !putString(out, OFF_BLOB, PATH_LEN, m.blobPath)
+  ) {
+    return undefined
+  }
+  let offset = OFF_FLAGS
+  for (let i = 0, { length } = m.nodeFlags; i < length; i += 1) {
+    const flag = m.nodeFlags[i]!
+    // An empty flag would read back as the list terminator.
+    if (!flag) {
+      return undefined
+    }
+    const used = Buffer.byteLength(flag, 'utf8') + 1
+    // Keep one byte for the terminating empty string.
+    if (
+      offset + used + 1 > LAUNCH_MANIFEST_SIZE ||
+      !putString(out, offset, used, flag)
+    ) {
+      return undefined
+    }
+    offset += used
+  }
+  return out
+}
+
+/**
+ * Decode a manifest read from disk; undefined for a wrong magic / size.
+ */
+export function decodeLaunchManifest(buf: Buffer): LaunchManifest | undefined {
+  if (
+    buf.length !== LAUNCH_MANIFEST_SIZE ||
+    !buf.subarray(0, MAGIC.length).equals(MAGIC) ||
+    buf.readUInt32LE(OFF_SIZE) !== LAUNCH_MANIFEST_SIZE
+  ) {
+    return undefined
+  }
+  const nodeFlags: string[] = []
+  for (let offset = OFF_FLAGS; offset < LAUNCH_MANIFEST_SIZE; ) {
+    const flag = getString(buf, offset, LAUNCH_MANIFEST_SIZE - offset)
+    if (!flag) {
+      break
+    }
+    nodeFlags.push(flag)
+    offset += Buffer.byteLength(flag, 'utf8') + 1
+  }
+  return {
+    __proto__: null,
+    blobIno: buf.readBigUInt64LE(OFF_BLOB_INO),
+    blobMtimeNs: buf.readBigInt64LE(OFF_BLOB_MTIME),
+    blobPath: getString(buf, OFF_BLOB, PATH_LEN),
+    blobSize: buf.readBigUInt64LE(OFF_BLOB_SIZE),
+    bundleHash: getString(buf, OFF_HASH, HASH_LEN),
+    nodeFlags,
+    nodePath: getString(buf, OFF_NODE, PATH_LEN),
+    tunedFlags: buf.readUInt32LE(OFF_TUNED),
+  } as LaunchManifest
+}
@@ -0,0 +1,28 @@
+/**
+ * @file Bounded-concurrency runner for fleet build scripts: the snapshot
+ *   build's per-runtime blob builds and its attribution heap probes each
+ *   queue up more subprocesses than the machine should run at once.
+ */
+
+/**
+ * Run `tasks` with at most `limit` in flight, in order of start.
+ */
+export async function runPool(
+  tasks: ReadonlyArray<() => Promise<void>>,
+  limit: number,
+): Promise<void> {
+  let next = 0
+  const worker = async (): Promise<void> => {
+    while (next < tasks.length) {
+      const task = tasks[next]!
+      next += 1
+      // eslint-disable-next-line no-await-in-loop
+      await task()
+    }
+  }
+  const workers: Array<Promise<void>> = []
+  for (let w = 0, n = Math.min(limit, tasks.length); w < n; w += 1) {
+    workers.push(worker())
+  }
+  await Promise.all(workers)
+}
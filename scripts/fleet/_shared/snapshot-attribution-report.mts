@@ -0,0 +1,346 @@
+/**
+ * @file The snapshot build's attribution report (`build-hook-snapshot.mts
+ *   --report`): per hook and per shared module, what it adds to the blob every
+ *   event boots. Three measures per row:
+ *
+ *   - Bundled bytes (`snapshot-attribution.mts`).
+ *   - Retained heap: the `heapUsed` a fresh node keeps, after GC, for
+ *     importing the module on top of `_shared/guard.mts` (the base every
+ *     hook imports). This is module-eval state; a lazy `await import()`
+ *     inside a check isn't charged, although its source still is in bytes.
+ *   - Deserialize time, estimated: the measured boot time of the blob (less
+ *     a bare `node -e 0`), apportioned by retained heap over blob size.
+ *     Deserializing is close to linear in serialized heap, so this ranks
+ *     rows well but is an estimate, not a measurement.
+ *
+ *   Hooks split out to `excluded-bundle.cjs` (snapshot-excluded, or lazy
+ *   under `--lazy-cold`) are listed with `frozen: false` and bytes only.
+ */
+
+import { readFileSync, statSync } from 'node:fs'
+import { createRequire } from 'node:module'
+import path from 'node:path'
+
+import { spawn } from '@socketsecurity/lib-stable/process/spawn/child'
+
+import type { EligibleHook } from './dispatch-scan.mts'
+import { runPool } from './run-pool.mts'
+import {
+  attributeBytes,
+  collectReach,
+  parseBundleRegions,
+} from './snapshot-attribution.mts'
+import type {
+  AttributionReport,
+  HookCost,
+  PackageMemo,
+  Reach,
+  SharedCost,
+} from './snapshot-attribution.mts'
+
+export const ATTRIBUTION_NAME = 'attribution.json'
+export const ATTRIBUTION_VERSION = 1
+
+// In the probe node: heap kept by importing argv[2] on top of argv[1].
+const HEAP_PROBE =
+  "const{pathToFileURL}=require('node:url');" +
+  'const load=f=>import(pathToFileURL(f).href);' +
+  '(async()=>{await load(process.argv[1]);gc();gc();' +
+  'const a=process.memoryUsage().heapUsed;' +
+  'await load(process.argv[2]);gc();gc();' +
+  'process.stdout.write(String(process.memoryUsage().heapUsed-a))})()' +
+  '.catch(()=>process.exit(1))'
+
+const BOOT_RUNS = 7
+
+// Shared modules past this many (by bytes) get no heap probe: the long tail
+// is small helpers whose probe costs more than it tells.
+const SHARED_HEAP_ROWS = 40
+
+// The generated tables import every hook, so the core walk stops at them.
+const DISPATCH_TABLE_FILE_RE = /^dispatch-table(?:-[a-z]+)?\.mts$/
+
+/**
+ * Heap `node` retains for importing `target` on top of `base`, after GC;
+ * undefined when the probe fails (no TypeScript loader, a module-eval throw).
+ */
+export async function probeHeapBytes(
+  node: string,
+  base: string,
+  target: string,
+  cwd: string,
+): Promise<number | undefined> {
+  try {
+    const r = await spawn(
+      node,
+      [
+        '--expose-gc',
+        '--experimental-strip-types',
+        '--no-warnings',
+        '-e',
+        HEAP_PROBE,
+        base,
+        target,
+      ],
+      { cwd, stdio: 'pipe', stdioString: true },
+    )
+    const n = Number(String(r.stdout ?? '').trim())
+    return Number.isFinite(n) ? Math.max(0, n) : undefined
+  } catch {
+    return undefined
+  }
+}
+
+async function medianWallMs(
+  node: string,
+  args: readonly string[],
+  cwd: string,
+): Promise<number | undefined> {
+  const samples: number[] = []
+  for (let i = 0; i < BOOT_RUNS; i += 1) {
+    const start = process.hrtime.bigint()
+    try {
+      // eslint-disable-next-line no-await-in-loop
+      await spawn(node, [...args], { cwd, stdio: 'ignore' })
+    } catch {
+      return undefined
+    }
+    samples.push(Number(process.hrtime.bigint() - start) / 1e6)
+  }
+  samples.sort((a, b) => a - b)
+  return samples[samples.length >> 1]
+}
+
+/**
+ * Median boot of `blob` with no event (deserialize-main exits at once), less
+ * a bare node's: the deserialize cost the estimates apportion.
+ */
+export async function measureBlobBootMs(
+  node: string,
+  nodeFlags: readonly string[],
+  blob: string,
+  cwd: string,
+): Promise<number | undefined> {
+  const bare = await medianWallMs(node, ['-e', '0'], cwd)
+  const booted = await medianWallMs(
+    node,
+    [...nodeFlags, '--snapshot-blob', blob],
+    cwd,
+  )
+  if (bare === undefined || booted === undefined) {
+    return undefined
+  }
+  return Math.max(0, booted - bare)
+}
+
+/**
+ * Deserialize-time estimate for a row retaining `heapBytes`.
+ */
+export function deserializeShare(
+  heapBytes: number | undefined,
+  bootMs: number | undefined,
+  blobBytes: number,
+): number | undefined {
+  if (heapBytes === undefined || bootMs === undefined || blobBytes <= 0) {
+    return undefined
+  }
+  return (bootMs * heapBytes) / blobBytes
+}
+
+export interface AttributionConfig {
+  readonly blob: string
+  readonly bundle: string
+  readonly dispatchDir: string
+  // The hooks in excluded-bundle.cjs (snapshot-excluded, plus the lazy ones
+  // under --lazy-cold): charged from that bundle, never to the blob.
+  readonly excludedBundle: string
+  readonly hooks: readonly EligibleHook[]
+  readonly hooksDir: string
+  readonly jobs: number
+  readonly node: string
+  readonly nodeFlags: readonly string[]
+  readonly repoRoot: string
+  readonly splitOut: ReadonlySet<string>
+}
+
+function readRegions(file: string): Map<string, number> {
+  try {
+    return parseBundleRegions(readFileSync(file, 'utf8'))
+  } catch {
+    return new Map()
+  }
+}
+
+function entryOf(hooksDir: string, hook: string): string {
+  return path.join(hooksDir, hook, 'index.mts')
+}
+
+/**
+ * Measure the built bundle + blob: bytes per hook and shared module, heap
+ * probes for every frozen hook and the top SHARED_HEAP_ROWS shared modules
+ * (`jobs` probes at a time), and the blob's boot time to apportion.
+ */
+export async function buildAttributionReport(
+  config: AttributionConfig,
+): Promise<AttributionReport> {
+  const cfg = { __proto__: null, ...config } as AttributionConfig
+  const names = [...new Set(cfg.hooks.map(h => h.name))].toSorted()
+  const memo: PackageMemo = new Map()
+  const reach = new Map<string, Reach>()
+  for (let i = 0, { length } = names; i < length; i += 1) {
+    reach.set(names[i]!, collectReach(entryOf(cfg.hooksDir, names[i]!), memo))
+  }
+  // The dispatcher alone: the generated tables are what import the hooks.
+  const core = collectReach(
+    path.join(cfg.dispatchDir, 'dispatch-snapshot-entry.mts'),
+    memo,
+    file => DISPATCH_TABLE_FILE_RE.test(path.basename(file)),
+  )
+  const frozenReach = new Map<string, Reach>()
+  const splitReach = new Map<string, Reach>()
+  for (const { 0: name, 1: r } of reach) {
+    ;(cfg.splitOut.has(name) ? splitReach : frozenReach).set(name, r)
+  }
+  const bundleRegions = readRegions(cfg.bundle)
+  const frozen = attributeBytes(
+    bundleRegions,
+    cfg.repoRoot,
+    cfg.hooksDir,
+    frozenReach,
+    core,
+  )
+  // The excluded bundle carries its own copy of what its hooks share; only
+  // the per-hook rows are of interest, the blob never holds any of it.
+  const split = attributeBytes(
+    readRegions(cfg.excludedBundle),
+    cfg.repoRoot,
+    cfg.hooksDir,
+    splitReach,
+    core,
+  )
+
+  const base = path.join(cfg.hooksDir, '_shared', 'guard.mts')
+  const resolveFrom = createRequire(base)
+  const heap = new Map<string, number | undefined>()
+  const probes: Array<() => Promise<void>> = []
+  const probe = (key: string, target: string) => {
+    probes.push(async () => {
+      heap.set(
+        key,
+        await probeHeapBytes(cfg.node, base, target, cfg.repoRoot),
+      )
+    })
+  }
+  for (const name of frozenReach.keys()) {
+    probe(`hook:${name}`, entryOf(cfg.hooksDir, name))
+  }
+  const sharedRows = [...frozen.shared.values()]
+    .filter(r => r.kind !== 'runtime')
+    .toSorted((a, b) => b.bytes - a.bytes)
+  const probeRows = Math.min(sharedRows.length, SHARED_HEAP_ROWS)
+  for (let i = 0; i < probeRows; i += 1) {
+    const row = sharedRows[i]!
+    let target: string | undefined
+    if (row.kind === 'package') {
+      try {
+        target = resolveFrom.resolve(row.module)
+      } catch {}
+    } else {
+      target = path.join(cfg.repoRoot, row.module)
+    }
+    if (target) {
+      probe(`module:${row.module}`, target)
+    }
+  }
+  await runPool(probes, cfg.jobs)
+
+  let blobBytes = 0
+  try {
+    blobBytes = statSync(cfg.blob).size
+  } catch {}
+  const bootMs = await measureBlobBootMs(
+    cfg.node,
+    cfg.nodeFlags,
+    cfg.blob,
+    cfg.repoRoot,
+  )
+  const hooks: HookCost[] = []
+  for (const name of names) {
+    const isFrozen = !cfg.splitOut.has(name)
+    const row = (isFrozen ? frozen : split).hooks.get(name)!
+    const heapBytes = isFrozen ? heap.get(`hook:${name}`) : undefined
+    hooks.push({
+      __proto__: null,
+      bytes: row.bytes,
+      deserializeMsEst: deserializeShare(heapBytes, bootMs, blobBytes),
+      frozen: isFrozen,
+      heapBytes,
+      hook: name,
+      ownBytes: row.ownBytes,
+    } as HookCost)
+  }
+  hooks.sort((a, b) => b.bytes - a.bytes || a.hook.localeCompare(b.hook))
+  const shared: SharedCost[] = []
+  for (const row of frozen.shared.values()) {
+    const heapBytes = heap.get(`module:${row.module}`)
+    shared.push({
+      __proto__: null,
+      ...row,
+      deserializeMsEst: deserializeShare(heapBytes, bootMs, blobBytes),
+      heapBytes,
+    } as SharedCost)
+  }
+  shared.sort((a, b) => b.bytes - a.bytes || a.module.localeCompare(b.module))
+  let bundleBytes = 0
+  for (const bytes of bundleRegions.values()) {
+    bundleBytes += bytes
+  }
+  return {
+    __proto__: null,
+    blob: { __proto__: null, bootMs, bytes: blobBytes, path: cfg.blob },
+    bundle: { __proto__: null, bytes: bundleBytes, path: cfg.bundle },
+    hooks,
+    shared,
+    v: ATTRIBUTION_VERSION,
+  } as AttributionReport
+}
+
+function kb(n: number | undefined): string {
+  return (n === undefined ? '-' : (n / 1024).toFixed(1)).padStart(9)
+}
+
+/**
+ * The report's top `top` hooks and shared modules as aligned text lines.
+ */
+export function formatAttribution(
+  report: AttributionReport,
+  top: number,
+): string[] {
+  const rows = [
+    ...report.hooks.slice(0, top).map(h => ({
+      bytes: h.bytes,
+      heapBytes: h.heapBytes,
+      label: h.frozen ? h.hook : `${h.hook} (lazy)`,
+      ms: h.deserializeMsEst,
+    })),
+    ...report.shared.slice(0, top).map(s => ({
+      bytes: s.bytes,
+      heapBytes: s.heapBytes,
+      label: `${s.module} [${s.core ? 'core' : `${s.hooks} hooks`}]`,
+      ms: s.deserializeMsEst,
+    })),
+  ]
+  const width = Math.max(4, ...rows.map(r => r.label.length))
+  const lines = [
+    `  ${'row'.padEnd(width)} ${'src KB'.padStart(9)} ` +
+      `${'heap KB'.padStart(9)} ${'~deser ms'.padStart(9)}`,
+  ]
+  for (let i = 0, { length } = rows; i < length; i += 1) {
+    const r = rows[i]!
+    lines.push(
+      `  ${r.label.padEnd(width)} ${kb(r.bytes)} ${kb(r.heapBytes)} ` +
+        `${(r.ms === undefined ? '-' : r.ms.toFixed(2)).padStart(9)}`,
+    )
+  }
+  return lines
+}
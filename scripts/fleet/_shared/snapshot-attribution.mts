@@ -0,0 +1,305 @@
+/**
+ * @file Bundled-bytes half of the snapshot attribution report
+ *   (`snapshot-attribution-report.mts` measures heap + boot and writes it).
+ *
+ *   Bytes are read off the bundle's own `//#region <module>` markers
+ *   (rolldown's unminified output). A hook is charged its own files plus every
+ *   module and package only it reaches, i.e. what leaving it out would drop.
+ *   A module two or more hooks reach is a shared row, and one the dispatcher
+ *   itself reaches is core. Reachability is the static (and literal dynamic)
+ *   import graph of the sources, packages closed over their package.json
+ *   `dependencies`.
+ */
+
+import { readFileSync } from 'node:fs'
+import { createRequire } from 'node:module'
+import path from 'node:path'
+
+// Catch-all rows for bundle text outside any region and for modules nothing
+// in the import graph reaches (rolldown runtime helpers, stubs).
+const RUNTIME_ROW = '(runtime)'
+
+const REGION_RE = /^\/\/#region (.+)$/
+const ENDREGION_RE = /^\/\/#endregion\b/
+// `… from '<spec>'` (never `import type`), `import('<spec>')` and a bare
+// `import '<spec>'`.
+const IMPORT_SPEC_RE = new RegExp(
+  [
+    String.raw`\b(?:import|export)\s+(?!type\b)[^'";]*?` +
+      String.raw`\bfrom\s*['"]([^'"]+)['"]`,
+    String.raw`\bimport\s*\(\s*['"]([^'"]+)['"]\s*\)`,
+    String.raw`^\s*import\s*['"]([^'"]+)['"]`,
+  ].join('|'),
+  'gm',
+)
+const LOCAL_EXT_RE = /\.(?:c|m)?(?:j|t)s$/
+
+export interface HookCost {
+  readonly bytes: number
+  readonly deserializeMsEst: number | undefined
+  // False for a hook that lives in excluded-bundle.cjs instead of the blob.
+  readonly frozen: boolean
+  readonly heapBytes: number | undefined
+  readonly hook: string
+  readonly ownBytes: number
+}
+
+export interface SharedCost {
+  readonly bytes: number
+  readonly core: boolean
+  readonly deserializeMsEst: number | undefined
+  readonly heapBytes: number | undefined
+  readonly hooks: number
+  readonly kind: 'module' | 'package' | 'runtime'
+  readonly module: string
+}
+
+export interface AttributionReport {
+  readonly blob: {
+    readonly bootMs: number | undefined
+    readonly bytes: number
+    readonly path: string
+  }
+  readonly bundle: { readonly bytes: number; readonly path: string }
+  readonly hooks: readonly HookCost[]
+  readonly shared: readonly SharedCost[]
+  readonly v: number
+}
+
+/**
+ * Bytes per module id from rolldown's `//#region` markers; text outside any
+ * region is charged to RUNTIME_ROW.
+ */
+export function parseBundleRegions(source: string): Map<string, number> {
+  const out = new Map<string, number>()
+  const add = (id: string, n: number) => {
+    out.set(id, (out.get(id) ?? 0) + n)
+  }
+  let current: string | undefined
+  const lines = source.split('\n')
+  for (let i = 0, { length } = lines; i < length; i += 1) {
+    const line = lines[i]!
+    const n = Buffer.byteLength(line) + 1
+    const open = REGION_RE.exec(line)
+    if (open) {
+      current = open[1]!.trim()
+      add(current, n)
+      continue
+    }
+    if (ENDREGION_RE.test(line)) {
+      add(current ?? RUNTIME_ROW, n)
+      current = undefined
+      continue
+    }
+    add(current ?? RUNTIME_ROW, n)
+  }
+  return out
+}
+
+/**
+ * The package a module path sits in (after its last `node_modules/`), or
+ * undefined for a source file.
+ */
+export function packageOf(id: string): string | undefined {
+  const unix = id.split('\\').join('/')
+  const at = unix.lastIndexOf('node_modules/')
+  if (at === -1) {
+    return undefined
+  }
+  const parts = unix.slice(at + 'node_modules/'.length).split('/')
+  return parts[0]!.startsWith('@') ? `${parts[0]}/${parts[1]}` : parts[0]
+}
+
+function bareName(spec: string): string {
+  const parts = spec.split('/')
+  return spec.startsWith('@') ? `${parts[0]}/${parts[1]}` : parts[0]!
+}
+
+function packageDir(name: string, from: string): string | undefined {
+  const req = createRequire(from)
+  try {
+    return path.dirname(req.resolve(`${name}/package.json`))
+  } catch {}
+  // An `exports` map that hides package.json: walk up from the entry.
+  try {
+    let dir = path.dirname(req.resolve(name))
+    for (let i = 0; i < 8; i += 1) {
+      try {
+        const pkg = JSON.parse(
+          readFileSync(path.join(dir, 'package.json'), 'utf8'),
+        ) as { name?: string }
+        if (pkg.name === name) {
+          return dir
+        }
+      } catch {}
+      dir = path.dirname(dir)
+    }
+  } catch {}
+  return undefined
+}
+
+export interface Reach {
+  readonly files: Set<string>
+  readonly packages: Set<string>
+}
+
+// A package's resolved dir and declared dependencies, shared across roots.
+export interface PackageInfo {
+  readonly dependencies: readonly string[]
+  readonly dir: string | undefined
+}
+
+export type PackageMemo = Map<string, PackageInfo>
+
+/**
+ * What one root reaches: local source files and packages, closed over
+ * package dependencies. A file `skip` matches is neither counted nor walked.
+ */
+export function collectReach(
+  root: string,
+  memo: PackageMemo = new Map(),
+  skip?: ((file: string) => boolean) | undefined,
+): Reach {
+  const files = new Set<string>()
+  const packages = new Set<string>()
+  const pending = [root]
+  const addPackage = (name: string, from: string) => {
+    const queue: Array<[string, string]> = [[name, from]]
+    while (queue.length) {
+      const { 0: pkg, 1: fromFile } = queue.pop()!
+      if (packages.has(pkg)) {
+        continue
+      }
+      packages.add(pkg)
+      let entry = memo.get(pkg)
+      if (!entry) {
+        const dir = packageDir(pkg, fromFile)
+        let dependencies: string[] = []
+        if (dir) {
+          try {
+            const json = JSON.parse(
+              readFileSync(path.join(dir, 'package.json'), 'utf8'),
+            ) as { dependencies?: Record<string, string> }
+            dependencies = Object.keys(json.dependencies ?? {})
+          } catch {}
+        }
+        entry = { __proto__: null, dependencies, dir } as PackageInfo
+        memo.set(pkg, entry)
+      }
+      const next = entry.dir ? path.join(entry.dir, 'package.json') : fromFile
+      for (const dep of entry.dependencies) {
+        queue.push([dep, next])
+      }
+    }
+  }
+  while (pending.length) {
+    const file = pending.pop()!
+    if (files.has(file) || skip?.(file)) {
+      continue
+    }
+    files.add(file)
+    let source: string
+    try {
+      source = readFileSync(file, 'utf8')
+    } catch {
+      continue
+    }
+    for (const m of source.matchAll(IMPORT_SPEC_RE)) {
+      const spec = m[1] ?? m[2] ?? m[3]!
+      if (spec.startsWith('node:')) {
+        continue
+      }
+      if (spec.startsWith('.')) {
+        const target = path.resolve(path.dirname(file), spec)
+        if (LOCAL_EXT_RE.test(target)) {
+          pending.push(target)
+        }
+        continue
+      }
+      addPackage(bareName(spec), file)
+    }
+  }
+  return { __proto__: null, files, packages } as Reach
+}
+
+interface ByteRow {
+  bytes: number
+  ownBytes: number
+}
+
+type SharedBytes = Omit<SharedCost, 'deserializeMsEst' | 'heapBytes'>
+
+/**
+ * Charge `regions` (module id → bytes, ids relative to `repoRoot`) to hooks
+ * and shared rows. `reach` maps each hook name to what it reaches; `core` is
+ * what the dispatcher entry reaches on its own.
+ */
+export function attributeBytes(
+  regions: ReadonlyMap<string, number>,
+  repoRoot: string,
+  hooksDir: string,
+  reach: ReadonlyMap<string, Reach>,
+  core: Reach,
+): { hooks: Map<string, ByteRow>; shared: Map<string, SharedBytes> } {
+  const hooks = new Map<string, ByteRow>()
+  for (const name of reach.keys()) {
+    hooks.set(name, { __proto__: null, bytes: 0, ownBytes: 0 } as ByteRow)
+  }
+  const shared = new Map<string, SharedBytes>()
+  const addShared = (
+    key: string,
+    kind: SharedCost['kind'],
+    bytes: number,
+    reachers: number,
+    isCore: boolean,
+  ) => {
+    const prior = shared.get(key)
+    shared.set(key, {
+      __proto__: null,
+      bytes: (prior?.bytes ?? 0) + bytes,
+      core: isCore,
+      hooks: reachers,
+      kind,
+      module: key,
+    } as SharedBytes)
+  }
+  for (const { 0: id, 1: bytes } of regions) {
+    const pkg = packageOf(id)
+    const abs = path.resolve(repoRoot, id)
+    const rel = path.relative(hooksDir, abs).split(path.sep)
+    const ownHook =
+      !pkg && rel.length > 1 && rel[0] !== '..' && !rel[0]!.startsWith('_')
+        ? rel[0]!
+        : undefined
+    if (ownHook && hooks.has(ownHook)) {
+      const row = hooks.get(ownHook)!
+      row.bytes += bytes
+      row.ownBytes += bytes
+      continue
+    }
+    const has = (r: Reach) => (pkg ? r.packages.has(pkg) : r.files.has(abs))
+    const reachers: string[] = []
+    for (const { 0: name, 1: r } of reach) {
+      if (has(r)) {
+        reachers.push(name)
+      }
+    }
+    const isCore = has(core)
+    if (!isCore && reachers.length === 1) {
+      hooks.get(reachers[0]!)!.bytes += bytes
+      continue
+    }
+    if (!isCore && reachers.length === 0) {
+      addShared(RUNTIME_ROW, 'runtime', bytes, 0, false)
+      continue
+    }
+    addShared(
+      pkg ?? path.relative(repoRoot, abs),
+      pkg ? 'package' : 'module',
+      bytes,
+      reachers.length,
+      isCore,
+    )
+  }
+  return { hooks, shared }
+}
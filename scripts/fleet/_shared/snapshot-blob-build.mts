@@ -0,0 +1,427 @@
+/**
+ * @file The snapshot build's blob step (`build-hook-snapshot.mts`): every
+ *   bundle frozen under every runtime, with reuse and a bounded parallel
+ *   pool.
+ *
+ *   Each runtime is a node: the host, or one named by `--node`. Its blob
+ *   paths come from `snapshot-cache-path.cjs` evaluated inside that node.
+ *   When its `<platform>-<arch>` has a tuned flag profile, the blobs build
+ *   under those flags. A node that won't start under the profile builds
+ *   untuned. So does a tuned `--build-snapshot` that fails.
+ *
+ *   A blob is keyed on its bundle's content and stamped with `<blob>.sha256`
+ *   once complete. A blob whose stamp matches its bytes is reused. A new
+ *   blob is written to a temp name and linked in, so the first finished
+ *   build wins and a frozen manifest never sees its blob swapped.
+ */
+
+import crypto from 'node:crypto'
+import {
+  existsSync,
+  linkSync,
+  mkdirSync,
+  readFileSync,
+  renameSync,
+  writeFileSync,
+} from 'node:fs'
+import { createRequire } from 'node:module'
+import os from 'node:os'
+import path from 'node:path'
+import process from 'node:process'
+
+import { safeDeleteSync } from '@socketsecurity/lib-stable/fs/safe'
+import { getDefaultLogger } from '@socketsecurity/lib-stable/logger/default'
+import {
+  spawn,
+  spawnSync,
+} from '@socketsecurity/lib-stable/process/spawn/child'
+import { isSpawnError } from '@socketsecurity/lib-stable/process/spawn/errors'
+
+import { DISPATCH_DIR, REPO_ROOT } from '../paths.mts'
+import { runPool } from './run-pool.mts'
+
+const logger = getDefaultLogger()
+
+// Each `--build-snapshot` holds the whole bundle's heap (several hundred MB
+// at peak), so a wide machine still only runs a few at once.
+const MAX_JOBS = 4
+
+const require = createRequire(import.meta.url)
+const { SNAPSHOT_NODE_FLAGS, blobPath, tunedNodeFlags } = require(
+  path.join(DISPATCH_DIR, 'snapshot-cache-path.cjs'),
+) as {
+  SNAPSHOT_NODE_FLAGS: readonly string[]
+  blobPath: (
+    entryId: string,
+    sourceHash: string,
+    nodeFlags?: readonly string[],
+  ) => string
+  tunedNodeFlags: () => readonly string[]
+}
+
+export type BlobStatus = 'built' | 'failed' | 'reused'
+
+/**
+ * One bundle to freeze: the full one, or an event's split.
+ */
+export interface BlobJob {
+  readonly bundlePath: string
+  readonly entryId: string
+  readonly event: string | undefined
+  readonly sourceHash: string
+}
+
+/**
+ * A node to build blobs under, with where each job's blob goes for it:
+ * `blobs` under `nodeFlags` (its tuned flag profile, when it has one), and
+ * `untunedBlobs`, the fallback when node won't take the profile.
+ */
+export interface Runtime {
+  readonly arch: string
+  readonly blobs: readonly string[]
+  readonly node: string
+  readonly nodeFlags: readonly string[]
+  readonly platform: string
+  readonly untunedBlobs: readonly string[]
+  readonly version: string
+}
+
+/**
+ * The blob one job left under one runtime, and the flags it boots under.
+ */
+export interface BlobOutcome {
+  readonly blob: string
+  readonly nodeFlags: readonly string[]
+  readonly status: BlobStatus
+}
+
+/**
+ * Content-key a built bundle — sha256, first 16 hex — the same derivation the
+ * loader uses, so a bundle change always resolves to a fresh blob path.
+ */
+export function computeSourceHash(content: Buffer | string): string {
+  return crypto.createHash('sha256').update(content).digest('hex').slice(0, 16)
+}
+
+/**
+ * Classify a spawned build step from its exit status + whether the expected
+ * output landed.
+ */
+export function classifySpawnOutcome(config: {
+  exitStatus: number | null
+  outputExists: boolean
+}): { ok: boolean } {
+  const cfg = { __proto__: null, ...config }
+  const { exitStatus, outputExists } = cfg
+  return { ok: exitStatus === 0 && outputExists }
+}
+
+/**
+ * The default `--jobs`: the CPU count, at most MAX_JOBS.
+ */
+export function defaultBlobJobs(): number {
+  return Math.min(os.availableParallelism?.() ?? 2, MAX_JOBS)
+}
+
+export function sha256File(file: string): string {
+  return crypto.createHash('sha256').update(readFileSync(file)).digest('hex')
+}
+
+/**
+ * The digest stamp written beside a blob once it is complete.
+ */
+export function blobSumPath(blob: string): string {
+  return `${blob}.sha256`
+}
+
+/**
+ * Whether `blob` is a finished build: its stamp exists and matches the
+ * blob's bytes. A blob without a stamp (older builder, torn copy) is redone.
+ */
+export function blobIsCurrent(blob: string): boolean {
+  try {
+    const stamp = readFileSync(blobSumPath(blob), 'utf8').trim()
+    return stamp.length === 64 && stamp === sha256File(blob)
+  } catch {
+    return false
+  }
+}
+
+export function bundleJob(
+  entryId: string,
+  bundlePath: string,
+  event?: string,
+): BlobJob {
+  return {
+    __proto__: null,
+    bundlePath,
+    entryId,
+    event,
+    sourceHash: computeSourceHash(readFileSync(bundlePath)),
+  } as BlobJob
+}
+
+// Run inside a target node: that runtime's flag profile and blob paths for
+// each (entryId, hash) pair, tuned and untuned, from the same
+// snapshot-cache-path.cjs the host uses.
+const RUNTIME_PROBE =
+  'const c=require(process.argv[1]);' +
+  'const pairs=JSON.parse(process.argv[2]);' +
+  'const f=c.tunedNodeFlags();' +
+  'process.stdout.write(JSON.stringify({arch:process.arch,' +
+  'platform:process.platform,version:process.version,nodeFlags:f,' +
+  'blobs:pairs.map(p=>c.blobPath(p[0],p[1],f)),' +
+  'untunedBlobs:pairs.map(p=>c.blobPath(p[0],p[1]))}))'
+
+function hostRuntime(jobs: readonly BlobJob[]): Runtime {
+  const nodeFlags = tunedNodeFlags()
+  return {
+    __proto__: null,
+    arch: process.arch,
+    blobs: jobs.map(j => blobPath(j.entryId, j.sourceHash, nodeFlags)),
+    node: process.execPath,
+    nodeFlags,
+    platform: process.platform,
+    untunedBlobs: jobs.map(j => blobPath(j.entryId, j.sourceHash)),
+    version: process.version,
+  } as Runtime
+}
+
+/**
+ * `runtime`, or its untuned self when node won't even start under its flag
+ * profile: a flag this node doesn't know (renamed or dropped by a V8 bump)
+ * must cost the tuning, never the fast path.
+ */
+function acceptFlagProfile(runtime: Runtime): Runtime {
+  if (runtime.nodeFlags.length <= SNAPSHOT_NODE_FLAGS.length) {
+    return runtime
+  }
+  const probe = spawnSync(runtime.node, [...runtime.nodeFlags, '-e', '0'], {
+    cwd: REPO_ROOT,
+    encoding: 'utf8',
+  })
+  if (probe.status === 0) {
+    return runtime
+  }
+  logger.warn(
+    `${runtime.version} ${runtime.arch} rejected the flag profile ` +
+      `(${runtime.nodeFlags.join(' ')}): ` +
+      `${String(probe.stderr ?? '').trim().split('\n')[0] || 'no output'}; ` +
+      'building untuned blobs.',
+  )
+  return {
+    __proto__: null,
+    ...runtime,
+    blobs: runtime.untunedBlobs,
+    nodeFlags: SNAPSHOT_NODE_FLAGS,
+  } as Runtime
+}
+
+function probeRuntime(
+  node: string,
+  jobs: readonly BlobJob[],
+): Runtime | undefined {
+  const probe = spawnSync(
+    node,
+    [
+      '-e',
+      RUNTIME_PROBE,
+      path.join(DISPATCH_DIR, 'snapshot-cache-path.cjs'),
+      JSON.stringify(jobs.map(j => [j.entryId, j.sourceHash])),
+    ],
+    { cwd: REPO_ROOT, encoding: 'utf8' },
+  )
+  try {
+    const found = JSON.parse(String(probe.stdout ?? '')) as Omit<
+      Runtime,
+      'node'
+    >
+    if (
+      probe.status === 0 &&
+      Array.isArray(found.nodeFlags) &&
+      Array.isArray(found.blobs) &&
+      found.blobs.length === jobs.length &&
+      Array.isArray(found.untunedBlobs) &&
+      found.untunedBlobs.length === jobs.length
+    ) {
+      return { __proto__: null, ...found, node } as Runtime
+    }
+  } catch {}
+  logger.error(`${node}: not a usable node runtime; skipping it.`)
+  return undefined
+}
+
+/**
+ * The runtimes to build `jobs` under: the host first, then each `--node`
+ * that probes as a usable runtime and keys a dir the host doesn't.
+ */
+export function resolveRuntimes(
+  jobs: readonly BlobJob[],
+  nodes: readonly string[],
+): Runtime[] {
+  const runtimes: Runtime[] = [acceptFlagProfile(hostRuntime(jobs))]
+  for (const node of new Set(nodes)) {
+    const probed = probeRuntime(node, jobs)
+    const runtime = probed && acceptFlagProfile(probed)
+    if (runtime && !runtimes.some(r => r.blobs[0] === runtime.blobs[0])) {
+      runtimes.push(runtime)
+    }
+  }
+  return runtimes
+}
+
+/**
+ * `node --build-snapshot` one bundle into its content-keyed blob under
+ * `runtime` and `nodeFlags`, unless a current blob is already there. The
+ * blob is written beside its final name and published (`publishBlob`), then
+ * stamped, so a killed build never leaves a blob that looks finished.
+ */
+async function buildBlob(
+  runtime: Runtime,
+  nodeFlags: readonly string[],
+  job: BlobJob,
+  blobOut: string,
+  force: boolean,
+): Promise<BlobStatus> {
+  if (!force && blobIsCurrent(blobOut)) {
+    return 'reused'
+  }
+  const tmp = `${blobOut}.${process.pid}.tmp`
+  mkdirSync(path.dirname(blobOut), { recursive: true })
+  let exitStatus: number | null = 0
+  try {
+    await spawn(
+      runtime.node,
+      [
+        ...nodeFlags,
+        '--snapshot-blob',
+        tmp,
+        '--build-snapshot',
+        job.bundlePath,
+      ],
+      { cwd: REPO_ROOT, stdio: 'inherit' },
+    )
+  } catch (e) {
+    exitStatus = isSpawnError(e) && typeof e.code === 'number' ? e.code : null
+  }
+  if (
+    !classifySpawnOutcome({ exitStatus, outputExists: existsSync(tmp) }).ok
+  ) {
+    logger.error(
+      `--build-snapshot ${path.basename(job.bundlePath)} under ` +
+        `${runtime.version} failed (exit ${String(exitStatus)}).`,
+    )
+    safeDeleteSync(tmp, { force: true })
+    return 'failed'
+  }
+  return publishBlob(tmp, blobOut, force)
+}
+
+/**
+ * Move a finished `tmp` into place as `blobOut`, then stamp it. Unless
+ * `force`, the first finished blob wins: a hard link fails with EEXIST when a
+ * concurrent build (another checkout on the shared store) got there first,
+ * and a current blob at the name is kept. Replacing it would change the
+ * size / mtime / inode every manifest naming it has frozen and turn their
+ * hits into misses. A torn or unstamped blob is replaced, as is everything
+ * on a filesystem without hard links.
+ */
+function publishBlob(
+  tmp: string,
+  blobOut: string,
+  force: boolean,
+): BlobStatus {
+  let linked = false
+  if (!force) {
+    try {
+      linkSync(tmp, blobOut)
+      linked = true
+    } catch (e) {
+      const code = (e as { code?: string | undefined })?.code
+      if (code === 'EEXIST' && blobIsCurrent(blobOut)) {
+        safeDeleteSync(tmp, { force: true })
+        return 'reused'
+      }
+    }
+  }
+  if (linked) {
+    safeDeleteSync(tmp, { force: true })
+  } else {
+    renameSync(tmp, blobOut)
+  }
+  writeFileSync(blobSumPath(blobOut), `${sha256File(blobOut)}\n`)
+  return 'built'
+}
+
+/**
+ * Job `j`'s blob under `runtime`: tuned when the runtime has a profile,
+ * retried untuned when the tuned `--build-snapshot` fails, since a flag can
+ * start node yet still break the snapshot build.
+ */
+async function buildRuntimeBlob(
+  runtime: Runtime,
+  jobs: readonly BlobJob[],
+  j: number,
+  force: boolean,
+): Promise<BlobOutcome> {
+  const job = jobs[j]!
+  const tuned = runtime.blobs[j]!
+  const status = await buildBlob(
+    runtime,
+    runtime.nodeFlags,
+    job,
+    tuned,
+    force,
+  )
+  const untuned = runtime.untunedBlobs[j]!
+  if (status !== 'failed' || tuned === untuned) {
+    return {
+      __proto__: null,
+      blob: tuned,
+      nodeFlags: runtime.nodeFlags,
+      status,
+    } as BlobOutcome
+  }
+  logger.warn(
+    `${path.basename(job.bundlePath)}: tuned blob failed under ` +
+      `${runtime.version}; building it untuned.`,
+  )
+  return {
+    __proto__: null,
+    blob: untuned,
+    nodeFlags: SNAPSHOT_NODE_FLAGS,
+    status: await buildBlob(
+      runtime,
+      SNAPSHOT_NODE_FLAGS,
+      job,
+      untuned,
+      force,
+    ),
+  } as BlobOutcome
+}
+
+/**
+ * Every job under every runtime, `concurrency` builds at a time. The result
+ * is indexed [runtime][job], in the order given.
+ */
+export async function buildRuntimeBlobs(
+  runtimes: readonly Runtime[],
+  jobs: readonly BlobJob[],
+  config: { concurrency: number; force: boolean },
+): Promise<BlobOutcome[][]> {
+  const { concurrency, force } = { __proto__: null, ...config } as {
+    concurrency: number
+    force: boolean
+  }
+  const outcomes = runtimes.map(() => new Array<BlobOutcome>(jobs.length))
+  const tasks: Array<() => Promise<void>> = []
+  for (let r = 0, { length } = runtimes; r < length; r += 1) {
+    for (let j = 0, { length: n } = jobs; j < n; j += 1) {
+      tasks.push(async () => {
+        outcomes[r]![j] = await buildRuntimeBlob(runtimes[r]!, jobs, j, force)
+      })
+    }
+  }
+  await runPool(tasks, concurrency)
+  return outcomes
+}
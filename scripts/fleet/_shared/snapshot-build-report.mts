@@ -0,0 +1,74 @@
+/**
+ * @file The snapshot build's `--report` step: measure the host's full blob
+ *   (`snapshot-attribution-report.mts`), write `attribution.json` beside the
+ *   build manifest and log the top rows.
+ */
+
+import { writeFileSync } from 'node:fs'
+import path from 'node:path'
+
+import { getDefaultLogger } from '@socketsecurity/lib-stable/logger/default'
+
+import {
+  DISPATCH_DIR,
+  FLEET_HOOKS_DIR,
+  isSplitOut,
+} from '../gen/hook-dispatch.mts'
+import type { TableOptions } from '../gen/hook-dispatch.mts'
+import { EXCLUDED_BUNDLE_PATH, REPO_ROOT } from '../paths.mts'
+import { collectEligibleHooks } from './dispatch-scan.mts'
+import {
+  ATTRIBUTION_NAME,
+  buildAttributionReport,
+  formatAttribution,
+} from './snapshot-attribution-report.mts'
+
+const logger = getDefaultLogger()
+
+// Rows per section in the logged attribution summary.
+const REPORT_TOP = 10
+
+export interface SnapshotReportConfig {
+  readonly blob: string
+  readonly bundle: string
+  // Where attribution.json goes: the build manifest's default dir.
+  readonly cacheRoot: string
+  readonly jobs: number
+  readonly node: string
+  readonly nodeFlags: readonly string[]
+  readonly tableOptions: TableOptions
+}
+
+/**
+ * Attribute `blob` to the hooks and shared modules it froze, write the
+ * report, and log its top rows. Returns the report's path.
+ */
+export async function reportSnapshotAttribution(
+  config: SnapshotReportConfig,
+): Promise<string> {
+  const cfg = { __proto__: null, ...config } as SnapshotReportConfig
+  const hooks = collectEligibleHooks(FLEET_HOOKS_DIR)
+  const report = await buildAttributionReport({
+    __proto__: null,
+    blob: cfg.blob,
+    bundle: cfg.bundle,
+    dispatchDir: DISPATCH_DIR,
+    excludedBundle: EXCLUDED_BUNDLE_PATH,
+    hooks,
+    hooksDir: FLEET_HOOKS_DIR,
+    jobs: cfg.jobs,
+    node: cfg.node,
+    nodeFlags: cfg.nodeFlags,
+    repoRoot: REPO_ROOT,
+    splitOut: new Set(
+      hooks.filter(h => isSplitOut(h, cfg.tableOptions)).map(h => h.name),
+    ),
+  })
+  const reportOut = path.join(cfg.cacheRoot, ATTRIBUTION_NAME)
+  writeFileSync(reportOut, `${JSON.stringify(report, undefined, 2)}\n`)
+  logger.log(`Attribution (top ${REPORT_TOP}), ${reportOut}:`)
+  for (const line of formatAttribution(report, REPORT_TOP)) {
+    logger.log(line)
+  }
+  return reportOut
+}
@@ -0,0 +1,178 @@
+/**
+ * @file The snapshot build's per-event split (`build-hook-snapshot.mts
+ *   --split-events`) and the sticky plans for it and `--lazy-cold`.
+ *
+ *   Each hook event gets `snapshot-bundle.<Event>.cjs`, rolled from a
+ *   narrowed snapshot table written over the same aliased
+ *   `dispatch-table-snapshot.mts`, so the snapshot rolldown config is
+ *   untouched. The full table is always written back afterwards. An event
+ *   whose split fails to roll, or whose blob fails to build, loses its
+ *   bundle: the sidecar step then writes no event manifest, and the event
+ *   boots the full blob.
+ */
+
+import { existsSync, renameSync, writeFileSync } from 'node:fs'
+import { createRequire } from 'node:module'
+import path from 'node:path'
+
+import { safeDeleteSync } from '@socketsecurity/lib-stable/fs/safe'
+import { getDefaultLogger } from '@socketsecurity/lib-stable/logger/default'
+import { spawnSync } from '@socketsecurity/lib-stable/process/spawn/child'
+
+import {
+  DISPATCH_DIR,
+  FLEET_HOOKS_DIR,
+  generateDispatchTableSource,
+} from '../gen/hook-dispatch.mts'
+import type { TableOptions } from '../gen/hook-dispatch.mts'
+import { DISPATCH_TABLE_SNAPSHOT_PATH, REPO_ROOT } from '../paths.mts'
+import { collectEligibleHooks } from './dispatch-scan.mts'
+import { bundleJob, classifySpawnOutcome } from './snapshot-blob-build.mts'
+import type { BlobJob } from './snapshot-blob-build.mts'
+
+const logger = getDefaultLogger()
+
+export const ROLLDOWN_BIN = path.join(
+  REPO_ROOT,
+  'node_modules',
+  '.bin',
+  'rolldown',
+)
+export const SNAPSHOT_CONFIG = path.join(
+  REPO_ROOT,
+  '.config',
+  'repo',
+  'rolldown',
+  'hook-bundle-snapshot.config.mts',
+)
+export const SNAPSHOT_BUNDLE = path.join(DISPATCH_DIR, 'snapshot-bundle.cjs')
+
+const require = createRequire(import.meta.url)
+const { eventEntryId, isSplitEvent, splitBundleEvents, splitBundleName } =
+  require(path.join(DISPATCH_DIR, 'snapshot-cache-path.cjs')) as {
+    eventEntryId: (event: string) => string
+    isSplitEvent: (event: unknown) => boolean
+    splitBundleEvents: (dispatchDir: string) => string[]
+    splitBundleName: (event: string) => string
+  }
+
+/**
+ * Whether this build emits the per-event split blobs: the explicit flag wins,
+ * otherwise keep doing what the last build did.
+ */
+export function planSplit(
+  argv: readonly string[],
+  config: { hasSplitBundles: boolean },
+): boolean {
+  const cfg = { __proto__: null, ...config } as { hasSplitBundles: boolean }
+  if (argv.includes('--no-split-events')) {
+    return false
+  }
+  return argv.includes('--split-events') || cfg.hasSplitBundles
+}
+
+/**
+ * Whether `@dispatch-lazy` hooks leave the frozen heap: the explicit flag
+ * wins, otherwise keep what the snapshot table on disk was generated with.
+ */
+export function planLazy(
+  argv: readonly string[],
+  config: { hasLazyTable: boolean },
+): boolean {
+  const cfg = { __proto__: null, ...config } as { hasLazyTable: boolean }
+  if (argv.includes('--no-lazy-cold')) {
+    return false
+  }
+  return argv.includes('--lazy-cold') || cfg.hasLazyTable
+}
+
+/**
+ * Whether the tree has split bundles from an earlier build.
+ */
+export function hasSplitBundles(): boolean {
+  return splitBundleEvents(DISPATCH_DIR).length > 0
+}
+
+/**
+ * Roll `snapshot-bundle.<Event>.cjs` for every hook event, one narrowed
+ * table at a time through the snapshot config. Always leaves the full
+ * snapshot table back in place. Returns a blob job per bundle built.
+ */
+export function bundleSplitEvents(options: TableOptions): BlobJob[] {
+  const events = [
+    ...new Set(collectEligibleHooks(FLEET_HOOKS_DIR).map(h => h.event)),
+  ]
+    .filter(event => isSplitEvent(event))
+    .toSorted()
+  const jobs: BlobJob[] = []
+  try {
+    for (let i = 0, { length } = events; i < length; i += 1) {
+      const event = events[i]!
+      const out = path.join(DISPATCH_DIR, splitBundleName(event))
+      writeFileSync(
+        DISPATCH_TABLE_SNAPSHOT_PATH,
+        generateDispatchTableSource(
+          FLEET_HOOKS_DIR,
+          'snapshot',
+          event,
+          options,
+        ),
+      )
+      const bundle = spawnSync(ROLLDOWN_BIN, ['-c', SNAPSHOT_CONFIG], {
+        cwd: REPO_ROOT,
+        stdio: 'inherit',
+      })
+      if (
+        classifySpawnOutcome({
+          exitStatus: bundle.status,
+          outputExists: existsSync(SNAPSHOT_BUNDLE),
+        }).ok
+      ) {
+        renameSync(SNAPSHOT_BUNDLE, out)
+        jobs.push(bundleJob(eventEntryId(event), out, event))
+        continue
+      }
+      dropSplit(event)
+    }
+  } finally {
+    writeFileSync(
+      DISPATCH_TABLE_SNAPSHOT_PATH,
+      generateDispatchTableSource(
+        FLEET_HOOKS_DIR,
+        'snapshot',
+        undefined,
+        options,
+      ),
+    )
+  }
+  // An event whose hooks are all gone keeps no bundle.
+  const current = new Set(events)
+  for (const event of splitBundleEvents(DISPATCH_DIR)) {
+    if (!current.has(event)) {
+      safeDeleteSync(path.join(DISPATCH_DIR, splitBundleName(event)), {
+        force: true,
+      })
+    }
+  }
+  return jobs
+}
+
+// No blob, no bundle: the sidecar step then writes no event manifest and
+// this event boots the full blob.
+export function dropSplit(event: string): void {
+  logger.warn(`${event} split blob not built; it boots the full blob.`)
+  safeDeleteSync(path.join(DISPATCH_DIR, splitBundleName(event)), {
+    force: true,
+  })
+}
+
+/**
+ * Delete every split bundle (`--no-split-events`).
+ */
+export function dropSplits(): void {
+  for (const event of splitBundleEvents(DISPATCH_DIR)) {
+    safeDeleteSync(path.join(DISPATCH_DIR, splitBundleName(event)), {
+      force: true,
+    })
+  }
+}
@@ -0,0 +1,400 @@
+/*
+ * @file The snapshot BLOB STORE under
+ *   `node_modules/.cache/fleet/node-snapshot-cache/`: one dir per runtime tag
+ *   (`snapshot-cache-path.cjs`), one content-keyed blob per built bundle. Every
+ *   guard edit or node upgrade adds another 11-21 MB blob and nothing used to
+ *   remove the old ones, so a long-lived dev VM or baked CI image grew the
+ *   store without bound. This module is its bookkeeping: the access log the
+ *   native launcher appends to, an LRU sweep under a byte budget, and the
+ *   numbers `scripts/fleet/snapshot-store.mts` reports.
+ *
+ *   ACCESS LOG (`access.log` in the store root, rotated to `access.log.1` at
+ *   ACCESS_LOG_MAX by the launcher). The launcher appends one fixed
+ *   ACCESS_RECORD_SIZE record per launch that had a manifest; the C writers in
+ *   `dispatch-launcher-store.c` / `dispatch-launcher-win-store.c` mirror this
+ *   layout:
+ *
+ *     off  size  field
+ *       0     8  i64 wall clock, ns since the epoch (little-endian)
+ *       8     1  kind (AccessKind below)
+ *       9     7  reserved (0)
+ *      16   112  blob path relative to the store root (`<tag>/<file>`),
+ *                UTF-8, NUL-padded
+ *
+ *   A record that doesn't decode (a torn append, a foreign file) is skipped.
+ *
+ *   EVICTION. A blob's last use is its newest access record, or its mtime
+ *   (the build) when it has none. `gcSnapshotStore` deletes least recently
+ *   used blobs until the store fits the budget, and never deletes a blob a
+ *   launch manifest names or one used within GC_MIN_AGE_MS — a second
+ *   checkout sharing this node_modules may be booting it. Run by the sidecar
+ *   freeze (`build-snapshot-launcher.mts`), i.e. after every build and heal.
+ *
+ *   CHECKOUTS. In the opt-in per-user shared store (`snapshot-cache-path.cjs`)
+ *   the blobs other repos' manifests name are just as live as this repo's.
+ *   So every sidecar freeze registers its `_dispatch/` dir under
+ *   `checkouts/` in the store root (one file per dir, named by its hash), and
+ *   `storeKeepSet` spares what every registered checkout's manifests name,
+ *   read fresh from those manifests at sweep time. A registered dir that no
+ *   longer exists (a deleted clone) is dropped from the registry.
+ */
+
+import { safeDeleteSync } from '@socketsecurity/lib-stable/fs/safe'
+import crypto from 'node:crypto'
+import {
+  existsSync,
+  mkdirSync,
+  readFileSync,
+  readdirSync,
+  rmdirSync,
+  statSync,
+  writeFileSync,
+} from 'node:fs'
+import path from 'node:path'
+import process from 'node:process'
+
+import {
+  LAUNCH_MANIFEST_NAME,
+  decodeLaunchManifest,
+} from './launch-manifest.mts'
+
+export const ACCESS_LOG_NAME = 'access.log'
+export const ACCESS_LOG_ROTATED_NAME = 'access.log.1'
+export const ACCESS_RECORD_SIZE = 128
+// Rotation point (16384 records); the launcher checks it on every append.
+export const ACCESS_LOG_MAX = 2 * 1024 * 1024
+
+// FLEET_SNAPSHOT_STORE_MB overrides it; 0 keeps only what is protected.
+export const STORE_BUDGET_ENV = 'FLEET_SNAPSHOT_STORE_MB'
+export const DEFAULT_STORE_BUDGET_MB = 256
+export const GC_MIN_AGE_MS = 60 * 60 * 1000
+
+export const CHECKOUTS_DIR_NAME = 'checkouts'
+
+const NAME_OFF = 16
+const NAME_LEN = 112
+
+/**
+ * What one launch did with its blob:
+ *
+ * - `H` booted the full blob
+ * - `S` booted the event's split blob
+ * - `P` tool pre-flight answered without booting (the blob was valid)
+ * - `D` a warm daemon served it
+ * - `M` miss: the manifest's blob was gone or changed, fell open to index.cjs
+ */
+export type AccessKind = 'D' | 'H' | 'M' | 'P' | 'S'
+
+const ACCESS_KINDS = new Set<string>(['D', 'H', 'M', 'P', 'S'])
+
+export interface AccessRecord {
+  readonly atMs: number
+  readonly blob: string
+  readonly kind: AccessKind
+}
+
+export interface StoredBlob {
+  readonly file: string
+  readonly hits: number
+  readonly lastUsedMs: number
+  // `<tag>/<file>`, the access log's key.
+  readonly rel: string
+  readonly size: number
+}
+
+export interface StoreGcResult {
+  readonly evicted: readonly StoredBlob[]
+  readonly freedBytes: number
+  readonly keptBytes: number
+}
+
+/**
+ * Decode an access log; torn or foreign records are skipped.
+ */
+export function decodeAccessLog(buf: Buffer): AccessRecord[] {
+  const records: AccessRecord[] = []
+  for (
+    let off = 0;
+    off + ACCESS_RECORD_SIZE <= buf.length;
+    off += ACCESS_RECORD_SIZE
+  ) {
+    const kind = String.fromCharCode(buf[off + 8]!)
+    const name = buf.subarray(off + NAME_OFF, off + NAME_OFF + NAME_LEN)
+    const end = name.indexOf(0)
+    if (!ACCESS_KINDS.has(kind) || end <= 0) {
+      continue
+    }
+    records.push({
+      __proto__: null,
+      atMs: Number(buf.readBigInt64LE(off) / 1_000_000n),
+      // The Windows launcher writes its own separator.
+      blob: name.toString('utf8', 0, end).replaceAll('\\', '/'),
+      kind: kind as AccessKind,
+    } as AccessRecord)
+  }
+  return records
+}
+
+/**
+ * Every access record under `root`, oldest first (the rotated log, then the
+ * live one).
+ */
+export function readAccessLog(root: string): AccessRecord[] {
+  const records: AccessRecord[] = []
+  for (const name of [ACCESS_LOG_ROTATED_NAME, ACCESS_LOG_NAME]) {
+    let buf: Buffer
+    try {
+      buf = readFileSync(path.join(root, name))
+    } catch {
+      continue
+    }
+    records.push(...decodeAccessLog(buf))
+  }
+  return records
+}
+
+/**
+ * The blob budget in bytes, from FLEET_SNAPSHOT_STORE_MB (default 256 MB).
+ */
+export function storeBudgetBytes(
+  env: NodeJS.ProcessEnv = process.env,
+): number {
+  const raw = env[STORE_BUDGET_ENV]
+  const mb = raw === undefined || raw === '' ? NaN : Number(raw)
+  return (mb >= 0 ? mb : DEFAULT_STORE_BUDGET_MB) * 1024 * 1024
+}
+
+/**
+ * Every blob in the store, with its last use and hit count folded in from
+ * `records`.
+ */
+export function scanSnapshotStore(
+  root: string,
+  records: readonly AccessRecord[],
+): StoredBlob[] {
+  const lastUse = new Map<string, number>()
+  const hits = new Map<string, number>()
+  for (let i = 0, { length } = records; i < length; i += 1) {
+    const r = records[i]!
+    lastUse.set(r.blob, Math.max(lastUse.get(r.blob) ?? 0, r.atMs))
+    if (r.kind === 'H' || r.kind === 'S') {
+      hits.set(r.blob, (hits.get(r.blob) ?? 0) + 1)
+    }
+  }
+  const blobs: StoredBlob[] = []
+  let tags: string[]
+  try {
+    tags = readdirSync(root)
+  } catch {
+    return blobs
+  }
+  for (const tag of tags.toSorted()) {
+    let names: string[]
+    try {
+      names = readdirSync(path.join(root, tag))
+    } catch {
+      // heal.lock, the access logs: not runtime dirs.
+      continue
+    }
+    for (const name of names.toSorted()) {
+      if (!name.endsWith('.blob')) {
+        continue
+      }
+      const file = path.join(root, tag, name)
+      let st
+      try {
+        st = statSync(file)
+      } catch {
+        continue
+      }
+      const rel = `${tag}/${name}`
+      blobs.push({
+        __proto__: null,
+        file,
+        hits: hits.get(rel) ?? 0,
+        lastUsedMs: Math.max(lastUse.get(rel) ?? 0, st.mtimeMs),
+        rel,
+        size: st.size,
+      } as StoredBlob)
+    }
+  }
+  return blobs
+}
+
+/**
+ * The blobs to evict, least recently used first, so the rest fits
+ * `budgetBytes`. Protected blobs (`keep`, or used within `minAgeMs` of
+ * `nowMs`) count against the budget but are never chosen. PURE.
+ */
+export function planEviction(
+  blobs: readonly StoredBlob[],
+  config: {
+    budgetBytes: number
+    keep: ReadonlySet<string>
+    minAgeMs: number
+    nowMs: number
+  },
+): StoredBlob[] {
+  const cfg = { __proto__: null, ...config } as typeof config
+  let total = 0
+  for (let i = 0, { length } = blobs; i < length; i += 1) {
+    total += blobs[i]!.size
+  }
+  const candidates = blobs
+    .filter(
+      b =>
+        !cfg.keep.has(path.resolve(b.file)) &&
+        cfg.nowMs - b.lastUsedMs >= cfg.minAgeMs,
+    )
+    .toSorted((a, b) => a.lastUsedMs - b.lastUsedMs || a.size - b.size)
+  const evict: StoredBlob[] = []
+  for (let i = 0, { length } = candidates; i < length; i += 1) {
+    if (total <= cfg.budgetBytes) {
+      break
+    }
+    const blob = candidates[i]!
+    evict.push(blob)
+    total -= blob.size
+  }
+  return evict
+}
+
+/**
+ * The blob paths the launch manifests in `dispatchDir` (`launch.manifest`
+ * and every `launch.<Event>.manifest`) name, resolved.
+ */
+export function manifestBlobs(dispatchDir: string): Set<string> {
+  const keep = new Set<string>()
+  let names: string[]
+  try {
+    names = readdirSync(dispatchDir)
+  } catch {
+    return keep
+  }
+  for (const name of names) {
+    if (name !== LAUNCH_MANIFEST_NAME && !/^launch\..+\.manifest$/.test(name)) {
+      continue
+    }
+    let m
+    try {
+      m = decodeLaunchManifest(readFileSync(path.join(dispatchDir, name)))
+    } catch {
+      continue
+    }
+    if (m?.blobPath) {
+      keep.add(path.resolve(m.blobPath))
+    }
+  }
+  return keep
+}
+
+function checkoutId(dispatchDir: string): string {
+  return crypto
+    .createHash('sha256')
+    .update(path.resolve(dispatchDir))
+    .digest('hex')
+    .slice(0, 16)
+}
+
+/**
+ * Record `dispatchDir` as a checkout whose manifests name blobs in the store
+ * at `root`. Fail-open: false when the registry couldn't be written.
+ */
+export function registerCheckout(root: string, dispatchDir: string): boolean {
+  const dir = path.join(root, CHECKOUTS_DIR_NAME)
+  try {
+    mkdirSync(dir, { recursive: true })
+    writeFileSync(
+      path.join(dir, checkoutId(dispatchDir)),
+      `${path.resolve(dispatchDir)}\n`,
+    )
+    return true
+  } catch {
+    return false
+  }
+}
+
+/**
+ * The blobs a sweep of the store at `root` must spare: what the manifests in
+ * `dispatchDir` and in every registered checkout name, resolved. Checkouts
+ * whose dir is gone are unregistered on the way.
+ */
+export function storeKeepSet(root: string, dispatchDir: string): Set<string> {
+  const keep = manifestBlobs(dispatchDir)
+  const dir = path.join(root, CHECKOUTS_DIR_NAME)
+  let names: string[]
+  try {
+    names = readdirSync(dir)
+  } catch {
+    return keep
+  }
+  for (let i = 0, { length } = names; i < length; i += 1) {
+    const file = path.join(dir, names[i]!)
+    let checkout: string
+    try {
+      checkout = readFileSync(file, 'utf8').trim()
+    } catch {
+      continue
+    }
+    if (!checkout || !existsSync(checkout)) {
+      try {
+        safeDeleteSync(file, { force: true })
+      } catch {}
+      continue
+    }
+    for (const blob of manifestBlobs(checkout)) {
+      keep.add(blob)
+    }
+  }
+  return keep
+}
+
+/**
+ * Evict least recently used blobs from the store at `root` until it fits
+ * `budgetBytes`, never touching `keep`; runtime dirs left empty go too.
+ * Fail-open: a blob that won't delete is just counted as kept.
+ */
+export function gcSnapshotStore(
+  root: string,
+  keep: ReadonlySet<string>,
+  budgetBytes: number = storeBudgetBytes(),
+  nowMs: number = Date.now(),
+): StoreGcResult {
+  const blobs = scanSnapshotStore(root, readAccessLog(root))
+  const plan = planEviction(blobs, {
+    __proto__: null,
+    budgetBytes,
+    keep,
+    minAgeMs: GC_MIN_AGE_MS,
+    nowMs,
+  } as Parameters<typeof planEviction>[1])
+  const evicted: StoredBlob[] = []
+  let freedBytes = 0
+  for (let i = 0, { length } = plan; i < length; i += 1) {
+    const blob = plan[i]!
+    try {
+      safeDeleteSync(blob.file, { force: true })
+    } catch {
+      continue
+    }
+    evicted.push(blob)
+    freedBytes += blob.size
+  }
+  const dirs = new Set(evicted.map(b => path.dirname(b.file)))
+  for (const dir of dirs) {
+    try {
+      // Only succeeds once the dir is empty.
+      rmdirSync(dir)
+    } catch {}
+  }
+  let total = 0
+  for (let i = 0, { length } = blobs; i < length; i += 1) {
+    total += blobs[i]!.size
+  }
+  return {
+    __proto__: null,
+    evicted,
+    freedBytes,
+    keptBytes: total - freedBytes,
+  } as StoreGcResult
+}
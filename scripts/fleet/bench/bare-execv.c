@@ -0,0 +1,14 @@
+/*
+ * Reference point for the dispatch launcher's intrinsic overhead
+ * (scripts/fleet/bench/dispatch.mts): an `execv` of argv[1] and nothing
+ * else. The bench times `dispatch-launcher -> true` against
+ * `bare-execv -> true`; the difference is what self-locate, the manifest
+ * read, the blob stat and the access-log append cost.
+ */
+#include <unistd.h>
+
+int main(int argc, char **argv) {
+  if (argc < 2) return 2;
+  execv(argv[1], argv + 1);
+  return 127;
+}
@@ -0,0 +1,217 @@
+#!/usr/bin/env node
+/*
+ * @file Benchmark the hook dispatch paths end to end, per event and
+ *   fixture, and gate on the numbers `_dispatch/snapshot-notes.md` claims.
+ *
+ *   Variants, each spawned with the fixture payload on stdin:
+ *
+ *   - `native-launcher` — `_dispatch/dispatch-launcher <Event>`, the wired
+ *     fast path (the launcher's own pre-flight / daemon / blob choice is
+ *     part of what's timed)
+ *   - `snapshot-direct` — `node <flags> --snapshot-blob <blob> <Event>` from
+ *     the frozen `launch.manifest`, the ceiling the launcher chases
+ *   - `compile-cache` — `node index.cjs <Event>`, the fail-open path
+ *   - `cold-dispatch` — `node _dispatch/dispatch.mts <Event>`, no bundle,
+ *     no cache
+ *
+ *   plus two fixture-independent POSIX probes for the launcher's INTRINSIC
+ *   cost: a copy of the launcher whose manifest points node at `true`, and
+ *   `bare-execv.c` exec'ing the same `true`. The difference of their medians
+ *   is self-locate + manifest read + blob stat + access-log append.
+ *
+ *   Every fixture (`fixtures.mts`) runs `--warmup` untimed rounds, then
+ *   `--runs` timed rounds; within a round the variants go in turn, so drift
+ *   (thermal, a background build) lands on all of them alike. A variant
+ *   whose artifact isn't built is skipped, and so is every gate that needs
+ *   it. Hooks run against a scratch dir, never this checkout, with the
+ *   latency profile off.
+ *
+ *   GATES (exit 1 when any fails):
+ *
+ *   - `launcher-overhead` — launcher minus bare execv, ≤
+ *     `maxLauncherOverheadMs` (2 ms)
+ *   - `snapshot-win/<fixture>` — snapshot-direct AND the native launcher
+ *     both beat compile-cache
+ *   - `equivalence/<fixture>` — every variant's first run printed the same
+ *     stdout with the same exit status
+ *   - `baseline/<variant>/<fixture>` — median within `tolerance` (+
+ *     `slackMs`) of the stored baseline for this platform, when one exists
+ *     and was recorded under the same node major
+ *
+ *   All gates compare medians: one preempted run shouldn't fail a gate.
+ *   Baselines live in `bench/baselines/<platform>-<arch>.json`; record one on
+ *   a quiet machine with `--save-baseline` and commit it. A re-save keeps the
+ *   file's thresholds.
+ *
+ *   This file is the CLI and the run loop. The variants, probes, timed
+ *   rounds and scratch dir live in `harness.mts`, the gates and baselines
+ *   in `gates.mts`, and the printed report in `report.mts`.
+ *
+ *   Usage:
+ *     node scripts/fleet/bench/dispatch.mts [--event <Event>]
+ *       [--fixture <name>] [--runs <n>] [--warmup <n>] [--json]
+ *       [--save-baseline]
+ */
+
+import { getDefaultLogger } from '@socketsecurity/lib-stable/logger/default'
+import path from 'node:path'
+import process from 'node:process'
+
+import { isMainModule } from '../_shared/is-main-module.mts'
+import { runMain } from '../_shared/run-main.mts'
+import { BENCH_FIXTURES } from './fixtures.mts'
+import type { BenchFixture } from './fixtures.mts'
+import { evaluateGates, readBaseline, writeBaseline } from './gates.mts'
+import type { BenchResult } from './gates.mts'
+import {
+  dispatchVariants,
+  intrinsicProbes,
+  timeRounds,
+  withBenchScratch,
+} from './harness.mts'
+import { printReport } from './report.mts'
+import type { BenchReport } from './report.mts'
+import { summarizeSamples } from './stats.mts'
+
+const logger = getDefaultLogger()
+
+interface Args {
+  readonly event: string | undefined
+  readonly fixture: string | undefined
+  readonly json: boolean
+  readonly runs: number
+  readonly saveBaseline: boolean
+  readonly warmup: number
+}
+
+function parseArgs(argv: readonly string[]): Args | undefined {
+  let event: string | undefined
+  let fixture: string | undefined
+  let json = false
+  let runs = 30
+  let saveBaseline = false
+  let warmup = 3
+  for (let i = 0, { length } = argv; i < length; i += 1) {
+    const a = argv[i]!
+    if (a === '--json') {
+      json = true
+    } else if (a === '--save-baseline') {
+      saveBaseline = true
+    } else if (a === '--event') {
+      event = argv[(i += 1)]
+    } else if (a === '--fixture') {
+      fixture = argv[(i += 1)]
+    } else if (a === '--runs') {
+      runs = Number(argv[(i += 1)])
+      if (!(runs >= 1)) {
+        return undefined
+      }
+    } else if (a === '--warmup') {
+      warmup = Number(argv[(i += 1)])
+      if (!(warmup >= 0)) {
+        return undefined
+      }
+    } else {
+      return undefined
+    }
+  }
+  return {
+    __proto__: null,
+    event,
+    fixture,
+    json,
+    runs,
+    saveBaseline,
+    warmup,
+  } as Args
+}
+
+/**
+ * Run the bench and evaluate its gates.
+ */
+export function runBench(args: Args): BenchReport {
+  const skipped: string[] = []
+  const results: BenchResult[] = []
+  const outputs = new Map<string, Map<string, string>>()
+  withBenchScratch((scratch, env) => {
+    const probes = args.fixture ? [] : intrinsicProbes(scratch, skipped)
+    if (probes.length) {
+      const samples = timeRounds(probes, '', env, args, () => {})
+      for (const [variant, ms] of samples) {
+        results.push({
+          __proto__: null,
+          ...summarizeSamples(ms),
+          event: 'PreToolUse',
+          fixture: 'intrinsic',
+          variant,
+        } as BenchResult)
+      }
+    }
+
+    const variants = dispatchVariants(skipped)
+    const fixtures = BENCH_FIXTURES.filter(
+      (f: BenchFixture) =>
+        (!args.event || f.event === args.event) &&
+        (!args.fixture || f.name === args.fixture),
+    )
+    for (let i = 0, { length } = fixtures; i < length; i += 1) {
+      const fixture = fixtures[i]!
+      const input = JSON.stringify(fixture.payload(scratch))
+      const seen = new Map<string, string>()
+      outputs.set(fixture.name, seen)
+      const samples = timeRounds(
+        variants.map(v => [v.name, v.cmd, [...v.args, fixture.event]] as const),
+        input,
+        env,
+        args,
+        (name, output) => seen.set(name, output),
+      )
+      for (const [variant, ms] of samples) {
+        results.push({
+          __proto__: null,
+          ...summarizeSamples(ms),
+          event: fixture.event,
+          fixture: fixture.name,
+          variant,
+        } as BenchResult)
+      }
+    }
+  })
+  return {
+    __proto__: null,
+    arch: process.arch,
+    gates: evaluateGates(results, outputs, readBaseline(), process.version),
+    node: process.version,
+    platform: process.platform,
+    results,
+    skipped,
+  } as BenchReport
+}
+
+function main(): number {
+  const args = parseArgs(process.argv.slice(2))
+  if (!args) {
+    logger.error(
+      'Usage: bench/dispatch.mts [--event <Event>] [--fixture <name>] ' +
+        '[--runs <n>] [--warmup <n>] [--json] [--save-baseline]',
+    )
+    return 2
+  }
+  const report = runBench(args)
+  if (args.json) {
+    logger.log(JSON.stringify(report, undefined, 2))
+  } else {
+    printReport(report)
+  }
+  if (args.saveBaseline) {
+    const file = writeBaseline(report.results, readBaseline())
+    if (!args.json) {
+      logger.log(`Baseline written: ${path.relative(process.cwd(), file)}`)
+    }
+  }
+  return report.gates.every(g => g.ok) ? 0 : 1
+}
+
+if (isMainModule(import.meta.url)) {
+  runMain(main)
+}
@@ -0,0 +1,101 @@
+/*
+ * @file Hook payloads the dispatch bench feeds every variant, one or more
+ *   per event. Each is a payload shape Claude Code actually sends, pointed at
+ *   a scratch dir (`cwd`, the transcript, every file path) so no hook acts on
+ *   this checkout while being timed: a Stop fixture must never reach
+ *   auto-land, a Write fixture must never land on a tracked file.
+ *
+ *   `write-large` is the case the lazy payload parse (`_shared/lazy-json.mts`)
+ *   exists for; `bash-clean` is the common PreToolUse the notes' tables use.
+ */
+
+import path from 'node:path'
+
+export interface BenchFixture {
+  readonly event: string
+  readonly name: string
+  readonly payload: (scratch: string) => Record<string, unknown>
+}
+
+function envelope(
+  scratch: string,
+  event: string,
+  fields: Record<string, unknown>,
+): Record<string, unknown> {
+  return {
+    __proto__: null,
+    cwd: scratch,
+    hook_event_name: event,
+    session_id: 'fleet-bench',
+    transcript_path: path.join(scratch, 'transcript.jsonl'),
+    ...fields,
+  }
+}
+
+export const BENCH_FIXTURES: readonly BenchFixture[] = [
+  {
+    __proto__: null,
+    event: 'PreToolUse',
+    name: 'bash-clean',
+    payload: scratch =>
+      envelope(scratch, 'PreToolUse', {
+        tool_input: { command: 'ls -la' },
+        tool_name: 'Bash',
+      }),
+  },
+  {
+    __proto__: null,
+    event: 'PreToolUse',
+    name: 'edit-small',
+    payload: scratch =>
+      envelope(scratch, 'PreToolUse', {
+        tool_input: {
+          file_path: path.join(scratch, 'notes.md'),
+          new_string: 'Second draft of the notes.\n',
+          old_string: 'First draft of the notes.\n',
+        },
+        tool_name: 'Edit',
+      }),
+  },
+  {
+    __proto__: null,
+    event: 'PreToolUse',
+    name: 'write-large',
+    payload: scratch =>
+      envelope(scratch, 'PreToolUse', {
+        tool_input: {
+          content: 'The quick brown fox jumps over the lazy dog.\n'.repeat(
+            24_000,
+          ),
+          file_path: path.join(scratch, 'large.txt'),
+        },
+        tool_name: 'Write',
+      }),
+  },
+  {
+    __proto__: null,
+    event: 'PostToolUse',
+    name: 'read-post',
+    payload: scratch =>
+      envelope(scratch, 'PostToolUse', {
+        tool_input: { file_path: path.join(scratch, 'notes.md') },
+        tool_name: 'Read',
+        tool_response: { content: 'First draft of the notes.\n' },
+      }),
+  },
+  {
+    __proto__: null,
+    event: 'UserPromptSubmit',
+    name: 'prompt',
+    payload: scratch =>
+      envelope(scratch, 'UserPromptSubmit', {
+        prompt: 'Rename the helper and update its callers.',
+      }),
+  },
+  {
+    __proto__: null,
+    event: 'Stop',
+    name: 'stop',
+    payload: scratch => envelope(scratch, 'Stop', { stop_hook_active: false }),
+  },
+] as BenchFixture[]
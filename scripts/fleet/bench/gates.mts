@@ -0,0 +1,185 @@
+/*
+ * @file The dispatch bench's gates and per-platform baselines. The gates
+ *   themselves are listed in `dispatch.mts`; `evaluateGates` is PURE, the
+ *   baseline read / write touch only `bench/baselines/`.
+ */
+
+import { mkdirSync, readFileSync, writeFileSync } from 'node:fs'
+import path from 'node:path'
+import process from 'node:process'
+import { fileURLToPath } from 'node:url'
+
+import type { SampleStats } from './stats.mts'
+
+const BASELINE_DIR = path.join(
+  path.dirname(fileURLToPath(import.meta.url)),
+  'baselines',
+)
+
+export const DEFAULT_MAX_LAUNCHER_OVERHEAD_MS = 2
+export const DEFAULT_BASELINE_TOLERANCE = 0.25
+export const DEFAULT_BASELINE_SLACK_MS = 2
+
+export interface BenchResult extends SampleStats {
+  readonly event: string
+  readonly fixture: string
+  readonly variant: string
+}
+
+export interface GateResult {
+  readonly detail: string
+  readonly name: string
+  readonly ok: boolean
+}
+
+export interface Baseline {
+  readonly arch: string
+  readonly maxLauncherOverheadMs: number
+  readonly node: string
+  readonly platform: string
+  readonly recordedAt: string
+  // `<variant>/<fixture>` → median ms.
+  readonly results: Readonly<Record<string, number>>
+  readonly slackMs: number
+  readonly tolerance: number
+}
+
+/**
+ * The key a baseline stores a result under.
+ */
+export function resultKey(r: { fixture: string; variant: string }): string {
+  return `${r.variant}/${r.fixture}`
+}
+
+function nodeMajor(version: string): string {
+  return /^v?(\d+)/.exec(version)?.[1] ?? version
+}
+
+function median(results: readonly BenchResult[], key: string): number {
+  return results.find(r => resultKey(r) === key)?.medianMs ?? NaN
+}
+
+/**
+ * Evaluate the gates (see the file header) over one run's results. PURE.
+ */
+export function evaluateGates(
+  results: readonly BenchResult[],
+  outputs: ReadonlyMap<string, ReadonlyMap<string, string>>,
+  baseline: Baseline | undefined,
+  node: string,
+): GateResult[] {
+  const gates: GateResult[] = []
+  const maxOverhead =
+    baseline?.maxLauncherOverheadMs ?? DEFAULT_MAX_LAUNCHER_OVERHEAD_MS
+  const launcher = median(results, 'launcher-true/intrinsic')
+  const bare = median(results, 'bare-execv-true/intrinsic')
+  if (!Number.isNaN(launcher) && !Number.isNaN(bare)) {
+    const overhead = launcher - bare
+    gates.push({
+      __proto__: null,
+      detail: `${overhead.toFixed(2)} ms over a bare execv (limit ${maxOverhead} ms)`,
+      name: 'launcher-overhead',
+      ok: overhead <= maxOverhead,
+    } as GateResult)
+  }
+  const fixtures = [
+    ...new Set(
+      results.filter(r => r.fixture !== 'intrinsic').map(r => r.fixture),
+    ),
+  ]
+  for (let i = 0, { length } = fixtures; i < length; i += 1) {
+    const fixture = fixtures[i]!
+    const cache = median(results, `compile-cache/${fixture}`)
+    const rivals = (['snapshot-direct', 'native-launcher'] as const)
+      .map(v => [v, median(results, `${v}/${fixture}`)] as const)
+      .filter(([, ms]) => !Number.isNaN(ms))
+    if (!Number.isNaN(cache) && rivals.length) {
+      const losers = rivals.filter(([, ms]) => ms >= cache)
+      gates.push({
+        __proto__: null,
+        detail: rivals
+          .map(([v, ms]) => `${v} ${(ms / cache).toFixed(2)}x`)
+          .join(', '),
+        name: `snapshot-win/${fixture}`,
+        ok: !losers.length,
+      } as GateResult)
+    }
+    const seen = outputs.get(fixture)
+    if (seen && seen.size > 1) {
+      const distinct = new Set(seen.values())
+      gates.push({
+        __proto__: null,
+        detail:
+          distinct.size === 1
+            ? `${seen.size} variants agree`
+            : [...seen.keys()].join(', ') + ' disagree',
+        name: `equivalence/${fixture}`,
+        ok: distinct.size === 1,
+      } as GateResult)
+    }
+  }
+  if (baseline && nodeMajor(baseline.node) === nodeMajor(node)) {
+    for (let i = 0, { length } = results; i < length; i += 1) {
+      const r = results[i]!
+      const key = resultKey(r)
+      const base = baseline.results[key]
+      if (base === undefined) {
+        continue
+      }
+      const limit = base * (1 + baseline.tolerance) + baseline.slackMs
+      gates.push({
+        __proto__: null,
+        detail: `${r.medianMs.toFixed(2)} ms vs baseline ${base.toFixed(2)} ms (limit ${limit.toFixed(2)} ms)`,
+        name: `baseline/${key}`,
+        ok: r.medianMs <= limit,
+      } as GateResult)
+    }
+  }
+  return gates
+}
+
+function baselinePath(): string {
+  return path.join(BASELINE_DIR, `${process.platform}-${process.arch}.json`)
+}
+
+export function readBaseline(): Baseline | undefined {
+  try {
+    return JSON.parse(readFileSync(baselinePath(), 'utf8')) as Baseline
+  } catch {
+    return undefined
+  }
+}
+
+export function writeBaseline(
+  results: readonly BenchResult[],
+  prior: Baseline | undefined,
+): string {
+  const map: Record<string, number> = { __proto__: null } as Record<
+    string,
+    number
+  >
+  for (let i = 0, { length } = results; i < length; i += 1) {
+    map[resultKey(results[i]!)] = results[i]!.medianMs
+  }
+  const file = baselinePath()
+  mkdirSync(BASELINE_DIR, { recursive: true })
+  writeFileSync(
+    file,
+    `${JSON.stringify(
+      {
+        platform: process.platform,
+        arch: process.arch,
+        node: process.version,
+        recordedAt: new Date().toISOString(),
+        maxLauncherOverheadMs:
+          prior?.maxLauncherOverheadMs ?? DEFAULT_MAX_LAUNCHER_OVERHEAD_MS,
+        tolerance: prior?.tolerance ?? DEFAULT_BASELINE_TOLERANCE,
+        slackMs: prior?.slackMs ?? DEFAULT_BASELINE_SLACK_MS,
+        results: map,
+      },
+      undefined,
+      2,
+    )}\n`,
+  )
+  return file
+}
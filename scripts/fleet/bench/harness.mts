@@ -0,0 +1,242 @@
+/*
+ * @file The dispatch bench's harness: the variants this checkout can run,
+ *   the POSIX intrinsic-overhead probes, the timed rounds, and the scratch
+ *   dir every timed hook runs against. `tune-flags.mts` times its
+ *   candidates through the same rounds and scratch.
+ */
+
+import { safeDeleteSync } from '@socketsecurity/lib-stable/fs/safe'
+import { spawnSync } from '@socketsecurity/lib-stable/process/spawn/child'
+import {
+  chmodSync,
+  copyFileSync,
+  existsSync,
+  mkdirSync,
+  mkdtempSync,
+  readFileSync,
+  statSync,
+  writeFileSync,
+} from 'node:fs'
+import os from 'node:os'
+import path from 'node:path'
+import process from 'node:process'
+import { fileURLToPath } from 'node:url'
+
+import { DISPATCH_DIR, FLEET_HOOKS_DIR } from '../gen/hook-dispatch.mts'
+import {
+  LAUNCH_MANIFEST_NAME,
+  decodeLaunchManifest,
+  encodeLaunchManifest,
+} from '../_shared/launch-manifest.mts'
+import type { LaunchManifest } from '../_shared/launch-manifest.mts'
+
+const BENCH_DIR = path.dirname(fileURLToPath(import.meta.url))
+const IS_WIN = process.platform === 'win32'
+
+export type VariantName =
+  | 'cold-dispatch'
+  | 'compile-cache'
+  | 'native-launcher'
+  | 'snapshot-direct'
+
+export interface Variant {
+  readonly args: readonly string[]
+  readonly cmd: string
+  readonly name: VariantName
+}
+
+interface RunOutcome {
+  readonly ms: number
+  readonly output: string
+}
+
+function readManifest(): LaunchManifest | undefined {
+  try {
+    return decodeLaunchManifest(
+      readFileSync(path.join(DISPATCH_DIR, LAUNCH_MANIFEST_NAME)),
+    )
+  } catch {
+    return undefined
+  }
+}
+
+function blobIntact(m: LaunchManifest): boolean {
+  try {
+    return statSync(m.blobPath, { bigint: true }).size === m.blobSize
+  } catch {
+    return false
+  }
+}
+
+function runOnce(
+  cmd: string,
+  args: readonly string[],
+  input: string,
+  env: NodeJS.ProcessEnv,
+): RunOutcome {
+  const start = process.hrtime.bigint()
+  const r = spawnSync(cmd, [...args], { env, input, stdio: 'pipe' })
+  const ms = Number(process.hrtime.bigint() - start) / 1e6
+  return {
+    __proto__: null,
+    ms,
+    output: `${String(r.status)}\n${String(r.stdout ?? '')}`,
+  } as RunOutcome
+}
+
+/**
+ * The dispatch variants this checkout has the artifacts for; the rest are
+ * named in `skipped`.
+ */
+export function dispatchVariants(skipped: string[]): Variant[] {
+  const variants: Variant[] = []
+  const launcher = path.join(
+    DISPATCH_DIR,
+    IS_WIN ? 'dispatch-launcher.exe' : 'dispatch-launcher',
+  )
+  const manifest = readManifest()
+  if (existsSync(launcher)) {
+    variants.push({
+      __proto__: null,
+      args: [],
+      cmd: launcher,
+      name: 'native-launcher',
+    } as Variant)
+  } else {
+    skipped.push('native-launcher: not built (build-snapshot-launcher.mts)')
+  }
+  if (manifest && blobIntact(manifest)) {
+    variants.push({
+      __proto__: null,
+      args: [...manifest.nodeFlags, '--snapshot-blob', manifest.blobPath],
+      cmd: manifest.nodePath,
+      name: 'snapshot-direct',
+    } as Variant)
+  } else {
+    skipped.push('snapshot-direct: no intact blob in launch.manifest')
+  }
+  const indexCjs = path.join(FLEET_HOOKS_DIR, 'index.cjs')
+  if (existsSync(path.join(FLEET_HOOKS_DIR, '_dist', 'bundle.cjs'))) {
+    variants.push({
+      __proto__: null,
+      args: [indexCjs],
+      cmd: process.execPath,
+      name: 'compile-cache',
+    } as Variant)
+  } else {
+    skipped.push('compile-cache: _dist/bundle.cjs not built')
+  }
+  variants.push({
+    __proto__: null,
+    args: [path.join(DISPATCH_DIR, 'dispatch.mts')],
+    cmd: process.execPath,
+    name: 'cold-dispatch',
+  } as Variant)
+  return variants
+}
+
+/**
+ * Set up the two intrinsic-overhead probes in `scratch`: a launcher copy
+ * whose manifest execs `true` (with a one-byte blob so the fast path is
+ * taken) and bare-execv.c compiled. POSIX only.
+ */
+export function intrinsicProbes(
+  scratch: string,
+  skipped: string[],
+): Array<readonly [string, string, readonly string[]]> {
+  const launcher = path.join(DISPATCH_DIR, 'dispatch-launcher')
+  const trueBin = ['/usr/bin/true', '/bin/true'].find(p => existsSync(p))
+  if (IS_WIN || !existsSync(launcher) || !trueBin) {
+    skipped.push(
+      'launcher-overhead: needs a POSIX host, a built launcher and true(1)',
+    )
+    return []
+  }
+  const dir = path.join(scratch, 'probe', '_dispatch')
+  const blob = path.join(scratch, 'probe', 'store', 'tag', 'probe.blob')
+  mkdirSync(dir, { recursive: true })
+  mkdirSync(path.dirname(blob), { recursive: true })
+  writeFileSync(blob, '\0')
+  const probe = path.join(dir, 'dispatch-launcher')
+  copyFileSync(launcher, probe)
+  chmodSync(probe, 0o755)
+  const st = statSync(blob, { bigint: true })
+  const manifest = encodeLaunchManifest({
+    __proto__: null,
+    blobIno: st.ino,
+    blobMtimeNs: st.mtimeNs,
+    blobPath: blob,
+    blobSize: st.size,
+    bundleHash: '0'.repeat(16),
+    nodeFlags: [],
+    nodePath: trueBin,
+  } as LaunchManifest)
+  const bare = path.join(scratch, 'probe', 'bare-execv')
+  const cc = spawnSync(
+    'cc',
+    ['-O2', '-o', bare, path.join(BENCH_DIR, 'bare-execv.c')],
+    { stdio: 'ignore' },
+  )
+  if (!manifest || cc.status !== 0) {
+    skipped.push('launcher-overhead: could not build the probes')
+    return []
+  }
+  writeFileSync(path.join(dir, LAUNCH_MANIFEST_NAME), manifest)
+  return [
+    ['launcher-true', probe, ['PreToolUse']],
+    ['bare-execv-true', bare, [trueBin, 'PreToolUse']],
+  ]
+}
+
+/**
+ * `--warmup` untimed rounds then `--runs` timed ones over `entries` (name,
+ * command, argv), each round running every entry in turn. `onFirst` sees
+ * each entry's first output (exit status + stdout).
+ */
+export function timeRounds(
+  entries: ReadonlyArray<readonly [string, string, readonly string[]]>,
+  input: string,
+  env: NodeJS.ProcessEnv,
+  args: { readonly runs: number; readonly warmup: number },
+  onFirst: (name: string, output: string) => void,
+): Map<string, number[]> {
+  const samples = new Map<string, number[]>(entries.map(([n]) => [n, []]))
+  for (let round = 0; round < args.warmup + args.runs; round += 1) {
+    for (let i = 0, { length } = entries; i < length; i += 1) {
+      const [name, cmd, argv] = entries[i]!
+      const r = runOnce(cmd, argv, input, env)
+      if (round === 0) {
+        onFirst(name, r.output)
+      }
+      if (round >= args.warmup) {
+        samples.get(name)!.push(r.ms)
+      }
+    }
+  }
+  return samples
+}
+
+/**
+ * Run `fn` against a fresh scratch dir the fixtures point at, with the env
+ * every timed hook runs under (project dir = scratch, profile and trace
+ * off). The dir is removed afterwards.
+ */
+export function withBenchScratch<T>(
+  fn: (scratch: string, env: NodeJS.ProcessEnv) => T,
+): T {
+  const scratch = mkdtempSync(path.join(os.tmpdir(), 'fleet-bench-'))
+  try {
+    writeFileSync(path.join(scratch, 'transcript.jsonl'), '')
+    writeFileSync(path.join(scratch, 'notes.md'), 'First draft of the notes.\n')
+    const env: NodeJS.ProcessEnv = {
+      ...process.env,
+      CLAUDE_PROJECT_DIR: scratch,
+      FLEET_DISPATCH_PROFILE: '0',
+    }
+    delete env['FLEET_DISPATCH_TRACE']
+    delete env['FLEET_DISPATCH_TRACE_CTX']
+    return fn(scratch, env)
+  } finally {
+    safeDeleteSync(scratch, { force: true })
+  }
+}
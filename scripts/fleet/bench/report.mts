@@ -0,0 +1,39 @@
+/*
+ * @file The dispatch bench's report: one line per result, the skipped
+ *   variants, then PASS / FAIL per gate.
+ */
+
+import { getDefaultLogger } from '@socketsecurity/lib-stable/logger/default'
+
+import type { BenchResult, GateResult } from './gates.mts'
+
+const logger = getDefaultLogger()
+
+export interface BenchReport {
+  readonly arch: string
+  readonly gates: readonly GateResult[]
+  readonly node: string
+  readonly platform: string
+  readonly results: readonly BenchResult[]
+  readonly skipped: readonly string[]
+}
+
+export function printReport(report: BenchReport): void {
+  logger.log(`${report.platform}-${report.arch}, node ${report.node}`)
+  for (let i = 0, { length } = report.results; i < length; i += 1) {
+    const r = report.results[i]!
+    logger.log(
+      `  ${`${r.event}/${r.fixture}`.padEnd(28)} ${r.variant.padEnd(16)} ` +
+        `median ${r.medianMs.toFixed(2).padStart(8)} ms  ` +
+        `mean ${r.meanMs.toFixed(2).padStart(8)} ± ${r.stdevMs.toFixed(2)} ms  ` +
+        `p95 ${r.p95Ms.toFixed(2)} ms`,
+    )
+  }
+  for (let i = 0, { length } = report.skipped; i < length; i += 1) {
+    logger.log(`  skipped ${report.skipped[i]}`)
+  }
+  for (let i = 0, { length } = report.gates; i < length; i += 1) {
+    const g = report.gates[i]!
+    logger.log(`${g.ok ? 'PASS' : 'FAIL'} ${g.name}: ${g.detail}`)
+  }
+}
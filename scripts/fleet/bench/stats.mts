@@ -0,0 +1,55 @@
+/*
+ * @file Sample statistics for the dispatch bench. PURE.
+ */
+
+export interface SampleStats {
+  readonly maxMs: number
+  readonly meanMs: number
+  readonly medianMs: number
+  readonly minMs: number
+  readonly p95Ms: number
+  readonly runs: number
+  readonly stdevMs: number
+}
+
+function quantile(sorted: readonly number[], q: number): number {
+  if (!sorted.length) {
+    return 0
+  }
+  const at = (sorted.length - 1) * q
+  const lo = Math.floor(at)
+  const hi = Math.ceil(at)
+  return sorted[lo]! + (sorted[hi]! - sorted[lo]!) * (at - lo)
+}
+
+function round(ms: number): number {
+  return Math.round(ms * 1000) / 1000
+}
+
+/**
+ * Mean, sample standard deviation, and order statistics of `samples` (ms),
+ * rounded to the microsecond.
+ */
+export function summarizeSamples(samples: readonly number[]): SampleStats {
+  const sorted = samples.toSorted((a, b) => a - b)
+  const runs = sorted.length
+  let sum = 0
+  for (let i = 0; i < runs; i += 1) {
+    sum += sorted[i]!
+  }
+  const mean = runs ? sum / runs : 0
+  let sq = 0
+  for (let i = 0; i < runs; i += 1) {
+    sq += (sorted[i]! - mean) ** 2
+  }
+  return {
+    __proto__: null,
+    maxMs: round(sorted[runs - 1] ?? 0),
+    meanMs: round(mean),
+    medianMs: round(quantile(sorted, 0.5)),
+    minMs: round(sorted[0] ?? 0),
+    p95Ms: round(quantile(sorted, 0.95)),
+    runs,
+    stdevMs: round(runs > 1 ? Math.sqrt(sq / (runs - 1)) : 0),
+  } as SampleStats
+}
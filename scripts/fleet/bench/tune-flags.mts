@@ -0,0 +1,379 @@
+#!/usr/bin/env node
+/*
+ * @file Pick the per-platform V8 flag profile the snapshot dispatcher boots
+ *   under (`_dispatch/node-flag-profile.json`, read by
+ *   `snapshot-cache-path.cjs`). A hook process lives for tens of ms, so
+ *   defaults tuned for long-running servers don't fit it: a young generation
+ *   that starts small scavenges mid-event, GC helper threads start up and
+ *   are never used, and optimizing tiers compile code the process exits
+ *   before it runs.
+ *
+ *   Every candidate in CANDIDATES gets its own blob, built from the current
+ *   `snapshot-bundle.cjs` under its flags into a temp dir (never the blob
+ *   store). The candidates are then timed the way `dispatch.mts` times its
+ *   `snapshot-direct` variant: same fixtures, same scratch dir, candidates
+ *   taking turns within each round.
+ *
+ *   A candidate is REJECTED when:
+ *
+ *   - node won't start under its flags, or `--build-snapshot` fails under
+ *     them (this node doesn't know one of the flags)
+ *   - its first run on any fixture is not byte-identical (exit status +
+ *     stdout) to the untuned blob's
+ *
+ *   The winner is the accepted candidate with the lowest sum of fixture
+ *   medians, and only when that sum beats the untuned one by MIN_GAIN.
+ *   Otherwise the platform stays untuned. `--write` records the result
+ *   under this `<platform>-<arch>`; commit the profile, then rebuild the
+ *   snapshot and the launcher sidecars so the launch manifest picks it up.
+ *   Run it on a quiet machine, like `--save-baseline`.
+ *
+ *   PREREQUISITE: run `build-hook-snapshot.mts` first (this reads the
+ *   bundle it rolled).
+ *
+ *   Usage:
+ *     node scripts/fleet/bench/tune-flags.mts [--runs <n>] [--warmup <n>]
+ *       [--write]
+ */
+
+import { safeDeleteSync } from '@socketsecurity/lib-stable/fs/safe'
+import { getDefaultLogger } from '@socketsecurity/lib-stable/logger/default'
+import { spawnSync } from '@socketsecurity/lib-stable/process/spawn/child'
+import {
+  existsSync,
+  mkdtempSync,
+  readFileSync,
+  writeFileSync,
+} from 'node:fs'
+import { createRequire } from 'node:module'
+import os from 'node:os'
+import path from 'node:path'
+import process from 'node:process'
+
+import { DISPATCH_DIR } from '../gen/hook-dispatch.mts'
+import { REPO_ROOT } from '../paths.mts'
+import { isMainModule } from '../_shared/is-main-module.mts'
+import { runMain } from '../_shared/run-main.mts'
+import { BENCH_FIXTURES } from './fixtures.mts'
+import { timeRounds, withBenchScratch } from './harness.mts'
+import { summarizeSamples } from './stats.mts'
+
+const logger = getDefaultLogger()
+
+const require = createRequire(import.meta.url)
+const { NODE_FLAG_PROFILE_FILE, SNAPSHOT_NODE_FLAGS } = require(
+  path.join(DISPATCH_DIR, 'snapshot-cache-path.cjs'),
+) as {
+  NODE_FLAG_PROFILE_FILE: string
+  SNAPSHOT_NODE_FLAGS: readonly string[]
+}
+
+const SNAPSHOT_BUNDLE = path.join(DISPATCH_DIR, 'snapshot-bundle.cjs')
+const PROFILE_PATH = path.join(DISPATCH_DIR, NODE_FLAG_PROFILE_FILE)
+export const PROFILE_VERSION = 1
+
+// A profile has to earn its place: under this fraction of the untuned time
+// saved is noise on most machines, and the untuned command line is the one
+// every other path (index.cjs, a rejected flag) already runs.
+export const MIN_GAIN = 0.03
+
+const UNTUNED = 'untuned'
+
+export interface FlagCandidate {
+  readonly flags: readonly string[]
+  readonly name: string
+}
+
+// Semi-space sizes are in MB. Each flag is one `--name[=value]` token, the
+// only shape snapshot-cache-path.cjs accepts from the profile.
+export const CANDIDATES: readonly FlagCandidate[] = [
+  { __proto__: null, flags: [], name: UNTUNED },
+  {
+    __proto__: null,
+    flags: ['--min-semi-space-size=8'],
+    name: 'young-8',
+  },
+  {
+    __proto__: null,
+    flags: ['--min-semi-space-size=16', '--max-semi-space-size=16'],
+    name: 'young-16',
+  },
+  {
+    __proto__: null,
+    flags: ['--min-semi-space-size=32', '--max-semi-space-size=32'],
+    name: 'young-32',
+  },
+  { __proto__: null, flags: ['--single-threaded-gc'], name: 'single-gc' },
+  { __proto__: null, flags: ['--no-opt'], name: 'no-opt' },
+  { __proto__: null, flags: ['--no-maglev'], name: 'no-maglev' },
+  {
+    __proto__: null,
+    flags: ['--min-semi-space-size=16', '--single-threaded-gc'],
+    name: 'young-16+single-gc',
+  },
+  {
+    __proto__: null,
+    flags: ['--min-semi-space-size=16', '--single-threaded-gc', '--no-opt'],
+    name: 'young-16+single-gc+no-opt',
+  },
+] as FlagCandidate[]
+
+export interface CandidateResult {
+  readonly flags: readonly string[]
+  // `<fixture>` → median ms; empty for a rejected candidate.
+  readonly medians: Readonly<Record<string, number>>
+  readonly name: string
+  // Why it can't be the profile; undefined when accepted.
+  readonly rejected: string | undefined
+  readonly totalMs: number
+}
+
+export interface ProfileEntry {
+  readonly flags: readonly string[]
+  readonly medianMs: number
+  readonly node: string
+  readonly recordedAt: string
+  readonly untunedMedianMs: number
+}
+
+interface Args {
+  readonly runs: number
+  readonly warmup: number
+  readonly write: boolean
+}
+
+function parseArgs(argv: readonly string[]): Args | undefined {
+  let runs = 20
+  let warmup = 3
+  let write = false
+  for (let i = 0, { length } = argv; i < length; i += 1) {
+    const a = argv[i]!
+    if (a === '--write') {
+      write = true
+    } else if (a === '--runs') {
+      runs = Number(argv[(i += 1)])
+      if (!(runs >= 1)) {
+        return undefined
+      }
+    } else if (a === '--warmup') {
+      warmup = Number(argv[(i += 1)])
+      if (!(warmup >= 0)) {
+        return undefined
+      }
+    } else {
+      return undefined
+    }
+  }
+  return { __proto__: null, runs, warmup, write } as Args
+}
+
+/**
+ * The winning candidate, or undefined when the platform should stay
+ * untuned: the fastest accepted one, if it beats untuned by MIN_GAIN. PURE.
+ */
+export function pickProfile(
+  results: readonly CandidateResult[],
+): CandidateResult | undefined {
+  const untuned = results.find(r => r.name === UNTUNED)
+  if (!untuned || untuned.rejected !== undefined) {
+    return undefined
+  }
+  let best: CandidateResult | undefined
+  for (let i = 0, { length } = results; i < length; i += 1) {
+    const r = results[i]!
+    if (
+      r.name !== UNTUNED &&
+      r.rejected === undefined &&
+      (!best || r.totalMs < best.totalMs)
+    ) {
+      best = r
+    }
+  }
+  return best && best.totalMs <= untuned.totalMs * (1 - MIN_GAIN)
+    ? best
+    : undefined
+}
+
+/**
+ * Why node can't build a blob under `flags`, or undefined once it has
+ * built one at `blob`.
+ */
+function buildCandidateBlob(
+  flags: readonly string[],
+  blob: string,
+): string | undefined {
+  const start = spawnSync(process.execPath, [...flags, '-e', '0'], {
+    encoding: 'utf8',
+  })
+  if (start.status !== 0) {
+    const why = String(start.stderr ?? '').trim().split('\n')[0]
+    return `node rejected the flags${why ? `: ${why}` : ''}`
+  }
+  const build = spawnSync(
+    process.execPath,
+    [...flags, '--snapshot-blob', blob, '--build-snapshot', SNAPSHOT_BUNDLE],
+    { cwd: REPO_ROOT, encoding: 'utf8' },
+  )
+  if (build.status !== 0 || !existsSync(blob)) {
+    return `--build-snapshot failed (exit ${String(build.status)})`
+  }
+  return undefined
+}
+
+/**
+ * Build and time every candidate, then gate each on byte-identical output
+ * against the untuned blob.
+ */
+export function tuneFlags(args: {
+  readonly runs: number
+  readonly warmup: number
+}): CandidateResult[] {
+  const blobDir = mkdtempSync(path.join(os.tmpdir(), 'fleet-tune-'))
+  try {
+    const rejected = new Map<string, string>()
+    const live: Array<readonly [FlagCandidate, readonly string[], string]> =
+      []
+    for (let i = 0, { length } = CANDIDATES; i < length; i += 1) {
+      const c = CANDIDATES[i]!
+      const flags = [...SNAPSHOT_NODE_FLAGS, ...c.flags]
+      const blob = path.join(blobDir, `${c.name}.blob`)
+      const why = buildCandidateBlob(flags, blob)
+      if (why) {
+        rejected.set(c.name, why)
+      } else {
+        live.push([c, flags, blob])
+      }
+    }
+    const medians = new Map<string, Record<string, number>>()
+    for (const [c] of live) {
+      medians.set(c.name, { __proto__: null } as Record<string, number>)
+    }
+    withBenchScratch((scratch, env) => {
+      for (let i = 0, { length } = BENCH_FIXTURES; i < length; i += 1) {
+        const fixture = BENCH_FIXTURES[i]!
+        const input = JSON.stringify(fixture.payload(scratch))
+        const seen = new Map<string, string>()
+        const samples = timeRounds(
+          live.map(
+            ([c, flags, blob]) =>
+              [
+                c.name,
+                process.execPath,
+                [...flags, '--snapshot-blob', blob, fixture.event],
+              ] as const,
+          ),
+          input,
+          env,
+          args,
+          (name, output) => seen.set(name, output),
+        )
+        const reference = seen.get(UNTUNED)
+        for (const [name, ms] of samples) {
+          medians.get(name)![fixture.name] = summarizeSamples(ms).medianMs
+          if (
+            name !== UNTUNED &&
+            !rejected.has(name) &&
+            seen.get(name) !== reference
+          ) {
+            rejected.set(
+              name,
+              `output differs from untuned on ${fixture.name}`,
+            )
+          }
+        }
+      }
+    })
+    return CANDIDATES.map(c => {
+      const m = medians.get(c.name) ?? {}
+      let totalMs = 0
+      for (const ms of Object.values(m)) {
+        totalMs += ms
+      }
+      return {
+        __proto__: null,
+        flags: c.flags,
+        medians: m,
+        name: c.name,
+        rejected: rejected.get(c.name),
+        totalMs,
+      } as CandidateResult
+    })
+  } finally {
+    safeDeleteSync(blobDir, { force: true })
+  }
+}
+
+/**
+ * Record `entry` as this platform's profile, keeping every other
+ * platform's.
+ */
+function writeProfile(entry: ProfileEntry): void {
+  let profiles: Record<string, ProfileEntry> = {}
+  try {
+    const prior = JSON.parse(readFileSync(PROFILE_PATH, 'utf8')) as {
+      profiles?: Record<string, ProfileEntry>
+    }
+    profiles = { ...prior.profiles }
+  } catch {}
+  profiles[`${process.platform}-${process.arch}`] = entry
+  const sorted = Object.fromEntries(
+    Object.entries(profiles).toSorted(([a], [b]) => (a < b ? -1 : 1)),
+  )
+  const profile = { v: PROFILE_VERSION, profiles: sorted }
+  writeFileSync(PROFILE_PATH, `${JSON.stringify(profile, undefined, 2)}\n`)
+}
+
+function main(): number {
+  const args = parseArgs(process.argv.slice(2))
+  if (!args) {
+    logger.error(
+      'Usage: bench/tune-flags.mts [--runs <n>] [--warmup <n>] [--write]',
+    )
+    return 2
+  }
+  if (!existsSync(SNAPSHOT_BUNDLE)) {
+    logger.error(
+      'snapshot-bundle.cjs missing — run build-hook-snapshot.mts first.',
+    )
+    return 2
+  }
+  const results = tuneFlags(args)
+  const untuned = results.find(r => r.name === UNTUNED)!
+  if (untuned.rejected !== undefined) {
+    logger.error(`untuned blob: ${untuned.rejected}`)
+    return 1
+  }
+  logger.log(`${process.platform}-${process.arch}, node ${process.version}`)
+  for (let i = 0, { length } = results; i < length; i += 1) {
+    const r = results[i]!
+    logger.log(
+      `  ${r.name.padEnd(28)} ` +
+        (r.rejected === undefined
+          ? `${r.totalMs.toFixed(2).padStart(9)} ms  ` +
+            `${((r.totalMs / untuned.totalMs - 1) * 100).toFixed(1)}%`
+          : `rejected: ${r.rejected}`),
+    )
+  }
+  const winner = pickProfile(results)
+  logger.log(
+    winner
+      ? `Profile: ${winner.name} (${winner.flags.join(' ')})`
+      : `Profile: untuned (nothing beat it by ${MIN_GAIN * 100}%)`,
+  )
+  if (args.write) {
+    writeProfile({
+      __proto__: null,
+      flags: winner?.flags ?? [],
+      medianMs: (winner ?? untuned).totalMs,
+      node: process.version,
+      recordedAt: new Date().toISOString(),
+      untunedMedianMs: untuned.totalMs,
+    } as ProfileEntry)
+    logger.log(`Written: ${path.relative(process.cwd(), PROFILE_PATH)}`)
+  }
+  return 0
+}
+
+if (isMainModule(import.meta.url)) {
+  runMain(main)
+}
@@ -8,8 +8,16 @@
  *   The hand-written `index.cjs` loader (NOT bundled) turns on the V8
  *   compile cache, then `require()`s the bundle. Output is CJS so the compile
  *   cache reliably persists; see docs/agents.md/fleet/hook-bundle.md.
- *   Usage: `node scripts/fleet/build-hook-bundle.mts [--check]`
- *   --check  fail (exit 2) if the dispatch table is stale; does not rebuild.
+ *   After a build it primes that compile cache for the host node
+ *   (`_shared/compile-cache-prime.mts`), so the first `index.cjs` run in a
+ *   fresh container is already warm.
+ *   Usage: `node scripts/fleet/build-hook-bundle.mts [--check | --prime-only]
+ *     [--no-prime]`
+ *   --check       fail (exit 2) if the dispatch table is stale; does not
+ *                 rebuild.
+ *   --prime-only  prime the compile cache for the bundle already on disk
+ *                 (the release-shipped one in a bundle-only member); no build.
+ *   --no-prime    build without priming.
  */
 
 // prefer-async-spawn: sync-required — top-level CLI build runner; the flow is
@@ -29,7 +37,8 @@ import {
   generateDispatchTableSource,
   HOOK_BUNDLE_PATH,
 } from './gen/hook-dispatch.mts'
-import { REPO_ROOT } from './paths.mts'
+import { REPO_ROOT, resolveHookBundleOut } from './paths.mts'
+import { primeHookCompileCache } from './_shared/compile-cache-prime.mts'
 import { hasFleetHookSource } from './_shared/fleet-source-present.mts'
 import { isMainModule } from './_shared/is-main-module.mts'
 
@@ -83,14 +92,39 @@ export function classifyBundleBuild(config: {
   return { ok: true }
 }
 
+/**
+ * Prime the compile cache for the bundle `index.cjs` loads. Never fails the
+ * build: an unprimed cache only means the first hook run compiles.
+ */
+function primeCompileCache(): void {
+  // A FLEET_HOOK_BUNDLE_OUT build went somewhere index.cjs never loads.
+  if (resolveHookBundleOut() !== HOOK_BUNDLE_PATH) {
+    return
+  }
+  const primed = primeHookCompileCache()
+  if (primed.status === 'primed') {
+    logger.log(`Primed the compile cache (${primed.detail}).`)
+  } else {
+    logger.warn(`Compile cache not primed: ${primed.detail}.`)
+  }
+}
+
 function main(): void {
+  if (process.argv.includes('--prime-only')) {
+    primeCompileCache()
+    return
+  }
   // A bundle-only member has no hook source to bundle — a rebuild here would
   // replace the release-shipped bundle.cjs with an EMPTY one, silently
   // disabling every fleet hook (index.cjs fails open). Built at the source repo.
+  // The shipped bundle still gets a primed cache.
   if (!hasFleetHookSource(REPO_ROOT)) {
     logger.log(
       '[build-hook-bundle] no fleet hook source (bundle-only) — bundle.cjs ships via the release bundle.',
     )
+    if (!process.argv.includes('--no-prime')) {
+      primeCompileCache()
+    }
     return
   }
   const checkOnly = process.argv.includes('--check')
@@ -182,6 +216,9 @@ function main(): void {
     return
   }
   logger.log(`Built ${path.relative(REPO_ROOT, HOOK_BUNDLE_PATH)}.`)
+  if (!process.argv.includes('--no-prime')) {
+    primeCompileCache()
+  }
 }
 
 if (isMainModule(import.meta.url)) {
@@ -20,13 +20,77 @@
  *   the active path); the content hash means a bundle edit writes a fresh blob
  *   (the loader misses → fails open to index.cjs).
  *
- *   Usage: `node scripts/fleet/build-hook-snapshot.mts`
+ *   PER-EVENT SPLIT (opt-in, `--split-events`): the full blob freezes every
+ *   hook (~11 MB on Node 24, up to ~21 MB per platform), yet one event only
+ *   ever runs its own slice — a PreToolUse Bash boot never needs the Stop
+ *   hooks or `compromise`, the NLP library judgment-nudge inlines. With the
+ *   flag, each hook event also gets `snapshot-bundle.<Event>.cjs` and its own
+ *   blob, `blobPath('dispatch-<Event>', <its hash>)`. They are built from a
+ *   narrowed snapshot table, written over the same aliased
+ *   `dispatch-table-snapshot.mts` and restored before the full bundle is
+ *   built, so the snapshot rolldown config is untouched. The launcher boots
+ *   `launch.<Event>.manifest` when its blob is intact, else the full blob, else
+ *   index.cjs — a split blob can only ever be an extra, smaller hit. The
+ *   choice is sticky: without either flag, a tree that has split bundles
+ *   keeps splitting (so the launcher's `--heal` rebuild restores them);
+ *   `--no-split-events` drops them again. A split that fails to build is
+ *   dropped with a warning, never failing the full build. The split and its
+ *   sticky plans live in `_shared/snapshot-split.mts`.
+ *
+ *   INCREMENTAL: a blob is keyed on its bundle's content, so a rebuild with
+ *   an unchanged bundle lands on a blob that already exists. Each finished
+ *   blob gets a `<blob>.sha256` stamp. It is written to a temp name, linked
+ *   in (first finished build wins, so concurrent builders into the shared
+ *   store never swap a blob under a frozen manifest), then stamped, so a
+ *   killed build never looks finished. A blob whose stamp matches its bytes
+ *   is reused, whichever checkout built it. Only the rolldown passes re-run,
+ *   and a setup / cascade that changed no hook skips every `--build-snapshot`.
+ *   `--force` rebuilds anyway. Reuse, publishing and the runtimes below
+ *   live in `_shared/snapshot-blob-build.mts`.
+ *
+ *   MULTI-RUNTIME: `--node <path>` (repeatable) builds the same bundles
+ *   under more installed nodes (other majors, or another arch through an
+ *   emulated node) in the same invocation. Each runtime's blob path comes
+ *   from `snapshot-cache-path.cjs` evaluated inside that node, so its
+ *   version × arch × V8 tag keys its own dir. The blob builds run in
+ *   parallel, `--jobs <n>` at a time (default: the CPU count, at most
+ *   MAX_JOBS). A runtime that can't be probed is skipped with an error. One
+ *   that fails its full blob fails the build.
+ *
+ *   LAZY COLD HOOKS (opt-in, `--lazy-cold`): a hook tagged `@dispatch-lazy`
+ *   (heavy, rarely firing — judgment-nudge and the compromise NLP library it
+ *   inlines) moves out of the snapshot table into the excluded table, so it
+ *   leaves the frozen heap and rides `excluded-bundle.cjs`. Deserialize-main
+ *   requires that bundle, through the compile cache, only for an event/tool
+ *   its hints match. Sticky like the split: the snapshot table records it.
+ *
+ *   FLAG PROFILE: a runtime whose `<platform>-<arch>` has a tuned V8 flag
+ *   profile (`_dispatch/node-flag-profile.json`, picked by
+ *   `bench/tune-flags.mts`) builds its blobs under those flags, into
+ *   flag-tagged blob names. When that node won't start under the profile, or
+ *   a tuned `--build-snapshot` fails, the blob is built untuned instead, so a
+ *   rejected flag only ever costs the tuning.
+ *
+ *   ATTRIBUTION (`--report`): after the blobs, writes `attribution.json`
+ *   beside the build manifest — per hook and per shared module, bundled
+ *   bytes, retained heap and an estimated share of deserialize time (see
+ *   `_shared/snapshot-attribution-report.mts`) — and logs the top rows
+ *   (`_shared/snapshot-build-report.mts`).
+ *
+ *   BUILD MANIFEST: every run writes `build-manifest.json` beside the
+ *   runtime dirs (`--manifest <file>` elsewhere). It lists each bundle
+ *   (entry id, content hash) and, per runtime (node, version, arch,
+ *   platform), every blob's path, size, sha256 and whether it was built,
+ *   reused or failed, and the node flags it boots under. An image
+ *   bake copies the blobs it lists instead of re-deriving cache keys.
+ *
+ *   Usage: `node scripts/fleet/build-hook-snapshot.mts [--split-events |
+ *     --no-split-events] [--lazy-cold | --no-lazy-cold] [--node <path>]…
+ *     [--jobs <n>] [--force] [--manifest <file>] [--report]`
  */
 
 import { spawnSync } from '@socketsecurity/lib-stable/process/spawn/child'
-import crypto from 'node:crypto'
-import { existsSync, mkdirSync, readFileSync, writeFileSync } from 'node:fs'
-import { createRequire } from 'node:module'
+import { existsSync, mkdirSync, statSync, writeFileSync } from 'node:fs'
 import path from 'node:path'
 import process from 'node:process'
 
@@ -37,7 +101,9 @@ import {
   DISPATCH_TABLE_PATH,
   FLEET_HOOKS_DIR,
   generateDispatchTableSource,
+  tableOptionsOnDisk,
 } from './gen/hook-dispatch.mts'
+import type { TableOptions } from './gen/hook-dispatch.mts'
 import {
   DISPATCH_TABLE_EXCLUDED_PATH,
   DISPATCH_TABLE_SNAPSHOT_PATH,
@@ -46,17 +112,32 @@ import {
 } from './paths.mts'
 import { hasFleetHookSource } from './_shared/fleet-source-present.mts'
 import { isMainModule } from './_shared/is-main-module.mts'
+import { runMain } from './_shared/run-main.mts'
+import {
+  buildRuntimeBlobs,
+  bundleJob,
+  classifySpawnOutcome,
+  defaultBlobJobs,
+  resolveRuntimes,
+  sha256File,
+} from './_shared/snapshot-blob-build.mts'
+import type { BlobStatus } from './_shared/snapshot-blob-build.mts'
+import { reportSnapshotAttribution } from './_shared/snapshot-build-report.mts'
+import type { SnapshotReportConfig } from './_shared/snapshot-build-report.mts'
+import {
+  ROLLDOWN_BIN,
+  SNAPSHOT_BUNDLE,
+  SNAPSHOT_CONFIG,
+  bundleSplitEvents,
+  dropSplit,
+  dropSplits,
+  hasSplitBundles,
+  planLazy,
+  planSplit,
+} from './_shared/snapshot-split.mts'
 
 const logger = getDefaultLogger()
 
-const ROLLDOWN_BIN = path.join(REPO_ROOT, 'node_modules', '.bin', 'rolldown')
-const SNAPSHOT_CONFIG = path.join(
-  REPO_ROOT,
-  '.config',
-  'repo',
-  'rolldown',
-  'hook-bundle-snapshot.config.mts',
-)
 const EXCLUDED_CONFIG = path.join(
   REPO_ROOT,
   '.config',
@@ -64,38 +145,106 @@ const EXCLUDED_CONFIG = path.join(
   'rolldown',
   'hook-bundle-excluded.config.mts',
 )
-const SNAPSHOT_BUNDLE = path.join(DISPATCH_DIR, 'snapshot-bundle.cjs')
+// Written beside the per-runtime blob dirs unless `--manifest` says where.
+export const BUILD_MANIFEST_NAME = 'build-manifest.json'
+export const BUILD_MANIFEST_VERSION = 2
 
-// snapshot-cache-path.cjs is the SHARED key derivation: the loader resolves the
-// exact same path at runtime, so the generator and the loader can never disagree
-// on where a blob lives or how it's keyed. One source of truth, by construction.
-const require = createRequire(import.meta.url)
-const { blobPath } = require(
-  path.join(DISPATCH_DIR, 'snapshot-cache-path.cjs'),
-) as { blobPath: (entryId: string, sourceHash: string) => string }
+export interface BuildArgs {
+  readonly force: boolean
+  readonly jobs: number
+  readonly manifest: string | undefined
+  readonly nodes: readonly string[]
+  readonly report: boolean
+}
 
 /**
- * Content-key a built bundle — sha256, first 16 hex — the same derivation the
- * loader uses, so a bundle change always resolves to a fresh blob path.
+ * The builder's own flags (the split and lazy flags are read by `planSplit`
+ * and `planLazy`);
+ * undefined on a malformed value.
  */
-export function computeSourceHash(content: Buffer | string): string {
-  return crypto.createHash('sha256').update(content).digest('hex').slice(0, 16)
+export function parseBuildArgs(
+  argv: readonly string[],
+): BuildArgs | undefined {
+  let force = false
+  let jobs = defaultBlobJobs()
+  let manifest: string | undefined
+  const nodes: string[] = []
+  let report = false
+  for (let i = 0, { length } = argv; i < length; i += 1) {
+    const a = argv[i]!
+    if (a === '--force') {
+      force = true
+    } else if (a === '--report') {
+      report = true
+    } else if (a === '--jobs') {
+      jobs = Number(argv[(i += 1)])
+      if (!(jobs >= 1)) {
+        return undefined
+      }
+    } else if (a === '--manifest') {
+      manifest = argv[(i += 1)]
+      if (!manifest) {
+        return undefined
+      }
+    } else if (a === '--node') {
+      const node = argv[(i += 1)]
+      if (!node) {
+        return undefined
+      }
+      nodes.push(node)
+    }
+  }
+  return {
+    __proto__: null,
+    force,
+    jobs: Math.floor(jobs),
+    manifest,
+    nodes,
+    report,
+  } as BuildArgs
+}
+
+export interface ManifestBlob {
+  readonly blob: string
+  readonly entryId: string
+  readonly nodeFlags: readonly string[]
+  readonly sha256: string | undefined
+  readonly size: number | undefined
+  readonly sourceHash: string
+  readonly status: BlobStatus
+}
+
+export interface ManifestRuntime {
+  readonly arch: string
+  readonly blobs: readonly ManifestBlob[]
+  readonly node: string
+  readonly platform: string
+  readonly version: string
 }
 
 /**
- * Classify a spawned build step from its exit status + whether the expected
- * output landed.
+ * The build manifest: what this invocation left where, per runtime.
  */
-export function classifySpawnOutcome(config: {
-  exitStatus: number | null
-  outputExists: boolean
-}): { ok: boolean } {
-  const cfg = { __proto__: null, ...config }
-  const { exitStatus, outputExists } = cfg
-  return { ok: exitStatus === 0 && outputExists }
+export interface SnapshotBuildManifest {
+  readonly bundles: ReadonlyArray<{
+    readonly bundle: string
+    readonly entryId: string
+    readonly sourceHash: string
+  }>
+  readonly runtimes: readonly ManifestRuntime[]
+  readonly v: number
 }
 
-function main(): void {
+async function main(): Promise<number> {
+  const args = parseBuildArgs(process.argv.slice(2))
+  if (!args) {
+    logger.error(
+      'Usage: build-hook-snapshot.mts [--split-events | --no-split-events] ' +
+        '[--lazy-cold | --no-lazy-cold] [--node <path>]… [--jobs <n>] ' +
+        '[--force] [--manifest <file>] [--report]',
+    )
+    return 2
+  }
   // A bundle-only member has no hook source — regenerating the table variants
   // + snapshot bundles over absent dirs would emit empty artifacts. Built at
   // the source repo; the per-machine snapshot re-primes only where source ships.
@@ -103,22 +252,39 @@ function main(): void {
     logger.log(
       '[build-hook-snapshot] no fleet hook source (bundle-only) — skipping the snapshot build.',
     )
-    return
+    return 0
   }
   // All three table variants: the FULL table (index.cjs path), the
   // snapshot-SAFE table (aliased into the snapshot bundle), and the
-  // EXCLUDED table (the sibling runtime bundle's source).
+  // EXCLUDED table (the sibling runtime bundle's source). Lazy cold hooks
+  // move from the second to the third.
+  const tableOptions = {
+    __proto__: null,
+    lazy: planLazy(process.argv, {
+      hasLazyTable: !!tableOptionsOnDisk().lazy,
+    }),
+  } as TableOptions
   writeFileSync(
     DISPATCH_TABLE_PATH,
     generateDispatchTableSource(FLEET_HOOKS_DIR),
   )
   writeFileSync(
     DISPATCH_TABLE_SNAPSHOT_PATH,
-    generateDispatchTableSource(FLEET_HOOKS_DIR, 'snapshot'),
+    generateDispatchTableSource(
+      FLEET_HOOKS_DIR,
+      'snapshot',
+      undefined,
+      tableOptions,
+    ),
   )
   writeFileSync(
     DISPATCH_TABLE_EXCLUDED_PATH,
-    generateDispatchTableSource(FLEET_HOOKS_DIR, 'excluded'),
+    generateDispatchTableSource(
+      FLEET_HOOKS_DIR,
+      'excluded',
+      undefined,
+      tableOptions,
+    ),
   )
 
   mkdirSync(DISPATCH_DIR, { recursive: true })
@@ -127,8 +293,7 @@ function main(): void {
     logger.error(
       `rolldown not found at ${path.relative(REPO_ROOT, ROLLDOWN_BIN)}; run pnpm install.`,
     )
-    process.exitCode = 2
-    return
+    return 2
   }
 
   // The excluded-hooks sibling first: deserialize-main requires it at
@@ -146,8 +311,17 @@ function main(): void {
     logger.error(
       `excluded bundle build failed (exit ${String(excluded.status)}).`,
     )
-    process.exitCode = excluded.status ?? 1
-    return
+    return excluded.status ?? 1
+  }
+
+  // Splits before the full bundle: they roll through the same output path
+  // and restore the full snapshot table when done.
+  const split = planSplit(process.argv, {
+    hasSplitBundles: hasSplitBundles(),
+  })
+  const splitJobs = split ? bundleSplitEvents(tableOptions) : []
+  if (!split) {
+    dropSplits()
   }
 
   const bundle = spawnSync(ROLLDOWN_BIN, ['-c', SNAPSHOT_CONFIG], {
@@ -163,36 +337,112 @@ function main(): void {
     logger.error(
       `snapshot bundle build failed (exit ${String(bundle.status)}).`,
     )
-    process.exitCode = bundle.status ?? 1
-    return
+    return bundle.status ?? 1
   }
 
   // Content-key on the built bundle — the loader hashes snapshot-bundle.cjs the
   // same way (sha256, first 16 hex), so the blob written here is exactly the one
   // the loader looks for. A bundle change → new hash → new blob; the stale one is
   // orphaned in tmpdir and reaped, never booted.
-  const sourceHash = computeSourceHash(readFileSync(SNAPSHOT_BUNDLE))
-  const blobOut = blobPath('dispatch', sourceHash)
-  mkdirSync(path.dirname(blobOut), { recursive: true })
-
-  const snap = spawnSync(
-    process.execPath,
-    ['--snapshot-blob', blobOut, '--build-snapshot', SNAPSHOT_BUNDLE],
-    { cwd: REPO_ROOT, stdio: 'inherit' },
-  )
-  if (
-    !classifySpawnOutcome({
-      exitStatus: snap.status,
-      outputExists: existsSync(blobOut),
-    }).ok
-  ) {
-    logger.error(`--build-snapshot failed (exit ${String(snap.status)}).`)
-    process.exitCode = snap.status ?? 1
-    return
+  const jobs = [bundleJob('dispatch', SNAPSHOT_BUNDLE), ...splitJobs]
+  const runtimes = resolveRuntimes(jobs, args.nodes)
+  const outcomes = await buildRuntimeBlobs(runtimes, jobs, {
+    concurrency: args.jobs,
+    force: args.force,
+  })
+  const statuses = outcomes.map(row => row.map(o => o.status))
+  const hostBlob = outcomes[0]![0]!
+
+  // The launcher boots the host's blobs: a split that failed here loses its
+  // bundle so no event manifest points at a missing blob.
+  for (let j = 1, { length } = jobs; j < length; j += 1) {
+    if (statuses[0]![j] === 'failed') {
+      dropSplit(jobs[j]!.event!)
+    }
+  }
+
+  const manifest: SnapshotBuildManifest = {
+    __proto__: null,
+    bundles: jobs.map(j => ({
+      __proto__: null,
+      bundle: path.relative(REPO_ROOT, j.bundlePath),
+      entryId: j.entryId,
+      sourceHash: j.sourceHash,
+    })),
+    runtimes: runtimes.map((runtime, r) => ({
+      __proto__: null,
+      arch: runtime.arch,
+      blobs: jobs.map((job, j) => {
+        const { blob, nodeFlags } = outcomes[r]![j]!
+        const ok = statuses[r]![j] !== 'failed'
+        return {
+          __proto__: null,
+          blob,
+          entryId: job.entryId,
+          nodeFlags,
+          sha256: ok ? sha256File(blob) : undefined,
+          size: ok ? statSync(blob).size : undefined,
+          sourceHash: job.sourceHash,
+          status: statuses[r]![j]!,
+        } as ManifestBlob
+      }),
+      node: runtime.node,
+      platform: runtime.platform,
+      version: runtime.version,
+    })),
+    v: BUILD_MANIFEST_VERSION,
+  } as SnapshotBuildManifest
+  // blobPath() is <cache>/<runtime tag>/<blob>, tuned or not.
+  const cacheRoot = path.dirname(path.dirname(runtimes[0]!.blobs[0]!))
+  const manifestOut =
+    args.manifest ?? path.join(cacheRoot, BUILD_MANIFEST_NAME)
+  mkdirSync(path.dirname(manifestOut), { recursive: true })
+  writeFileSync(manifestOut, `${JSON.stringify(manifest, undefined, 2)}\n`)
+
+  let failed = false
+  for (let r = 0, { length } = runtimes; r < length; r += 1) {
+    const counts = {
+      __proto__: null,
+      built: 0,
+      failed: 0,
+      reused: 0,
+    } as Record<BlobStatus, number>
+    for (const status of statuses[r]!) {
+      counts[status] += 1
+    }
+    logger.log(
+      `${runtimes[r]!.version} ${runtimes[r]!.arch}: ${counts.built} built, ` +
+        `${counts.reused} reused, ${counts.failed} failed.`,
+    )
+    // A runtime without its full blob is a failed build; a split is optional.
+    failed ||= statuses[r]![0] === 'failed'
+  }
+  if (split) {
+    const splits = statuses[0]!.filter((s, j) => j > 0 && s !== 'failed')
+    logger.log(`${splits.length} per-event split blob(s) current.`)
   }
-  logger.log(`Built ${blobOut}.`)
+  if (args.report && statuses[0]![0] !== 'failed') {
+    await reportSnapshotAttribution({
+      __proto__: null,
+      blob: hostBlob.blob,
+      bundle: SNAPSHOT_BUNDLE,
+      cacheRoot,
+      jobs: args.jobs,
+      node: runtimes[0]!.node,
+      nodeFlags: hostBlob.nodeFlags,
+      tableOptions,
+    } as SnapshotReportConfig)
+  }
+  logger.log(
+    `Snapshot blob ${hostBlob.blob}` +
+      (hostBlob.nodeFlags.length
+        ? ` (flags ${hostBlob.nodeFlags.join(' ')})`
+        : '') +
+      `; manifest ${manifestOut}.`,
+  )
+  return failed ? 1 : 0
 }
 
 if (isMainModule(import.meta.url)) {
-  main()
+  runMain(main)
 }
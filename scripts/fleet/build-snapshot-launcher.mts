@@ -23,17 +23,39 @@
  *       parent stays resident) — see the build note below. Correctness is
  *       guaranteed on every platform by the total fail-open to index.cjs.
  *
- *   It also writes the two build-time-FROZEN sidecars the launcher reads
- *   (mirroring `dispatch-snapshot-entry.mts`'s DISPATCH_DIR_FROZEN model):
- *     - node.path           abs path to the node binary that built the blob
- *     - snapshot-blob.path  abs path to the current blob (runtime+content keyed)
- *   so the launcher resolves the fast path with two small reads instead of
- *   re-deriving the node-ver × arch × v8tag × uid × content-hash key in C.
+ *   It also writes the build-time-FROZEN sidecars the launcher reads
+ *   (mirroring `dispatch-snapshot-entry.mts`'s DISPATCH_DIR_FROZEN model). The
+ *   main one, launch.manifest (`_shared/launch-manifest.mts`), is one
+ *   fixed-layout binary record: the node binary that built the blob, the
+ *   current blob (runtime+content keyed) with the size / mtime / inode it had
+ *   at freeze time, the bundle hash, and the node flags the blob was built
+ *   under. The launcher resolves the fast path with one open + fixed-size read
+ *   instead of re-deriving the node-ver × arch × v8tag × uid × content-hash key
+ *   in C, and its single blob `stat` doubles as the swapped / truncated-blob
+ *   check. A second, daemon.path (`<bundle-hash> <slots> <socket-base>`), tells the
+ *   launcher where an opt-in warm daemon (`hook-daemon.mts start`) would be
+ *   listening and which bundle it must be serving; with no daemon running it
+ *   costs the launcher one failed lstat per slot. A third, hook-tools.map,
+ *   freezes the event→tool-set surface of the dispatch table (from the same
+ *   `buildHookIndex` (event, tool) index `gen/hook-dispatch.mts` renders into
+ *   the table as `DISPATCH_INDEX`) so
+ *   the launcher can exit 0 on an event no hook handles — most Read / Glob /
+ *   Grep calls — without booting node at all. Its trigger rules (hooks'
+ *   declared `triggers`, via `buildTriggerRules`) let it also exit 0 on a
+ *   handled tool whose every hook is prefiltered and whose payload holds
+ *   none of their triggers. When `build-hook-snapshot.mts
+ *   --split-events` left per-event bundles, each also gets a
+ *   `launch.<Event>.manifest` in the launch.manifest layout, which the
+ *   launcher boots ahead of the full blob for that event. Once the
+ *   manifests are frozen it sweeps the blob store down to its byte budget
+ *   (`_shared/snapshot-store.mts`), least recently launched first, sparing
+ *   every blob a manifest names.
  *
  *   HOST-ONLY by default: this builds the launcher for the HOST os/arch (the
  *   binary + sidecars are machine/runtime-specific and gitignored). The C
  *   sources — `dispatch-launcher.c` (POSIX) and `dispatch-launcher-win.c`
- *   (Windows) — are the committed source of truth. The non-host platforms are
+ *   (Windows), each with its units (POSIX_SRCS / WIN_SRCS, which share
+ *   `dispatch-launcher-preflight.c`) — are the committed source of truth. The non-host platforms are
  *   built in CI / Docker; `--print-build` documents the exact incantations.
  *
  *   PREREQUISITE for the host build: run `build-hook-snapshot.mts` first (this
@@ -44,25 +66,91 @@
  *     node scripts/fleet/build-snapshot-launcher.mts --print-build  # show the
  *                                                                   #   per-platform
  *                                                                   #   Docker/CI recipe
+ *     node scripts/fleet/build-snapshot-launcher.mts --sidecars-only  # refreeze the
+ *                                                                     #   sidecars, no
+ *                                                                     #   recompile
  */
 
+import { safeDeleteSync } from '@socketsecurity/lib-stable/fs/safe'
 import { spawnSync } from '@socketsecurity/lib-stable/process/spawn/child'
 import crypto from 'node:crypto'
-import { existsSync, readFileSync, writeFileSync } from 'node:fs'
+import {
+  existsSync,
+  readFileSync,
+  readdirSync,
+  statSync,
+  writeFileSync,
+} from 'node:fs'
+import type { BigIntStats } from 'node:fs'
 import { createRequire } from 'node:module'
 import path from 'node:path'
 import process from 'node:process'
 
-import { DISPATCH_DIR } from './gen/hook-dispatch.mts'
+import {
+  DISPATCH_DIR,
+  FLEET_HOOKS_DIR,
+  buildHookIndex,
+  buildTriggerRules,
+} from './gen/hook-dispatch.mts'
+import type { EligibleHook } from './_shared/dispatch-scan.mts'
+import { collectEligibleHooks } from './_shared/dispatch-scan.mts'
 import { isMainModule } from './_shared/is-main-module.mts'
+import {
+  LAUNCH_MANIFEST_NAME,
+  encodeLaunchManifest,
+  eventLaunchManifestName,
+} from './_shared/launch-manifest.mts'
+import type { LaunchManifest } from './_shared/launch-manifest.mts'
+import {
+  gcSnapshotStore,
+  registerCheckout,
+  storeBudgetBytes,
+  storeKeepSet,
+} from './_shared/snapshot-store.mts'
 
 const require = createRequire(import.meta.url)
-const { blobPath } = require(
-  path.join(DISPATCH_DIR, 'snapshot-cache-path.cjs'),
-) as { blobPath: (entryId: string, sourceHash: string) => string }
+const {
+  DAEMON_SLOTS,
+  bootBlob,
+  daemonSocketBase,
+  eventEntryId,
+  snapshotCacheDir,
+  splitBundleEvents,
+  splitBundleName,
+} = require(path.join(DISPATCH_DIR, 'snapshot-cache-path.cjs')) as {
+  DAEMON_SLOTS: number
+  bootBlob: (entryId: string, sourceHash: string) => BootBlob
+  daemonSocketBase: (dispatchDir: string) => string
+  snapshotCacheDir: () => string
+  eventEntryId: (event: string) => string
+  splitBundleEvents: (dispatchDir: string) => string[]
+  splitBundleName: (event: string) => string
+}
+
+interface BootBlob {
+  readonly blob: string
+  readonly nodeFlags: readonly string[]
+  readonly tunedFlags: number
+}
 
-const POSIX_SRC = path.join(DISPATCH_DIR, 'dispatch-launcher.c')
-const WIN_SRC = path.join(DISPATCH_DIR, 'dispatch-launcher-win.c')
+// Each launcher's translation units, main first; they compile into one
+// binary. The tool pre-flight scan is shared between the two.
+export const POSIX_SRCS: readonly string[] = [
+  'dispatch-launcher.c',
+  'dispatch-launcher-manifest.c',
+  'dispatch-launcher-daemon.c',
+  'dispatch-launcher-store.c',
+  'dispatch-launcher-trace.c',
+  'dispatch-launcher-preflight.c',
+]
+export const WIN_SRCS: readonly string[] = [
+  'dispatch-launcher-win.c',
+  'dispatch-launcher-win-manifest.c',
+  'dispatch-launcher-win-daemon.c',
+  'dispatch-launcher-win-store.c',
+  'dispatch-launcher-win-trace.c',
+  'dispatch-launcher-preflight.c',
+]
 const SNAPSHOT_BUNDLE = path.join(DISPATCH_DIR, 'snapshot-bundle.cjs')
 
 /**
@@ -87,37 +175,43 @@ HOST (mac/linux/windows): this script auto-detects and builds for the host.
   node scripts/fleet/build-hook-snapshot.mts        # build the blob (host node)
   node scripts/fleet/build-snapshot-launcher.mts    # build the host launcher
 
---- POSIX cross/CI targets (dispatch-launcher.c, execv) ---
+--- POSIX cross/CI targets (dispatch-launcher.c + units, execv) ---
+
+POSIX sources (run from _dispatch/):
+  $POSIX = ${POSIX_SRCS.join(' ')}
 
 darwin-arm64 / darwin-x64 (from a mac host — fat universal in one cc):
-  cc -O2 -arch arm64 -arch x86_64 -o dispatch-launcher dispatch-launcher.c
+  cc -O2 -arch arm64 -arch x86_64 -o dispatch-launcher $POSIX
 
 linux-x64  (Docker, native on an amd64 runner; QEMU on an arm64 host):
-  docker run --rm --platform linux/amd64 -v "$DISPATCH":/d node:22-bookworm \\
+  docker run --rm --platform linux/amd64 -v "$DISPATCH":/d -w /d node:22-bookworm \\
     bash -c 'apt-get update -qq && apt-get install -y -qq gcc &&
-             cc -O2 -o /d/dispatch-launcher /d/dispatch-launcher.c'
+             cc -O2 -o dispatch-launcher $POSIX'
 
 linux-arm64  (Docker, native on an arm64 runner):
-  docker run --rm --platform linux/arm64 -v "$DISPATCH":/d node:22-bookworm \\
+  docker run --rm --platform linux/arm64 -v "$DISPATCH":/d -w /d node:22-bookworm \\
     bash -c 'apt-get update -qq && apt-get install -y -qq gcc &&
-             cc -O2 -o /d/dispatch-launcher /d/dispatch-launcher.c'
+             cc -O2 -o dispatch-launcher $POSIX'
 
   (musl: node:22-alpine + apk add gcc musl-dev.)
 
---- Windows targets (dispatch-launcher-win.c, CreateProcess + wait) ---
+--- Windows targets (dispatch-launcher-win.c + units, CreateProcess + wait) ---
+
+Windows sources (run from _dispatch\\):
+  $WIN = ${WIN_SRCS.join(' ')}
 
 win32-x64  (mingw cross from a POSIX host — PROVEN):
   x86_64-w64-mingw32-gcc -O2 -municode -DUNICODE -D_UNICODE \\
-    -o dispatch-launcher.exe dispatch-launcher-win.c
+    -o dispatch-launcher.exe $WIN
 
 win32-x86  (mingw cross):
   i686-w64-mingw32-gcc   -O2 -municode -DUNICODE -D_UNICODE \\
-    -o dispatch-launcher.exe dispatch-launcher-win.c
+    -o dispatch-launcher.exe $WIN
 
 win32-arm64  (NO mingw toolchain on a typical posix host -> build on the
   windows-latest CI runner with MSVC, or a win-arm64 cross-SDK):
-  cl /O2 /DUNICODE /D_UNICODE dispatch-launcher-win.c /Fe:dispatch-launcher.exe ^
-     kernel32.lib
+  cl /O2 /DUNICODE /D_UNICODE $WIN /Fe:dispatch-launcher.exe ^
+     kernel32.lib advapi32.lib
 
 PERF NOTE (Windows): the native launcher removes the loader's full PARENT-node
 startup, but — unlike POSIX execv — it does NOT eliminate the parent process; it
@@ -127,6 +221,9 @@ the tax is CI-confirm-only (no Windows on the build host). If CI shows the win
 does NOT hold, Windows takes the compile-cache fallback (point settings.json at
 \`node index.cjs <Event>\`) — correctness is identical, the snapshot is dropped
 only as the perf path. Fail-open guarantees correctness on every platform.
+With the opt-in warm daemon running (\`hook-daemon.mts start\`) the launcher
+creates no node process at all: it relays the event over a per-user named pipe
+to an already-booted worker, which removes the CreateProcess tax outright.
 `.trim()
 
 export interface CompilerPlan {
@@ -139,7 +236,7 @@ export interface CompilerPlan {
  * (prefer gcc when present), plain `cc` everywhere else.
  */
 export function selectCompiler(
-  src: string,
+  srcs: readonly string[],
   outBin: string,
   config: { haveGcc: boolean; isWin: boolean },
 ): CompilerPlan {
@@ -154,7 +251,7 @@ export function selectCompiler(
             '-D_UNICODE',
             '-o',
             outBin,
-            src,
+            ...srcs,
           ],
           cc: 'gcc',
         }
@@ -163,22 +260,30 @@ export function selectCompiler(
             '/O2',
             '/DUNICODE',
             '/D_UNICODE',
-            src,
+            ...srcs,
             `/Fe:${outBin}`,
             'kernel32.lib',
+            // The warm-daemon pipe-owner check (OpenProcessToken et al.).
+            'advapi32.lib',
           ],
           cc: 'cl',
         }
   }
-  return { args: ['-O2', '-o', outBin, src], cc: 'cc' }
+  return { args: ['-O2', '-o', outBin, ...srcs], cc: 'cc' }
 }
 
-export type LauncherAction = 'build' | 'missing-bundle' | 'print-build'
+export type LauncherAction =
+  | 'build'
+  | 'missing-bundle'
+  | 'print-build'
+  | 'sidecars'
 
 /**
  * Decide which top-level action `main()` takes: `--print-build` short-circuits
  * before anything else is checked, then a missing snapshot bundle blocks the
  * build (the prerequisite `build-hook-snapshot.mts` step hasn't run yet).
+ * `--sidecars-only` refreezes the sidecars without recompiling — the
+ * launcher's own self-heal runs it while that very binary may be executing.
  */
 export function planLauncherAction(
   argv: readonly string[],
@@ -191,7 +296,7 @@ export function planLauncherAction(
   if (!cfg.bundleExists) {
     return 'missing-bundle'
   }
-  return 'build'
+  return argv.includes('--sidecars-only') ? 'sidecars' : 'build'
 }
 
 /**
@@ -199,13 +304,16 @@ export function planLauncherAction(
  */
 function buildHostLauncher(): boolean {
   const isWin = process.platform === 'win32'
-  const src = isWin ? WIN_SRC : POSIX_SRC
+  const srcs = (isWin ? WIN_SRCS : POSIX_SRCS).map(f =>
+    path.join(DISPATCH_DIR, f),
+  )
   const outBin = path.join(
     DISPATCH_DIR,
     isWin ? 'dispatch-launcher.exe' : 'dispatch-launcher',
   )
-  if (!existsSync(src)) {
-    process.stderr.write(`launcher source missing: ${src}\n`)
+  const missing = srcs.find(src => !existsSync(src))
+  if (missing) {
+    process.stderr.write(`launcher source missing: ${missing}\n`)
     return false
   }
 
@@ -213,7 +321,7 @@ function buildHostLauncher(): boolean {
   // is the simplest; MSVC `cl` is the CI default. Prefer gcc if present.
   const haveGcc =
     isWin && spawnSync('gcc', ['--version'], { stdio: 'ignore' }).status === 0
-  const { args, cc } = selectCompiler(src, outBin, { haveGcc, isWin })
+  const { args, cc } = selectCompiler(srcs, outBin, { haveGcc, isWin })
 
   const r = spawnSync(cc, args, { stdio: 'inherit' })
   if (r.status !== 0 || !existsSync(outBin)) {
@@ -224,21 +332,183 @@ function buildHostLauncher(): boolean {
   return true
 }
 
+// First line of hook-tools.map; the launcher ignores a file without it (torn
+// write, older format), which only costs it the pre-flight.
+export const HOOK_TOOLS_MAGIC = '# fleet hook-tools v1'
+
 /**
- * Freeze node.path + snapshot-blob.path next to the launcher.
+ * Render the launcher's tool pre-flight map: one `<Event> <tool> <tool>…`
+ * line per event with at least one hook, or `<Event> *` when any hook for the
+ * event declares no tools (it handles every tool, and a payload with no
+ * `tool_name`). Read off `buildHookIndex`, the same (event, tool) index the
+ * dispatch table's `DISPATCH_INDEX` is rendered from: an event that is
+ * absent, or whose list lacks the payload's tool, has no hook that can fire.
+ * Then one `?<Event> <tool>\t<trigger>\t…` line per `buildTriggerRules`
+ * rule: that tool's hooks can only fire when a trigger occurs in the raw
+ * payload. A `?` line matches no event, so a launcher that predates the rules
+ * just skips them. Sorted, so an unchanged hook set rewrites identical bytes.
  */
-function writeSidecars(): void {
-  const sourceHash = crypto
+export function renderHookToolsMap(hooks: readonly EligibleHook[]): string {
+  const index = buildHookIndex(hooks)
+  const lines = [...index.keys()].toSorted().map(event => {
+    const { any, byTool } = index.get(event)!
+    const tools = any.length ? '*' : [...byTool.keys()].toSorted().join(' ')
+    return `${event} ${tools}`
+  })
+  for (const { event, tool, triggers } of buildTriggerRules(hooks)) {
+    lines.push(`?${event} ${tool}\t${triggers.join('\t')}`)
+  }
+  return `${HOOK_TOOLS_MAGIC}\n${lines.map(l => `${l}\n`).join('')}`
+}
+
+/**
+ * The launch manifest for the blob at `blobOut`: node + blob paths, the
+ * blob's size / mtime / inode as the launcher will `stat` them, the bundle
+ * hash, and the node flags the blob was built under (the tuned profile's
+ * only when `bootBlob` found the tuned blob, so the launcher never boots
+ * node with a flag it wasn't built, or couldn't start, under). `tunedFlags`
+ * counts the profile's share; non-zero, the launcher waits on the boot and
+ * reruns the event through index.cjs when node rejects them. A blob that
+ * isn't there yet encodes as size 0, which the launcher reads as "no fast
+ * path" (index.cjs fail-open).
+ */
+export function buildLaunchManifest(
+  blobOut: string,
+  bundleHash: string,
+  nodeFlags: readonly string[],
+  tunedFlags = 0,
+): Buffer | undefined {
+  let st: BigIntStats | undefined
+  try {
+    st = statSync(blobOut, { bigint: true })
+  } catch {
+    st = undefined
+  }
+  return encodeLaunchManifest({
+    __proto__: null,
+    blobIno: st?.ino ?? 0n,
+    blobMtimeNs: st?.mtimeNs ?? 0n,
+    blobPath: blobOut,
+    blobSize: st?.size ?? 0n,
+    bundleHash,
+    nodeFlags,
+    nodePath: process.execPath,
+    tunedFlags,
+  } as LaunchManifest)
+}
+
+function bundleHash(bundlePath: string): string {
+  return crypto
     .createHash('sha256')
-    .update(readFileSync(SNAPSHOT_BUNDLE))
+    .update(readFileSync(bundlePath))
     .digest('hex')
     .slice(0, 16)
-  const blobOut = blobPath('dispatch', sourceHash)
-  writeFileSync(path.join(DISPATCH_DIR, 'node.path'), `${process.execPath}\n`)
-  writeFileSync(path.join(DISPATCH_DIR, 'snapshot-blob.path'), `${blobOut}\n`)
+}
+
+/**
+ * One `launch.<Event>.manifest` per split bundle `build-hook-snapshot.mts
+ * --split-events` left behind, and none for any other event: a manifest
+ * outliving its split bundle would keep booting that bundle's old blob,
+ * which is still intact on disk. Returns the events written.
+ */
+function writeEventManifests(): string[] {
+  const written: string[] = []
+  for (const event of splitBundleEvents(DISPATCH_DIR)) {
+    const hash = bundleHash(path.join(DISPATCH_DIR, splitBundleName(event)))
+    const boot = bootBlob(eventEntryId(event), hash)
+    const manifest = buildLaunchManifest(
+      boot.blob,
+      hash,
+      boot.nodeFlags,
+      boot.tunedFlags,
+    )
+    if (manifest) {
+      writeFileSync(
+        path.join(DISPATCH_DIR, eventLaunchManifestName(event)),
+        manifest,
+      )
+      written.push(event)
+    }
+  }
+  const keep = new Set(written.map(eventLaunchManifestName))
+  for (const name of readdirSync(DISPATCH_DIR)) {
+    if (
+      name !== LAUNCH_MANIFEST_NAME &&
+      /^launch\..+\.manifest$/.test(name) &&
+      !keep.has(name)
+    ) {
+      safeDeleteSync(path.join(DISPATCH_DIR, name), { force: true })
+    }
+  }
+  return written
+}
+
+/**
+ * Freeze launch.manifest (+ one per split event) + daemon.path +
+ * hook-tools.map next to the launcher.
+ */
+function writeSidecars(): boolean {
+  const sourceHash = bundleHash(SNAPSHOT_BUNDLE)
+  const {
+    blob: blobOut,
+    nodeFlags,
+    tunedFlags,
+  } = bootBlob('dispatch', sourceHash)
+  const manifest = buildLaunchManifest(
+    blobOut,
+    sourceHash,
+    nodeFlags,
+    tunedFlags,
+  )
+  if (!manifest) {
+    process.stderr.write(
+      `launch manifest: node or blob path too long for its field ` +
+        `(${process.execPath}, ${blobOut}).\n`,
+    )
+    return false
+  }
+  writeFileSync(path.join(DISPATCH_DIR, LAUNCH_MANIFEST_NAME), manifest)
+  // The text sidecars the manifest replaced: a launcher built from older
+  // source would still trust them, so they must not outlive their blob.
+  for (const legacy of ['node.path', 'snapshot-blob.path']) {
+    safeDeleteSync(path.join(DISPATCH_DIR, legacy), { force: true })
+  }
+  // The hash rides along so a daemon still serving the PREVIOUS bundle answers
+  // 'S' (stale) and the launcher falls through to the fresh blob.
+  const socketBase = daemonSocketBase(DISPATCH_DIR)
+  const daemonLine = `${sourceHash} ${DAEMON_SLOTS} ${socketBase}`
+  writeFileSync(path.join(DISPATCH_DIR, 'daemon.path'), `${daemonLine}\n`)
+  const splitEvents = writeEventManifests()
+  // With every manifest frozen, sweep the blob store: LRU under the byte
+  // budget, never a blob a manifest (just written, or another registered
+  // checkout's in a shared store) names.
+  const storeRoot = path.dirname(snapshotCacheDir())
+  registerCheckout(storeRoot, DISPATCH_DIR)
+  const gc = gcSnapshotStore(
+    storeRoot,
+    storeKeepSet(storeRoot, DISPATCH_DIR),
+    storeBudgetBytes(),
+  )
+  const hooks = collectEligibleHooks(FLEET_HOOKS_DIR)
+  writeFileSync(
+    path.join(DISPATCH_DIR, 'hook-tools.map'),
+    renderHookToolsMap(hooks),
+  )
+  const triggerRules = buildTriggerRules(hooks).length
   process.stdout.write(
-    `  node.path=${process.execPath}\n  snapshot-blob.path=${blobOut}\n`,
+    `  ${LAUNCH_MANIFEST_NAME}: node=${process.execPath}\n` +
+      `    blob=${blobOut}\n` +
+      `    flags=${nodeFlags.join(' ') || '(none)'}` +
+      `${tunedFlags ? ` (${tunedFlags} tuned)` : ''}\n` +
+      `  split events=${splitEvents.join(' ') || '(none)'}\n` +
+      `  blob store: evicted ${gc.evicted.length} ` +
+      `(${(gc.freedBytes / 1048576).toFixed(1)} MB), ` +
+      `${(gc.keptBytes / 1048576).toFixed(1)} MB kept\n` +
+      `  daemon.path=${daemonLine}\n` +
+      `  hook-tools.map=${hooks.length} hooks, ` +
+      `${triggerRules} trigger rule${triggerRules === 1 ? '' : 's'}\n`,
   )
+  return true
 }
 
 function main(): void {
@@ -256,11 +526,17 @@ function main(): void {
     process.exitCode = 2
     return
   }
-  if (!buildHostLauncher()) {
+  if (action === 'build' && !buildHostLauncher()) {
     process.exitCode = 1
     return
   }
-  writeSidecars()
+  if (!writeSidecars()) {
+    process.exitCode = 1
+    return
+  }
+  if (action === 'sidecars') {
+    return
+  }
   process.stdout.write(
     `\nNon-host platforms are built in Docker/CI — run with --print-build for the recipe.\n`,
   )
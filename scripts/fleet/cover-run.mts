@@ -12,7 +12,6 @@ import {
   existsSync,
   mkdirSync,
   readdirSync,
-  readFileSync,
   statSync,
 } from 'node:fs'
 import os from 'node:os'
@@ -43,6 +42,12 @@ import {
   REPO_ROOT,
 } from './paths.mts'
 import { resolveCoverageConfig } from '../../.config/fleet/vitest.coverage.fleet.config.mts'
+import {
+  LEDGER_TTL_MS,
+  listOtherActorLedgerPaths,
+  readActorLedger,
+  resolveStoreRoot,
+} from '../../.claude/hooks/fleet/_shared/active-edits-ledger.mts'
 import type { EnvSnapshot, SuiteResult, TestSuitesResult } from './cover.mts'
 
 const rootPath = REPO_ROOT
@@ -191,43 +196,24 @@ export function captureEnvSnapshot(): EnvSnapshot {
 // "foreign" from the run's perspective.
 export function collectLiveActorNotes(windowMs: number): string[] {
   const out: string[] = []
-  try {
-    const dir = path.join(
-      rootPath,
-      'node_modules',
-      '.cache',
-      'fleet',
-      'socket-active-edits',
-    )
-    for (const entry of readdirSync(dir)) {
-      if (!entry.endsWith('.json')) {
-        continue
-      }
-      try {
-        const parsed = JSON.parse(
-          readFileSync(path.join(dir, entry), 'utf8'),
-        ) as {
-          actorId?: string | undefined
-          paths?: Record<string, number> | undefined
-          updatedAt?: number | undefined
-        }
-        const updatedAt = parsed.updatedAt ?? 0
-        const age = Date.now() - updatedAt
-        if (age > windowMs) {
-          continue
-        }
-        const repoPaths = Object.keys(parsed.paths ?? {}).filter(p =>
-          p.startsWith(rootPath),
-        )
-        out.push(
-          `actor ${String(parsed.actorId).slice(0, 8)} last edited ${Math.round(age / 60_000)}min ago (${repoPaths.length} path(s) in this repo)`,
-        )
-      } catch {
-        // Unreadable ledger entry — skip it.
-      }
+  const now = Date.now()
+  const ledgers = listOtherActorLedgerPaths(resolveStoreRoot(rootPath), '')
+  for (let i = 0, { length } = ledgers; i < length; i += 1) {
+    // Unreadable ledger entries read as undefined and are skipped.
+    const ledger = readActorLedger(ledgers[i]!, now - LEDGER_TTL_MS)
+    if (!ledger) {
+      continue
     }
-  } catch {
-    // No ledger dir — nothing to report.
+    const age = now - ledger.updatedAt
+    if (age > windowMs) {
+      continue
+    }
+    const repoPaths = Object.keys(ledger.paths).filter(p =>
+      p.startsWith(rootPath),
+    )
+    out.push(
+      `actor ${ledger.actorId.slice(0, 8)} last edited ${Math.round(age / 60_000)}min ago (${repoPaths.length} path(s) in this repo)`,
+    )
   }
   return out
 }
@@ -0,0 +1,210 @@
+#!/usr/bin/env node
+/*
+ * @file List the slowest dispatched hooks per event + tool, from the
+ *   dispatcher's always-on latency histograms
+ *   (`node_modules/.cache/fleet/dispatch-profile/`).
+ *
+ *   Every event `dispatchRaw` runs logs each hook's wall time as a log2
+ *   bucket (layout + writer: `.claude/hooks/fleet/_dispatch/
+ *   dispatch-profile.mts`); the histogram is decayed so the numbers reflect
+ *   roughly the last couple of thousand runs of each hook, and samples not
+ *   yet folded into it are counted too. Percentiles are bucket upper
+ *   bounds, so read them as "at most": a p95 of 0.26 ms means the hook's
+ *   95th-percentile run took between 0.13 and 0.26 ms.
+ *
+ *   Usage:
+ *     node scripts/fleet/dispatch-profile-report.mts [dir] [--event <Event>]
+ *       [--tool <Tool>] [--top <n>] [--json]
+ *   `dir` defaults to this repo's profile dir. `--top` caps the rows per
+ *   event + tool (slowest p95 first, default 10; 0 lists every hook).
+ */
+
+import process from 'node:process'
+
+import { getDefaultLogger } from '@socketsecurity/lib-stable/logger/default'
+
+import {
+  PROFILE_ENV,
+  loadProfile,
+  profileDir,
+  profileQuantile,
+} from '../../.claude/hooks/fleet/_dispatch/dispatch-profile.mts'
+import type { ProfileStore } from '../../.claude/hooks/fleet/_dispatch/dispatch-profile.mts'
+import { isMainModule } from './_shared/is-main-module.mts'
+import { runMain } from './_shared/run-main.mts'
+import { REPO_ROOT } from './paths.mts'
+
+const logger = getDefaultLogger()
+
+export interface HookLatency {
+  readonly count: number
+  readonly hook: string
+  readonly p50Ms: number
+  readonly p95Ms: number
+  readonly p99Ms: number
+}
+
+export interface ToolReport {
+  readonly event: string
+  readonly hooks: readonly HookLatency[]
+  readonly tool: string
+}
+
+interface Args {
+  readonly event: string | undefined
+  readonly json: boolean
+  readonly dir: string
+  readonly tool: string | undefined
+  readonly top: number
+}
+
+/**
+ * One report per (event, tool), events and tools by name, hooks slowest p95
+ * first (ties by p99, then name).
+ */
+export function summarizeProfile(
+  store: ProfileStore,
+  filter: { event?: string | undefined; tool?: string | undefined },
+  top: number,
+): ToolReport[] {
+  const reports: ToolReport[] = []
+  for (const event of Object.keys(store.events).sort()) {
+    if (filter.event && event !== filter.event) {
+      continue
+    }
+    const byTool = store.events[event]!
+    for (const tool of Object.keys(byTool).sort()) {
+      if (filter.tool && tool !== filter.tool) {
+        continue
+      }
+      const rows = byTool[tool]!
+      const hooks: HookLatency[] = []
+      for (const hook of Object.keys(rows)) {
+        const counts = rows[hook]!
+        let count = 0
+        for (let i = 0, { length } = counts; i < length; i += 1) {
+          count += counts[i]!
+        }
+        if (!count) {
+          continue
+        }
+        hooks.push({
+          __proto__: null,
+          count,
+          hook,
+          p50Ms: profileQuantile(counts, 50) / 1e3,
+          p95Ms: profileQuantile(counts, 95) / 1e3,
+          p99Ms: profileQuantile(counts, 99) / 1e3,
+        } as HookLatency)
+      }
+      hooks.sort(
+        (a, b) =>
+          b.p95Ms - a.p95Ms ||
+          b.p99Ms - a.p99Ms ||
+          a.hook.localeCompare(b.hook),
+      )
+      reports.push({
+        __proto__: null,
+        event,
+        hooks: top > 0 ? hooks.slice(0, top) : hooks,
+        tool,
+      } as ToolReport)
+    }
+  }
+  return reports
+}
+
+function parseArgs(argv: readonly string[]): Args | undefined {
+  let event: string | undefined
+  let json = false
+  let dir: string | undefined
+  let tool: string | undefined
+  let top = 10
+  for (let i = 0, { length } = argv; i < length; i += 1) {
+    const a = argv[i]!
+    if (a === '--json') {
+      json = true
+    } else if (a === '--event') {
+      event = argv[(i += 1)]
+    } else if (a === '--tool') {
+      tool = argv[(i += 1)]
+    } else if (a === '--top') {
+      top = Number(argv[(i += 1)])
+      if (!(top >= 0)) {
+        return undefined
+      }
+    } else if (!a.startsWith('--') && !dir) {
+      dir = a
+    } else {
+      return undefined
+    }
+  }
+  return {
+    __proto__: null,
+    dir: dir ?? profileDir(REPO_ROOT),
+    event,
+    json,
+    tool,
+    top,
+  } as Args
+}
+
+function ms(n: number): string {
+  return n.toFixed(3).padStart(9)
+}
+
+function main(): number {
+  const args = parseArgs(process.argv.slice(2))
+  if (!args) {
+    logger.error(
+      'Usage: dispatch-profile-report.mts [dir] [--event <Event>] ' +
+        '[--tool <Tool>] [--top <n>] [--json]',
+    )
+    return 2
+  }
+  const store = loadProfile(args.dir)
+  if (!store) {
+    logger.error(
+      `No hook latency samples under ${args.dir} — run some hooks first ` +
+        `(recording is off while ${PROFILE_ENV}=0).`,
+    )
+    return 1
+  }
+  const reports = summarizeProfile(
+    store,
+    { __proto__: null, event: args.event, tool: args.tool } as {
+      event?: string | undefined
+      tool?: string | undefined
+    },
+    args.top,
+  )
+  if (args.json) {
+    logger.log(JSON.stringify(reports, undefined, 2))
+    return 0
+  }
+  if (!reports.length) {
+    logger.log('No hook latency samples yet.')
+    return 0
+  }
+  for (let i = 0, { length } = reports; i < length; i += 1) {
+    const report = reports[i]!
+    const width = Math.max(4, ...report.hooks.map(h => h.hook.length))
+    logger.log(`${report.event} ${report.tool}`)
+    logger.log(
+      `  ${'hook'.padEnd(width)}  ${'n'.padStart(6)}` +
+        ['p50 ms', 'p95 ms', 'p99 ms'].map(h => ` ${h.padStart(9)}`).join(''),
+    )
+    for (let j = 0, { length: n } = report.hooks; j < n; j += 1) {
+      const h = report.hooks[j]!
+      logger.log(
+        `  ${h.hook.padEnd(width)}  ${String(h.count).padStart(6)}` +
+          ` ${ms(h.p50Ms)} ${ms(h.p95Ms)} ${ms(h.p99Ms)}`,
+      )
+    }
+  }
+  return 0
+}
+
+if (isMainModule(import.meta.url)) {
+  runMain(main)
+}
@@ -0,0 +1,365 @@
+#!/usr/bin/env node
+/*
+ * @file Replay recorded hook events through the dispatcher's batch mode
+ *   (`.claude/hooks/fleet/_dispatch/dispatch-batch.mts`) — one warm process
+ *   per build instead of one process per event — and report per-hook cost,
+ *   or the verdicts that changed between two builds.
+ *
+ *   Inputs are NDJSON files of `{ event, payload }` records and/or Claude
+ *   transcripts (`~/.claude/projects/<project>/<session>.jsonl`), which the
+ *   batch mode replays into their PreToolUse / PostToolUse / Stop events.
+ *   Hooks that write runtime state (`stateful` in the dispatch table) are
+ *   skipped, so a replay never touches the live project's ledgers; their
+ *   verdicts aren't part of a diff.
+ *
+ *   A build is an `index.cjs` loader (or any `.cjs` / `.js` / `.mjs` entry),
+ *   run under this node, or a snapshot blob, booted under the node + flags
+ *   of this checkout's `launch.manifest`. The default is the blob the
+ *   manifest names, else `.claude/hooks/fleet/index.cjs`.
+ *
+ *   The timing summary puts each hook's FIRST run (module init + cold JIT)
+ *   apart from the rest, so the warm columns are steady-state cost with
+ *   startup factored out. `--against` runs a second build over the same
+ *   input and lists every record whose exit code, stdout or stderr differs;
+ *   it exits 1 when any does.
+ *
+ *   Usage:
+ *     node scripts/fleet/dispatch-replay.mts <input…> [--build <build>]
+ *       [--against <build>] [--top <n>] [--json]
+ */
+
+import { readFileSync } from 'node:fs'
+import path from 'node:path'
+import process from 'node:process'
+
+import { getDefaultLogger } from '@socketsecurity/lib-stable/logger/default'
+import { spawnSync } from '@socketsecurity/lib-stable/process/spawn/child'
+
+import { BATCH_ARG } from '../../.claude/hooks/fleet/_dispatch/dispatch-batch.mts'
+import type { BatchResult } from '../../.claude/hooks/fleet/_dispatch/dispatch-batch.mts'
+import { isMainModule } from './_shared/is-main-module.mts'
+import {
+  LAUNCH_MANIFEST_NAME,
+  decodeLaunchManifest,
+} from './_shared/launch-manifest.mts'
+import type { LaunchManifest } from './_shared/launch-manifest.mts'
+import { runMain } from './_shared/run-main.mts'
+import { DISPATCH_DIR, FLEET_HOOKS_DIR, REPO_ROOT } from './paths.mts'
+
+const logger = getDefaultLogger()
+
+// Batch output for a long session replay runs to hundreds of MB of stderr
+// text; the default 1 MB cap would truncate it.
+const MAX_OUTPUT = 1024 * 1024 * 1024
+
+export interface HookCost {
+  readonly coldMs: number
+  readonly hook: string
+  readonly runs: number
+  readonly totalMs: number
+  readonly warmMeanMs: number
+  readonly warmP95Ms: number
+}
+
+export interface BatchSummary {
+  readonly firstRecordMs: number
+  readonly hooks: readonly HookCost[]
+  readonly records: number
+  readonly warmRecordMeanMs: number
+}
+
+export interface VerdictDiff {
+  readonly a: BatchResult | undefined
+  readonly b: BatchResult | undefined
+  readonly fields: readonly string[]
+  readonly i: number
+}
+
+interface Args {
+  readonly against: string | undefined
+  readonly build: string | undefined
+  readonly inputs: readonly string[]
+  readonly json: boolean
+  readonly top: number
+}
+
+function mean(values: readonly number[]): number {
+  let sum = 0
+  for (let i = 0, { length } = values; i < length; i += 1) {
+    sum += values[i]!
+  }
+  return values.length ? sum / values.length : 0
+}
+
+function p95(values: readonly number[]): number {
+  if (!values.length) {
+    return 0
+  }
+  const sorted = [...values].sort((x, y) => x - y)
+  return sorted[Math.max(0, Math.ceil(0.95 * sorted.length) - 1)]!
+}
+
+/**
+ * Per-hook cost over one batch run, slowest warm mean first (ties by name).
+ * Each hook's first run is its cold sample; the rest are warm.
+ */
+export function summarizeBatch(
+  results: readonly BatchResult[],
+  top: number,
+): BatchSummary {
+  const byHook = new Map<string, number[]>()
+  for (let i = 0, { length } = results; i < length; i += 1) {
+    const { hooks } = results[i]!
+    for (let j = 0, { length: n } = hooks; j < n; j += 1) {
+      const { 0: name, 1: us } = hooks[j]!
+      let list = byHook.get(name)
+      if (!list) {
+        list = []
+        byHook.set(name, list)
+      }
+      list.push(us / 1e3)
+    }
+  }
+  const hooks: HookCost[] = []
+  for (const { 0: hook, 1: runs } of byHook) {
+    const warm = runs.slice(1)
+    hooks.push({
+      __proto__: null,
+      coldMs: runs[0]!,
+      hook,
+      runs: runs.length,
+      totalMs: runs.reduce((sum, ms) => sum + ms, 0),
+      warmMeanMs: mean(warm),
+      warmP95Ms: p95(warm),
+    } as HookCost)
+  }
+  hooks.sort(
+    (x, y) => y.warmMeanMs - x.warmMeanMs || x.hook.localeCompare(y.hook),
+  )
+  return {
+    __proto__: null,
+    firstRecordMs: results.length ? results[0]!.us / 1e3 : 0,
+    hooks: top > 0 ? hooks.slice(0, top) : hooks,
+    records: results.length,
+    warmRecordMeanMs: mean(results.slice(1).map(r => r.us / 1e3)),
+  } as BatchSummary
+}
+
+/**
+ * Every record whose rendered verdict differs between two runs over the same
+ * input, matched by record index; a record only one run has lists the run
+ * that lacks it as undefined.
+ */
+export function diffVerdicts(
+  a: readonly BatchResult[],
+  b: readonly BatchResult[],
+): VerdictDiff[] {
+  const diffs: VerdictDiff[] = []
+  for (let i = 0, n = Math.max(a.length, b.length); i < n; i += 1) {
+    const x = a[i]
+    const y = b[i]
+    const fields: string[] = []
+    if (!x || !y) {
+      fields.push('record')
+    } else {
+      for (const field of ['exitCode', 'stdout', 'stderr'] as const) {
+        if (x[field] !== y[field]) {
+          fields.push(field)
+        }
+      }
+    }
+    if (fields.length) {
+      diffs.push({ __proto__: null, a: x, b: y, fields, i } as VerdictDiff)
+    }
+  }
+  return diffs
+}
+
+/**
+ * Parse batch-mode stdout; malformed lines are skipped.
+ */
+export function parseBatchOutput(text: string): BatchResult[] {
+  const out: BatchResult[] = []
+  const lines = text.split('\n')
+  for (let i = 0, { length } = lines; i < length; i += 1) {
+    if (!lines[i]) {
+      continue
+    }
+    try {
+      const value = JSON.parse(lines[i]!) as BatchResult
+      if (typeof value?.i === 'number' && Array.isArray(value.hooks)) {
+        out.push(value)
+      }
+    } catch {}
+  }
+  return out
+}
+
+function readManifest(): LaunchManifest | undefined {
+  try {
+    return decodeLaunchManifest(
+      readFileSync(path.join(DISPATCH_DIR, LAUNCH_MANIFEST_NAME)),
+    )
+  } catch {
+    return undefined
+  }
+}
+
+/**
+ * The argv that runs `build` (undefined = this checkout's default) in batch
+ * mode, minus the inputs.
+ */
+export function buildCommand(
+  build: string | undefined,
+  manifest: LaunchManifest | undefined,
+): readonly string[] {
+  const target =
+    build ?? manifest?.blobPath ?? path.join(FLEET_HOOKS_DIR, 'index.cjs')
+  if (/\.[cm]?js$/.test(target)) {
+    return [process.execPath, path.resolve(target), BATCH_ARG]
+  }
+  // The blob only boots under the node + flags it was built with.
+  return [
+    manifest?.nodePath || process.execPath,
+    ...(manifest?.nodeFlags ?? []),
+    '--snapshot-blob',
+    path.resolve(target),
+    BATCH_ARG,
+  ]
+}
+
+function runBuild(
+  command: readonly string[],
+  inputs: readonly string[],
+): BatchResult[] | undefined {
+  const result = spawnSync(
+    command[0]!,
+    [...command.slice(1), ...inputs.map(f => path.resolve(f))],
+    { cwd: REPO_ROOT, encoding: 'utf8', maxBuffer: MAX_OUTPUT },
+  )
+  if (result.status !== 0) {
+    logger.error(
+      `${command.join(' ')} exited ${String(result.status)}: ` +
+        `${String(result.stderr ?? '').trim()}`,
+    )
+    return undefined
+  }
+  return parseBatchOutput(String(result.stdout ?? ''))
+}
+
+function parseArgs(argv: readonly string[]): Args | undefined {
+  let against: string | undefined
+  let build: string | undefined
+  const inputs: string[] = []
+  let json = false
+  let top = 15
+  for (let i = 0, { length } = argv; i < length; i += 1) {
+    const a = argv[i]!
+    if (a === '--json') {
+      json = true
+    } else if (a === '--build') {
+      build = argv[(i += 1)]
+    } else if (a === '--against') {
+      against = argv[(i += 1)]
+    } else if (a === '--top') {
+      top = Number(argv[(i += 1)])
+      if (!(top >= 0)) {
+        return undefined
+      }
+    } else if (!a.startsWith('--')) {
+      inputs.push(a)
+    } else {
+      return undefined
+    }
+  }
+  if (!inputs.length) {
+    return undefined
+  }
+  return { __proto__: null, against, build, inputs, json, top } as Args
+}
+
+function ms(n: number): string {
+  return n.toFixed(3).padStart(9)
+}
+
+function logSummary(label: string, summary: BatchSummary): void {
+  logger.log(
+    `${label}: ${summary.records} records, ` +
+      `first ${summary.firstRecordMs.toFixed(1)} ms, ` +
+      `warm mean ${summary.warmRecordMeanMs.toFixed(3)} ms`,
+  )
+  const width = Math.max(4, ...summary.hooks.map(h => h.hook.length))
+  logger.log(
+    `  ${'hook'.padEnd(width)}  ${'runs'.padStart(6)}` +
+      ['cold ms', 'warm ms', 'warm p95', 'total ms']
+        .map(h => ` ${h.padStart(9)}`)
+        .join(''),
+  )
+  for (let i = 0, { length } = summary.hooks; i < length; i += 1) {
+    const h = summary.hooks[i]!
+    logger.log(
+      `  ${h.hook.padEnd(width)}  ${String(h.runs).padStart(6)}` +
+        ` ${ms(h.coldMs)} ${ms(h.warmMeanMs)}` +
+        ` ${ms(h.warmP95Ms)} ${ms(h.totalMs)}`,
+    )
+  }
+}
+
+function main(): number {
+  const args = parseArgs(process.argv.slice(2))
+  if (!args) {
+    logger.error(
+      'Usage: dispatch-replay.mts <input…> [--build <build>] ' +
+        '[--against <build>] [--top <n>] [--json]',
+    )
+    return 2
+  }
+  const manifest = readManifest()
+  const a = runBuild(buildCommand(args.build, manifest), args.inputs)
+  if (!a) {
+    return 1
+  }
+  const b =
+    args.against === undefined
+      ? undefined
+      : runBuild(buildCommand(args.against, manifest), args.inputs)
+  if (args.against !== undefined && !b) {
+    return 1
+  }
+  const summaryA = summarizeBatch(a, args.top)
+  const summaryB = b ? summarizeBatch(b, args.top) : undefined
+  const diffs = b ? diffVerdicts(a, b) : []
+  if (args.json) {
+    logger.log(
+      JSON.stringify(
+        { __proto__: null, build: summaryA, against: summaryB, diffs },
+        undefined,
+        2,
+      ),
+    )
+    return diffs.length ? 1 : 0
+  }
+  logSummary('build', summaryA)
+  if (summaryB) {
+    logSummary('against', summaryB)
+    if (!diffs.length) {
+      logger.success(`Verdicts identical across ${a.length} records.`)
+      return 0
+    }
+    logger.warn(`${diffs.length} of ${a.length} records changed verdict:`)
+    for (let i = 0, { length } = diffs; i < length; i += 1) {
+      const d = diffs[i]!
+      const rec = d.a ?? d.b!
+      logger.log(
+        `  #${d.i} ${rec.source} ${rec.event} ${rec.tool ?? ''}`.trimEnd() +
+          ` — ${d.fields.join(', ')}`,
+      )
+    }
+    return 1
+  }
+  return 0
+}
+
+if (isMainModule(import.meta.url)) {
+  runMain(main)
+}
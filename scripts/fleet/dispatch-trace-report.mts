@@ -0,0 +1,271 @@
+#!/usr/bin/env node
+/*
+ * @file Summarize a hook-dispatch phase-trace ring: p50 / p95 / p99 per
+ *   phase, per event.
+ *
+ *   The ring is written only when `FLEET_DISPATCH_TRACE=<absolute path>` is
+ *   set in the hook environment: the native launcher stamps its own phases
+ *   (`trace-open`, `self-locate`, `manifest`, `heal`, `preflight[-skip]`,
+ *   `daemon[-miss]`, `replay`, `prewarm`, and on Windows `child`), and node
+ *   appends `deserialize` / `boot` / `handoff` (launcher handoff → node
+ *   entry), `stdin`, `parse`, `dispatch`, and one `hook:<name>` per hook that
+ *   ran.
+ *   Layout + writer: `.claude/hooks/fleet/_dispatch/dispatch-trace.mts`.
+ *
+ *   `total` is synthesized per hook event: first record start → last record
+ *   end across every process that wrote under its trace id. The ring keeps
+ *   the most recent ~512 events; older ones are overwritten.
+ *
+ *   Usage:
+ *     node scripts/fleet/dispatch-trace-report.mts [ring] [--event <Event>]
+ *       [--hooks <n>] [--json]
+ *   `ring` defaults to $FLEET_DISPATCH_TRACE. `--hooks` caps the per-hook
+ *   rows per event (slowest p95 first, default 10; 0 hides them).
+ */
+
+import { readFileSync } from 'node:fs'
+import process from 'node:process'
+
+import { getDefaultLogger } from '@socketsecurity/lib-stable/logger/default'
+
+import {
+  TRACE_ENV,
+  decodeTraceRing,
+} from '../../.claude/hooks/fleet/_dispatch/dispatch-trace.mts'
+import type { TraceRecord } from '../../.claude/hooks/fleet/_dispatch/dispatch-trace.mts'
+import { isMainModule } from './_shared/is-main-module.mts'
+import { runMain } from './_shared/run-main.mts'
+
+const logger = getDefaultLogger()
+
+// Pipeline order for the fixed phases; hooks sort by p95 after them.
+const PHASE_ORDER: readonly string[] = [
+  'total',
+  'trace-open',
+  'self-locate',
+  'manifest',
+  'heal',
+  'preflight',
+  'preflight-skip',
+  'trigger-skip',
+  'daemon',
+  'daemon-miss',
+  'daemon-truncated',
+  'replay',
+  'prewarm',
+  'child',
+  'flags-rejected',
+  'deserialize',
+  'boot',
+  'handoff',
+  'stdin',
+  'parse',
+  'dispatch',
+]
+
+export interface PhaseStats {
+  readonly count: number
+  readonly p50Ms: number
+  readonly p95Ms: number
+  readonly p99Ms: number
+  readonly phase: string
+}
+
+export interface EventReport {
+  readonly event: string
+  readonly phases: readonly PhaseStats[]
+}
+
+interface Args {
+  readonly event: string | undefined
+  readonly hooks: number
+  readonly json: boolean
+  readonly ring: string | undefined
+}
+
+/**
+ * Nearest-rank percentile of an ascending-sorted sample.
+ */
+export function percentile(sorted: readonly number[], p: number): number {
+  if (!sorted.length) {
+    return 0
+  }
+  const rank = Math.ceil((p / 100) * sorted.length)
+  return sorted[Math.min(sorted.length, Math.max(1, rank)) - 1]!
+}
+
+function stats(phase: string, samplesMs: number[]): PhaseStats {
+  const sorted = samplesMs.sort((a, b) => a - b)
+  return {
+    __proto__: null,
+    count: sorted.length,
+    p50Ms: percentile(sorted, 50),
+    p95Ms: percentile(sorted, 95),
+    p99Ms: percentile(sorted, 99),
+    phase,
+  } as PhaseStats
+}
+
+/**
+ * Group decoded records into per-event phase percentiles, with the
+ * synthesized per-event `total`. Events sort by name.
+ */
+export function summarizeTrace(
+  records: readonly TraceRecord[],
+  hookRows: number,
+): EventReport[] {
+  // event → phase → samples (ms)
+  const samples = new Map<string, Map<string, number[]>>()
+  // trace id → [event, first start, last end]
+  const spans = new Map<bigint, [string, bigint, bigint]>()
+  for (let i = 0, { length } = records; i < length; i += 1) {
+    const rec = records[i]!
+    let phases = samples.get(rec.event)
+    if (!phases) {
+      phases = new Map()
+      samples.set(rec.event, phases)
+    }
+    let list = phases.get(rec.phase)
+    if (!list) {
+      list = []
+      phases.set(rec.phase, list)
+    }
+    list.push(Number(rec.durationNs) / 1e6)
+    const end = rec.startNs + rec.durationNs
+    const span = spans.get(rec.traceId)
+    if (!span) {
+      spans.set(rec.traceId, [rec.event, rec.startNs, end])
+    } else {
+      if (rec.startNs < span[1]) {
+        span[1] = rec.startNs
+      }
+      if (end > span[2]) {
+        span[2] = end
+      }
+    }
+  }
+  for (const [event, start, end] of spans.values()) {
+    const phases = samples.get(event)!
+    let list = phases.get('total')
+    if (!list) {
+      list = []
+      phases.set('total', list)
+    }
+    list.push(Number(end - start) / 1e6)
+  }
+  const reports: EventReport[] = []
+  for (const event of [...samples.keys()].sort()) {
+    const phases = samples.get(event)!
+    const fixed: PhaseStats[] = []
+    const hooks: PhaseStats[] = []
+    for (const [phase, list] of phases) {
+      ;(phase.startsWith('hook:') ? hooks : fixed).push(stats(phase, list))
+    }
+    fixed.sort((a, b) => rank(a.phase) - rank(b.phase))
+    hooks.sort((a, b) => b.p95Ms - a.p95Ms)
+    reports.push({
+      __proto__: null,
+      event,
+      phases: [...fixed, ...hooks.slice(0, hookRows)],
+    } as EventReport)
+  }
+  return reports
+}
+
+function rank(phase: string): number {
+  const i = PHASE_ORDER.indexOf(phase)
+  return i === -1 ? PHASE_ORDER.length : i
+}
+
+function parseArgs(argv: readonly string[]): Args | undefined {
+  let event: string | undefined
+  let hooks = 10
+  let json = false
+  let ring: string | undefined
+  for (let i = 0, { length } = argv; i < length; i += 1) {
+    const a = argv[i]!
+    if (a === '--json') {
+      json = true
+    } else if (a === '--event') {
+      event = argv[(i += 1)]
+    } else if (a === '--hooks') {
+      hooks = Number(argv[(i += 1)])
+      if (!(hooks >= 0)) {
+        return undefined
+      }
+    } else if (!a.startsWith('--') && !ring) {
+      ring = a
+    } else {
+      return undefined
+    }
+  }
+  return {
+    __proto__: null,
+    event,
+    hooks,
+    json,
+    ring: ring ?? process.env[TRACE_ENV],
+  } as Args
+}
+
+function ms(n: number): string {
+  return n.toFixed(2).padStart(9)
+}
+
+function main(): number {
+  const args = parseArgs(process.argv.slice(2))
+  if (!args || !args.ring) {
+    logger.error(
+      'Usage: dispatch-trace-report.mts [ring] [--event <Event>] ' +
+        `[--hooks <n>] [--json] (ring defaults to $${TRACE_ENV})`,
+    )
+    return 2
+  }
+  let buf: Buffer
+  try {
+    buf = readFileSync(args.ring)
+  } catch {
+    logger.error(
+      `No trace ring at ${args.ring} — set ${TRACE_ENV} and run some hooks first.`,
+    )
+    return 1
+  }
+  const records = decodeTraceRing(buf)
+  if (!records) {
+    logger.error(`${args.ring} is not a dispatch trace ring.`)
+    return 1
+  }
+  const reports = summarizeTrace(
+    args.event ? records.filter(r => r.event === args.event) : records,
+    args.hooks,
+  )
+  if (args.json) {
+    logger.log(JSON.stringify(reports, undefined, 2))
+    return 0
+  }
+  if (!reports.length) {
+    logger.log('No trace records yet.')
+    return 0
+  }
+  for (let i = 0, { length } = reports; i < length; i += 1) {
+    const report = reports[i]!
+    const width = Math.max(5, ...report.phases.map(p => p.phase.length))
+    logger.log(report.event)
+    logger.log(
+      `  ${'phase'.padEnd(width)}  ${'n'.padStart(6)}` +
+        ['p50 ms', 'p95 ms', 'p99 ms'].map(h => ` ${h.padStart(9)}`).join(''),
+    )
+    for (let j = 0, { length: n } = report.phases; j < n; j += 1) {
+      const p = report.phases[j]!
+      logger.log(
+        `  ${p.phase.padEnd(width)}  ${String(p.count).padStart(6)}` +
+          ` ${ms(p.p50Ms)} ${ms(p.p95Ms)} ${ms(p.p99Ms)}`,
+      )
+    }
+  }
+  return 0
+}
+
+if (isMainModule(import.meta.url)) {
+  runMain(main)
+}
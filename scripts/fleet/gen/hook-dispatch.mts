@@ -68,6 +68,33 @@ const VARIANT_BANNER: Record<TableVariant, string> = {
     '// excluded-bundle.cjs only when a dispatch could need it.',
 } as Record<TableVariant, string>
 
+/**
+ * Table options beyond the variant.
+ */
+export interface TableOptions {
+  /**
+   * Split the `@dispatch-lazy` hooks out of the snapshot variant into the
+   * excluded one (`build-hook-snapshot.mts --lazy-cold`).
+   */
+  readonly lazy?: boolean | undefined
+}
+
+// Marks a snapshot / excluded table rendered with `lazy`, so the next build
+// can keep the choice (see `planLazy` in build-hook-snapshot.mts).
+export const LAZY_TABLE_MARK =
+  '// Lazy cold hooks split out (build-hook-snapshot.mts --lazy-cold).'
+
+/**
+ * Whether `hook` leaves the snapshot for the excluded bundle: always when
+ * snapshot-hostile, and when lazy when it declared `@dispatch-lazy`.
+ */
+export function isSplitOut(
+  hook: EligibleHook,
+  options?: TableOptions | undefined,
+): boolean {
+  return hook.snapshotExcluded || (!!options?.lazy && hook.lazy)
+}
+
 /**
  * The event→tools surface of the snapshot-excluded hooks: `null` for an event
  * with an any-tool excluded hook, else the deduped tool union. Frozen into
@@ -118,19 +145,193 @@ export function renderExcludedHints(excluded: readonly EligibleHook[]): string {
   )
 }
 
+/**
+ * One event's slice of the (event, tool) → hooks index, as positions into
+ * the hook list it was built from, in that list's (table) order.
+ */
+export interface HookEventIndex {
+  /**
+   * The any-tool hooks alone: what fires for a tool no hook names, or for a
+   * payload with no `tool_name`.
+   */
+  readonly any: readonly number[]
+  /**
+   * Every declared tool → the hooks that fire for it: the ones naming it plus
+   * the any-tool ones, interleaved at their table positions.
+   */
+  readonly byTool: ReadonlyMap<string, readonly number[]>
+}
+
+interface EventIndexDraft {
+  readonly any: number[]
+  readonly byTool: Map<string, number[]>
+}
+
+/**
+ * Precompute, per event, the dense hook list for each tool. The ONE
+ * derivation behind both the `DISPATCH_INDEX` rendered into the dispatch
+ * table (so `dispatch()` walks only hooks that can fire) and the launcher's
+ * `hook-tools.map` pre-flight (`build-snapshot-launcher.mts`), so the native
+ * and the JS filter can't drift apart.
+ */
+export function buildHookIndex(
+  hooks: readonly EligibleHook[],
+): Map<string, HookEventIndex> {
+  const index = new Map<string, EventIndexDraft>()
+  for (let i = 0, { length } = hooks; i < length; i += 1) {
+    const hook = hooks[i]!
+    let slot = index.get(hook.event)
+    if (!slot) {
+      slot = { __proto__: null, any: [], byTool: new Map() } as EventIndexDraft
+      index.set(hook.event, slot)
+    }
+    for (const tool of hook.tools) {
+      if (!slot.byTool.has(tool)) {
+        slot.byTool.set(tool, [])
+      }
+    }
+  }
+  for (let i = 0, { length } = hooks; i < length; i += 1) {
+    const hook = hooks[i]!
+    const slot = index.get(hook.event)!
+    if (hook.tools.length === 0) {
+      slot.any.push(i)
+      for (const list of slot.byTool.values()) {
+        list.push(i)
+      }
+      continue
+    }
+    for (const tool of new Set(hook.tools)) {
+      slot.byTool.get(tool)!.push(i)
+    }
+  }
+  return index
+}
+
+// What a trigger may hold for the launcher to find it in the raw payload
+// bytes: printable ASCII without `"` or `\`, characters JSON.stringify writes
+// as themselves. A trigger outside this set can be spelled by an escape.
+const NATIVE_TRIGGER_RE = /^[\x20\x21\x23-\x5b\x5d-\x7e]+$/
+
+/**
+ * One (event, tool) whose every hook declared `triggers`: no hook can fire
+ * unless one of `triggers` occurs in the raw payload.
+ */
+export interface TriggerRule {
+  readonly event: string
+  readonly tool: string
+  /**
+   * The union of the hooks' triggers, sorted, minus any that contains
+   * another (the shorter one already matches wherever it does).
+   */
+  readonly triggers: readonly string[]
+}
+
+/**
+ * The launcher's trigger rules, off the same `buildHookIndex` lists
+ * `dispatch()` walks: a rule for each (event, tool) whose hooks ALL declare
+ * triggers the launcher can match natively. One hook without triggers (an
+ * open-ended scanner) leaves its tool to node. Events with an any-tool hook
+ * get none, since the launcher hands those to node without reading stdin.
+ */
+export function buildTriggerRules(
+  hooks: readonly EligibleHook[],
+): TriggerRule[] {
+  const index = buildHookIndex(hooks)
+  const rules: TriggerRule[] = []
+  for (const event of [...index.keys()].toSorted()) {
+    const { any, byTool } = index.get(event)!
+    if (any.length) {
+      continue
+    }
+    for (const tool of [...byTool.keys()].toSorted()) {
+      const union = new Set<string>()
+      let gated = true
+      for (const i of byTool.get(tool)!) {
+        const { triggers } = hooks[i]!
+        if (!triggers.length || !triggers.every(t => NATIVE_TRIGGER_RE.test(t))) {
+          gated = false
+          break
+        }
+        for (const trigger of triggers) {
+          union.add(trigger)
+        }
+      }
+      if (!gated) {
+        continue
+      }
+      const all = [...union]
+      rules.push({
+        __proto__: null,
+        event,
+        tool,
+        triggers: all
+          .filter(t => !all.some(u => u !== t && t.includes(u)))
+          .toSorted(),
+      } as TriggerRule)
+    }
+  }
+  return rules
+}
+
+function renderDispatchIndex(hooks: readonly EligibleHook[]): string {
+  const index = buildHookIndex(hooks)
+  const refs = (list: readonly number[]) =>
+    `[${list.map(i => `entry${i}`).join(', ')}]`
+  const rows = [...index.keys()].toSorted().map(event => {
+    const { any, byTool } = index.get(event)!
+    const tools = [...byTool.keys()]
+      .toSorted()
+      .map(tool => `      '${tool}': ${refs(byTool.get(tool)!)},`)
+    return (
+      `  '${event}': {\n` +
+      `    any: ${refs(any)},\n` +
+      `    byTool: {\n` +
+      `      __proto__: null,\n` +
+      (tools.length ? tools.join('\n') + '\n' : '') +
+      `    } as Record<string, readonly DispatchHookEntry[]>,\n` +
+      `  },`
+    )
+  })
+  return (
+    `// (event, tool) → the hooks that can fire, in table order; \`any\` is the\n` +
+    `// list for a tool no hook names (or no tool). dispatch() walks only these.\n` +
+    `export const DISPATCH_INDEX: Record<string, DispatchEventIndex> = {\n` +
+    `  __proto__: null,\n` +
+    (rows.length ? rows.join('\n') + '\n' : '') +
+    `} as Record<string, DispatchEventIndex>\n`
+  )
+}
+
 export function renderDispatchTable(
   hooks: readonly EligibleHook[],
   variant: TableVariant = 'full',
   allHooks: readonly EligibleHook[] = hooks,
+  event?: string | undefined,
+  options?: TableOptions | undefined,
 ): string {
+  // The split variants carry each hook's full-table position, so
+  // deserialize-main can splice excluded entries back in table order.
+  const seqOf = (hook: EligibleHook) =>
+    variant === 'full' ? '' : `, seq: ${allHooks.indexOf(hook)}`
   const importLines = hooks.map(
     (h, i) => `import { hook as hook${i} } from '../${h.name}/index.mts'`,
   )
-  const byEvent = new Map<string, Array<{ idx: number; hook: EligibleHook }>>()
+  // One entry object per hook, shared by the table and the index.
+  const entryLines = hooks.map((hook, idx) => {
+    const toolsLiteral = hook.tools.length
+      ? `[${hook.tools.map(t => `'${t}'`).join(', ')}]`
+      : 'undefined'
+    const pureLiteral = hook.pure ? ', pure: true' : ''
+    const advisoryLiteral = hook.advisory ? ', advisory: true' : ''
+    const statefulLiteral = hook.stateful ? ', stateful: true' : ''
+    return `const entry${idx}: DispatchHookEntry = { name: '${hook.name}', check: hook${idx}.check, tools: ${toolsLiteral}${pureLiteral}${advisoryLiteral}${statefulLiteral}${seqOf(hook)} }`
+  })
+  const byEvent = new Map<string, number[]>()
   for (let idx = 0, { length } = hooks; idx < length; idx += 1) {
     const hook = hooks[idx]!
     const list = byEvent.get(hook.event) ?? []
-    list.push({ hook, idx })
+    list.push(idx)
     byEvent.set(hook.event, list)
   }
   const events = [...byEvent.keys()].toSorted()
@@ -138,12 +339,7 @@ export function renderDispatchTable(
     .map(event => {
       const rows = byEvent
         .get(event)!
-        .map(({ hook, idx }) => {
-          const toolsLiteral = hook.tools.length
-            ? `[${hook.tools.map(t => `'${t}'`).join(', ')}]`
-            : 'undefined'
-          return `    { name: '${hook.name}', check: hook${idx}.check, tools: ${toolsLiteral} },`
-        })
+        .map(idx => `    entry${idx},`)
         .join('\n')
       return `  '${event}': [\n${rows}\n  ],`
     })
@@ -153,35 +349,68 @@ export function renderDispatchTable(
   // the snapshot build (dev runs, type-checking) and to the snapshot variant
   // inside it — the export must exist in both.
   const hints =
-    '\n' + renderExcludedHints(allHooks.filter(h => h.snapshotExcluded))
+    '\n' + renderExcludedHints(allHooks.filter(h => isSplitOut(h, options)))
   return (
     `// GENERATED by scripts/fleet/gen/hook-dispatch.mts — do not edit by hand.\n` +
     VARIANT_BANNER[variant] +
     `\n` +
+    (options?.lazy && variant !== 'full' ? `${LAZY_TABLE_MARK}\n` : '') +
+    (event
+      ? `// Per-event split: only the ${event} hooks, frozen into their own\n` +
+        `// blob (build-hook-snapshot.mts --split-events).\n`
+      : '') +
     `// Re-run the maker after adding/removing an eligible hook, then rebuild\n` +
     `// the bundle with scripts/fleet/build-hook-bundle.mts.\n` +
     `\n` +
-    `import type { DispatchHookEntry } from './dispatch.mts'\n` +
+    `import type { DispatchEventIndex, DispatchHookEntry } from './dispatch-types.mts'\n` +
     `\n` +
     (importLines.length ? importLines.join('\n') + '\n\n' : '\n') +
+    (entryLines.length ? entryLines.join('\n') + '\n\n' : '') +
     `export const DISPATCH_TABLE: Record<string, readonly DispatchHookEntry[]> = {\n` +
     `  __proto__: null,\n` +
     (tableBody ? tableBody + '\n' : '') +
     `} as Record<string, readonly DispatchHookEntry[]>\n` +
+    `\n` +
+    renderDispatchIndex(hooks) +
     hints
   )
 }
 
+/**
+ * Render one table variant over the hooks in `hooksDir`; `event` narrows it
+ * to that event's hooks (the per-event split snapshot bundles), and
+ * `options.lazy` splits the `@dispatch-lazy` hooks out of the snapshot.
+ */
 export function generateDispatchTableSource(
   hooksDir: string,
   variant: TableVariant = 'full',
+  event?: string | undefined,
+  options?: TableOptions | undefined,
 ): string {
   const all = collectEligibleHooks(hooksDir)
-  const subset =
+  let subset =
     variant === 'full'
       ? all
-      : all.filter(h => h.snapshotExcluded === (variant === 'excluded'))
-  return renderDispatchTable(subset, variant, all)
+      : all.filter(h => isSplitOut(h, options) === (variant === 'excluded'))
+  if (event) {
+    subset = subset.filter(h => h.event === event)
+  }
+  return renderDispatchTable(subset, variant, all, event, options)
+}
+
+/**
+ * The options the on-disk snapshot table was rendered with, so a plain regen
+ * (or `--check`) reproduces the last snapshot build's split instead of
+ * undoing it.
+ */
+export function tableOptionsOnDisk(): TableOptions {
+  let lazy = false
+  try {
+    lazy = readFileSync(DISPATCH_TABLE_SNAPSHOT_PATH, 'utf8').includes(
+      LAZY_TABLE_MARK,
+    )
+  } catch {}
+  return { __proto__: null, lazy } as TableOptions
 }
 
 export type ManifestHookEntry =
@@ -269,9 +498,15 @@ function main(): void {
     return
   }
   const checkOnly = process.argv.includes('--check')
+  const tableOptions = tableOptionsOnDisk()
   if (checkOnly) {
     for (const [variant, outPath] of TABLE_OUTPUTS) {
-      const generated = generateDispatchTableSource(FLEET_HOOKS_DIR, variant)
+      const generated = generateDispatchTableSource(
+        FLEET_HOOKS_DIR,
+        variant,
+        undefined,
+        tableOptions,
+      )
       let onDisk = ''
       try {
         onDisk = readFileSync(outPath, 'utf8')
@@ -311,7 +546,12 @@ function main(): void {
   for (const [variant, outPath] of TABLE_OUTPUTS) {
     writeFileSync(
       outPath,
-      generateDispatchTableSource(FLEET_HOOKS_DIR, variant),
+      generateDispatchTableSource(
+        FLEET_HOOKS_DIR,
+        variant,
+        undefined,
+        tableOptions,
+      ),
     )
   }
   writeFileSync(
@@ -0,0 +1,255 @@
+#!/usr/bin/env node
+/*
+ * @file Start / stop / inspect the opt-in warm hook-dispatch daemon
+ *   (`.claude/hooks/fleet/_dispatch/dispatch-daemon.mts`).
+ *
+ *   The daemon is booted from the SAME snapshot blob the native launcher
+ *   execs, keeps one pre-booted one-shot worker parked per slot socket, and
+ *   lets `dispatch-launcher` skip the node boot entirely on the hook's
+ *   critical path. Everything it needs is read from the sidecars that
+ *   `build-snapshot-launcher.mts` froze next to the launcher —
+ *   `launch.manifest` (node, blob, node flags) and `daemon.path` — so a
+ *   daemon only ever serves the bundle the launcher would have exec'd. After a bundle rebuild the old
+ *   daemon answers 'S' (stale) to the first request and shuts itself down;
+ *   run `start` again to serve the new blob.
+ *
+ *   Opt-in and disposable: nothing starts it automatically, it exits on its
+ *   own after 30 idle minutes, and with no daemon running the launcher just
+ *   takes its usual execv (POSIX) / CreateProcess (Windows) path. The slots
+ *   are Unix sockets on POSIX and per-user named pipes on Windows.
+ *
+ *   Usage:
+ *     node scripts/fleet/hook-daemon.mts start    # boot it (no-op when running)
+ *     node scripts/fleet/hook-daemon.mts stop
+ *     node scripts/fleet/hook-daemon.mts status
+ */
+
+// oxlint-disable-next-line socket/prefer-async-spawn -- detached + unref'd long-lived daemon; the lib wrapper's promise tracks an exit that never comes.
+import { spawn } from 'node:child_process'
+import { existsSync, readFileSync } from 'node:fs'
+import { createRequire } from 'node:module'
+import path from 'node:path'
+import process from 'node:process'
+
+import { getDefaultLogger } from '@socketsecurity/lib-stable/logger/default'
+
+import { DISPATCH_DIR } from './gen/hook-dispatch.mts'
+import { isMainModule } from './_shared/is-main-module.mts'
+import {
+  LAUNCH_MANIFEST_NAME,
+  decodeLaunchManifest,
+} from './_shared/launch-manifest.mts'
+import type { LaunchManifest } from './_shared/launch-manifest.mts'
+import { runMain } from './_shared/run-main.mts'
+
+const logger = getDefaultLogger()
+
+const require = createRequire(import.meta.url)
+const { daemonPidPath } = require(
+  path.join(DISPATCH_DIR, 'snapshot-cache-path.cjs'),
+) as { daemonPidPath: (dispatchDir: string) => string }
+
+// Poll budget for `start` to see the slot sockets appear (each worker is a
+// full snapshot boot, ~50 ms warm; a cold page cache can take several times
+// that).
+const START_WAIT_MS = 3000
+
+export interface DaemonSidecars {
+  readonly blob: string
+  readonly bundleHash: string
+  readonly node: string
+  readonly nodeFlags: readonly string[]
+  readonly pidPath: string
+  readonly slots: number
+  readonly socketBase: string
+}
+
+function readSidecar(name: string): string | undefined {
+  try {
+    const text = readFileSync(path.join(DISPATCH_DIR, name), 'utf8')
+    return text.split('\n')[0]!.trim() || undefined
+  } catch {
+    return undefined
+  }
+}
+
+/**
+ * Parse the frozen `daemon.path` line: `<bundle-hash> <slots> <socket-base>`.
+ * The base is the rest of the line, so a tmpdir containing spaces survives.
+ */
+export function parseDaemonSidecar(
+  line: string,
+): Pick<DaemonSidecars, 'bundleHash' | 'slots' | 'socketBase'> | undefined {
+  const m = /^(\S+) (\d+) (.+)$/.exec(line)
+  if (!m) {
+    return undefined
+  }
+  const slots = Number(m[2])
+  if (!(slots > 0)) {
+    return undefined
+  }
+  return { bundleHash: m[1]!, slots, socketBase: m[3]! }
+}
+
+function loadSidecars(): DaemonSidecars | undefined {
+  let manifest: LaunchManifest | undefined
+  try {
+    manifest = decodeLaunchManifest(
+      readFileSync(path.join(DISPATCH_DIR, LAUNCH_MANIFEST_NAME)),
+    )
+  } catch {
+    manifest = undefined
+  }
+  const daemonLine = readSidecar('daemon.path')
+  const daemon = daemonLine ? parseDaemonSidecar(daemonLine) : undefined
+  if (!manifest?.nodePath || !manifest.blobPath || !daemon) {
+    return undefined
+  }
+  return {
+    __proto__: null,
+    blob: manifest.blobPath,
+    node: manifest.nodePath,
+    nodeFlags: manifest.nodeFlags,
+    pidPath: daemonPidPath(DISPATCH_DIR),
+    ...daemon,
+  } as DaemonSidecars
+}
+
+/**
+ * The supervisor pid when one is alive, else undefined (dead pid file = none).
+ */
+function livePid(pidPath: string): number | undefined {
+  try {
+    const pid = Number(readFileSync(pidPath, 'utf8').trim())
+    if (pid > 0) {
+      process.kill(pid, 0)
+      return pid
+    }
+  } catch {}
+  return undefined
+}
+
+/**
+ * How many slot sockets are listening, or undefined where that can't be
+ * probed safely: opening a Windows named pipe to look at it CONNECTS to it,
+ * which would hand the parked one-shot worker a bogus request.
+ */
+function liveSlots(cars: DaemonSidecars): number | undefined {
+  if (process.platform === 'win32') {
+    return undefined
+  }
+  let n = 0
+  for (let i = 0; i < cars.slots; i += 1) {
+    if (existsSync(`${cars.socketBase}.${i}.sock`)) {
+      n += 1
+    }
+  }
+  return n
+}
+
+async function start(cars: DaemonSidecars): Promise<number> {
+  const running = livePid(cars.pidPath)
+  if (running !== undefined) {
+    logger.success(`Hook daemon already running (pid ${running}).`)
+    return 0
+  }
+  if (!existsSync(cars.blob)) {
+    logger.error(
+      `Snapshot blob missing (${cars.blob}) — run build-hook-snapshot.mts first.`,
+    )
+    return 1
+  }
+  const child = spawn(
+    cars.node,
+    [
+      // The blob only boots under the flags it was built with.
+      ...cars.nodeFlags,
+      '--snapshot-blob',
+      cars.blob,
+      '__fleet-daemon',
+      cars.socketBase,
+      cars.pidPath,
+      cars.bundleHash,
+      String(cars.slots),
+    ],
+    {
+      detached: true,
+      // As the launcher does: a shared-store blob resolves its runtime
+      // requires from this checkout, not the one that built it.
+      env: { ...process.env, FLEET_DISPATCH_DIR: DISPATCH_DIR },
+      stdio: 'ignore',
+      windowsHide: true,
+    },
+  )
+  child.unref()
+  const deadline = Date.now() + START_WAIT_MS
+  while (Date.now() < deadline) {
+    const listening = liveSlots(cars)
+    if (
+      listening === undefined
+        ? livePid(cars.pidPath) !== undefined
+        : listening === cars.slots
+    ) {
+      logger.success(
+        `Hook daemon started (pid ${String(child.pid)}, ${cars.slots} slots).`,
+      )
+      return 0
+    }
+    // eslint-disable-next-line no-await-in-loop
+    await new Promise(resolve => setTimeout(resolve, 50))
+  }
+  logger.warn(
+    `Hook daemon spawned (pid ${String(child.pid)}) but not all ` +
+      `${cars.slots} slots are listening yet.`,
+  )
+  return 0
+}
+
+function stop(cars: DaemonSidecars): number {
+  const pid = livePid(cars.pidPath)
+  if (pid === undefined) {
+    logger.log('Hook daemon not running.')
+    return 0
+  }
+  process.kill(pid, 'SIGTERM')
+  logger.success(`Stopped hook daemon (pid ${pid}).`)
+  return 0
+}
+
+function status(cars: DaemonSidecars): number {
+  const pid = livePid(cars.pidPath)
+  if (pid === undefined) {
+    logger.log('Hook daemon not running — the launcher takes its exec path.')
+    return 0
+  }
+  const listening = liveSlots(cars)
+  logger.log(
+    `Hook daemon running (pid ${pid}): ` +
+      `${listening === undefined ? '?' : listening}/${cars.slots} slots ` +
+      `parked, bundle ${cars.bundleHash}.`,
+  )
+  return 0
+}
+
+async function main(): Promise<number> {
+  const command = process.argv[2]
+  if (command !== 'start' && command !== 'stop' && command !== 'status') {
+    logger.error('Usage: hook-daemon.mts start|stop|status')
+    return 2
+  }
+  const cars = loadSidecars()
+  if (!cars) {
+    logger.error(
+      'Launcher sidecars missing — run build-snapshot-launcher.mts first.',
+    )
+    return 1
+  }
+  if (command === 'start') {
+    return await start(cars)
+  }
+  return command === 'stop' ? stop(cars) : status(cars)
+}
+
+if (isMainModule(import.meta.url)) {
+  runMain(main)
+}
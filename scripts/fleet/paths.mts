@@ -317,6 +317,18 @@ export const DISPATCH_ENTRY_PATH = path.join(DISPATCH_DIR, 'dispatch-entry.mts')
  */
 export const HOOK_BUNDLE_PATH = path.join(DIST_DIR, 'bundle.cjs')
 
+/**
+ * The V8 compile-cache dir `index.cjs` enables before requiring the bundle.
+ * The loader is plain CJS and spells the same path out itself.
+ */
+export const HOOK_COMPILE_CACHE_DIR = path.join(
+  REPO_ROOT,
+  'node_modules',
+  '.cache',
+  'fleet',
+  'fleet-hooks',
+)
+
 /**
  * The fleet oxlint plugin source dir + its rolldown-bundled artifact. Members
  * load the bundle via `jsPlugins`; the wheelhouse edits + tests the source and
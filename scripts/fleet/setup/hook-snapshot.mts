@@ -19,7 +19,7 @@
  *        bundle, and the runtime-keyed blob, so the compile-cache baseline is
  *        current and a matching blob exists for the host node × arch × V8 tag.
  *     2. Compile the native launcher for the HOST os/arch + freeze its sidecars
- *        (`node.path`, `snapshot-blob.path`).
+ *        (`launch.manifest`, `daemon.path`, `hook-tools.map`).
  *     3. POSIX: rewrite the LIVE `.claude/settings.json` dispatch commands to the
  *        launcher binary. The launcher re-execs `node --snapshot-blob <blob>
  *        <Event>` in ONE process transition (`execv` replaces the launcher image
@@ -36,6 +36,10 @@
  *        this step builds the `.exe` launcher but LEAVES settings on the
  *        compile-cache baseline; pass `--win-launcher` to wire the `.exe` once CI
  *        confirms the win. Correctness is identical either way via fail-open.
+ *        Paired with the opt-in warm daemon (`hook-daemon.mts start`) the wired
+ *        `.exe` creates no node process per event — it relays over a per-user
+ *        named pipe to a pre-booted worker — which is the configuration where
+ *        `--win-launcher` is a win independent of CreateProcess cost.
  *
  *   IDEMPOTENT + cascade-aware. The launcher command is per-machine state that
  *   the FLEET cascade does not know about: a cascade rewrites `settings.json` to
@@ -50,6 +54,22 @@
  *     node scripts/fleet/setup/hook-snapshot.mts --win-launcher # also wire on Windows
  *     node scripts/fleet/setup/hook-snapshot.mts --no-wire      # build only, don't touch settings
  *     node scripts/fleet/setup/hook-snapshot.mts --unwire       # revert live settings to the baseline
+ *     node scripts/fleet/setup/hook-snapshot.mts --heal         # snapshot + sidecars only (see below)
+ *     node scripts/fleet/setup/hook-snapshot.mts --split-events # also build per-event split blobs
+ *
+ *   `--split-events` / `--no-split-events` pass through to
+ *   `build-hook-snapshot.mts`, which remembers the choice (a heal rebuilds
+ *   the split blobs a tree already had).
+ *
+ *   --heal is what the launcher itself spawns, detached, when its manifest
+ *   names a blob that has vanished (a node_modules rebuild, an image without
+ *   the bake step): rebuild the snapshot bundle + blob, refreeze the
+ *   sidecars and re-prime index.cjs's compile cache (the same node_modules
+ *   rebuild emptied it), nothing else — no production-bundle rebuild
+ *   (index.cjs is the path hooks are running on meanwhile), no launcher
+ *   recompile (that binary may be executing), no settings change. The
+ *   launcher guards it with heal.lock in the blob cache root and sends its
+ *   output to heal.log there.
  */
 
 import { spawnSync } from '@socketsecurity/lib-stable/process/spawn/child'
@@ -124,6 +144,10 @@ function main(): void {
   const winLauncher = argv.includes('--win-launcher')
   const wireLauncher = argv.includes('--wire-launcher')
   const unwire = argv.includes('--unwire')
+  const heal = argv.includes('--heal')
+  const splitArgs = argv.filter(
+    a => a === '--split-events' || a === '--no-split-events',
+  )
   const isWin = process.platform === 'win32'
 
   // --unwire is a pure settings revert (no rebuild) — restore the baseline.
@@ -134,11 +158,35 @@ function main(): void {
 
   // A bundle-only member has no hook source — the rebuild passes below would
   // replace the release-shipped bundle.cjs with an empty one. The snapshot
-  // fast path is a source-repo affordance only.
+  // fast path is a source-repo affordance only; the shipped bundle's compile
+  // cache is still primed.
   if (!hasFleetHookSource(REPO_ROOT)) {
     logger.log(
-      '[setup:hook-snapshot] no fleet hook source (bundle-only) — hooks run from the release-shipped bundle; nothing to build.',
+      '[setup:hook-snapshot] no fleet hook source (bundle-only) — hooks run from the release-shipped bundle; priming its compile cache only.',
+    )
+    build('scripts/fleet/build-hook-bundle.mts', ['--prime-only'])
+    return
+  }
+
+  if (heal) {
+    logger.log(
+      `[setup:hook-snapshot] healing the snapshot blob (${new Date().toISOString()})…`,
     )
+    if (
+      !build('scripts/fleet/build-hook-snapshot.mts', splitArgs) ||
+      !build('scripts/fleet/build-snapshot-launcher.mts', ['--sidecars-only'])
+    ) {
+      // heal.lock stays stamped: the launcher retries on a later miss once
+      // the retry window has passed, not on every event.
+      logger.error('Snapshot heal failed; hooks stay on index.cjs.')
+      process.exitCode = 1
+      return
+    }
+    // Whatever wiped the blob (a node_modules rebuild) wiped index.cjs's
+    // compile cache with it. Priming writes cache files only, never the
+    // bundle, so it is safe while hooks run on index.cjs.
+    build('scripts/fleet/build-hook-bundle.mts', ['--prime-only'])
+    logger.success('Snapshot healed; the next launch takes the fast path.')
     return
   }
 
@@ -150,7 +198,7 @@ function main(): void {
     process.exitCode = 1
     return
   }
-  if (!build('scripts/fleet/build-hook-snapshot.mts')) {
+  if (!build('scripts/fleet/build-hook-snapshot.mts', splitArgs)) {
     logger.error('Snapshot bundle/blob build failed.')
     process.exitCode = 1
     return
@@ -189,7 +237,8 @@ function main(): void {
     // with --win-launcher once Windows CI confirms the win.
     logger.log(
       'Windows: built the launcher but staying on the compile-cache baseline ' +
-        '(pass --win-launcher to wire it once CI confirms the win).',
+        '(pass --win-launcher to wire it once CI confirms the win, or ' +
+        'alongside `hook-daemon.mts start`).',
     )
     return
   }
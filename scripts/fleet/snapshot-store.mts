@@ -0,0 +1,179 @@
+#!/usr/bin/env node
+/*
+ * @file Report on, or sweep, the snapshot blob store
+ *   (`node_modules/.cache/fleet/node-snapshot-cache/`): its size against the
+ *   byte budget, every blob with its last launch and hit count, and the
+ *   launcher's hit / miss counts from its access log. Log layout, eviction
+ *   rules and the budget (FLEET_SNAPSHOT_STORE_MB, default 256) live in
+ *   `_shared/snapshot-store.mts`.
+ *
+ *   `gc` runs the same LRU sweep the sidecar freeze
+ *   (`build-snapshot-launcher.mts`) runs after every build, sparing every
+ *   blob a launch manifest in this checkout names. In the opt-in per-user
+ *   shared store (FLEET_SNAPSHOT_SHARED_STORE) the report and the sweep
+ *   cover that store, and the blobs every registered checkout names are
+ *   spared too.
+ *
+ *   Usage:
+ *     node scripts/fleet/snapshot-store.mts [status] [--json]
+ *     node scripts/fleet/snapshot-store.mts gc [--budget-mb <n>]
+ */
+
+import { createRequire } from 'node:module'
+import path from 'node:path'
+import process from 'node:process'
+
+import { getDefaultLogger } from '@socketsecurity/lib-stable/logger/default'
+
+import { DISPATCH_DIR } from './gen/hook-dispatch.mts'
+import { isMainModule } from './_shared/is-main-module.mts'
+import { runMain } from './_shared/run-main.mts'
+import {
+  gcSnapshotStore,
+  readAccessLog,
+  scanSnapshotStore,
+  storeBudgetBytes,
+  storeKeepSet,
+} from './_shared/snapshot-store.mts'
+import type {
+  AccessKind,
+  AccessRecord,
+  StoredBlob,
+} from './_shared/snapshot-store.mts'
+
+const logger = getDefaultLogger()
+
+const require = createRequire(import.meta.url)
+const { snapshotCacheDir } = require(
+  path.join(DISPATCH_DIR, 'snapshot-cache-path.cjs'),
+) as { snapshotCacheDir: () => string }
+
+export interface StoreStatus {
+  readonly blobs: ReadonlyArray<StoredBlob & { readonly kept: boolean }>
+  readonly budgetBytes: number
+  readonly counts: Readonly<Record<AccessKind, number>>
+  readonly root: string
+  readonly since: number | undefined
+  readonly totalBytes: number
+}
+
+/**
+ * Fold the store scan + access log into one report. PURE.
+ */
+export function summarizeStore(
+  root: string,
+  blobs: readonly StoredBlob[],
+  records: readonly AccessRecord[],
+  keep: ReadonlySet<string>,
+  budgetBytes: number,
+): StoreStatus {
+  const counts = { __proto__: null, D: 0, H: 0, M: 0, P: 0, S: 0 } as Record<
+    AccessKind,
+    number
+  >
+  let since: number | undefined
+  for (let i = 0, { length } = records; i < length; i += 1) {
+    const r = records[i]!
+    counts[r.kind] += 1
+    since = since === undefined ? r.atMs : Math.min(since, r.atMs)
+  }
+  let totalBytes = 0
+  for (let i = 0, { length } = blobs; i < length; i += 1) {
+    totalBytes += blobs[i]!.size
+  }
+  return {
+    __proto__: null,
+    blobs: blobs
+      .map(b => ({ ...b, kept: keep.has(path.resolve(b.file)) }))
+      .toSorted((a, b) => b.lastUsedMs - a.lastUsedMs),
+    budgetBytes,
+    counts,
+    root,
+    since,
+    totalBytes,
+  } as StoreStatus
+}
+
+function mb(bytes: number): string {
+  return `${(bytes / 1048576).toFixed(1)} MB`
+}
+
+function printStatus(s: StoreStatus): void {
+  const { D, H, M, P, S } = s.counts
+  const launches = D + H + M + P + S
+  logger.log(
+    `${s.root}: ${s.blobs.length} blob(s), ${mb(s.totalBytes)} of a ` +
+      `${mb(s.budgetBytes)} budget`,
+  )
+  for (let i = 0, { length } = s.blobs; i < length; i += 1) {
+    const b = s.blobs[i]!
+    logger.log(
+      `  ${b.kept ? '*' : ' '} ${b.rel}  ${mb(b.size).padStart(9)}  ` +
+        `${String(b.hits).padStart(6)} hits  last ${new Date(b.lastUsedMs).toISOString()}`,
+    )
+  }
+  if (!launches) {
+    logger.log('No launches recorded yet.')
+    return
+  }
+  const pct = (n: number) => `${((n / launches) * 100).toFixed(1)}%`
+  logger.log(
+    `${launches} launch(es) since ${new Date(s.since!).toISOString()}: ` +
+      `${H} full-blob hit(s) (${pct(H)}), ${S} split-blob hit(s) (${pct(S)}), ` +
+      `${P} pre-flight (${pct(P)}), ${D} daemon (${pct(D)}), ` +
+      `${M} miss(es) (${pct(M)})`,
+  )
+  logger.log('(* = named by a launch manifest, never evicted)')
+}
+
+function main(): number {
+  const argv = process.argv.slice(2)
+  const command = argv[0] && !argv[0].startsWith('--') ? argv[0] : 'status'
+  if (command !== 'status' && command !== 'gc') {
+    logger.error(
+      'Usage: snapshot-store.mts [status] [--json] | gc [--budget-mb <n>]',
+    )
+    return 2
+  }
+  const root = path.dirname(snapshotCacheDir())
+  const keep = storeKeepSet(root, DISPATCH_DIR)
+  let budgetBytes = storeBudgetBytes()
+  const budgetAt = argv.indexOf('--budget-mb')
+  if (budgetAt !== -1) {
+    const n = Number(argv[budgetAt + 1])
+    if (!(n >= 0)) {
+      logger.error('--budget-mb takes a number of megabytes.')
+      return 2
+    }
+    budgetBytes = n * 1024 * 1024
+  }
+  if (command === 'gc') {
+    const gc = gcSnapshotStore(root, keep, budgetBytes)
+    for (let i = 0, { length } = gc.evicted; i < length; i += 1) {
+      logger.log(`  evicted ${gc.evicted[i]!.rel}`)
+    }
+    logger.log(
+      `Evicted ${gc.evicted.length} blob(s), ${mb(gc.freedBytes)}; ` +
+        `${mb(gc.keptBytes)} kept.`,
+    )
+    return 0
+  }
+  const records = readAccessLog(root)
+  const status = summarizeStore(
+    root,
+    scanSnapshotStore(root, records),
+    records,
+    keep,
+    budgetBytes,
+  )
+  if (argv.includes('--json')) {
+    logger.log(JSON.stringify(status, undefined, 2))
+  } else {
+    printStatus(status)
+  }
+  return 0
+}
+
+if (isMainModule(import.meta.url)) {
+  runMain(main)
+}
@@ -0,0 +1,231 @@
+/**
+ * @file The append-only line logs behind the runtime-state ledgers: the
+ *   backward tail read across its fixed chunks, and `compactLog` keeping
+ *   every other writer's line while it folds the log.
+ */
+
+import {
+  appendFileSync,
+  existsSync,
+  mkdtempSync,
+  readFileSync,
+  renameSync,
+  writeFileSync,
+} from 'node:fs'
+import os from 'node:os'
+import path from 'node:path'
+
+import { safeDeleteSync } from '@socketsecurity/lib-stable/fs/safe'
+import { afterEach, describe, expect, it } from 'vitest'
+
+import {
+  appendActorEdit,
+  listOtherActorLedgerPaths,
+  readActorLedger,
+} from '../../../../.claude/hooks/fleet/_shared/active-edits-ledger.mts'
+import {
+  appendLogLines,
+  compactLog,
+  logExists,
+  readCompactingLogLines,
+  readLogTail,
+} from '../../../../.claude/hooks/fleet/_shared/append-log.mts'
+
+// append-log.mts reads backwards in 16 KiB chunks.
+const CHUNK = 16 * 1024
+
+const dirs: string[] = []
+
+afterEach(() => {
+  for (const dir of dirs.splice(0)) {
+    safeDeleteSync(dir, { force: true })
+  }
+})
+
+function scratchLog(): string {
+  const dir = mkdtempSync(path.join(os.tmpdir(), 'append-log-'))
+  dirs.push(dir)
+  return path.join(dir, 'x.log')
+}
+
+function tail(file: string): string[] {
+  const seen: string[] = []
+  readLogTail(file, line => {
+    seen.push(line)
+    return true
+  })
+  return seen
+}
+
+describe('readLogTail', () => {
+  it('visits every line newest first across chunk boundaries', () => {
+    const file = scratchLog()
+    // Uneven lengths, so lines straddle every chunk edge at a new offset.
+    const lines: string[] = []
+    for (let i = 0, size = 0; size < 3 * CHUNK; i += 1) {
+      const line = `${i}:${'x'.repeat(i % 97)}`
+      lines.push(line)
+      size += line.length + 1
+    }
+    appendLogLines(file, lines)
+    expect(tail(file)).toEqual(lines.toReversed())
+  })
+
+  it('reads a line longer than a chunk whole', () => {
+    const file = scratchLog()
+    const long = 'y'.repeat(CHUNK * 2 + 5)
+    appendLogLines(file, ['first', long, 'last'])
+    expect(tail(file)).toEqual(['last', long, 'first'])
+  })
+
+  it('keeps an unterminated last line and skips blanks', () => {
+    const file = scratchLog()
+    writeFileSync(file, 'a\n\n\nb\nc')
+    expect(tail(file)).toEqual(['c', 'b', 'a'])
+  })
+
+  it('splits a newline that falls exactly on a chunk edge', () => {
+    const file = scratchLog()
+    // The tail chunk is exactly `b…\n`: the newline before it ends chunk two.
+    const b = 'b'.repeat(CHUNK - 1)
+    const a = 'a'.repeat(CHUNK - 1)
+    writeFileSync(file, `${a}\n${b}\n`)
+    expect(tail(file)).toEqual([b, a])
+  })
+
+  it('stops as soon as the visitor says so', () => {
+    const file = scratchLog()
+    appendLogLines(file, ['1', '2', '3', '4'])
+    const seen: string[] = []
+    readLogTail(file, line => {
+      seen.push(line)
+      return line !== '3'
+    })
+    expect(seen).toEqual(['4', '3'])
+  })
+
+  it('reads a missing log as empty', () => {
+    expect(tail(scratchLog())).toEqual([])
+  })
+})
+
+describe('compactLog', () => {
+  it('keeps a line appended while the log is set aside', () => {
+    const file = scratchLog()
+    appendLogLines(file, ['a', 'b', 'a'])
+    const ok = compactLog(file, lines => {
+      // Another writer's append after the rename: a fresh log.
+      appendLogLines(file, ['during'])
+      return [...new Set(lines)]
+    })
+    expect(ok).toBe(true)
+    expect(readCompactingLogLines(file).toSorted()).toEqual([
+      'a',
+      'b',
+      'during',
+    ])
+    expect(existsSync(`${file}.compacting`)).toBe(false)
+    expect(existsSync(`${file}.compact`)).toBe(false)
+  })
+
+  it('carries over a late write to the set-aside copy', () => {
+    const file = scratchLog()
+    appendLogLines(file, ['a'])
+    compactLog(file, lines => {
+      // A writer that opened the log before the rename still appends there.
+      appendFileSync(`${file}.compacting`, 'late\n')
+      return lines
+    })
+    expect(readCompactingLogLines(file).toSorted()).toEqual(['a', 'late'])
+  })
+
+  it('backs off while another compaction holds the lock', () => {
+    const file = scratchLog()
+    appendLogLines(file, ['a', 'a'])
+    writeFileSync(`${file}.compact`, '')
+    expect(compactLog(file, () => [])).toBe(false)
+    expect(readFileSync(file, 'utf8')).toBe('a\na\n')
+  })
+
+  it('finishes a dead compaction rather than set the log aside again', () => {
+    const file = scratchLog()
+    appendLogLines(file, ['old'])
+    renameSync(file, `${file}.compacting`)
+    appendLogLines(file, ['new'])
+    // Readers fold the set-aside copy meanwhile.
+    expect(logExists(file)).toBe(true)
+    expect(readCompactingLogLines(file)).toEqual(['old', 'new'])
+    const folded: string[][] = []
+    compactLog(file, lines => {
+      folded.push([...lines])
+      return lines
+    })
+    expect(folded).toEqual([['old']])
+    expect(readCompactingLogLines(file)).toEqual(['new', 'old'])
+  })
+
+  it('counts a log that only exists set aside', () => {
+    const file = scratchLog()
+    appendLogLines(file, ['only'])
+    renameSync(file, `${file}.compacting`)
+    expect(logExists(file)).toBe(true)
+    expect(readCompactingLogLines(file)).toEqual(['only'])
+  })
+})
+
+describe('actor ledger compaction', () => {
+  const ttlMs = 60 * 60 * 1000
+
+  it('keeps an edit that lands before the compacted index', () => {
+    const file = scratchLog()
+    // An edit made during a compaction sits before its (older) index lines.
+    appendLogLines(file, [
+      `5000\t${JSON.stringify('/r/during')}`,
+      `=1000\t${JSON.stringify('/r/old')}`,
+      `=2000\t${JSON.stringify('/r/during')}`,
+    ])
+    const ledger = readActorLedger(file, 4000)
+    expect(ledger?.paths).toEqual({ '/r/during': 5000 })
+    expect(ledger?.updatedAt).toBe(5000)
+    expect(readActorLedger(file)?.paths).toEqual({
+      '/r/during': 5000,
+      '/r/old': 1000,
+    })
+  })
+
+  it('still stops the tail read at an old edit line', () => {
+    const file = scratchLog()
+    appendLogLines(file, [
+      `9000\t${JSON.stringify('/r/ancient')}`,
+      `1000\t${JSON.stringify('/r/old')}`,
+      `5000\t${JSON.stringify('/r/new')}`,
+    ])
+    expect(readActorLedger(file, 4000)?.paths).toEqual({ '/r/new': 5000 })
+  })
+
+  it('compacts past the threshold and keeps the newest write per path', () => {
+    const file = scratchLog()
+    const now = 10_000_000
+    for (let i = 0; i < 1500; i += 1) {
+      appendActorEdit(file, `/r/${'p'.repeat(40)}${i % 7}`, {
+        now: now + i,
+        ttlMs,
+      })
+    }
+    const ledger = readActorLedger(file)
+    expect(Object.keys(ledger?.paths ?? {})).toHaveLength(7)
+    expect(ledger?.paths[`/r/${'p'.repeat(40)}6`]).toBe(now + 1497)
+    expect(ledger?.updatedAt).toBe(now + 1499)
+    expect(readFileSync(file, 'utf8')).toMatch(/^=/m)
+  })
+
+  it('lists an actor whose log is set aside mid-compaction', () => {
+    const file = scratchLog()
+    appendLogLines(file, [`1000\t${JSON.stringify('/r/a')}`])
+    renameSync(file, `${file}.compacting`)
+    expect(listOtherActorLedgerPaths(path.dirname(file), 'own')).toEqual([
+      file,
+    ])
+    expect(readActorLedger(file)?.paths).toEqual({ '/r/a': 1000 })
+  })
+})
@@ -0,0 +1,115 @@
+/**
+ * @file The (event, tool) → hooks index the dispatch table is rendered from:
+ *   every tool's list keeps the table order, any-tool hooks included. And
+ *   the launcher's trigger rules compiled off the same lists.
+ */
+
+import { describe, expect, it } from 'vitest'
+
+import {
+  buildHookIndex,
+  buildTriggerRules,
+} from '../../../../scripts/fleet/gen/hook-dispatch.mts'
+import type { EligibleHook } from '../../../../scripts/fleet/_shared/dispatch-scan.mts'
+
+function hook(
+  name: string,
+  event: string,
+  tools: readonly string[] = [],
+  triggers: readonly string[] = [],
+): EligibleHook {
+  return {
+    __proto__: null,
+    advisory: false,
+    event,
+    lazy: false,
+    name,
+    pure: false,
+    snapshotExcluded: false,
+    stateful: false,
+    tools,
+    triggers,
+  } as EligibleHook
+}
+
+const HOOKS = [
+  hook('any-first', 'PreToolUse'),
+  hook('bash', 'PreToolUse', ['Bash']),
+  hook('edit-write', 'PreToolUse', ['Edit', 'Write']),
+  hook('any-late', 'PreToolUse'),
+  hook('bash-again', 'PreToolUse', ['Bash', 'Bash']),
+  hook('stop', 'Stop'),
+]
+
+describe('buildHookIndex', () => {
+  const index = buildHookIndex(HOOKS)
+
+  it('groups by event', () => {
+    expect([...index.keys()].toSorted()).toEqual(['PreToolUse', 'Stop'])
+    expect(index.get('Stop')?.any).toEqual([5])
+    expect(index.get('Stop')?.byTool.size).toBe(0)
+  })
+
+  it('keeps the any-tool hooks alone in `any`', () => {
+    expect(index.get('PreToolUse')?.any).toEqual([0, 3])
+  })
+
+  it('interleaves any-tool hooks into each tool list in table order', () => {
+    const byTool = index.get('PreToolUse')!.byTool
+    expect(byTool.get('Bash')).toEqual([0, 1, 3, 4])
+    expect(byTool.get('Edit')).toEqual([0, 2, 3])
+    expect(byTool.get('Write')).toEqual([0, 2, 3])
+  })
+
+  it('lists a hook once however often it names a tool', () => {
+    const bash = buildHookIndex(HOOKS).get('PreToolUse')!.byTool.get('Bash')!
+    expect(new Set(bash).size).toBe(bash.length)
+  })
+
+  it('has no tool list a hook does not declare', () => {
+    expect(index.get('PreToolUse')?.byTool.has('Read')).toBe(false)
+  })
+})
+
+describe('buildTriggerRules', () => {
+  it('gates a tool only when every hook on it declares triggers', () => {
+    const rules = buildTriggerRules([
+      hook('a', 'PostToolUse', ['Bash'], ['npx ', 'pnpm dlx']),
+      hook('b', 'PostToolUse', ['Bash'], ['yarn dlx']),
+      hook('c', 'PostToolUse', ['Edit'], ['x']),
+      hook('d', 'PostToolUse', ['Edit']),
+    ])
+    expect(rules).toEqual([
+      {
+        event: 'PostToolUse',
+        tool: 'Bash',
+        triggers: ['npx ', 'pnpm dlx', 'yarn dlx'],
+      },
+    ])
+  })
+
+  it('drops a trigger another one already matches', () => {
+    const rules = buildTriggerRules([
+      hook('a', 'PreToolUse', ['Bash'], ['git push', 'git']),
+      hook('b', 'PreToolUse', ['Bash'], ['rm -rf']),
+    ])
+    expect(rules[0]?.triggers).toEqual(['git', 'rm -rf'])
+  })
+
+  it('leaves a tool to node when a trigger needs escaping in JSON', () => {
+    for (const trigger of ['say "hi"', 'C:\\', 'tab\t', 'é']) {
+      expect(
+        buildTriggerRules([hook('a', 'PreToolUse', ['Bash'], [trigger])]),
+      ).toEqual([])
+    }
+  })
+
+  it('makes no rule for an event with an any-tool hook', () => {
+    expect(
+      buildTriggerRules([
+        hook('a', 'PreToolUse', ['Bash'], ['npx']),
+        hook('any', 'PreToolUse', [], ['npx']),
+      ]),
+    ).toEqual([])
+  })
+})
@@ -0,0 +1,185 @@
+/**
+ * @file The worker pool behind `dispatch()`: table-order starts and results
+ *   at any concurrency, first-block-wins, and the latency budget dropping
+ *   only advisory hooks.
+ */
+
+import { describe, expect, it } from 'vitest'
+
+import {
+  dispatchBudgetMs,
+  dispatchConcurrency,
+  runHookPool,
+} from '../../../../.claude/hooks/fleet/_dispatch/dispatch-pool.mts'
+import type { HookPoolOptions } from '../../../../.claude/hooks/fleet/_dispatch/dispatch-pool.mts'
+import type {
+  DispatchHookEntry,
+  DispatchPayload,
+  DispatchVerdict,
+} from '../../../../.claude/hooks/fleet/_dispatch/dispatch-types.mts'
+
+const PAYLOAD = {
+  __proto__: null,
+  hook_event_name: 'PreToolUse',
+  tool_name: 'Bash',
+} as DispatchPayload
+
+function sleep(ms: number): Promise<void> {
+  return new Promise(resolve => setTimeout(resolve, ms))
+}
+
+interface Probe {
+  readonly entries: DispatchHookEntry[]
+  readonly started: string[]
+  maxInFlight: number
+}
+
+// One entry per spec: [name, delay ms, verdict kind, advisory].
+function probe(
+  specs: ReadonlyArray<
+    readonly [string, number, ('block' | 'notify')?, boolean?]
+  >,
+): Probe {
+  let inFlight = 0
+  const state: Probe = { entries: [], maxInFlight: 0, started: [] }
+  for (const { 0: name, 1: delay, 2: kind, 3: advisory } of specs) {
+    state.entries.push({
+      __proto__: null,
+      advisory,
+      check: async () => {
+        state.started.push(name)
+        inFlight += 1
+        state.maxInFlight = Math.max(state.maxInFlight, inFlight)
+        await sleep(delay)
+        inFlight -= 1
+        return kind
+          ? ({ __proto__: null, kind, message: name } as DispatchVerdict)
+          : undefined
+      },
+      name,
+    } as DispatchHookEntry)
+  }
+  return state
+}
+
+function run(p: Probe, options?: HookPoolOptions | undefined) {
+  return runHookPool(p.entries, PAYLOAD, {
+    __proto__: null,
+    ...options,
+  } as HookPoolOptions)
+}
+
+function messages(outcomes: readonly DispatchVerdict[]): string[] {
+  return outcomes.flatMap(o => (o ? [o.message] : []))
+}
+
+describe('runHookPool', () => {
+  it('runs one at a time by default and reports in table order', async () => {
+    const p = probe([
+      ['a', 5, 'notify'],
+      ['b', 0, 'notify'],
+      ['c', 1, 'notify'],
+    ])
+    const { outcomes, stop } = await run(p)
+    expect(p.maxInFlight).toBe(1)
+    expect(p.started).toEqual(['a', 'b', 'c'])
+    expect(stop).toBe(3)
+    expect(messages(outcomes)).toEqual(['a', 'b', 'c'])
+  })
+
+  it('keeps table order at any concurrency', async () => {
+    const p = probe([
+      ['a', 30, 'notify'],
+      ['b', 0, 'notify'],
+      ['c', 10, 'notify'],
+      ['d', 0, 'notify'],
+    ])
+    const { outcomes } = await run(p, { concurrency: 2 })
+    expect(p.started).toEqual(['a', 'b', 'c', 'd'])
+    expect(p.maxInFlight).toBe(2)
+    expect(messages(outcomes)).toEqual(['a', 'b', 'c', 'd'])
+  })
+
+  it('lets the first block win and starts nothing past it', async () => {
+    const p = probe([
+      ['a', 0, 'notify'],
+      ['b', 0, 'block'],
+      ['c', 0, 'block'],
+    ])
+    const { outcomes, stop } = await run(p)
+    expect(stop).toBe(1)
+    expect(p.started).toEqual(['a', 'b'])
+    expect(messages(outcomes)).toEqual(['a', 'b'])
+  })
+
+  it('waits for every hook before a later-settling lower block', async () => {
+    // c blocks first in time; a and b before it still count, and b's
+    // block is the lower one.
+    const p = probe([
+      ['a', 20, 'notify'],
+      ['b', 10, 'block'],
+      ['c', 0, 'block'],
+    ])
+    const { outcomes, stop } = await run(p, { concurrency: 3 })
+    expect(stop).toBe(1)
+    expect(messages(outcomes.slice(0, stop + 1))).toEqual(['a', 'b'])
+  })
+
+  it('fails a throwing hook open', async () => {
+    const p = probe([['b', 0, 'notify']])
+    p.entries.unshift({
+      __proto__: null,
+      check: () => {
+        throw new Error('boom')
+      },
+      name: 'throws',
+    } as DispatchHookEntry)
+    const { outcomes, stop } = await run(p)
+    expect(stop).toBe(2)
+    expect(outcomes[0]).toBeUndefined()
+    expect(messages(outcomes)).toEqual(['b'])
+  })
+
+  it('drops a slow nudge past the budget, never a guard', async () => {
+    const p = probe([
+      ['slow-nudge', 200, 'notify', true],
+      ['guard', 40, 'block'],
+      ['fast-nudge', 0, 'notify', true],
+    ])
+    const started = Date.now()
+    const { outcomes, stop } = await run(p, { budgetMs: 20, concurrency: 3 })
+    expect(Date.now() - started).toBeLessThan(150)
+    expect(stop).toBe(1)
+    // The guard starts first under a budget, and its block stands.
+    expect(p.started[0]).toBe('guard')
+    expect(outcomes[0]).toBeUndefined()
+    expect(outcomes[1]?.kind).toBe('block')
+  })
+
+  it('keeps an advisory verdict that settles inside the budget', async () => {
+    const p = probe([
+      ['nudge', 0, 'notify', true],
+      ['guard', 5, 'notify'],
+    ])
+    const { outcomes } = await run(p, { budgetMs: 1000 })
+    expect(messages(outcomes)).toEqual(['nudge', 'guard'])
+  })
+})
+
+describe('dispatch env knobs', () => {
+  it('clamps the concurrency', () => {
+    expect(dispatchConcurrency('')).toBe(1)
+    expect(dispatchConcurrency('0')).toBe(1)
+    expect(dispatchConcurrency('junk')).toBe(1)
+    expect(dispatchConcurrency('4')).toBe(4)
+    expect(dispatchConcurrency('999')).toBe(16)
+  })
+
+  it('takes only a positive finite budget', () => {
+    expect(dispatchBudgetMs('')).toBeUndefined()
+    expect(dispatchBudgetMs('0')).toBeUndefined()
+    expect(dispatchBudgetMs('-5')).toBeUndefined()
+    expect(dispatchBudgetMs('Infinity')).toBeUndefined()
+    expect(dispatchBudgetMs('25')).toBe(25)
+  })
+})
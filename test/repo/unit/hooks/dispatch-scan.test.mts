@@ -0,0 +1,149 @@
+/**
+ * @file The dispatch-table maker's source scan: which hooks it marks pure
+ *   (verdict replay), advisory (droppable past the budget) and stateful
+ *   (skipped by batch / replay, a barrier in `dispatch()`).
+ */
+
+import path from 'node:path'
+import { fileURLToPath } from 'node:url'
+
+import { describe, expect, it } from 'vitest'
+
+import {
+  collectEligibleHooks,
+  parseHookSource,
+  parseTriggers,
+} from '../../../../scripts/fleet/_shared/dispatch-scan.mts'
+
+const here = path.dirname(fileURLToPath(import.meta.url))
+const HOOKS_DIR = path.join(
+  here,
+  '..',
+  '..',
+  '..',
+  '..',
+  '.claude',
+  'hooks',
+  'fleet',
+)
+
+// The smallest source the scan accepts as bundle-safe, plus `body`.
+function hookSource(defineHookBody: string, header = '', body = ''): string {
+  return [
+    header,
+    body,
+    `export const hook = defineHook({ ${defineHookBody} })`,
+    'void runHook(hook, import.meta.url)',
+  ].join('\n')
+}
+
+function scan(source: string) {
+  return parseHookSource('h', source)
+}
+
+describe('parseHookSource', () => {
+  it('skips a hook that is not entrypoint-guarded', () => {
+    expect(
+      scan("export const hook = defineHook({ event: 'Stop' })"),
+    ).toBeUndefined()
+  })
+
+  it('reads the event and matcher tools', () => {
+    const h = scan(
+      hookSource("event: 'PostToolUse', matcher: ['Edit', \"Write\"]"),
+    )
+    expect(h?.event).toBe('PostToolUse')
+    expect(h?.tools).toEqual(['Edit', 'Write'])
+    expect(scan(hookSource(''))?.event).toBe('PreToolUse')
+  })
+
+  it('marks a nudge that never blocks as advisory', () => {
+    expect(scan(hookSource("type: 'nudge'"))?.advisory).toBe(true)
+    expect(scan(hookSource("type: 'guard'"))?.advisory).toBe(false)
+    expect(
+      scan(hookSource("type: 'nudge'", '', 'return block(msg)'))?.advisory,
+    ).toBe(false)
+    expect(
+      scan(
+        hookSource(
+          "type: 'nudge'",
+          "import { block } from '../_shared/guard.mts'",
+        ),
+      )?.advisory,
+    ).toBe(false)
+    expect(
+      scan(hookSource("type: 'nudge'", '// @dispatch-must-run — a ledger'))
+        ?.advisory,
+    ).toBe(false)
+  })
+
+  it('reads `type` from the defineHook call, not an earlier object', () => {
+    const h = scan(
+      hookSource("type: 'nudge'", '', "const other = { type: 'guard' }"),
+    )
+    expect(h?.advisory).toBe(true)
+  })
+
+  it('honors @dispatch-pure only without state-reading wrapping', () => {
+    expect(scan(hookSource('', '// @dispatch-pure'))?.pure).toBe(true)
+    expect(scan(hookSource(''))?.pure).toBe(false)
+    for (const wrapping of [
+      "scope: 'convention'",
+      'bypass: ["x"]',
+      'fleetOnly: true',
+      'editedText',
+    ]) {
+      expect(scan(hookSource(wrapping, '// @dispatch-pure'))?.pure).toBe(false)
+    }
+  })
+
+  it('marks writes, kills and ledger writers as stateful', () => {
+    expect(scan(hookSource(''))?.stateful).toBe(false)
+    for (const body of [
+      '// @dispatch-stateful — writes via a sibling module',
+      '// @dispatch-must-run — lands the turn',
+      'writeFileSync(file, data)',
+      'appendFileSync (file, data)',
+      'safeDelete(dir)',
+      'child.kill()',
+      'appendActorEdit(fp, p, cfg)',
+      'recordOccurrence(dir, obs)',
+    ]) {
+      expect(scan(hookSource('', '', body))?.stateful).toBe(true)
+    }
+    // A read, or a name that only contains a writer's, is not a write.
+    for (const body of ['readFileSync(file)', 'rewriteFileSyncLater']) {
+      expect(scan(hookSource('', '', body))?.stateful).toBe(false)
+    }
+  })
+})
+
+describe('parseTriggers', () => {
+  it('keeps a token that holds a `]`, in either quote style', () => {
+    expect(parseTriggers(`triggers: [']52;', "a(b", 'c\\'d']`)).toEqual([
+      ']52;',
+      'a(b',
+      "c'd",
+    ])
+  })
+
+  it('skips the `[]` in an exported array annotation', () => {
+    expect(
+      parseTriggers("export const triggers: readonly string[] = ['x', 'y']"),
+    ).toEqual(['x', 'y'])
+    expect(parseTriggers('no triggers here')).toEqual([])
+  })
+})
+
+describe('the live hook tree', () => {
+  it('marks the Stop lander stateful and its neighbours not', () => {
+    const byName = new Map(
+      collectEligibleHooks(HOOKS_DIR).map(h => [h.name, h]),
+    )
+    // dispatch() forgets settled git probes after it (process-scheduler).
+    expect(byName.get('auto-land-on-stop')?.stateful).toBe(true)
+    expect(byName.get('ai-config-drift-nudge')?.stateful).toBe(false)
+    expect(byName.get('dirty-worktree-stop-guard')?.stateful).toBe(false)
+    expect(byName.get('dirty-worktree-stop-guard')?.advisory).toBe(false)
+  })
+})
@@ -0,0 +1,183 @@
+/**
+ * @file The Stop ordering the per-dispatch process scope must survive: a
+ *   nudge lists the worktree, a stateful hook lands a commit, and a guard
+ *   then blocks on whatever is still dirty. A settled `git status` shared
+ *   across the commit would block on files that were just landed.
+ */
+
+import { mkdtempSync, writeFileSync } from 'node:fs'
+import os from 'node:os'
+import path from 'node:path'
+
+import { safeDeleteSync } from '@socketsecurity/lib-stable/fs/safe'
+import { spawnSync } from '@socketsecurity/lib-stable/process/spawn/child'
+import { afterEach, describe, expect, it } from 'vitest'
+
+import { runHookPool } from '../../../../.claude/hooks/fleet/_dispatch/dispatch-pool.mts'
+import type { HookPoolOptions } from '../../../../.claude/hooks/fleet/_dispatch/dispatch-pool.mts'
+import type {
+  DispatchHookEntry,
+  DispatchPayload,
+} from '../../../../.claude/hooks/fleet/_dispatch/dispatch-types.mts'
+import {
+  closeProcessScope,
+  invalidateProcessScope,
+  openProcessScope,
+  runProcess,
+} from '../../../../.claude/hooks/fleet/_shared/process-scheduler.mts'
+
+const GIT_IDENTITY = [
+  '-c',
+  'user.name=fleet-test',
+  '-c',
+  'user.email=fleet-test@example.com',
+  '-c',
+  'commit.gpgsign=false',
+]
+
+const STOP = { __proto__: null, hook_event_name: 'Stop' } as DispatchPayload
+
+const repos: string[] = []
+
+afterEach(() => {
+  for (const dir of repos.splice(0)) {
+    safeDeleteSync(dir, { force: true })
+  }
+})
+
+function dirtyRepo(): string {
+  const dir = mkdtempSync(path.join(os.tmpdir(), 'dispatch-stop-order-'))
+  repos.push(dir)
+  const init = spawnSync('git', ['init', '-q'], { cwd: dir })
+  expect(init.status).toBe(0)
+  writeFileSync(path.join(dir, 'landed.txt'), 'landed\n')
+  return dir
+}
+
+async function porcelain(cwd: string): Promise<string> {
+  const r = await runProcess('git', ['status', '--porcelain'], { cwd })
+  return r.stdout.trim()
+}
+
+async function land(cwd: string): Promise<void> {
+  await runProcess('git', [...GIT_IDENTITY, 'add', '-A'], {
+    cwd,
+    dedupe: false,
+  })
+  await runProcess('git', [...GIT_IDENTITY, 'commit', '-q', '-m', 'land'], {
+    cwd,
+    dedupe: false,
+  })
+}
+
+// ai-config-drift-nudge, auto-land-on-stop, dirty-worktree-stop-guard: the
+// table order of the three on Stop.
+function stopEntries(repo: string): DispatchHookEntry[] {
+  return [
+    {
+      __proto__: null,
+      check: async () => {
+        await porcelain(repo)
+        return undefined
+      },
+      name: 'ai-config-drift-nudge',
+    },
+    {
+      __proto__: null,
+      check: async () => {
+        await land(repo)
+        return undefined
+      },
+      name: 'auto-land-on-stop',
+      stateful: true,
+    },
+    {
+      __proto__: null,
+      check: async () =>
+        (await porcelain(repo))
+          ? { __proto__: null, kind: 'block', message: 'dirty worktree' }
+          : undefined,
+      name: 'dirty-worktree-stop-guard',
+    },
+  ] as DispatchHookEntry[]
+}
+
+describe('process scope across a stateful hook', () => {
+  it('reuses a settled probe until the scope is invalidated', async () => {
+    const repo = dirtyRepo()
+    openProcessScope()
+    try {
+      expect(await porcelain(repo)).toContain('landed.txt')
+      await land(repo)
+      // Still the pre-commit answer: that is the dedupe.
+      expect(await porcelain(repo)).toContain('landed.txt')
+      invalidateProcessScope()
+      expect(await porcelain(repo)).toBe('')
+    } finally {
+      closeProcessScope()
+    }
+  })
+
+  it('the Stop guard sees the worktree the lander left', async () => {
+    const repo = dirtyRepo()
+    openProcessScope()
+    try {
+      const { outcomes, stop } = await runHookPool(
+        stopEntries(repo),
+        STOP,
+      )
+      expect(stop).toBe(3)
+      expect(outcomes[2]).toBeUndefined()
+    } finally {
+      closeProcessScope()
+    }
+  })
+
+  it('waits out a slow lander under concurrency', async () => {
+    const repo = dirtyRepo()
+    const entries = stopEntries(repo)
+    // A slow lander: a pool that started the guard beside it would see the
+    // worktree before the commit.
+    entries[1] = {
+      __proto__: null,
+      check: async () => {
+        await new Promise(resolve => setTimeout(resolve, 50))
+        await land(repo)
+        return undefined
+      },
+      name: 'auto-land-on-stop',
+      stateful: true,
+    } as DispatchHookEntry
+    openProcessScope()
+    try {
+      const { outcomes, stop } = await runHookPool(entries, STOP, {
+        __proto__: null,
+        concurrency: 4,
+      } as HookPoolOptions)
+      expect(stop).toBe(3)
+      expect(outcomes[2]).toBeUndefined()
+    } finally {
+      closeProcessScope()
+    }
+  })
+
+  it('still blocks on dirt the lander left behind', async () => {
+    const repo = dirtyRepo()
+    const entries = stopEntries(repo)
+    // A lander that lands nothing: the guard's block must stand.
+    entries[1] = {
+      __proto__: null,
+      check: () => undefined,
+      name: 'auto-land-on-stop',
+      stateful: true,
+    } as DispatchHookEntry
+    openProcessScope()
+    try {
+      const { outcomes, stop } = await runHookPool(entries, STOP)
+      expect(stop).toBe(2)
+      expect(outcomes[2]?.kind).toBe('block')
+    } finally {
+      closeProcessScope()
+    }
+  })
+})
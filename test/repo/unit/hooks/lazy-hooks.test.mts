@@ -0,0 +1,118 @@
+/**
+ * @file The snapshot boot's left-out hooks: loaded only for an event and
+ *   tool their hints name, then merged into the frozen table's lists by
+ *   `seq` so the order matches the full `index.cjs` table.
+ */
+
+import { describe, expect, it } from 'vitest'
+
+import {
+  ensureLazyHooks,
+  registerLazyHooks,
+  splicedHooksFor,
+} from '../../../../.claude/hooks/fleet/_dispatch/lazy-hooks.mts'
+import type {
+  DispatchEventIndex,
+  DispatchHookEntry,
+} from '../../../../.claude/hooks/fleet/_dispatch/dispatch-types.mts'
+
+function entry(name: string, seq: number): DispatchHookEntry {
+  return { __proto__: null, name, seq } as DispatchHookEntry
+}
+
+function eventIndex(
+  any: readonly DispatchHookEntry[],
+  byTool: Record<string, readonly DispatchHookEntry[]> = {},
+): DispatchEventIndex {
+  return {
+    __proto__: null,
+    any,
+    byTool: { __proto__: null, ...byTool },
+  } as DispatchEventIndex
+}
+
+function names(list: readonly DispatchHookEntry[] | undefined): string[] {
+  return (list ?? []).map(e => e.name)
+}
+
+// The frozen table's PreToolUse: seq 0, 2, 5 (Bash adds 3).
+const OWN = eventIndex(
+  [entry('own0', 0), entry('own2', 2), entry('own5', 5)],
+  {
+    Bash: [
+      entry('own0', 0),
+      entry('own2', 2),
+      entry('own3', 3),
+      entry('own5', 5),
+    ],
+  },
+)
+
+// The left-out hooks: seq 1 (any tool), 4 (Bash only), 6 (any tool).
+const EXTRA = {
+  __proto__: null,
+  PreToolUse: eventIndex([entry('lazy1', 1), entry('lazy6', 6)], {
+    Bash: [entry('lazy1', 1), entry('lazy4', 4), entry('lazy6', 6)],
+  }),
+  Stop: eventIndex([entry('lazyStop', 0)]),
+} as Record<string, DispatchEventIndex>
+
+describe('lazy hooks', () => {
+  // One module, one registration: the cases run in order.
+  let loads = 0
+  registerLazyHooks({
+    __proto__: null,
+    hints: { __proto__: null, PreToolUse: ['Bash'], Stop: null },
+    load: () => {
+      loads += 1
+      return EXTRA
+    },
+  } as Parameters<typeof registerLazyHooks>[0])
+
+  it('loads nothing for an event or tool the hints do not name', () => {
+    ensureLazyHooks('PostToolUse', 'Bash')
+    ensureLazyHooks('PreToolUse', 'Edit')
+    ensureLazyHooks('PreToolUse', undefined)
+    expect(loads).toBe(0)
+    expect(splicedHooksFor('PreToolUse', 'Bash', OWN)).toBeUndefined()
+  })
+
+  it('loads once for a hinted tool and merges by seq', () => {
+    ensureLazyHooks('PreToolUse', 'Bash')
+    ensureLazyHooks('Stop', undefined)
+    expect(loads).toBe(1)
+    expect(names(splicedHooksFor('PreToolUse', 'Bash', OWN))).toEqual([
+      'own0',
+      'lazy1',
+      'own2',
+      'own3',
+      'lazy4',
+      'own5',
+      'lazy6',
+    ])
+    // A tool neither side names gets both `any` lists, merged.
+    expect(names(splicedHooksFor('PreToolUse', 'Read', OWN))).toEqual([
+      'own0',
+      'lazy1',
+      'own2',
+      'own5',
+      'lazy6',
+    ])
+  })
+
+  it('uses the spliced list alone for an event the table lacks', () => {
+    expect(names(splicedHooksFor('Stop', undefined, undefined))).toEqual([
+      'lazyStop',
+    ])
+  })
+
+  it('leaves an event nothing spliced touches to the table', () => {
+    expect(splicedHooksFor('PostToolUse', 'Bash', OWN)).toBeUndefined()
+  })
+
+  it('hands back the same merged list on a repeat lookup', () => {
+    expect(splicedHooksFor('PreToolUse', 'Bash', OWN)).toBe(
+      splicedHooksFor('PreToolUse', 'Bash', OWN),
+    )
+  })
+})
@@ -0,0 +1,125 @@
+/**
+ * @file The lazy hook-payload parser: it must read exactly like JSON.parse
+ *   whatever the escapes, keys and nesting around the strings it defers.
+ */
+
+import { describe, expect, it } from 'vitest'
+
+import {
+  LAZY_STRING_MIN,
+  LAZY_TEXT_MIN,
+  parseJsonLazy,
+} from '../../../../.claude/hooks/fleet/_shared/lazy-json.mts'
+
+// Long enough on its own to push a payload past LAZY_TEXT_MIN.
+const BIG = LAZY_TEXT_MIN + 1
+
+function writePayload(content: string): string {
+  return JSON.stringify({
+    hook_event_name: 'PreToolUse',
+    tool_input: { content, file_path: '/repo/a.txt' },
+    tool_name: 'Write',
+  })
+}
+
+function isDeferred(owner: object, key: string): boolean {
+  return typeof Object.getOwnPropertyDescriptor(owner, key)?.get === 'function'
+}
+
+describe('parseJsonLazy', () => {
+  it('is plain JSON.parse below LAZY_TEXT_MIN', () => {
+    const text = writePayload('x'.repeat(LAZY_STRING_MIN))
+    const parsed = parseJsonLazy(text) as { tool_input: object }
+    expect(parsed).toEqual(JSON.parse(text))
+    expect(isDeferred(parsed.tool_input, 'content')).toBe(false)
+  })
+
+  it('defers a long value until it is read', () => {
+    const text = writePayload('x'.repeat(BIG))
+    const parsed = parseJsonLazy(text) as {
+      tool_input: { content: string; file_path: string }
+      tool_name: string
+    }
+    expect(parsed.tool_name).toBe('Write')
+    expect(parsed.tool_input.file_path).toBe('/repo/a.txt')
+    expect(isDeferred(parsed.tool_input, 'content')).toBe(true)
+    expect(parsed.tool_input.content).toHaveLength(BIG)
+    // Read once, it settles into a plain data property.
+    expect(isDeferred(parsed.tool_input, 'content')).toBe(false)
+  })
+
+  it('matches JSON.parse across escaped quotes and backslash runs', () => {
+    // A string ending in a backslash closes on `\\"`; `\"` never closes.
+    const tricky = [
+      'a"b',
+      'ends with \\',
+      'two \\\\',
+      '\\"',
+      '\u2028 line sep',
+      'é \u0000 nul',
+    ]
+    for (let i = 0, { length } = tricky; i < length; i += 1) {
+      const content = `${'y'.repeat(BIG)}${tricky[i]!}`
+      const text = JSON.stringify({
+        a: content,
+        b: tricky[i],
+        c: [content, { d: tricky[i] }],
+      })
+      expect(parseJsonLazy(text)).toEqual(JSON.parse(text))
+    }
+  })
+
+  it('never defers a long key', () => {
+    const key = 'k'.repeat(LAZY_STRING_MIN)
+    const text = JSON.stringify({ [key]: 'v', pad: 'p'.repeat(BIG) })
+    const parsed = parseJsonLazy(text) as Record<string, string>
+    expect(Object.keys(parsed)).toEqual([key, 'pad'])
+    expect(parsed[key]).toBe('v')
+    // Whitespace between a key and its colon still marks it as a key.
+    const pad = JSON.stringify('p'.repeat(BIG))
+    const spaced = `{${JSON.stringify(key)} \n\t: ${pad}}`
+    expect(Object.keys(parseJsonLazy(spaced) as object)).toEqual([key])
+  })
+
+  it('defers strings inside arrays', () => {
+    const text = JSON.stringify({ list: ['s', 'z'.repeat(BIG)] })
+    const parsed = parseJsonLazy(text) as { list: string[] }
+    expect(isDeferred(parsed.list, '1')).toBe(true)
+    expect(parsed).toEqual(JSON.parse(text))
+  })
+
+  it('falls back to JSON.parse for a bare top-level string', () => {
+    const text = JSON.stringify('w'.repeat(BIG))
+    expect(parseJsonLazy(text)).toBe(JSON.parse(text))
+  })
+
+  it('falls back to JSON.parse when the text holds the marker', () => {
+    const text = JSON.stringify({
+      a: '\u0000fleet-lazy:0',
+      b: 'm'.repeat(BIG),
+    })
+    const parsed = parseJsonLazy(text) as { a: string }
+    expect(parsed).toEqual(JSON.parse(text))
+    expect(isDeferred(parsed, 'b')).toBe(false)
+  })
+
+  it('throws like JSON.parse on a broken envelope', () => {
+    const text = writePayload('x'.repeat(BIG))
+    expect(() => parseJsonLazy(text.slice(0, -1))).toThrow()
+    expect(() => parseJsonLazy(`[${text}`)).toThrow()
+  })
+
+  it('throws on read, not parse, for a bad escape it deferred', () => {
+    const text = `{"a":"${'x'.repeat(BIG)}\\q"}`
+    const parsed = parseJsonLazy(text) as { a: string }
+    expect(() => parsed.a).toThrow()
+  })
+
+  it('lets a deferred value be overwritten unread', () => {
+    const parsed = parseJsonLazy(writePayload('x'.repeat(BIG))) as {
+      tool_input: { content: string }
+    }
+    parsed.tool_input.content = 'replaced'
+    expect(parsed.tool_input.content).toBe('replaced')
+  })
+})